@@ -36,22 +36,24 @@
 ###################################################################
 # - Find out if the system supports Linux's TX_RING socket API
 # we only try compiling the test since that looks for TX_RING
+# with TPACKET_V2 frame headers
 
 
 INCLUDE(CheckCSourceRuns)
 
 CHECK_C_SOURCE_RUNS("
 #include <sys/socket.h>
-#include <netpacket/packet.h>
+#include <linux/if_packet.h>
 #include <net/ethernet.h>     /* the L2 protocols */
 #include <netinet/in.h>       /* htons */
-#include <linux/if_packet.h>
+#include <stdlib.h>
 
 int
 main(int argc, char *argv[])
 {
     int test;
-    test = TP_STATUS_WRONG_FORMAT
+    test = TP_STATUS_WRONG_FORMAT | PACKET_TX_RING | TPACKET_V2;
+    test += TPACKET2_HDRLEN;
     exit(0);
 }
 "
@@ -135,7 +135,10 @@ CHECK_FUNCTION_EXISTS("pcap_freecode" HAVE_PCAP_FREECODE)
 CHECK_FUNCTION_EXISTS("pcap_get_selectable_fd" HAVE_PCAP_GET_SELECTABLE_FD)
 CHECK_FUNCTION_EXISTS("pcap_lib_version" HAVE_PCAP_LIB_VERSION)
 CHECK_FUNCTION_EXISTS("pcap_list_datalinks" HAVE_PCAP_LIST_DATALINKS)
+CHECK_FUNCTION_EXISTS("pcap_offline_filter" HAVE_PCAP_OFFLINE_FILTER)
 CHECK_FUNCTION_EXISTS("pcap_open_dead" HAVE_PCAP_OPEN_DEAD)
+CHECK_FUNCTION_EXISTS("pcap_open_offline_with_tstamp_precision" HAVE_PCAP_OPEN_OFFLINE_WITH_TSTAMP_PRECISION)
+CHECK_FUNCTION_EXISTS("pcap_open_dead_with_tstamp_precision" HAVE_PCAP_OPEN_DEAD_WITH_TSTAMP_PRECISION)
 CHECK_FUNCTION_EXISTS("pcap_set_datalink" HAVE_PCAP_SET_DATALINK)
 CHECK_FUNCTION_EXISTS("pcap_dump_fopen" HAVE_PCAP_DUMP_FOPEN)
 CHECK_FUNCTION_EXISTS("pcap_inject" HAVE_PCAP_INJECT)
@@ -30,6 +30,7 @@ extern "C" {
 #include "common/pcap_dlt.h"
 #include "common/cache.h"
 #include "common/cidr.h"
+#include "common/csum.h"
 #include "common/err.h"
 #include "common/get.h"
 #include "common/fakepcap.h"
@@ -37,6 +38,9 @@ extern "C" {
 #include "common/fakepoll.h"
 #include "common/list.h"
 #include "common/mac.h"
+#include "common/mmpcap.h"
+#include "common/pcapwrite.h"
+#include "common/pktring.h"
 #include "common/services.h"
 #include "common/utils.h"
 #include "common/xX.h"
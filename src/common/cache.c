@@ -31,12 +31,33 @@
 #include <unistd.h>
 #include <errno.h>
 
+#ifdef HAVE_MMAP
+#include <sys/mman.h>
+#endif
+
 #ifdef DEBUG
 extern int debug;
 #endif
 
 static tcpr_cache_t *new_cache(void);
 
+/* direction of each of the CACHE_PACKETS_PER_BYTE packets in a cache byte */
+#define CACHE_DIR(x) (((x) & 0x2) ? \
+        (((x) & 0x1) ? TCPR_DIR_C2S : TCPR_DIR_S2C) : TCPR_DIR_NOSEND)
+#define CACHE_DIRS(x) { CACHE_DIR(x), CACHE_DIR((x) >> 2), \
+        CACHE_DIR((x) >> 4), CACHE_DIR((x) >> 6) }
+#define CACHE_DIRS4(x) CACHE_DIRS(x), CACHE_DIRS((x) + 1), \
+        CACHE_DIRS((x) + 2), CACHE_DIRS((x) + 3)
+#define CACHE_DIRS16(x) CACHE_DIRS4(x), CACHE_DIRS4((x) + 4), \
+        CACHE_DIRS4((x) + 8), CACHE_DIRS4((x) + 12)
+
+static const u_char cache_dirs[256][CACHE_PACKETS_PER_BYTE] = {
+    CACHE_DIRS16(0), CACHE_DIRS16(16), CACHE_DIRS16(32), CACHE_DIRS16(48),
+    CACHE_DIRS16(64), CACHE_DIRS16(80), CACHE_DIRS16(96), CACHE_DIRS16(112),
+    CACHE_DIRS16(128), CACHE_DIRS16(144), CACHE_DIRS16(160), CACHE_DIRS16(176),
+    CACHE_DIRS16(192), CACHE_DIRS16(208), CACHE_DIRS16(224), CACHE_DIRS16(240)
+};
+
 /**
  * Takes a single char and returns a ptr to a string representation of the
  * 8 bits that make up that char.  Use BIT_STR() to print it out
@@ -56,59 +77,211 @@ byte2bits(char byte, char *bitstring) {
 }
 #endif
 
+/* rounds x up to the next CACHE_ALIGN boundary */
+#define CACHE_ALIGN_UP(x) (((x) + CACHE_ALIGN - 1) & ~((u_int64_t)CACHE_ALIGN - 1))
+
+/* largest # of bytes Adler-32 can sum before the sums need reducing */
+#define ADLER_NMAX 5552
+#define ADLER_BASE 65521
+
+/* the cache file is written through a CACHE_WRITE_CHUNK buffer */
+typedef struct cache_writer_s {
+    int fd;
+    u_char *buf;
+    size_t len;
+    u_int64_t offset;           /* bytes written so far, incl. buf */
+} cache_writer_t;
+
+/**
+ * updates the Adler-32 checksum adler with len bytes of buf
+ */
+static u_int32_t
+cache_adler32(u_int32_t adler, const u_char *buf, size_t len)
+{
+    u_int32_t a = adler & 0xffff, b = adler >> 16;
+    size_t n;
+
+    while (len > 0) {
+        n = len < ADLER_NMAX ? len : ADLER_NMAX;
+        len -= n;
+        while (n--) {
+            a += *buf++;
+            b += a;
+        }
+        a %= ADLER_BASE;
+        b %= ADLER_BASE;
+    }
+
+    return (b << 16) | a;
+}
+
+/**
+ * returns the checksum of the data & index of a version 5 cache file
+ */
+static u_int32_t
+cache_checksum(const char *data, COUNTER data_len, const u_int64_t *index,
+        COUNTER packets)
+{
+    u_int32_t adler = 1;
+
+    adler = cache_adler32(adler, (const u_char *)data, data_len);
+    if (index != NULL)
+        adler = cache_adler32(adler, (const u_char *)index,
+                packets * sizeof(u_int64_t));
+
+    return adler;
+}
+
 /**
  * simple function to read in a cache file created with tcpprep this let's us
  * be really damn fast in picking an interface to send the packet out returns
  * number of cache entries read
  * 
- * now also checks for the cache magic and version
+ * now also checks for the cache magic and version.  The file stays mapped
+ * until the program exits, use open_cache() & close_cache() if you need to
+ * release it.
  */
 
 COUNTER
 read_cache(char **cachedata, const char *cachefile, char **comment)
+{
+    tcpr_cache_map_t cache;
+
+    open_cache(&cache, cachefile);
+    *cachedata = cache.data;
+    *comment = cache.comment;
+
+    return (cache.packets);
+}
+
+/**
+ * maps the whole of cachefile into cache->map, falling back to reading it
+ * into memory if it can't be mmap()'d
+ */
+static void
+map_cache(tcpr_cache_map_t *cache, const char *cachefile)
 {
     int cachefd;
-    tcpr_cache_file_hdr_t header;
+    struct stat statbuf;
     ssize_t read_size = 0;
-    COUNTER cache_size = 0;
+    size_t len;
 
     /* open the file or abort */
     if ((cachefd = open(cachefile, O_RDONLY)) == -1)
         errx(-1, "unable to open %s:%s", cachefile, strerror(errno));
 
-    /* read the cache header and determine compatibility */
-    if ((read_size = read(cachefd, &header, sizeof(header))) < 0)
+    if (fstat(cachefd, &statbuf) == -1)
+        errx(-1, "unable to stat %s:%s", cachefile, strerror(errno));
+
+    if ((u_int64_t)statbuf.st_size > (u_int64_t)SIZE_MAX)
+        errx(-1, "Cache file %s is too big", cachefile);
+
+    cache->maplen = (size_t)statbuf.st_size;
+
+#ifdef HAVE_MMAP
+    if (S_ISREG(statbuf.st_mode) && cache->maplen > 0) {
+        void *map = mmap(NULL, cache->maplen, PROT_READ, MAP_SHARED, cachefd, 0);
+
+        if (map != MAP_FAILED) {
+            cache->map = (u_char *)map;
+            cache->mapped = true;
+            close(cachefd);
+            dbgx(1, "Mapped %zu bytes of %s", cache->maplen, cachefile);
+            return;
+        }
+        dbgx(1, "Unable to mmap() %s: %s", cachefile, strerror(errno));
+    }
+#endif
+
+    /* read it in, growing the buffer as we go since it may not be a file */
+    len = 0;
+    cache->maplen = 0;
+    do {
+        if (cache->maplen == len) {
+            len += CACHE_WRITE_CHUNK;
+            cache->map = (u_char *)safe_realloc(cache->map, len);
+        }
+
+        if ((read_size = read(cachefd, cache->map + cache->maplen,
+                        len - cache->maplen)) > 0)
+            cache->maplen += (size_t)read_size;
+    } while (read_size > 0);
+
+    if (read_size < 0)
         errx(-1, "unable to read from %s:%s,", cachefile, strerror(errno));
 
-    if (read_size < (ssize_t)sizeof(header))
+    close(cachefd);
+}
+
+/**
+ * opens a cache file created with tcpprep and checks its magic & version.
+ * Returns the number of packets in the cache.  See verify_cache() for
+ * checking the checksum.
+ */
+COUNTER
+open_cache(tcpr_cache_map_t *cache, const char *cachefile)
+{
+    tcpr_cache_file_hdr_t header;
+    COUNTER cache_size = 0;
+    u_int64_t data_offset, index_offset = 0;
+    size_t hdrlen = CACHE_V4_HDR_LEN;
+    int version;
+
+    assert(cache);
+
+    memset(cache, 0, sizeof(tcpr_cache_map_t));
+    map_cache(cache, cachefile);
+
+    /* read the cache header and determine compatibility */
+    if (cache->maplen < CACHE_V4_HDR_LEN)
         errx(-1, "Cache file %s doesn't contain a full header", cachefile);
 
+    memset(&header, 0, sizeof(header));
+    memcpy(&header, cache->map, 
+            cache->maplen < sizeof(header) ? cache->maplen : sizeof(header));
+
     /* verify our magic: tcpprep\0 */
     if (memcmp(header.magic, CACHEMAGIC, sizeof(CACHEMAGIC)) != 0)
         errx(-1, "Unable to process %s: not a tcpprep cache file", cachefile);
 
-    /* verify version */
-    if (atoi(header.version) != atoi(CACHEVERSION))
+    /* verify version, version 4 files are still supported */
+    version = atoi(header.version);
+    header.comment_len = ntohs(header.comment_len);
+    if (version == atoi(CACHEVERSION)) {
+        hdrlen = sizeof(header);
+        if (cache->maplen < hdrlen)
+            errx(-1, "Cache file %s doesn't contain a full header", cachefile);
+        header.flags = ntohl(header.flags);
+        cache->has_checksum = true;
+        cache->checksum = ntohl(header.checksum);
+        data_offset = ntohll(header.data_offset);
+        if (header.flags & CACHE_FLAG_INDEX)
+            index_offset = ntohll(header.index_offset);
+    } else if (version == 4) {
+        data_offset = CACHE_V4_HDR_LEN + header.comment_len;
+    } else {
         errx(-1, "Unable to process %s: cache file version missmatch",
              cachefile);
+    }
 
     /* read the comment */
-    header.comment_len = ntohs(header.comment_len);
-    *comment = (char *)safe_malloc(header.comment_len + 1);
-
     dbgx(1, "Comment length: %d", header.comment_len);
-    
-    if ((read_size = read(cachefd, *comment, header.comment_len)) 
-            != header.comment_len)
-        errx(-1, "Unable to read %d bytes of data for the comment (%zu) %s", 
-            header.comment_len, read_size, 
-            read_size == -1 ? strerror(read_size) : "");
 
-    dbgx(1, "Cache file comment: %s", *comment);
+    if (hdrlen + header.comment_len > cache->maplen)
+        errx(-1, "Unable to read %d bytes of data for the comment",
+            header.comment_len);
+
+    cache->comment = (char *)safe_malloc(header.comment_len + 1);
+    memcpy(cache->comment, cache->map + hdrlen, header.comment_len);
+
+    dbgx(1, "Cache file comment: %s", cache->comment);
 
-    /* malloc our cache block */
     header.num_packets = ntohll(header.num_packets);
     header.packets_per_byte = ntohs(header.packets_per_byte);    
+    if (header.packets_per_byte != CACHE_PACKETS_PER_BYTE)
+        errx(-1, "Unable to process %s: %d packets per byte isn't supported",
+            cachefile, header.packets_per_byte);
+
     cache_size = header.num_packets / header.packets_per_byte;
         
     /* deal with any remainder, becuase above divsion is integer */
@@ -120,80 +293,227 @@ read_cache(char **cachedata, const char *cachefile, char **comment)
 
     dbgx(1, "Cache uses %d packets per byte", header.packets_per_byte);
 
-    *cachedata = (char *)safe_malloc(cache_size);
+    if (data_offset > cache->maplen || cache_size > cache->maplen - data_offset)
+        errx(-1, "Cache data length (%llu bytes) doesn't match "
+            "cache header (" COUNTER_SPEC " bytes)", 
+            data_offset > cache->maplen ? 0 : 
+                (unsigned long long)(cache->maplen - data_offset), cache_size);
+
+    cache->data = (char *)cache->map + data_offset;
+    cache->packets = header.num_packets;
+
+    if (index_offset != 0) {
+        if (index_offset % sizeof(u_int64_t) != 0 || index_offset > cache->maplen ||
+                header.num_packets > (cache->maplen - index_offset) / sizeof(u_int64_t))
+            errx(-1, "Unable to process %s: the packet index is truncated", 
+                cachefile);
 
-    /* read in the cache */
-    if ((COUNTER)(read_size = read(cachefd, *cachedata, cache_size)) 
-            != cache_size)
-        errx(-1, "Cache data length (%zu bytes) doesn't match "
-            "cache header (" COUNTER_SPEC " bytes)", read_size, cache_size);
+        cache->index = (const u_int64_t *)(cache->map + index_offset);
+        dbgx(1, "Cache file has an index at offset %llu", index_offset);
+    }
 
     dbgx(1, "Loaded in %llu packets from cache.", header.num_packets);
 
-    close(cachefd);
-    return (header.num_packets);
+    return (cache->packets);
+}
+
+/**
+ * checks the data & index of a cache file opened with open_cache() against
+ * the checksum in its header.  This reads the whole file.  Returns 0 if
+ * they match (or the file is too old to have a checksum) and -1 if not.
+ */
+int
+verify_cache(const tcpr_cache_map_t *cache)
+{
+    COUNTER cache_size;
+
+    assert(cache);
+
+    if (!cache->has_checksum)
+        return 0;
+
+    cache_size = (cache->packets + CACHE_PACKETS_PER_BYTE - 1) / CACHE_PACKETS_PER_BYTE;
+    if (cache->checksum != cache_checksum(cache->data, cache_size, cache->index,
+                cache->packets))
+        return -1;
+
+    return 0;
+}
+
+/**
+ * unmaps (or frees) a cache file opened with open_cache()
+ */
+void
+close_cache(tcpr_cache_map_t *cache)
+{
+    assert(cache);
+
+    if (cache->map != NULL) {
+#ifdef HAVE_MMAP
+        if (cache->mapped)
+            munmap(cache->map, cache->maplen);
+        else
+#endif
+            safe_free(cache->map);
+    }
+
+    safe_free(cache->comment);
+    memset(cache, 0, sizeof(tcpr_cache_map_t));
+}
+
+/**
+ * returns the offset of the given packet in the pcap the cache was built
+ * from, or 0 if the cache has no index.  Lets a replay start at any packet
+ * without reading the ones before it.
+ */
+u_int64_t
+cache_offset(const tcpr_cache_map_t *cache, COUNTER packetid)
+{
+    assert(cache);
+
+    if (cache->index == NULL || packetid == 0 || packetid > cache->packets)
+        return 0;
+
+    return ntohll(cache->index[packetid - 1]);
+}
+
+/**
+ * writes whatever's in the writer's buffer to the file
+ */
+static void
+cache_flush(cache_writer_t *writer)
+{
+    ssize_t written;
+
+    if (writer->len == 0)
+        return;
+
+    written = write(writer->fd, writer->buf, writer->len);
+    dbgx(1, "Wrote %zd bytes of cache file", written);
+    if (written != (ssize_t)writer->len)
+        errx(-1, "Only wrote %zd of %zu bytes to cache file!\n%s",
+             written, writer->len, written == -1 ? strerror(errno) : "");
+    writer->len = 0;
 }
 
+/**
+ * writes out len bytes of data through the writer's buffer
+ */
+static void
+cache_write(cache_writer_t *writer, const void *data, size_t len)
+{
+    const u_char *ptr = (const u_char *)data;
+    size_t n;
+
+    while (len > 0) {
+        n = CACHE_WRITE_CHUNK - writer->len;
+        if (n > len)
+            n = len;
+
+        memcpy(writer->buf + writer->len, ptr, n);
+        writer->len += n;
+        writer->offset += n;
+        ptr += n;
+        len -= n;
+
+        if (writer->len == CACHE_WRITE_CHUNK)
+            cache_flush(writer);
+    }
+}
+
+/**
+ * zero fills the file up to offset
+ */
+static void
+cache_pad(cache_writer_t *writer, u_int64_t offset)
+{
+    static const u_char zeros[CACHE_ALIGN];
+
+    while (writer->offset < offset)
+        cache_write(writer, zeros, offset - writer->offset < CACHE_ALIGN ?
+                (size_t)(offset - writer->offset) : CACHE_ALIGN);
+}
 
 /**
- * writes out the cache file header, comment and then the
- * contents of *cachedata to out_file and then returns the number 
- * of cache entries written
+ * writes out the cache file header, comment, the contents of *cachedata
+ * and, if given, the index of where each of numpackets packets is in the
+ * pcap to out_file and then returns the number of cache entries written
  */
 COUNTER
 write_cache(tcpr_cache_t * cachedata, const int out_file, COUNTER numpackets, 
-    char *comment)
+    char *comment, const u_int64_t *index)
 {
     tcpr_cache_t *mycache = NULL;
-    tcpr_cache_file_hdr_t *cache_header = NULL;
-    uint32_t chars, last = 0;
-    COUNTER packets = 0;
-    ssize_t written = 0;
+    tcpr_cache_file_hdr_t cache_header;
+    cache_writer_t writer;
+    u_int64_t data_offset, data_len, index_offset = 0;
+    u_int64_t buf[CACHE_ALIGN / sizeof(u_int64_t)];
+    uint32_t chars, adler = 1;
+    uint16_t comment_len = 0;
+    COUNTER packets = 0, i, n;
 
     assert(cachedata);
     assert(out_file);
 
-    /* write a header to our file */
-    cache_header = (tcpr_cache_file_hdr_t *)
-        safe_malloc(sizeof(tcpr_cache_file_hdr_t));
-    strncpy(cache_header->magic, CACHEMAGIC, strlen(CACHEMAGIC));
-    strncpy(cache_header->version, CACHEVERSION, strlen(CACHEVERSION));
-    cache_header->packets_per_byte = htons(CACHE_PACKETS_PER_BYTE);
-    cache_header->num_packets = htonll((u_int64_t)numpackets);
-
     /* we can't strlen(NULL) so ... */
-    if (comment != NULL) {
-        cache_header->comment_len = htons((uint16_t)strlen(comment));
-    } else {
-        cache_header->comment_len = 0;
-    }
+    if (comment != NULL)
+        comment_len = (uint16_t)strlen(comment);
 
-    written = write(out_file, cache_header, sizeof(tcpr_cache_file_hdr_t));
-    dbgx(1, "Wrote %zu bytes of cache file header", written);
+    /* checksum the data, which also tells us how much there is */
+    for (mycache = cachedata; mycache != NULL; mycache = mycache->next) {
+        packets += mycache->packets;
 
-    if (written != sizeof(tcpr_cache_file_hdr_t))
-        errx(-1, "Only wrote %zu of %zu bytes of the cache file header!\n%s",
-             written, sizeof(tcpr_cache_file_hdr_t),
-             written == -1 ? strerror(errno) : "");
+        /* calculate how many chars to write */
+        chars = mycache->packets / CACHE_PACKETS_PER_BYTE;
+        if (mycache->packets % CACHE_PACKETS_PER_BYTE)
+            chars++;
 
-    /* don't write comment if there is none */
-    if (comment != NULL) {
-        written = write(out_file, comment, strlen(comment));
-        dbgx(1, "Wrote %zu bytes of comment", written);
-        
-        if (written != (ssize_t)strlen(comment))
-            errx(-1, "Only wrote %zu of %zu bytes of the comment!\n%s",
-                 written, strlen(comment), 
-                 written == -1 ? strerror(errno) : "");
+        adler = cache_adler32(adler, (u_char *)mycache->data, chars);
     }
 
-    mycache = cachedata;
+    if (packets != numpackets)
+        errx(-1, "Cache has data for " COUNTER_SPEC " packets rather than "
+             COUNTER_SPEC, packets, numpackets);
+
+    data_len = (packets + CACHE_PACKETS_PER_BYTE - 1) / CACHE_PACKETS_PER_BYTE;
+    data_offset = CACHE_ALIGN_UP(sizeof(cache_header) + comment_len);
+
+    if (index != NULL) {
+        index_offset = CACHE_ALIGN_UP(data_offset + data_len);
+        for (i = 0; i < packets; i += n) {
+            n = packets - i < CACHE_ALIGN / sizeof(u_int64_t) ? 
+                packets - i : CACHE_ALIGN / sizeof(u_int64_t);
+            for (COUNTER j = 0; j < n; j++)
+                buf[j] = htonll(index[i + j]);
+            adler = cache_adler32(adler, (u_char *)buf, n * sizeof(u_int64_t));
+        }
+    }
 
-    while (!last) {
-        /* increment total packets */
-        packets += mycache->packets;
+    /* write a header to our file */
+    memset(&cache_header, 0, sizeof(cache_header));
+    memcpy(cache_header.magic, CACHEMAGIC, strlen(CACHEMAGIC));
+    memcpy(cache_header.version, CACHEVERSION, strlen(CACHEVERSION));
+    cache_header.packets_per_byte = htons(CACHE_PACKETS_PER_BYTE);
+    cache_header.num_packets = htonll((u_int64_t)packets);
+    cache_header.comment_len = htons(comment_len);
+    cache_header.flags = htonl(index != NULL ? CACHE_FLAG_INDEX : 0);
+    cache_header.checksum = htonl(adler);
+    cache_header.data_offset = htonll(data_offset);
+    cache_header.index_offset = htonll(index_offset);
+
+    memset(&writer, 0, sizeof(writer));
+    writer.fd = out_file;
+    writer.buf = (u_char *)safe_malloc(CACHE_WRITE_CHUNK);
+
+    cache_write(&writer, &cache_header, sizeof(cache_header));
 
-        /* calculate how many chars to write */
+    /* don't write comment if there is none */
+    if (comment != NULL)
+        cache_write(&writer, comment, comment_len);
+
+    cache_pad(&writer, data_offset);
+
+    for (mycache = cachedata; mycache != NULL; mycache = mycache->next) {
         chars = mycache->packets / CACHE_PACKETS_PER_BYTE;
         if (mycache->packets % CACHE_PACKETS_PER_BYTE) {
             chars++;
@@ -201,23 +521,24 @@ write_cache(tcpr_cache_t * cachedata, const int out_file, COUNTER numpackets,
                 CACHE_PACKETS_PER_BYTE);
         }
 
-        /* write to file, and verify it wrote properly */
-        written = write(out_file, mycache->data, chars);
-        dbgx(1, "Wrote %zu bytes of cache data", written);
-        if (written != (ssize_t)chars)
-            errx(-1, "Only wrote %zu of %i bytes to cache file!", written, chars);
+        cache_write(&writer, mycache->data, chars);
+    }
 
-        /*
-         * if that was the last, stop processing, otherwise wash,
-         * rinse, repeat
-         */
-        if (mycache->next != NULL) {
-            mycache = mycache->next;
-        }
-        else {
-            last = 1;
+    if (index != NULL) {
+        cache_pad(&writer, index_offset);
+        for (i = 0; i < packets; i += n) {
+            n = packets - i < CACHE_ALIGN / sizeof(u_int64_t) ? 
+                packets - i : CACHE_ALIGN / sizeof(u_int64_t);
+            for (COUNTER j = 0; j < n; j++)
+                buf[j] = htonll(index[i + j]);
+            cache_write(&writer, buf, n * sizeof(u_int64_t));
         }
     }
+
+    cache_flush(&writer);
+    dbgx(1, "Wrote %llu bytes of cache file", writer.offset);
+    safe_free(writer.buf);
+
     /* return number of packets written */
     return (packets);
 }
@@ -244,6 +565,18 @@ tcpr_dir_t
 add_cache(tcpr_cache_t ** cachedata, const int send, const tcpr_dir_t interface)
 {
     static tcpr_cache_t *lastcache = NULL;
+
+    return add_cache_r(cachedata, &lastcache, send, interface);
+}
+
+/**
+ * same as add_cache() but the caller keeps track of the last entry of
+ * cachedata in lastcache, so several caches can be built at once
+ */
+tcpr_dir_t
+add_cache_r(tcpr_cache_t ** cachedata, tcpr_cache_t ** lastcache,
+        const int send, const tcpr_dir_t interface)
+{
     u_char *byte = NULL;
     uint32_t bit;
     tcpr_dir_t result = TCPR_DIR_ERROR;
@@ -253,36 +586,37 @@ add_cache(tcpr_cache_t ** cachedata, const int send, const tcpr_dir_t interface)
 #endif
 
     assert(cachedata);
+    assert(lastcache);
 
     /* first run?  malloc our first entry, set bit count to 0 */
     if (*cachedata == NULL) {
         *cachedata = new_cache();
-        lastcache = *cachedata;
+        *lastcache = *cachedata;
     }
     else {
         /* check to see if this is the last bit in this struct */
-        if ((lastcache->packets + 1) > (CACHEDATASIZE * CACHE_PACKETS_PER_BYTE)) {
+        if (((*lastcache)->packets + 1) > CACHE_PACKETS_PER_NODE) {
             /*
              * if so, we have to malloc a new one and set bit to 0
              */
             dbg(1, "Adding to cachedata linked list");
-            lastcache->next = new_cache();
-            lastcache = lastcache->next;
+            (*lastcache)->next = new_cache();
+            *lastcache = (*lastcache)->next;
         }
     }
 
     /* always increment our bit count */
-    lastcache->packets++;
-    dbgx(1, "Cache array packet %d", lastcache->packets);
+    (*lastcache)->packets++;
+    dbgx(1, "Cache array packet %d", (*lastcache)->packets);
 
     /* send packet ? */
     if (send == SEND) {
-        index = (lastcache->packets - 1) / (COUNTER)CACHE_PACKETS_PER_BYTE;
-        bit = (((lastcache->packets - 1) % (COUNTER)CACHE_PACKETS_PER_BYTE) * 
+        index = ((*lastcache)->packets - 1) / (COUNTER)CACHE_PACKETS_PER_BYTE;
+        bit = ((((*lastcache)->packets - 1) % (COUNTER)CACHE_PACKETS_PER_BYTE) * 
                (COUNTER)CACHE_BITS_PER_PACKET) + 1;
         dbgx(3, "Bit: %d", bit);
 
-        byte = (u_char *) & lastcache->data[index];
+        byte = (u_char *) & (*lastcache)->data[index];
         *byte += (u_char) (1 << bit);
 
         dbgx(2, "set send bit: byte " COUNTER_SPEC " = 0x%x", index, *byte);
@@ -316,6 +650,57 @@ add_cache(tcpr_cache_t ** cachedata, const int send, const tcpr_dir_t interface)
     return result;
 }
 
+/**
+ * appends the packets of fragment, a cache built on its own with
+ * add_cache_r(), to cachedata.  fragment is linked in as is if cachedata
+ * ends on a full entry, otherwise it's copied a packet at a time and
+ * freed.  Returns the number of packets appended.
+ */
+COUNTER
+append_cache(tcpr_cache_t ** cachedata, tcpr_cache_t ** lastcache,
+        tcpr_cache_t * fragment)
+{
+    tcpr_cache_t *mycache, *next;
+    COUNTER packets = 0;
+    uint32_t i;
+    u_char bits;
+
+    assert(cachedata);
+    assert(lastcache);
+
+    if (fragment == NULL)
+        return 0;
+
+    if (*cachedata == NULL || (*lastcache)->packets == CACHE_PACKETS_PER_NODE) {
+        if (*cachedata == NULL) {
+            *cachedata = fragment;
+        } else {
+            (*lastcache)->next = fragment;
+        }
+
+        for (mycache = fragment; mycache != NULL; mycache = mycache->next) {
+            packets += mycache->packets;
+            *lastcache = mycache;
+        }
+        return packets;
+    }
+
+    for (mycache = fragment; mycache != NULL; mycache = next) {
+        for (i = 0; i < mycache->packets; i++) {
+            bits = (u_char)mycache->data[i / CACHE_PACKETS_PER_BYTE] >>
+                ((i % CACHE_PACKETS_PER_BYTE) * CACHE_BITS_PER_PACKET);
+            add_cache_r(cachedata, lastcache, (bits & 0x2) ? SEND : DONT_SEND,
+                    (bits & 0x1) ? TCPR_DIR_C2S : TCPR_DIR_S2C);
+        }
+
+        packets += mycache->packets;
+        next = mycache->next;
+        safe_free(mycache);
+    }
+
+    return packets;
+}
+
 
 /**
  * returns the action for a given packet based on the CACHE
@@ -356,6 +741,37 @@ check_cache(char *cachedata, COUNTER packetid)
     return TCPR_DIR_ERROR;
 }
 
+/**
+ * expands the direction of count packets, starting at packet first, into
+ * dirs as one tcpr_dir_t per byte.  Gives the same answers as calling
+ * check_cache() for each packet, but a whole cache byte at a time with a
+ * table lookup.  The caller makes sure the cache has that many packets.
+ */
+void
+decode_cache(const char *cachedata, COUNTER first, COUNTER count, u_char *dirs)
+{
+    const u_char *byte;
+    COUNTER i = 0, j;
+
+    assert(cachedata);
+    assert(dirs);
+
+    if (first == 0)
+        err(-1, "packetid must be > 0");
+
+    /* packets up to the next byte boundary */
+    for (; i < count && (first + i - 1) % CACHE_PACKETS_PER_BYTE != 0; i++)
+        dirs[i] = (u_char)check_cache((char *)cachedata, first + i);
+
+    byte = (const u_char *)cachedata + (first + i - 1) / CACHE_PACKETS_PER_BYTE;
+    for (; i + CACHE_PACKETS_PER_BYTE <= count; i += CACHE_PACKETS_PER_BYTE)
+        memcpy(dirs + i, cache_dirs[*byte++], CACHE_PACKETS_PER_BYTE);
+
+    /* and any left over in the last byte */
+    for (j = 0; i < count; i++, j++)
+        dirs[i] = cache_dirs[*byte][j];
+}
+
 /*
  Local Variables:
  mode:c
@@ -21,10 +21,17 @@
 #define __CACHE_H__
 
 #define CACHEMAGIC "tcpprep"
-#define CACHEVERSION "04"
+#define CACHEVERSION "05"
 #define CACHEDATASIZE 255
 #define CACHE_PACKETS_PER_BYTE 4    /* number of packets / byte */
 #define CACHE_BITS_PER_PACKET 2     /* number of bits / packet */
+#define CACHE_PACKETS_PER_NODE (CACHEDATASIZE * CACHE_PACKETS_PER_BYTE)
+#define CACHE_ALIGN 4096            /* data & index start on a page */
+#define CACHE_WRITE_CHUNK (256 * 1024) /* bytes per write() */
+
+#define CACHE_FLAG_INDEX 0x1        /* file has a packet offset index */
+
+#define CACHE_DECODE_BLOCK 256      /* packets decode_cache() callers expand at once */
 
 #define SEND 1
 #define DONT_SEND 0
@@ -35,6 +42,8 @@
  * 02 - 2 bits of data/packet (drop/send & primary or secondary nic)
  * 03 - Write integers in network-byte order
  * 04 - Increase num_packets from 32 to 64 bit integer
+ * 05 - Page align the data so it can be mmap()'d, add a checksum and an
+ *      optional index of where each packet is in the pcap
  */
 
 struct tcpr_cache_s {
@@ -67,10 +76,38 @@ struct tcpr_cache_file_hdr_s {
     u_int64_t num_packets;      /* total # of packets in file */
     u_int16_t packets_per_byte;
     u_int16_t comment_len;      /* how long is the user comment? */
+    /* begin version 5 features */
+    u_int32_t flags;            /* CACHE_FLAG_* */
+    u_int32_t checksum;         /* Adler-32 of the data & index */
+    u_int64_t data_offset;      /* where the data starts, CACHE_ALIGN'd */
+    u_int64_t index_offset;     /* where the index starts, CACHE_ALIGN'd */
 } __attribute__((__packed__));
 
 typedef struct tcpr_cache_file_hdr_s tcpr_cache_file_hdr_t;
 
+/* the part of the header version 4 files have */
+#define CACHE_V4_HDR_LEN 24
+
+/*
+ * A cache file opened with open_cache().  The file is mmap()'d when
+ * possible, so opening it only reads the header & comment and the data
+ * is paged in as packets are looked up.  Checking the checksum reads the
+ * whole file, so that's left to verify_cache().
+ * The index, if any, is the file offset of each packet's record in the
+ * pcap, as 64 bit integers in network-byte order.
+ */
+typedef struct tcpr_cache_map_s {
+    u_char *map;                /* the whole file */
+    size_t maplen;
+    bool mapped;                /* map is mmap()'d rather than malloc()'d */
+    char *data;                 /* CACHE_BITS_PER_PACKET bits per packet */
+    const u_int64_t *index;     /* NULL if the file has no index */
+    COUNTER packets;
+    char *comment;
+    bool has_checksum;          /* version 5 and up */
+    u_int32_t checksum;
+} tcpr_cache_map_t;
+
 enum tcpr_dir_e {
     TCPR_DIR_ERROR  = -1,
     TCPR_DIR_NOSEND = 0,
@@ -80,10 +117,17 @@ enum tcpr_dir_e {
 typedef enum tcpr_dir_e tcpr_dir_t;
 
 
-COUNTER write_cache(tcpr_cache_t *, const int, COUNTER, char *);
+COUNTER write_cache(tcpr_cache_t *, const int, COUNTER, char *, const u_int64_t *);
 tcpr_dir_t add_cache(tcpr_cache_t **, const int, const tcpr_dir_t);
+tcpr_dir_t add_cache_r(tcpr_cache_t **, tcpr_cache_t **, const int, const tcpr_dir_t);
+COUNTER append_cache(tcpr_cache_t **, tcpr_cache_t **, tcpr_cache_t *);
 COUNTER read_cache(char **, const char *, char **);
+COUNTER open_cache(tcpr_cache_map_t *, const char *);
+void close_cache(tcpr_cache_map_t *);
+int verify_cache(const tcpr_cache_map_t *);
+u_int64_t cache_offset(const tcpr_cache_map_t *, COUNTER);
 tcpr_dir_t check_cache(char *, COUNTER);
+void decode_cache(const char *, COUNTER, COUNTER, u_char *);
 
 /* return values for check_cache 
 #define CACHE_ERROR -1
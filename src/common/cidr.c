@@ -36,6 +36,7 @@ extern int debug;
 #endif
 
 static tcpr_cidr_t *cidr2cidr(char *);
+static void cidr_trie_free(struct tcpr_cidrtrie_s *);
 
 /**
  * prints to the given fd all the entries in mycidr
@@ -75,6 +76,9 @@ destroy_cidr(tcpr_cidr_t * cidr)
         if (cidr->next != NULL)
             destroy_cidr(cidr->next);
 
+        if (cidr->trie != NULL)
+            cidr_trie_free(cidr->trie);
+
         safe_free(cidr);
     }
     return;
@@ -95,6 +99,12 @@ add_cidr(tcpr_cidr_t ** cidrdata, tcpr_cidr_t ** newcidr)
     } else {
         cidr_ptr = *cidrdata;
 
+        /* the compiled table no longer matches the list */
+        if (cidr_ptr->trie != NULL) {
+            cidr_trie_free(cidr_ptr->trie);
+            cidr_ptr->trie = NULL;
+        }
+
         while (cidr_ptr->next != NULL)
             cidr_ptr = cidr_ptr->next;
 
@@ -567,6 +577,255 @@ out:
 
 }
 
+/*
+ * Compiled CIDR lists
+ *
+ * Lists of CIDR blocks are matched in order: the first entry which contains
+ * the address wins.  To avoid walking the list for every packet, the list
+ * can be compiled into a multibit trie with an 8 bit stride (4 levels for
+ * IPv4, 16 for IPv6) using controlled prefix expansion.  Each slot holds the
+ * result for its part of the address space and an optional child node for
+ * longer prefixes.  Entries are inserted last to first, each one overwriting
+ * everything it covers, so the table ends up holding the first match for
+ * every address.  A lookup is then one array load per byte of the address
+ * until we hit a slot without a child.
+ */
+typedef struct cidr_trie_node_s {
+    struct {
+        tcpr_cidr_t *result;
+        struct cidr_trie_node_s *child;
+    } slot[256];
+} cidr_trie_node_t;
+
+struct tcpr_cidrtrie_s {
+    cidr_trie_node_t *root4;
+    cidr_trie_node_t *root6;
+};
+
+/**
+ * sets result on a slot and everything below it
+ */
+static void
+cidr_trie_fill(cidr_trie_node_t *node, int i, tcpr_cidr_t *result)
+{
+    int j;
+
+    node->slot[i].result = result;
+    if (node->slot[i].child != NULL) {
+        for (j = 0; j < 256; j++)
+            cidr_trie_fill(node->slot[i].child, j, result);
+    }
+}
+
+/**
+ * inserts the first masklen bits of key with the given result, overriding
+ * anything already covered by the prefix
+ */
+static void
+cidr_trie_insert(cidr_trie_node_t **root, const u_char *key, int masklen,
+        tcpr_cidr_t *result)
+{
+    cidr_trie_node_t *node;
+    int depth = 0, i, span, first;
+
+    if (*root == NULL)
+        *root = (cidr_trie_node_t *)safe_malloc(sizeof(cidr_trie_node_t));
+
+    node = *root;
+
+    /* walk down one byte at a time, creating nodes as needed */
+    while (masklen > 8) {
+        i = key[depth];
+        if (node->slot[i].child == NULL) {
+            node->slot[i].child = (cidr_trie_node_t *)safe_malloc(sizeof(cidr_trie_node_t));
+            /* new node inherits the result of the slot it's replacing */
+            for (span = 0; span < 256; span++)
+                node->slot[i].child->slot[span].result = node->slot[i].result;
+        }
+
+        node = node->slot[i].child;
+        masklen -= 8;
+        depth++;
+    }
+
+    /* expand the remaining 0-8 bits into a range of slots */
+    span = 1 << (8 - masklen);
+    first = key[depth] & ~(span - 1);
+    for (i = first; i < first + span; i++)
+        cidr_trie_fill(node, i, result);
+}
+
+static tcpr_cidr_t *
+cidr_trie_lookup(const cidr_trie_node_t *node, const u_char *key)
+{
+    int depth = 0;
+
+    if (node == NULL)
+        return NULL;
+
+    while (node->slot[key[depth]].child != NULL) {
+        node = node->slot[key[depth]].child;
+        depth++;
+    }
+
+    return node->slot[key[depth]].result;
+}
+
+static tcpr_cidr_t *
+cidr_trie_lookup4(const struct tcpr_cidrtrie_s *trie, const u_int32_t ip)
+{
+    /* ip is in network byte order, so the bytes are in the right order */
+    return cidr_trie_lookup(trie->root4, (const u_char *)&ip);
+}
+
+static tcpr_cidr_t *
+cidr_trie_lookup6(const struct tcpr_cidrtrie_s *trie, const struct tcpr_in6_addr *addr)
+{
+    return cidr_trie_lookup(trie->root6, addr->tcpr_s6_addr);
+}
+
+static void
+cidr_trie_add(struct tcpr_cidrtrie_s *trie, tcpr_cidr_t *cidr, tcpr_cidr_t *result)
+{
+    if (cidr->masklen < 0 || (cidr->family == AF_INET && cidr->masklen > 32) ||
+            cidr->masklen > 128) {
+        warnx("Skipping invalid CIDR mask length: %d", cidr->masklen);
+        return;
+    }
+
+    if (cidr->family == AF_INET) {
+        cidr_trie_insert(&trie->root4, (const u_char *)&cidr->u.network,
+                cidr->masklen, result);
+    } else if (cidr->family == AF_INET6) {
+        cidr_trie_insert(&trie->root6, cidr->u.network6.tcpr_s6_addr,
+                cidr->masklen, result);
+    }
+}
+
+static void
+cidr_trie_free_node(cidr_trie_node_t *node)
+{
+    int i;
+
+    if (node == NULL)
+        return;
+
+    for (i = 0; i < 256; i++)
+        cidr_trie_free_node(node->slot[i].child);
+
+    safe_free(node);
+}
+
+static void
+cidr_trie_free(struct tcpr_cidrtrie_s *trie)
+{
+    cidr_trie_free_node(trie->root4);
+    cidr_trie_free_node(trie->root6);
+    safe_free(trie);
+}
+
+/**
+ * \brief Compiles a list of CIDR blocks for fast lookups
+ *
+ * Once compiled, check_ip_cidr() and check_ip6_cidr() do a trie lookup
+ * instead of walking the list.  add_cidr() throws the compiled version away.
+ */
+void
+compile_cidr(tcpr_cidr_t *cidrdata)
+{
+    tcpr_cidr_t **list, *cidr_ptr;
+    int count = 0, i;
+
+    if (cidrdata == NULL || cidrdata->trie != NULL)
+        return;
+
+    for (cidr_ptr = cidrdata; cidr_ptr != NULL; cidr_ptr = cidr_ptr->next)
+        count++;
+
+    list = (tcpr_cidr_t **)safe_malloc(sizeof(tcpr_cidr_t *) * count);
+    for (i = 0, cidr_ptr = cidrdata; cidr_ptr != NULL; cidr_ptr = cidr_ptr->next)
+        list[i++] = cidr_ptr;
+
+    cidrdata->trie = (struct tcpr_cidrtrie_s *)safe_malloc(sizeof(struct tcpr_cidrtrie_s));
+    for (i = count - 1; i >= 0; i--)
+        cidr_trie_add(cidrdata->trie, list[i], list[i]);
+
+    safe_free(list);
+    dbgx(1, "Compiled %d CIDR blocks", count);
+}
+
+/**
+ * \brief Compiles a CIDR map for fast lookups via cidr_map_lookup4/6()
+ */
+void
+compile_cidr_map(tcpr_cidrmap_t *cidrmap)
+{
+    tcpr_cidrmap_t **list, *map_ptr;
+    int count = 0, i;
+
+    if (cidrmap == NULL || cidrmap->trie != NULL)
+        return;
+
+    for (map_ptr = cidrmap; map_ptr != NULL; map_ptr = map_ptr->next)
+        count++;
+
+    list = (tcpr_cidrmap_t **)safe_malloc(sizeof(tcpr_cidrmap_t *) * count);
+    for (i = 0, map_ptr = cidrmap; map_ptr != NULL; map_ptr = map_ptr->next)
+        list[i++] = map_ptr;
+
+    cidrmap->trie = (struct tcpr_cidrtrie_s *)safe_malloc(sizeof(struct tcpr_cidrtrie_s));
+    for (i = count - 1; i >= 0; i--)
+        cidr_trie_add(cidrmap->trie, list[i]->from, list[i]->to);
+
+    safe_free(list);
+    dbgx(1, "Compiled %d CIDR map entries", count);
+}
+
+/**
+ * returns the target (to) CIDR of the first entry in cidrmap which 
+ * contains ip, or NULL if there is none
+ */
+tcpr_cidr_t *
+cidr_map_lookup4(tcpr_cidrmap_t *cidrmap, const u_int32_t ip)
+{
+    tcpr_cidrmap_t *map_ptr;
+
+    if (cidrmap == NULL)
+        return NULL;
+
+    if (cidrmap->trie != NULL)
+        return cidr_trie_lookup4(cidrmap->trie, ip);
+
+    for (map_ptr = cidrmap; map_ptr != NULL; map_ptr = map_ptr->next) {
+        if (ip_in_cidr(map_ptr->from, ip))
+            return map_ptr->to;
+    }
+
+    return NULL;
+}
+
+/**
+ * IPv6 version of cidr_map_lookup4()
+ */
+tcpr_cidr_t *
+cidr_map_lookup6(tcpr_cidrmap_t *cidrmap, const struct tcpr_in6_addr *addr)
+{
+    tcpr_cidrmap_t *map_ptr;
+
+    if (cidrmap == NULL)
+        return NULL;
+
+    if (cidrmap->trie != NULL)
+        return cidr_trie_lookup6(cidrmap->trie, addr);
+
+    for (map_ptr = cidrmap; map_ptr != NULL; map_ptr = map_ptr->next) {
+        if (ip6_in_cidr(map_ptr->from, addr))
+            return map_ptr->to;
+    }
+
+    return NULL;
+}
+
 
 /**
  * iterates over cidrdata to find if a given ip matches
@@ -583,6 +842,9 @@ check_ip_cidr(tcpr_cidr_t * cidrdata, const unsigned long ip)
      */
     if (cidrdata == NULL)
         return 1;
+
+    if (cidrdata->trie != NULL)
+        return cidr_trie_lookup4(cidrdata->trie, ip) != NULL;
         
     mycidr = cidrdata;
 
@@ -620,6 +882,9 @@ check_ip6_cidr(tcpr_cidr_t * cidrdata, const struct tcpr_in6_addr *addr)
         return 1;
     }
 
+    if (cidrdata->trie != NULL)
+        return cidr_trie_lookup6(cidrdata->trie, addr) != NULL;
+
     mycidr = cidrdata;
 
     /* loop through cidr */
@@ -22,6 +22,9 @@
 #ifndef __CIDR_H__
 #define __CIDR_H__
 
+/* compiled lookup table, see compile_cidr() */
+struct tcpr_cidrtrie_s;
+
 struct tcpr_cidr_s {
     int family;                 /* AF_INET or AF_INET6 */
     union {
@@ -30,6 +33,7 @@ struct tcpr_cidr_s {
     } u;
     int masklen;
     struct tcpr_cidr_s *next;
+    struct tcpr_cidrtrie_s *trie;   /* only set on the head of the list */
 };
 
 typedef struct tcpr_cidr_s tcpr_cidr_t;
@@ -38,6 +42,7 @@ struct tcpr_cidrmap_s {
     tcpr_cidr_t *from;
     tcpr_cidr_t *to;
     struct tcpr_cidrmap_s *next;
+    struct tcpr_cidrtrie_s *trie;   /* only set on the head of the list */
 };
 typedef struct tcpr_cidrmap_s tcpr_cidrmap_t;
 
@@ -58,6 +63,11 @@ char *cidr2iplist(tcpr_cidr_t *, char);
 int ip6_in_cidr(const tcpr_cidr_t * mycidr, const struct tcpr_in6_addr *addr);
 int check_ip6_cidr(tcpr_cidr_t *, const struct tcpr_in6_addr *addr);
 
+void compile_cidr(tcpr_cidr_t *);
+void compile_cidr_map(tcpr_cidrmap_t *);
+tcpr_cidr_t *cidr_map_lookup4(tcpr_cidrmap_t *, const u_int32_t ip);
+tcpr_cidr_t *cidr_map_lookup6(tcpr_cidrmap_t *, const struct tcpr_in6_addr *addr);
+
 #endif
 
 /*
@@ -0,0 +1,364 @@
+/* $Id$ */
+
+/*
+ *   Copyright (c) 2001-2010 Aaron Turner <aturner at synfin dot net>
+ *
+ *   The Tcpreplay Suite of tools is free software: you can redistribute it 
+ *   and/or modify it under the terms of the GNU General Public License as 
+ *   published by the Free Software Foundation, either version 3 of the 
+ *   License, or with the authors permission any later version.
+ *
+ *   The Tcpreplay Suite is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with the Tcpreplay Suite.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "config.h"
+#include "defines.h"
+#include "common.h"
+
+#include <string.h>
+#ifdef HAVE_PTHREAD
+#include <pthread.h>
+#endif
+
+#include "csum.h"
+
+#ifdef HAVE_X86_CPU_DISPATCH
+#include <immintrin.h>
+#endif
+
+/*
+ * Every kernel sums the data as 32bit words into 64bit accumulators and
+ * leaves the carries to csum_fold64() at the very end.  Since 2^16 == 1
+ * (mod 2^16 - 1) that folds to the same ones-complement sum as adding it
+ * up 16 bits at a time, on either byte order.
+ */
+typedef u_int64_t (*csum_kernel_t)(const u_char *, size_t);
+
+static u_int64_t csum_scalar(const u_char *data, size_t len);
+
+static struct {
+    const char *name;
+    csum_kernel_t func;
+} csum_impl = { NULL, NULL };
+
+#ifdef HAVE_PTHREAD
+static pthread_once_t csum_once = PTHREAD_ONCE_INIT;
+#endif
+
+/**
+ * folds a 64bit sum of 16/32bit words down to 16 bits
+ */
+static inline u_int32_t
+csum_fold64(u_int64_t sum)
+{
+    sum = (sum >> 32) + (sum & 0xffffffff);
+    sum = (sum >> 32) + (sum & 0xffffffff);
+    sum = (sum >> 16) + (sum & 0xffff);
+    sum = (sum >> 16) + (sum & 0xffff);
+    return (u_int32_t)sum;
+}
+
+/**
+ * the last 0-3 bytes.  An odd byte is padded with a zero byte after it
+ */
+static inline u_int64_t
+csum_tail(const u_char *data, size_t len)
+{
+    u_int16_t word;
+    u_char pad[2];
+    u_int64_t sum = 0;
+
+    if (len >= 2) {
+        memcpy(&word, data, 2);
+        sum += word;
+        data += 2;
+        len -= 2;
+    }
+
+    if (len == 1) {
+        pad[0] = *data;
+        pad[1] = 0;
+        memcpy(&word, pad, 2);
+        sum += word;
+    }
+
+    return sum;
+}
+
+/**
+ * portable version, 4 bytes at a time.  memcpy() keeps it safe on strict
+ * alignment CPUs no matter where the buffer starts
+ */
+static u_int64_t
+csum_scalar(const u_char *data, size_t len)
+{
+    u_int64_t sum0 = 0, sum1 = 0;
+    u_int32_t w0, w1;
+
+    while (len >= 8) {
+        memcpy(&w0, data, 4);
+        memcpy(&w1, data + 4, 4);
+        sum0 += w0;
+        sum1 += w1;
+        data += 8;
+        len -= 8;
+    }
+
+    if (len >= 4) {
+        memcpy(&w0, data, 4);
+        sum0 += w0;
+        data += 4;
+        len -= 4;
+    }
+
+    return sum0 + sum1 + csum_tail(data, len);
+}
+
+#ifdef HAVE_X86_CPU_DISPATCH
+/**
+ * SSE2: 16 bytes at a time, zero extending each 32bit word to 64 bits
+ */
+__attribute__((target("sse2")))
+static u_int64_t
+csum_sse2(const u_char *data, size_t len)
+{
+    __m128i zero = _mm_setzero_si128();
+    __m128i acc0 = zero, acc1 = zero, v;
+    u_int64_t lanes[2];
+
+    while (len >= 16) {
+        v = _mm_loadu_si128((const __m128i *)data);
+        acc0 = _mm_add_epi64(acc0, _mm_unpacklo_epi32(v, zero));
+        acc1 = _mm_add_epi64(acc1, _mm_unpackhi_epi32(v, zero));
+        data += 16;
+        len -= 16;
+    }
+
+    _mm_storeu_si128((__m128i *)lanes, _mm_add_epi64(acc0, acc1));
+    return lanes[0] + lanes[1] + csum_scalar(data, len);
+}
+
+/**
+ * AVX2: 64 bytes per loop in two independent chains
+ */
+__attribute__((target("avx2")))
+static u_int64_t
+csum_avx2(const u_char *data, size_t len)
+{
+    __m256i zero = _mm256_setzero_si256();
+    __m256i acc0 = zero, acc1 = zero, acc2 = zero, acc3 = zero, v0, v1;
+    u_int64_t lanes[4];
+
+    while (len >= 64) {
+        v0 = _mm256_loadu_si256((const __m256i *)data);
+        v1 = _mm256_loadu_si256((const __m256i *)(data + 32));
+        acc0 = _mm256_add_epi64(acc0, _mm256_unpacklo_epi32(v0, zero));
+        acc1 = _mm256_add_epi64(acc1, _mm256_unpackhi_epi32(v0, zero));
+        acc2 = _mm256_add_epi64(acc2, _mm256_unpacklo_epi32(v1, zero));
+        acc3 = _mm256_add_epi64(acc3, _mm256_unpackhi_epi32(v1, zero));
+        data += 64;
+        len -= 64;
+    }
+
+    if (len >= 32) {
+        v0 = _mm256_loadu_si256((const __m256i *)data);
+        acc0 = _mm256_add_epi64(acc0, _mm256_unpacklo_epi32(v0, zero));
+        acc1 = _mm256_add_epi64(acc1, _mm256_unpackhi_epi32(v0, zero));
+        data += 32;
+        len -= 32;
+    }
+
+    acc0 = _mm256_add_epi64(_mm256_add_epi64(acc0, acc1), _mm256_add_epi64(acc2, acc3));
+    _mm256_storeu_si256((__m256i *)lanes, acc0);
+    return lanes[0] + lanes[1] + lanes[2] + lanes[3] + csum_scalar(data, len);
+}
+
+#ifdef HAVE_AVX512F
+/**
+ * AVX-512: 128 bytes per loop, the tail is done with a masked load
+ */
+__attribute__((target("avx512f")))
+static u_int64_t
+csum_avx512(const u_char *data, size_t len)
+{
+    __m512i zero = _mm512_setzero_si512();
+    __m512i acc0 = zero, acc1 = zero, acc2 = zero, acc3 = zero, v0, v1;
+    __mmask16 mask;
+
+    while (len >= 128) {
+        v0 = _mm512_loadu_si512((const void *)data);
+        v1 = _mm512_loadu_si512((const void *)(data + 64));
+        acc0 = _mm512_add_epi64(acc0, _mm512_unpacklo_epi32(v0, zero));
+        acc1 = _mm512_add_epi64(acc1, _mm512_unpackhi_epi32(v0, zero));
+        acc2 = _mm512_add_epi64(acc2, _mm512_unpacklo_epi32(v1, zero));
+        acc3 = _mm512_add_epi64(acc3, _mm512_unpackhi_epi32(v1, zero));
+        data += 128;
+        len -= 128;
+    }
+
+    /* whole 32bit words left over; masked off lanes read as zero */
+    while (len >= 4) {
+        mask = len >= 64 ? 0xffff : (__mmask16)((1 << (len / 4)) - 1);
+        v0 = _mm512_maskz_loadu_epi32(mask, (const void *)data);
+        acc0 = _mm512_add_epi64(acc0, _mm512_unpacklo_epi32(v0, zero));
+        acc1 = _mm512_add_epi64(acc1, _mm512_unpackhi_epi32(v0, zero));
+        data += len >= 64 ? 64 : len & ~(size_t)3;
+        len -= len >= 64 ? 64 : len & ~(size_t)3;
+    }
+
+    acc0 = _mm512_add_epi64(_mm512_add_epi64(acc0, acc1), _mm512_add_epi64(acc2, acc3));
+    return (u_int64_t)_mm512_reduce_add_epi64(acc0) + csum_tail(data, len);
+}
+#endif /* HAVE_AVX512F */
+#endif /* HAVE_X86_CPU_DISPATCH */
+
+/**
+ * picks the fastest kernel the CPU supports, unless csum_set_kernel()
+ * already chose one
+ */
+static void
+csum_pick(void)
+{
+    if (csum_impl.func != NULL)
+        return;
+
+#ifdef HAVE_X86_CPU_DISPATCH
+    __builtin_cpu_init();
+#ifdef HAVE_AVX512F
+    if (csum_set_kernel("avx512") == 0)
+        return;
+#endif
+    if (csum_set_kernel("avx2") == 0)
+        return;
+    if (csum_set_kernel("sse2") == 0)
+        return;
+#endif
+
+    csum_set_kernel("scalar");
+}
+
+/**
+ * \brief Picks the fastest checksum kernel this CPU supports
+ *
+ * Each tool calls this at startup, before any worker threads exist, so
+ * the packet path never runs cpuid.  csum_partial() still calls it as a
+ * fallback; the selection only ever runs once.
+ */
+void
+csum_init(void)
+{
+#ifdef HAVE_PTHREAD
+    pthread_once(&csum_once, csum_pick);
+#else
+    csum_pick();
+#endif
+}
+
+/**
+ * \brief Forces a specific kernel: scalar, sse2, avx2 or avx512
+ *
+ * Returns 0 on success or -1 if it isn't built in or the CPU can't run it
+ */
+int
+csum_set_kernel(const char *name)
+{
+    csum_kernel_t func = NULL;
+
+    assert(name);
+
+    if (strcmp(name, "scalar") == 0) {
+        func = csum_scalar;
+    }
+#ifdef HAVE_X86_CPU_DISPATCH
+    else if (strcmp(name, "sse2") == 0 && __builtin_cpu_supports("sse2")) {
+        func = csum_sse2;
+    } else if (strcmp(name, "avx2") == 0 && __builtin_cpu_supports("avx2")) {
+        func = csum_avx2;
+    }
+#ifdef HAVE_AVX512F
+    else if (strcmp(name, "avx512") == 0 && __builtin_cpu_supports("avx512f")) {
+        func = csum_avx512;
+    }
+#endif
+#endif
+
+    if (func == NULL)
+        return -1;
+
+    dbgx(1, "Using %s checksum kernel", name);
+    csum_impl.name = name;
+    csum_impl.func = func;
+    return 0;
+}
+
+/**
+ * \brief Returns the name of the checksum kernel in use
+ */
+const char *
+csum_kernel(void)
+{
+    csum_init();
+    return csum_impl.name;
+}
+
+/**
+ * \brief Adds len bytes of data to a running ones-complement sum
+ *
+ * sum is the result of an earlier csum_partial() (or 0 to start) and the
+ * return value is folded to 16 bits, so a few of them can be safely added
+ * together before calling csum_fold().
+ */
+u_int32_t
+csum_partial(const void *data, size_t len, u_int32_t sum)
+{
+    if (csum_impl.func == NULL)
+        csum_init();
+
+    return csum_fold64(csum_impl.func((const u_char *)data, len) + sum);
+}
+
+/**
+ * \brief Reference implementation: the classic 16 bits at a time loop
+ *
+ * Slow; only meant for verifying the other kernels.
+ */
+u_int32_t
+csum_partial_ref(const void *data, size_t len, u_int32_t sum)
+{
+    const u_char *p = (const u_char *)data;
+    u_int64_t total = sum;
+    u_int16_t word;
+
+    while (len > 1) {
+        memcpy(&word, p, 2);
+        total += word;
+        p += 2;
+        len -= 2;
+    }
+
+    return csum_fold64(total + csum_tail(p, len));
+}
+
+/**
+ * \brief Turns a ones-complement sum into the checksum to put in a header
+ */
+u_int16_t
+csum_fold(u_int32_t sum)
+{
+    return (u_int16_t)~csum_fold64(sum);
+}
+
+/*
+ Local Variables:
+ mode:c
+ indent-tabs-mode:nil
+ c-basic-offset:4
+ End:
+*/
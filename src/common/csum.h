@@ -0,0 +1,54 @@
+/* $Id$ */
+
+/*
+ *   Copyright (c) 2001-2010 Aaron Turner <aturner at synfin dot net>
+ *
+ *   The Tcpreplay Suite of tools is free software: you can redistribute it 
+ *   and/or modify it under the terms of the GNU General Public License as 
+ *   published by the Free Software Foundation, either version 3 of the 
+ *   License, or with the authors permission any later version.
+ *
+ *   The Tcpreplay Suite is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with the Tcpreplay Suite.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/*
+ * Internet (RFC 1071) ones-complement checksum.  The work is done by the
+ * widest SIMD kernel the CPU supports, picked once via cpuid the first
+ * time it's needed, with a portable scalar version for everyone else.
+ *
+ * csum_partial() returns the folded 16bit sum of the data in host byte
+ * order words (just like summing it as u_int16_t's), so partial sums of
+ * the pseudo header & payload can simply be added.  csum_fold() turns the
+ * total into the checksum to store in the packet.
+ */
+
+#ifndef __CSUM_H__
+#define __CSUM_H__
+
+#include "config.h"
+#include "defines.h"
+
+u_int32_t csum_partial(const void *data, size_t len, u_int32_t sum);
+u_int32_t csum_partial_ref(const void *data, size_t len, u_int32_t sum);
+u_int16_t csum_fold(u_int32_t sum);
+
+void csum_init(void);
+const char *csum_kernel(void);
+int csum_set_kernel(const char *name);
+
+#endif
+
+/*
+ Local Variables:
+ mode:c
+ indent-tabs-mode:nil
+ c-basic-offset:4
+ End:
+*/
@@ -62,6 +62,35 @@ pcap_datalink_val_to_name(int dlt)
 
 #endif
 
+/**
+ * pcap_open_offline() which returns nanosecond timestamps if libpcap
+ * supports it.  See PKTHDR_TS_UNITS
+ */
+pcap_t *
+tcpr_pcap_open_offline(const char *path, char *ebuf)
+{
+#ifdef PKTHDR_TS_NSEC
+    return pcap_open_offline_with_tstamp_precision(path, PCAP_TSTAMP_PRECISION_NANO, ebuf);
+#else
+    return pcap_open_offline(path, ebuf);
+#endif
+}
+
+/**
+ * pcap_open_dead() for writing a file with nanosecond timestamps if nsec
+ * is set and libpcap supports it.  pcap_dump() doesn't convert the ts, so
+ * it's up to the caller to match the packets to the file
+ */
+pcap_t *
+tcpr_pcap_open_dead(int dlt, int snaplen, bool nsec)
+{
+#ifdef HAVE_PCAP_OPEN_DEAD_WITH_TSTAMP_PRECISION
+    if (nsec)
+        return pcap_open_dead_with_tstamp_precision(dlt, snaplen, PCAP_TSTAMP_PRECISION_NANO);
+#endif
+    return pcap_open_dead(dlt, snaplen);
+}
+
 /*
  Local Variables:
  mode:c
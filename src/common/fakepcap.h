@@ -44,6 +44,27 @@ const char *pcap_datalink_val_to_name(int dlt);
 
 #endif
 
+/*
+ * libpcap >= 1.5 can hand us nanosecond timestamps (in ts.tv_usec!) no
+ * matter what precision the file was written with.  When it can we always
+ * ask for them, so the ts of every struct pcap_pkthdr read from a file is
+ * in PKTHDR_TS_UNITS per second.  Use these macros rather then assuming
+ * the ts is a real struct timeval.
+ */
+#ifdef HAVE_PCAP_OPEN_OFFLINE_WITH_TSTAMP_PRECISION
+#define PKTHDR_TS_NSEC 1
+#define PKTHDR_TS_UNITS 1000000000
+#else
+#define PKTHDR_TS_UNITS 1000000
+#endif
+
+#define PKTHDR_TS_TO_NANOSEC(tsp) \
+    ((u_int64_t)(tsp)->tv_sec * 1000000000 + \
+     (u_int64_t)(tsp)->tv_usec * (1000000000 / PKTHDR_TS_UNITS))
+
+pcap_t *tcpr_pcap_open_offline(const char *path, char *ebuf);
+pcap_t *tcpr_pcap_open_dead(int dlt, int snaplen, bool nsec);
+
 #endif /* end of _FAKEPCAP_H_ */
 
 /*
@@ -0,0 +1,588 @@
+/* $Id$ */
+
+/*
+ *   Copyright (c) 2001-2010 Aaron Turner <aturner at synfin dot net>
+ *
+ *   The Tcpreplay Suite of tools is free software: you can redistribute it 
+ *   and/or modify it under the terms of the GNU General Public License as 
+ *   published by the Free Software Foundation, either version 3 of the 
+ *   License, or with the authors permission any later version.
+ *
+ *   The Tcpreplay Suite is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with the Tcpreplay Suite.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "config.h"
+#include "defines.h"
+#include "common.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#ifdef HAVE_MMAP
+#include <sys/mman.h>
+#endif
+
+#include "mmpcap.h"
+
+#define PCAP_MAGIC          0xa1b2c3d4
+#define PCAP_NSEC_MAGIC     0xa1b23c4d
+
+/* on disk pcap file & record headers */
+struct mmpcap_file_hdr {
+    u_int32_t magic;
+    u_int16_t version_major;
+    u_int16_t version_minor;
+    int32_t thiszone;
+    u_int32_t sigfigs;
+    u_int32_t snaplen;
+    u_int32_t linktype;
+};
+
+struct mmpcap_rec_hdr {
+    u_int32_t ts_sec;
+    u_int32_t ts_frac;
+    u_int32_t caplen;
+    u_int32_t len;
+};
+
+/* biggest caplen libpcap will accept, regardless of the snaplen */
+#define MMPCAP_MAX_CAPLEN 262144
+
+static inline u_int32_t
+mmpcap_swap32(u_int32_t x)
+{
+    return ((x & 0xff) << 24) | ((x & 0xff00) << 8) |
+        ((x >> 8) & 0xff00) | ((x >> 24) & 0xff);
+}
+
+/**
+ * \brief Maps the file if it's a regular, uncompressed pcap file
+ *
+ * Returns true if mm->map is usable.  Any failure is silent because the
+ * caller can always fall back to libpcap, which reports real errors.
+ */
+static bool
+mmpcap_map(mmpcap_t *mm, const char *path)
+{
+#ifdef HAVE_MMAP
+    struct mmpcap_file_hdr hdr;
+    struct stat statbuf;
+    void *map;
+    int fd;
+
+    if (strcmp(path, "-") == 0)
+        return false;
+
+    if ((fd = open(path, O_RDONLY)) < 0)
+        return false;
+
+    if (fstat(fd, &statbuf) < 0 || !S_ISREG(statbuf.st_mode) ||
+            (size_t)statbuf.st_size < sizeof(hdr) ||
+            (u_int64_t)statbuf.st_size > (u_int64_t)SIZE_MAX) {
+        close(fd);
+        return false;
+    }
+
+    map = mmap(NULL, (size_t)statbuf.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        dbgx(1, "Unable to mmap() %s: %s", path, strerror(errno));
+        return false;
+    }
+
+    memcpy(&hdr, map, sizeof(hdr));
+    switch (hdr.magic) {
+    case PCAP_MAGIC:
+        break;
+    case PCAP_NSEC_MAGIC:
+        mm->nsec = true;
+        break;
+    default:
+        switch (mmpcap_swap32(hdr.magic)) {
+        case PCAP_MAGIC:
+            mm->swapped = true;
+            break;
+        case PCAP_NSEC_MAGIC:
+            mm->swapped = true;
+            mm->nsec = true;
+            break;
+        default:
+            /* pcap-ng, compressed or some other format libpcap may know */
+            munmap(map, (size_t)statbuf.st_size);
+            return false;
+        }
+    }
+
+    mm->map = (u_char *)map;
+    mm->maplen = (size_t)statbuf.st_size;
+    mm->offset = sizeof(hdr);
+    mm->snaplen = mm->swapped ? mmpcap_swap32(hdr.snaplen) : hdr.snaplen;
+
+#ifdef HAVE_MADVISE
+    madvise(mm->map, mm->maplen, MADV_SEQUENTIAL);
+#endif
+
+    dbgx(1, "Using mmap()'d reader for %s (%zu bytes%s%s)", path, mm->maplen,
+            mm->swapped ? ", swapped" : "", mm->nsec ? ", nsec" : "");
+    return true;
+#else
+    return false;
+#endif
+}
+
+#if defined(HAVE_PTHREAD) && defined(HAVE_MMAP)
+/**
+ * \brief Read-ahead thread: keeps mm->window bytes past the reader paged in
+ *
+ * Touching the pages here means the page faults (and the disk reads behind
+ * them on a cold file) block this thread rather than the one sending.
+ */
+static void *
+mmpcap_prefetcher(void *arg)
+{
+    mmpcap_t *mm = (mmpcap_t *)arg;
+    size_t pagesize = (size_t)getpagesize(), start, end, off;
+    u_int32_t sum = 0;
+
+    pthread_mutex_lock(&mm->lock);
+    while (!mm->stop && mm->prefetched < mm->maplen) {
+        if (mm->prefetched >= mm->consumed + mm->window) {
+            pthread_cond_wait(&mm->cond, &mm->lock);
+            continue;
+        }
+        start = mm->prefetched;
+        pthread_mutex_unlock(&mm->lock);
+
+        end = start + MMPCAP_PREFETCH_CHUNK;
+        if (end > mm->maplen)
+            end = mm->maplen;
+
+#ifdef HAVE_MADVISE
+        /* get the whole chunk in flight before we wait on the first page */
+        madvise(mm->map + start, end - start, MADV_WILLNEED);
+#endif
+        for (off = start; off < end; off += pagesize)
+            sum += mm->map[off];
+
+        pthread_mutex_lock(&mm->lock);
+        mm->prefetched = end;
+    }
+    mm->sink = sum;
+    pthread_mutex_unlock(&mm->lock);
+
+    return NULL;
+}
+
+/**
+ * \brief Tells the prefetcher how far the reader got
+ */
+static void
+mmpcap_kick(mmpcap_t *mm)
+{
+    pthread_mutex_lock(&mm->lock);
+    mm->consumed = mm->offset;
+    pthread_cond_signal(&mm->cond);
+    pthread_mutex_unlock(&mm->lock);
+
+    mm->kick = mm->offset + mm->window / 8;
+}
+#endif
+
+/**
+ * \brief Start a read-ahead thread for the mapped file
+ *
+ * The thread stays up to window bytes ahead of mmpcap_next() so that
+ * reading a file which isn't in the page cache doesn't stall the caller.
+ * Does nothing if the file isn't mapped or we don't have threads.
+ */
+void
+mmpcap_prefetch(mmpcap_t *mm, size_t window)
+{
+    assert(mm);
+
+#if defined(HAVE_PTHREAD) && defined(HAVE_MMAP)
+    if (mm->map == NULL || mm->window > 0 || window == 0)
+        return;
+
+    mm->window = window < MMPCAP_PREFETCH_CHUNK ? MMPCAP_PREFETCH_CHUNK : window;
+    mm->prefetched = mm->offset;
+    mm->consumed = mm->offset;
+    mm->kick = mm->offset + mm->window / 8;
+
+    pthread_mutex_init(&mm->lock, NULL);
+    pthread_cond_init(&mm->cond, NULL);
+    if ((errno = pthread_create(&mm->thread, NULL, mmpcap_prefetcher, mm)) != 0)
+        errx(-1, "Unable to start prefetch thread: %s", strerror(errno));
+
+    dbgx(1, "Prefetching up to %zu bytes ahead", mm->window);
+#endif
+}
+
+/**
+ * \brief Returns the # of packets which were read before being prefetched
+ */
+COUNTER
+mmpcap_stalls(const mmpcap_t *mm)
+{
+    assert(mm);
+    return mm->stalls;
+}
+
+/**
+ * \brief Returns the # of bytes read ahead by the prefetch thread
+ */
+COUNTER
+mmpcap_prefetched(const mmpcap_t *mm)
+{
+    assert(mm);
+    return mm->window > 0 ? (COUNTER)mm->prefetched : 0;
+}
+
+static void
+mmpcap_unmap(mmpcap_t *mm)
+{
+#ifdef HAVE_MMAP
+    if (mm->map != NULL && !mm->slice)
+        munmap(mm->map, mm->maplen);
+#endif
+    mm->map = NULL;
+    mm->maplen = 0;
+}
+
+/**
+ * \brief Opens a zero-copy reader for the pcap at path
+ *
+ * pcap must be the libpcap handle for the same file: it's used to read
+ * packets if the file can't be mapped and remains the caller's to close.
+ * Never returns NULL.
+ */
+mmpcap_t *
+mmpcap_open(const char *path, pcap_t *pcap)
+{
+    mmpcap_t *mm;
+
+    assert(path);
+    assert(pcap);
+
+    mm = (mmpcap_t *)safe_malloc(sizeof(mmpcap_t));
+    mm->pcap = pcap;
+
+    if (!mmpcap_map(mm, path))
+        dbgx(1, "Reading %s via libpcap", path);
+
+    return mm;
+}
+
+/**
+ * \brief Opens a reader for the records between the given file offsets
+ *
+ * The slice shares the mapping (and the BPF filter) of mm, which must be
+ * mapped and must outlive it.  start & end must be record boundaries, see
+ * mmpcap_skip() and mmpcap_tell().  Slices can be read by different
+ * threads at the same time.
+ */
+mmpcap_t *
+mmpcap_slice(const mmpcap_t *mm, size_t start, size_t end)
+{
+    mmpcap_t *slice;
+
+    assert(mm);
+    assert(mm->map != NULL);
+    assert(start <= end && end <= mm->maplen);
+
+    slice = (mmpcap_t *)safe_malloc(sizeof(mmpcap_t));
+    slice->pcap = mm->pcap;
+    slice->map = mm->map;
+    slice->maplen = end;
+    slice->offset = start;
+    slice->advised = start;
+    slice->swapped = mm->swapped;
+    slice->nsec = mm->nsec;
+    slice->snaplen = mm->snaplen;
+    slice->filter = mm->filter;
+    slice->slice = true;
+
+    return slice;
+}
+
+/**
+ * \brief Only return packets matching the given BPF filter
+ *
+ * The filter must also be set on the libpcap handle for the fallback path.
+ * If libpcap can't apply a filter to our packets, we stop using the mapping.
+ */
+void
+mmpcap_setfilter(mmpcap_t *mm, const struct bpf_program *filter)
+{
+    assert(mm);
+
+#ifdef HAVE_PCAP_OFFLINE_FILTER
+    mm->filter = filter;
+#else
+    if (filter != NULL && mm->map != NULL) {
+        if (mm->offset != sizeof(struct mmpcap_file_hdr))
+            errx(-1, "%s", "Unable to set a filter once reading has started");
+        mmpcap_unmap(mm);
+    }
+#endif
+}
+
+/**
+ * \brief Returns true if packets are read from the mapping
+ */
+bool
+mmpcap_mapped(const mmpcap_t *mm)
+{
+    assert(mm);
+    return mm->map != NULL;
+}
+
+/**
+ * \brief Returns true if the file has nanosecond timestamps
+ *
+ * Only known for mapped files, everything else is assumed to be usec.
+ * Note this is about the file: see PKTHDR_TS_UNITS for the units of the
+ * timestamps mmpcap_next() returns.
+ */
+bool
+mmpcap_nsec(const mmpcap_t *mm)
+{
+    assert(mm);
+    return mm->map != NULL && mm->nsec;
+}
+
+/**
+ * \brief Drop in replacement for pcap_next()
+ *
+ * The returned pointer is into the read only file mapping (or libpcap's
+ * buffer) so it must not be modified.  Mapped packets stay valid until
+ * mmpcap_close().  Returns NULL at EOF.
+ */
+const u_char *
+mmpcap_next(mmpcap_t *mm, struct pcap_pkthdr *pkthdr)
+{
+    struct mmpcap_rec_hdr rec;
+    const u_char *pktdata;
+    u_int32_t maxcap;
+#ifdef HAVE_MADVISE
+    size_t start, pagemask;
+#endif
+
+    assert(mm);
+    assert(pkthdr);
+
+    if (mm->map == NULL)
+        return pcap_next(mm->pcap, pkthdr);
+
+    maxcap = mm->snaplen > MMPCAP_MAX_CAPLEN ? mm->snaplen : MMPCAP_MAX_CAPLEN;
+
+    do {
+        if (mm->offset + sizeof(rec) > mm->maplen) {
+            if (mm->offset != mm->maplen)
+                warnx("%s", "pcap file is truncated, ignoring partial record");
+            return NULL;
+        }
+
+        memcpy(&rec, mm->map + mm->offset, sizeof(rec));
+        if (mm->swapped) {
+            rec.ts_sec = mmpcap_swap32(rec.ts_sec);
+            rec.ts_frac = mmpcap_swap32(rec.ts_frac);
+            rec.caplen = mmpcap_swap32(rec.caplen);
+            rec.len = mmpcap_swap32(rec.len);
+        }
+
+        if (rec.caplen > maxcap) {
+            warnx("pcap record has a bogus caplen of %u bytes", rec.caplen);
+            return NULL;
+        }
+
+        if (mm->offset + sizeof(rec) + rec.caplen > mm->maplen) {
+            warnx("%s", "pcap file is truncated, ignoring partial packet");
+            return NULL;
+        }
+
+        pktdata = mm->map + mm->offset + sizeof(rec);
+        mm->last = mm->offset;
+        mm->offset += sizeof(rec) + rec.caplen;
+
+#if defined(HAVE_PTHREAD) && defined(HAVE_MMAP)
+        if (mm->window > 0) {
+            /* the prefetcher is behind, so we're waiting on the disk */
+            if (mm->offset > mm->prefetched)
+                mm->stalls++;
+
+            if (mm->offset >= mm->kick)
+                mmpcap_kick(mm);
+        } else
+#endif
+#ifdef HAVE_MADVISE
+        /* keep the kernel paging in the file well ahead of us */
+        if (mm->offset + MMPCAP_READAHEAD / 2 > mm->advised &&
+                mm->advised < mm->maplen) {
+            pagemask = (size_t)getpagesize() - 1;
+            start = mm->advised & ~pagemask;
+            mm->advised = start + MMPCAP_READAHEAD;
+            if (mm->advised > mm->maplen)
+                mm->advised = mm->maplen;
+            madvise(mm->map + start, mm->advised - start, MADV_WILLNEED);
+        }
+#endif
+
+        pkthdr->ts.tv_sec = rec.ts_sec;
+#ifdef PKTHDR_TS_NSEC
+        pkthdr->ts.tv_usec = mm->nsec ? rec.ts_frac : rec.ts_frac * 1000;
+#else
+        pkthdr->ts.tv_usec = mm->nsec ? rec.ts_frac / 1000 : rec.ts_frac;
+#endif
+        pkthdr->caplen = rec.caplen;
+        pkthdr->len = rec.len;
+
+#ifdef HAVE_PCAP_OFFLINE_FILTER
+    } while (mm->filter != NULL &&
+            pcap_offline_filter(mm->filter, pkthdr, pktdata) == 0);
+#else
+    } while (0);
+#endif
+
+    return pktdata;
+}
+
+/**
+ * \brief Skips over up to count records without looking at the packets
+ *
+ * The BPF filter isn't applied, so this counts records rather than the
+ * packets mmpcap_next() would return.  Returns the # of records skipped,
+ * which is less than count at EOF (or a bad record) and always 0 for files
+ * which aren't mapped.
+ */
+COUNTER
+mmpcap_skip(mmpcap_t *mm, COUNTER count)
+{
+    struct mmpcap_rec_hdr rec;
+    u_int32_t maxcap;
+    COUNTER skipped;
+
+    assert(mm);
+
+    if (mm->map == NULL)
+        return 0;
+
+    maxcap = mm->snaplen > MMPCAP_MAX_CAPLEN ? mm->snaplen : MMPCAP_MAX_CAPLEN;
+
+    for (skipped = 0; skipped < count; skipped++) {
+        if (mm->offset + sizeof(rec) > mm->maplen)
+            break;
+
+        memcpy(&rec, mm->map + mm->offset, sizeof(rec));
+        if (mm->swapped)
+            rec.caplen = mmpcap_swap32(rec.caplen);
+
+        /* leave it for mmpcap_next() to complain about */
+        if (rec.caplen > maxcap ||
+                mm->offset + sizeof(rec) + rec.caplen > mm->maplen)
+            break;
+
+        mm->offset += sizeof(rec) + rec.caplen;
+    }
+
+    return skipped;
+}
+
+/**
+ * \brief Returns the file offset of the next record of a mapped file
+ */
+size_t
+mmpcap_tell(const mmpcap_t *mm)
+{
+    assert(mm);
+    return mm->offset;
+}
+
+/**
+ * \brief Moves a mapped reader to the record at the given file offset
+ *
+ * offset must be a record boundary, like one from mmpcap_tell() or the
+ * index of a tcpprep cache.  Returns false without moving if the file
+ * isn't mapped or the offset is past the end.  Seek before starting
+ * mmpcap_prefetch() so it reads ahead from the right place.
+ */
+bool
+mmpcap_seek(mmpcap_t *mm, size_t offset)
+{
+    assert(mm);
+
+    if (mm->map == NULL || offset < sizeof(struct mmpcap_file_hdr) ||
+            offset > mm->maplen)
+        return false;
+
+    mm->offset = offset;
+    mm->advised = offset;
+    return true;
+}
+
+/**
+ * \brief Returns the file offset of the record mmpcap_next() last returned
+ *
+ * Only meaningful for mapped files.
+ */
+size_t
+mmpcap_last(const mmpcap_t *mm)
+{
+    assert(mm);
+    return mm->last;
+}
+
+/**
+ * \brief Returns the size of a mapped file (or where a slice ends)
+ */
+size_t
+mmpcap_size(const mmpcap_t *mm)
+{
+    assert(mm);
+    return mm->maplen;
+}
+
+/**
+ * \brief Unmaps the file.  Does not close the libpcap handle
+ */
+void
+mmpcap_close(mmpcap_t *mm)
+{
+    if (mm == NULL)
+        return;
+
+#if defined(HAVE_PTHREAD) && defined(HAVE_MMAP)
+    if (mm->window > 0) {
+        pthread_mutex_lock(&mm->lock);
+        mm->stop = true;
+        pthread_cond_signal(&mm->cond);
+        pthread_mutex_unlock(&mm->lock);
+        pthread_join(mm->thread, NULL);
+
+        pthread_cond_destroy(&mm->cond);
+        pthread_mutex_destroy(&mm->lock);
+    }
+#endif
+
+    mmpcap_unmap(mm);
+    safe_free(mm);
+}
+
+/*
+ Local Variables:
+ mode:c
+ indent-tabs-mode:nil
+ c-basic-offset:4
+ End:
+*/
@@ -0,0 +1,96 @@
+/* $Id$ */
+
+/*
+ *   Copyright (c) 2001-2010 Aaron Turner <aturner at synfin dot net>
+ *
+ *   The Tcpreplay Suite of tools is free software: you can redistribute it 
+ *   and/or modify it under the terms of the GNU General Public License as 
+ *   published by the Free Software Foundation, either version 3 of the 
+ *   License, or with the authors permission any later version.
+ *
+ *   The Tcpreplay Suite is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with the Tcpreplay Suite.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/*
+ * Zero-copy pcap reader.  Regular pcap files are mmap()'d and packets are
+ * handed out as pointers straight into the mapping, avoiding libpcap's
+ * fread() + copy per packet.  Anything we can't map (stdin, compressed or
+ * pcap-ng files, ...) is transparently read via the libpcap handle instead.
+ */
+
+#ifndef __MMPCAP_H__
+#define __MMPCAP_H__
+
+#include "config.h"
+#include "defines.h"
+
+#ifdef HAVE_PTHREAD
+#include <pthread.h>
+#endif
+
+/* how far ahead of the reader we ask the kernel to page in the file */
+#define MMPCAP_READAHEAD (8 * 1024 * 1024)
+
+/* the prefetch thread pages in the file this many bytes at a time */
+#define MMPCAP_PREFETCH_CHUNK (1024 * 1024)
+
+typedef struct mmpcap_s {
+    pcap_t *pcap;               /* libpcap handle for non-mapped files */
+    u_char *map;                /* mapping of the whole file or NULL */
+    size_t maplen;
+    size_t offset;              /* offset of the next record */
+    size_t last;                /* offset of the record last returned */
+    size_t advised;             /* file is paged in up to here */
+    bool swapped;               /* file is in the opposite byte order */
+    bool nsec;                  /* timestamps are in nanoseconds */
+    u_int32_t snaplen;
+    const struct bpf_program *filter;
+    bool slice;                 /* map belongs to another reader, see mmpcap_slice() */
+
+    /* read-ahead thread, see mmpcap_prefetch() */
+    size_t window;              /* bytes to keep paged in ahead of the reader */
+    volatile size_t prefetched; /* file is paged in up to here */
+    size_t kick;                /* wake the prefetcher when we get here */
+    COUNTER stalls;             /* packets read before they were prefetched */
+#ifdef HAVE_PTHREAD
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    size_t consumed;            /* reader offset as of the last kick */
+    bool stop;
+    u_int32_t sink;
+#endif
+} mmpcap_t;
+
+mmpcap_t *mmpcap_open(const char *path, pcap_t *pcap);
+mmpcap_t *mmpcap_slice(const mmpcap_t *mm, size_t start, size_t end);
+void mmpcap_setfilter(mmpcap_t *mm, const struct bpf_program *filter);
+void mmpcap_prefetch(mmpcap_t *mm, size_t window);
+COUNTER mmpcap_stalls(const mmpcap_t *mm);
+COUNTER mmpcap_prefetched(const mmpcap_t *mm);
+const u_char *mmpcap_next(mmpcap_t *mm, struct pcap_pkthdr *pkthdr);
+COUNTER mmpcap_skip(mmpcap_t *mm, COUNTER count);
+size_t mmpcap_tell(const mmpcap_t *mm);
+bool mmpcap_seek(mmpcap_t *mm, size_t offset);
+size_t mmpcap_last(const mmpcap_t *mm);
+size_t mmpcap_size(const mmpcap_t *mm);
+bool mmpcap_mapped(const mmpcap_t *mm);
+bool mmpcap_nsec(const mmpcap_t *mm);
+void mmpcap_close(mmpcap_t *mm);
+
+#endif
+
+/*
+ Local Variables:
+ mode:c
+ indent-tabs-mode:nil
+ c-basic-offset:4
+ End:
+*/
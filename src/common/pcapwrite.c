@@ -0,0 +1,315 @@
+/* $Id$ */
+
+/*
+ *   Copyright (c) 2001-2010 Aaron Turner <aturner at synfin dot net>
+ *
+ *   The Tcpreplay Suite of tools is free software: you can redistribute it 
+ *   and/or modify it under the terms of the GNU General Public License as 
+ *   published by the Free Software Foundation, either version 3 of the 
+ *   License, or with the authors permission any later version.
+ *
+ *   The Tcpreplay Suite is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with the Tcpreplay Suite.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+#include "config.h"
+#include "defines.h"
+#include "common.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/types.h>
+
+#include "pcapwrite.h"
+
+/* on disk pcap file & record headers */
+#define PCAPWRITE_FILE_HDR_LEN 24
+
+struct pcapwrite_rec_hdr {
+    u_int32_t ts_sec;
+    u_int32_t ts_frac;
+    u_int32_t caplen;
+    u_int32_t len;
+};
+
+/**
+ * \brief Writes out a full buffer, retrying short writes
+ */
+static void
+pcapwrite_write(pcapwrite_t *pw, const u_char *data, size_t len)
+{
+    ssize_t ret;
+
+    while (len > 0) {
+        if ((ret = write(pw->fd, data, len)) < 0) {
+            if (errno == EINTR)
+                continue;
+            errx(-1, "Unable to write to %s: %s", pw->filename, strerror(errno));
+        }
+        data += ret;
+        len -= (size_t)ret;
+        pw->bytes += (COUNTER)ret;
+    }
+
+    if (pw->fsync_policy == PCAPWRITE_FSYNC_BUFFER && fsync(pw->fd) < 0)
+        errx(-1, "Unable to fsync() %s: %s", pw->filename, strerror(errno));
+}
+
+#ifdef HAVE_PTHREAD
+/**
+ * \brief Writer thread: writes out the buffers in the order they filled
+ */
+static void *
+pcapwrite_thread(void *arg)
+{
+    pcapwrite_t *pw = (pcapwrite_t *)arg;
+    pcapwrite_buf_t *buf;
+
+    pthread_mutex_lock(&pw->lock);
+    while (1) {
+        buf = &pw->bufs[pw->next];
+        while (!buf->full && !pw->closing)
+            pthread_cond_wait(&pw->cond, &pw->lock);
+
+        if (!buf->full)
+            break;
+        pthread_mutex_unlock(&pw->lock);
+
+        pcapwrite_write(pw, buf->data, buf->len);
+
+        pthread_mutex_lock(&pw->lock);
+        buf->full = false;
+        pw->next = (pw->next + 1) % PCAPWRITE_BUFFERS;
+        pthread_cond_broadcast(&pw->cond);
+    }
+    pthread_mutex_unlock(&pw->lock);
+
+    return NULL;
+}
+#endif
+
+/**
+ * \brief Opens filename for writing pcap records of the given pcap_t
+ *
+ * bufsize is the size of each of the PCAPWRITE_BUFFERS output buffers.
+ * Returns NULL if libpcap can't open the file; see pcap_geterr(pcap)
+ */
+pcapwrite_t *
+pcapwrite_open(pcap_t *pcap, const char *filename, size_t bufsize,
+        int flags, pcapwrite_fsync_t fsync_policy)
+{
+    pcapwrite_t *pw;
+    FILE *file;
+    size_t hdrlen = 0;
+    int i;
+
+    assert(pcap);
+    assert(filename);
+
+    pw = (pcapwrite_t *)safe_malloc(sizeof(pcapwrite_t));
+
+    /* have libpcap write the file header */
+    if ((pw->dumper = pcap_dump_open(pcap, filename)) == NULL) {
+        safe_free(pw);
+        return NULL;
+    }
+
+    if (pcap_dump_flush(pw->dumper) < 0)
+        errx(-1, "Unable to write to %s: %s", filename, strerror(errno));
+
+    file = pcap_dump_file(pw->dumper);
+    pw->fd = fileno(file);
+    pw->filename = safe_strdup(filename);
+    pw->fsync_policy = fsync_policy;
+
+    if (bufsize < PCAPWRITE_MIN_BUFSIZE)
+        bufsize = PCAPWRITE_MIN_BUFSIZE;
+    pw->bufsize = (bufsize + PCAPWRITE_ALIGN - 1) & ~((size_t)PCAPWRITE_ALIGN - 1);
+
+    for (i = 0; i < PCAPWRITE_BUFFERS; i++) {
+        pw->bufs[i].alloc = safe_malloc(pw->bufsize + PCAPWRITE_ALIGN);
+        pw->bufs[i].data = (u_char *)(((size_t)pw->bufs[i].alloc + PCAPWRITE_ALIGN - 1) &
+                ~((size_t)PCAPWRITE_ALIGN - 1));
+    }
+
+    /*
+     * O_DIRECT writes have to start at an aligned offset, so read back
+     * the file header (libpcap's fd is write only) and write it again as
+     * part of the first buffer
+     */
+    if (flags & PCAPWRITE_DIRECT) {
+#ifdef O_DIRECT
+        u_char hdr[PCAPWRITE_FILE_HDR_LEN];
+        int rfd;
+        ssize_t ret = -1;
+
+        if ((rfd = open(filename, O_RDONLY)) >= 0) {
+            ret = read(rfd, hdr, sizeof(hdr));
+            close(rfd);
+        }
+
+        if (ret == (ssize_t)sizeof(hdr) &&
+                lseek(pw->fd, 0, SEEK_SET) == 0 &&
+                fcntl(pw->fd, F_SETFL, fcntl(pw->fd, F_GETFL) | O_DIRECT) == 0) {
+            memcpy(pw->bufs[0].data, hdr, sizeof(hdr));
+            hdrlen = sizeof(hdr);
+            pw->flags |= PCAPWRITE_DIRECT;
+        } else {
+            warnx("Unable to use O_DIRECT for %s: %s", filename, strerror(errno));
+            lseek(pw->fd, PCAPWRITE_FILE_HDR_LEN, SEEK_SET);
+        }
+#else
+        warnx("O_DIRECT isn't supported on this platform, not using it for %s", filename);
+#endif
+    }
+    pw->bufs[0].len = hdrlen;
+
+#ifdef HAVE_PTHREAD
+    pthread_mutex_init(&pw->lock, NULL);
+    pthread_cond_init(&pw->cond, NULL);
+    if ((errno = pthread_create(&pw->thread, NULL, pcapwrite_thread, pw)) != 0)
+        errx(-1, "Unable to start pcap writer thread: %s", strerror(errno));
+#endif
+
+    dbgx(1, "Writing %s via %d x %zu byte buffers%s", filename, PCAPWRITE_BUFFERS, 
+            pw->bufsize, (pw->flags & PCAPWRITE_DIRECT) ? " with O_DIRECT" : "");
+    return pw;
+}
+
+/**
+ * \brief Hands off the current buffer to be written and returns the next one
+ */
+static pcapwrite_buf_t *
+pcapwrite_next(pcapwrite_t *pw)
+{
+    pcapwrite_buf_t *buf = &pw->bufs[pw->cur], *next;
+    size_t tail = 0;
+
+    pw->cur = (pw->cur + 1) % PCAPWRITE_BUFFERS;
+    next = &pw->bufs[pw->cur];
+
+#ifdef HAVE_PTHREAD
+    pthread_mutex_lock(&pw->lock);
+    if (next->full) {
+        pw->stalls++;
+        while (next->full)
+            pthread_cond_wait(&pw->cond, &pw->lock);
+    }
+    pthread_mutex_unlock(&pw->lock);
+#endif
+
+    /* an O_DIRECT write has to be whole blocks, carry the rest over */
+    if (pw->flags & PCAPWRITE_DIRECT) {
+        tail = buf->len % PCAPWRITE_ALIGN;
+        memcpy(next->data, &buf->data[buf->len - tail], tail);
+        buf->len -= tail;
+    }
+    next->len = tail;
+
+#ifdef HAVE_PTHREAD
+    pthread_mutex_lock(&pw->lock);
+    buf->full = true;
+    pthread_cond_broadcast(&pw->cond);
+    pthread_mutex_unlock(&pw->lock);
+#else
+    pcapwrite_write(pw, buf->data, buf->len);
+#endif
+
+    return next;
+}
+
+/**
+ * \brief Writes a packet, same as pcap_dump() would
+ */
+void
+pcapwrite_dump(pcapwrite_t *pw, const struct pcap_pkthdr *pkthdr, const u_char *data)
+{
+    pcapwrite_buf_t *buf = &pw->bufs[pw->cur];
+    struct pcapwrite_rec_hdr rec;
+
+    assert(pw);
+    assert(pkthdr);
+    assert(data);
+    assert(sizeof(rec) + pkthdr->caplen + PCAPWRITE_ALIGN <= pw->bufsize);
+
+    if (buf->len + sizeof(rec) + pkthdr->caplen > pw->bufsize)
+        buf = pcapwrite_next(pw);
+
+    /* the timestamp is written as is, like pcap_dump() does */
+    rec.ts_sec = (u_int32_t)pkthdr->ts.tv_sec;
+    rec.ts_frac = (u_int32_t)pkthdr->ts.tv_usec;
+    rec.caplen = pkthdr->caplen;
+    rec.len = pkthdr->len;
+
+    memcpy(&buf->data[buf->len], &rec, sizeof(rec));
+    memcpy(&buf->data[buf->len + sizeof(rec)], data, pkthdr->caplen);
+    buf->len += sizeof(rec) + pkthdr->caplen;
+}
+
+/**
+ * \brief Writes out whatever is buffered and closes the file
+ */
+void
+pcapwrite_close(pcapwrite_t *pw)
+{
+    pcapwrite_buf_t *buf;
+    size_t aligned;
+    int i;
+
+    assert(pw);
+
+#ifdef HAVE_PTHREAD
+    pthread_mutex_lock(&pw->lock);
+    pw->closing = true;
+    pthread_cond_broadcast(&pw->cond);
+    pthread_mutex_unlock(&pw->lock);
+    pthread_join(pw->thread, NULL);
+
+    pthread_cond_destroy(&pw->cond);
+    pthread_mutex_destroy(&pw->lock);
+#endif
+
+    /* whole blocks can still go out via O_DIRECT, but not the last partial one */
+    buf = &pw->bufs[pw->cur];
+    aligned = 0;
+#ifdef O_DIRECT
+    if (pw->flags & PCAPWRITE_DIRECT) {
+        aligned = buf->len - buf->len % PCAPWRITE_ALIGN;
+        pcapwrite_write(pw, buf->data, aligned);
+        fcntl(pw->fd, F_SETFL, fcntl(pw->fd, F_GETFL) & ~O_DIRECT);
+    }
+#endif
+    pcapwrite_write(pw, &buf->data[aligned], buf->len - aligned);
+
+    if (pw->fsync_policy != PCAPWRITE_FSYNC_NONE && fsync(pw->fd) < 0)
+        errx(-1, "Unable to fsync() %s: %s", pw->filename, strerror(errno));
+
+    dbgx(1, "Wrote " COUNTER_SPEC " bytes to %s, waited on the disk " COUNTER_SPEC " times",
+            pw->bytes, pw->filename, pw->stalls);
+
+    /* nothing is left in the stdio buffer, this just closes the file */
+    pcap_dump_close(pw->dumper);
+
+    for (i = 0; i < PCAPWRITE_BUFFERS; i++)
+        safe_free(pw->bufs[i].alloc);
+    safe_free(pw->filename);
+    safe_free(pw);
+}
+
+/*
+ Local Variables:
+ mode:c
+ indent-tabs-mode:nil
+ c-basic-offset:4
+ End:
+*/
@@ -0,0 +1,100 @@
+/* $Id$ */
+
+/*
+ *   Copyright (c) 2001-2010 Aaron Turner <aturner at synfin dot net>
+ *
+ *   The Tcpreplay Suite of tools is free software: you can redistribute it 
+ *   and/or modify it under the terms of the GNU General Public License as 
+ *   published by the Free Software Foundation, either version 3 of the 
+ *   License, or with the authors permission any later version.
+ *
+ *   The Tcpreplay Suite is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with the Tcpreplay Suite.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+/*
+ * Buffered pcap writer, a drop-in for pcap_dump() with big output buffers.
+ * libpcap writes the file header (so the linktype & timestamp precision
+ * are whatever the pcap_t says), after which records are copied into
+ * large aligned buffers and written out with one write() per buffer, by a
+ * separate thread when we have one so the caller never waits on the disk.
+ */
+
+#ifndef __PCAPWRITE_H__
+#define __PCAPWRITE_H__
+
+#include "config.h"
+#include "defines.h"
+
+#ifdef HAVE_PTHREAD
+#include <pthread.h>
+#endif
+
+/* default & smallest size of each output buffer */
+#define PCAPWRITE_DEFAULT_BUFSIZE (4 * 1024 * 1024)
+#define PCAPWRITE_MIN_BUFSIZE (1024 * 1024)
+
+/* # of buffers: one being filled while the others are written */
+#define PCAPWRITE_BUFFERS 2
+
+/* buffer, file offset & write size alignment for O_DIRECT */
+#define PCAPWRITE_ALIGN 4096
+
+/* flags */
+#define PCAPWRITE_DIRECT        0x01    /* bypass the page cache via O_DIRECT */
+
+/* when to fsync() the output */
+typedef enum {
+    PCAPWRITE_FSYNC_NONE = 0,
+    PCAPWRITE_FSYNC_CLOSE,              /* once when closing */
+    PCAPWRITE_FSYNC_BUFFER              /* after each buffer is written */
+} pcapwrite_fsync_t;
+
+typedef struct pcapwrite_buf_s {
+    u_char *data;                       /* PCAPWRITE_ALIGN aligned */
+    void *alloc;                        /* what to free */
+    size_t len;                         /* bytes used */
+    volatile bool full;                 /* waiting to be written */
+} pcapwrite_buf_t;
+
+typedef struct pcapwrite_s {
+    pcap_dumper_t *dumper;              /* wrote the file header, owns the fd */
+    int fd;
+    char *filename;
+    int flags;
+    pcapwrite_fsync_t fsync_policy;
+    size_t bufsize;
+    pcapwrite_buf_t bufs[PCAPWRITE_BUFFERS];
+    int cur;                            /* buffer being filled */
+    COUNTER bytes;                      /* bytes written so far */
+    COUNTER stalls;                     /* times we had to wait for the disk */
+#ifdef HAVE_PTHREAD
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    int next;                           /* buffer the writer thread does next */
+    bool closing;
+#endif
+} pcapwrite_t;
+
+pcapwrite_t *pcapwrite_open(pcap_t *pcap, const char *filename, size_t bufsize,
+        int flags, pcapwrite_fsync_t fsync_policy);
+void pcapwrite_dump(pcapwrite_t *pw, const struct pcap_pkthdr *pkthdr, const u_char *data);
+void pcapwrite_close(pcapwrite_t *pw);
+
+#endif
+
+/*
+ Local Variables:
+ mode:c
+ indent-tabs-mode:nil
+ c-basic-offset:4
+ End:
+*/
@@ -0,0 +1,243 @@
+/* $Id$ */
+
+/*
+ *   Copyright (c) 2001-2010 Aaron Turner <aturner at synfin dot net>
+ *
+ *   The Tcpreplay Suite of tools is free software: you can redistribute it 
+ *   and/or modify it under the terms of the GNU General Public License as 
+ *   published by the Free Software Foundation, either version 3 of the 
+ *   License, or with the authors permission any later version.
+ *
+ *   The Tcpreplay Suite is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with the Tcpreplay Suite.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+#include "config.h"
+#include "defines.h"
+#include "common.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <sched.h>
+
+#include "pktring.h"
+
+/* atomic load-acquire/store-release of the counters shared between threads */
+#define PKTRING_LOAD(x)      __atomic_load_n(&(x), __ATOMIC_ACQUIRE)
+#define PKTRING_STORE(x, v)  __atomic_store_n(&(x), (v), __ATOMIC_RELEASE)
+
+/**
+ * spin for a little while, then let someone else have the CPU
+ */
+static void
+pktring_wait(int *spins)
+{
+    if (++(*spins) < PKTRING_SPIN) {
+        __asm__ __volatile__("" ::: "memory");
+    } else {
+        sched_yield();
+        *spins = 0;
+    }
+}
+
+/**
+ * Allocates a ring for at least the given number of packets (rounded up to
+ * a power of two).  The packet buffer is sized for PKTRING_SLOT_BYTES per
+ * packet, but always fits a few PKTRING_MAX_PKTLEN sized packets.
+ */
+pktring_t *
+pktring_open(u_int32_t slots)
+{
+    pktring_t *ring;
+    u_int32_t n = 1;
+
+    while (n < slots)
+        n <<= 1;
+
+    ring = (pktring_t *)safe_malloc(sizeof(pktring_t));
+    ring->slots = (pktring_slot_t *)safe_malloc(sizeof(pktring_slot_t) * n);
+    ring->mask = n - 1;
+
+    ring->data_size = n * PKTRING_SLOT_BYTES;
+    if (ring->data_size < 4 * PKTRING_MAX_PKTLEN)
+        ring->data_size = 4 * PKTRING_MAX_PKTLEN;
+    ring->data = (u_char *)safe_malloc(ring->data_size);
+
+    dbgx(1, "pktring: %u slots, %u byte buffer", n, ring->data_size);
+    return ring;
+}
+
+/**
+ * Producer: returns a buffer for a packet of len bytes, blocking until the
+ * consumer frees up enough room.  Packets are never split over the end of
+ * the buffer.  Returns NULL if the ring was aborted.
+ */
+u_char *
+pktring_reserve(pktring_t *ring, u_int32_t len)
+{
+    u_int32_t pos, skip = 0;
+    int spins = 0;
+    bool waited = false;
+
+    assert(ring);
+    assert(len <= PKTRING_MAX_PKTLEN);
+
+    pos = (u_int32_t)(ring->data_head % ring->data_size);
+    if (pos + len > ring->data_size)
+        skip = ring->data_size - pos;
+
+    while ((ring->head - PKTRING_LOAD(ring->tail)) > ring->mask ||
+            (ring->data_head + skip + len - PKTRING_LOAD(ring->data_tail)) > ring->data_size) {
+        if (ring->abort)
+            return NULL;
+        if (!waited) {
+            ring->full++;
+            waited = true;
+        }
+        pktring_wait(&spins);
+    }
+
+    ring->res_offset = skip > 0 ? 0 : pos;
+    ring->res_len = len;
+    ring->res_skip = skip;
+    return ring->data + ring->res_offset;
+}
+
+/**
+ * Producer: publishes the packet copied into the last pktring_reserve()
+ * buffer to the consumer
+ */
+void
+pktring_commit(pktring_t *ring, const struct pcap_pkthdr *pkthdr, void *cookie)
+{
+    pktring_slot_t *slot;
+
+    assert(ring);
+    assert(pkthdr);
+
+    slot = &ring->slots[ring->head & ring->mask];
+    memcpy(&slot->pkthdr, pkthdr, sizeof(struct pcap_pkthdr));
+    slot->cookie = cookie;
+    slot->offset = ring->res_offset;
+    slot->len = ring->res_len;
+    slot->skip = ring->res_skip;
+
+    ring->data_head += ring->res_skip + ring->res_len;
+    PKTRING_STORE(ring->head, ring->head + 1);
+}
+
+/**
+ * Producer: no more packets are coming
+ */
+void
+pktring_eof(pktring_t *ring)
+{
+    assert(ring);
+    PKTRING_STORE(ring->eof, true);
+}
+
+/**
+ * Consumer: returns the oldest packet in the ring, blocking until there is
+ * one.  The data stays valid until pktring_release().  Returns NULL once
+ * the producer is done and the ring is empty or when it was aborted.
+ */
+const u_char *
+pktring_peek(pktring_t *ring, struct pcap_pkthdr **pkthdr, void **cookie)
+{
+    pktring_slot_t *slot;
+    u_int32_t used;
+    int spins = 0;
+    bool waited = false;
+
+    assert(ring);
+
+    while ((used = (u_int32_t)(PKTRING_LOAD(ring->head) - ring->tail)) == 0) {
+        /* check eof, then the ring again so we don't miss the last packet */
+        if (PKTRING_LOAD(ring->eof) && PKTRING_LOAD(ring->head) == ring->tail)
+            return NULL;
+        if (ring->abort)
+            return NULL;
+        if (!waited) {
+            ring->underruns++;
+            waited = true;
+        }
+        pktring_wait(&spins);
+    }
+
+    ring->occupancy += used;
+    ring->samples++;
+    if (used > ring->max_occupancy)
+        ring->max_occupancy = used;
+
+    slot = &ring->slots[ring->tail & ring->mask];
+    *pkthdr = &slot->pkthdr;
+    if (cookie != NULL)
+        *cookie = slot->cookie;
+
+    return ring->data + slot->offset;
+}
+
+/**
+ * Consumer: hands the buffer of the packet returned by pktring_peek() back
+ * to the producer
+ */
+void
+pktring_release(pktring_t *ring)
+{
+    pktring_slot_t *slot;
+
+    assert(ring);
+
+    slot = &ring->slots[ring->tail & ring->mask];
+    PKTRING_STORE(ring->data_tail, ring->data_tail + slot->skip + slot->len);
+    PKTRING_STORE(ring->tail, ring->tail + 1);
+}
+
+/**
+ * Wakes up and fails any blocked pktring_reserve()/pktring_peek() call
+ */
+void
+pktring_abort(pktring_t *ring)
+{
+    assert(ring);
+    PKTRING_STORE(ring->abort, true);
+}
+
+/**
+ * Returns the # of packets the ring can hold
+ */
+u_int32_t
+pktring_size(const pktring_t *ring)
+{
+    assert(ring);
+    return ring->mask + 1;
+}
+
+/**
+ * Frees the ring.  Both threads must be done with it.
+ */
+void
+pktring_close(pktring_t *ring)
+{
+    if (ring == NULL)
+        return;
+
+    safe_free(ring->slots);
+    safe_free(ring->data);
+    safe_free(ring);
+}
+
+/*
+ Local Variables:
+ mode:c
+ indent-tabs-mode:nil
+ c-basic-offset:4
+ End:
+*/
@@ -0,0 +1,100 @@
+/* $Id$ */
+
+/*
+ *   Copyright (c) 2001-2010 Aaron Turner <aturner at synfin dot net>
+ *
+ *   The Tcpreplay Suite of tools is free software: you can redistribute it 
+ *   and/or modify it under the terms of the GNU General Public License as 
+ *   published by the Free Software Foundation, either version 3 of the 
+ *   License, or with the authors permission any later version.
+ *
+ *   The Tcpreplay Suite is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with the Tcpreplay Suite.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/*
+ * Bounded single producer/single consumer ring of packets.  One thread
+ * copies packets in with pktring_reserve() + pktring_commit(), the other
+ * takes them out in order with pktring_peek() + pktring_release().  No
+ * locks are taken; the two sides only share the head & tail counters.
+ */
+
+#ifndef __PKTRING_H__
+#define __PKTRING_H__
+
+#include "config.h"
+#include "defines.h"
+
+/* default # of packets the ring holds */
+#define PKTRING_DEFAULT_SLOTS 4096
+
+/* the packet buffer is sized for this many bytes per slot on average */
+#define PKTRING_SLOT_BYTES 2048
+
+/* largest packet the ring accepts (same as libpcap) */
+#define PKTRING_MAX_PKTLEN 262144
+
+/* # of times to poll an empty/full ring before giving up the CPU */
+#define PKTRING_SPIN 256
+
+#define PKTRING_CACHELINE 64
+
+typedef struct {
+    struct pcap_pkthdr pkthdr;
+    void *cookie;               /* opaque value passed along with the packet */
+    u_int32_t offset;           /* packet data offset in the buffer */
+    u_int32_t len;              /* bytes used in the buffer */
+    u_int32_t skip;             /* unused bytes at the end of the buffer before this packet */
+} pktring_slot_t;
+
+typedef struct pktring_s {
+    pktring_slot_t *slots;
+    u_int32_t mask;             /* # of slots - 1 */
+    u_char *data;
+    u_int32_t data_size;
+
+    /* written by the producer only */
+    volatile u_int64_t head;    /* # of packets committed */
+    u_int64_t data_head;        /* # of buffer bytes handed out */
+    u_int32_t res_offset, res_len, res_skip;
+    volatile bool eof;
+    COUNTER full;               /* times the producer had to wait for room */
+    char pad1[PKTRING_CACHELINE];
+
+    /* written by the consumer only */
+    volatile u_int64_t tail;    /* # of packets released */
+    volatile u_int64_t data_tail;
+    COUNTER underruns;          /* times the consumer had to wait for a packet */
+    COUNTER occupancy;          /* sum of the ring fill level seen by pktring_peek() */
+    COUNTER samples;
+    u_int32_t max_occupancy;
+    char pad2[PKTRING_CACHELINE];
+
+    volatile bool abort;
+} pktring_t;
+
+pktring_t *pktring_open(u_int32_t slots);
+u_char *pktring_reserve(pktring_t *ring, u_int32_t len);
+void pktring_commit(pktring_t *ring, const struct pcap_pkthdr *pkthdr, void *cookie);
+void pktring_eof(pktring_t *ring);
+const u_char *pktring_peek(pktring_t *ring, struct pcap_pkthdr **pkthdr, void **cookie);
+void pktring_release(pktring_t *ring);
+void pktring_abort(pktring_t *ring);
+u_int32_t pktring_size(const pktring_t *ring);
+void pktring_close(pktring_t *ring);
+
+#endif
+
+/*
+ Local Variables:
+ mode:c
+ indent-tabs-mode:nil
+ c-basic-offset:4
+ End:
+*/
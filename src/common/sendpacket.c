@@ -144,17 +144,18 @@
 //#include <linux/if.h>
 #include <linux/if_ether.h>
 #include <net/if_arp.h>
-#include <netpacket/packet.h>
-
 #ifdef HAVE_TX_RING
 #include "txring.h"
+#else
+#include <netpacket/packet.h>
 #endif
 
 #ifndef __GLIBC__
 typedef int socklen_t;
 #endif
 
-static sendpacket_t *sendpacket_open_pf(const char *, char *);
+static sendpacket_t *sendpacket_open_pf(const char *, char *, u_int32_t,
+        u_int32_t);
 static struct tcpr_ether_addr *sendpacket_get_hwaddr_pf(sendpacket_t *);
 static int get_iface_index(int fd, const int8_t *device, char *);
 
@@ -205,6 +206,12 @@ static struct tcpr_ether_addr *sendpacket_get_hwaddr_pcap(sendpacket_t *) _U_;
 
 static void sendpacket_seterr(sendpacket_t *sp, const char *fmt, ...);
 
+#if defined HAVE_PF_PACKET && defined HAVE_TX_RING
+static int sendpacket_batch_txring(sendpacket_t *sp, const struct iovec *iov, int cnt);
+#elif defined HAVE_PF_PACKET && defined HAVE_SENDMMSG
+static int sendpacket_batch_mmsg(sendpacket_t *sp, const struct iovec *iov, int cnt);
+#endif
+
 /**
  * returns number of bytes sent on success or -1 on error
  * Note: it is theoretically possible to get a return code >0 and < len
@@ -232,6 +239,8 @@ TRY_SEND_AGAIN:
 #if defined HAVE_PF_PACKET
 #ifdef HAVE_TX_RING
     retcode = (int)txring_put(sp->tx_ring, data, len);
+    if (retcode >= 0)
+        txring_kick(sp->tx_ring);
 #else
     retcode = (int)send(sp->handle.fd, (void *)data, len, 0);
 #endif
@@ -389,20 +398,163 @@ TRY_SEND_AGAIN:
     return retcode;
 }
 
+/**
+ * \brief Send a burst of packets with as few syscalls as possible
+ *
+ * Each iovec is a complete frame.  Uses sendmmsg() for PF_PACKET and a
+ * single kernel kick for TX_RING.  Other injection methods fall back to
+ * calling sendpacket() for each frame.  Returns the number of frames
+ * sent, which is less then cnt if we hit an error or were aborted.
+ */
+int
+sendpacket_batch(sendpacket_t *sp, const struct iovec *iov, int cnt)
+{
+    int sent;
+
+    assert(sp);
+    assert(iov);
+
+    if (cnt <= 0)
+        return -1;
+
+#if defined HAVE_PF_PACKET && defined HAVE_TX_RING
+    sent = sendpacket_batch_txring(sp, iov, cnt);
+#elif defined HAVE_PF_PACKET && defined HAVE_SENDMMSG
+    sent = sendpacket_batch_mmsg(sp, iov, cnt);
+#else
+    for (sent = 0; sent < cnt; sent++) {
+        if (sendpacket(sp, iov[sent].iov_base, iov[sent].iov_len) < (int)iov[sent].iov_len)
+            break;
+    }
+#endif
+
+    if (sent > 0) {
+        sp->bursts ++;
+        sp->burst_pkts += sent;
+        if ((u_int32_t)sent > sp->burst_max)
+            sp->burst_max = sent;
+    }
+
+    return sent;
+}
+
+#if defined HAVE_PF_PACKET && defined HAVE_TX_RING
+/**
+ * Copies every frame into the TX ring and then kicks the kernel once
+ */
+static int
+sendpacket_batch_txring(sendpacket_t *sp, const struct iovec *iov, int cnt)
+{
+    int i, retcode;
+
+    for (i = 0; i < cnt; i++) {
+        sp->attempt ++;
+TRY_PUT_AGAIN:
+        retcode = txring_put(sp->tx_ring, iov[i].iov_base, iov[i].iov_len);
+        if (retcode < 0) {
+            if (errno == ENOBUFS && !sp->abort) {
+                /* ring is still full after waiting; retry */
+                sp->retry_enobufs ++;
+                goto TRY_PUT_AGAIN;
+            }
+
+            sendpacket_seterr(sp, "Error with %s [" COUNTER_SPEC "]: "
+                    "%s (errno = %d)",
+                    INJECT_METHOD, sp->sent + sp->failed + 1,
+                    strerror(errno), errno);
+            sp->failed ++;
+            break;
+        }
+
+        sp->bytes_sent += iov[i].iov_len;
+        sp->sent ++;
+    }
+
+    if (i > 0)
+        txring_kick(sp->tx_ring);
+
+    return i;
+}
+
+#elif defined HAVE_PF_PACKET && defined HAVE_SENDMMSG
+/**
+ * Hands up to SENDPACKET_BURST_MAX frames at a time to sendmmsg()
+ */
+static int
+sendpacket_batch_mmsg(sendpacket_t *sp, const struct iovec *iov, int cnt)
+{
+    struct mmsghdr msgs[SENDPACKET_BURST_MAX];
+    int i, n, retcode, done = 0;
+
+    sp->attempt += cnt;
+
+    while (done < cnt) {
+        n = cnt - done;
+        if (n > SENDPACKET_BURST_MAX)
+            n = SENDPACKET_BURST_MAX;
+
+        memset(msgs, 0, sizeof(struct mmsghdr) * n);
+        for (i = 0; i < n; i++) {
+            msgs[i].msg_hdr.msg_iov = (struct iovec *)&iov[done + i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+        }
+
+TRY_SEND_AGAIN:
+        retcode = sendmmsg(sp->handle.fd, msgs, n, 0);
+
+        /*
+         * out of buffers, or hit max PHY speed, silently retry
+         * as long as we're not told to abort
+         */
+        if (retcode < 0) {
+            if (!sp->abort) {
+                switch (errno) {
+                    case EAGAIN:
+                        sp->retry_eagain ++;
+                        goto TRY_SEND_AGAIN;
+                        break;
+                    case ENOBUFS:
+                        sp->retry_enobufs ++;
+                        goto TRY_SEND_AGAIN;
+                        break;
+
+                    default:
+                        sendpacket_seterr(sp, "Error with %s [" COUNTER_SPEC "]: "
+                                "%s (errno = %d)",
+                                INJECT_METHOD, sp->sent + sp->failed + 1,
+                                strerror(errno), errno);
+                }
+            }
+            sp->failed += cnt - done;
+            break;
+        }
+
+        for (i = 0; i < retcode; i++)
+            sp->bytes_sent += msgs[i].msg_len;
+        sp->sent += retcode;
+        done += retcode;
+    }
+
+    return done;
+}
+#endif
+
 /**
  * Open the given network device name and returns a sendpacket_t struct
  * pass the error buffer (in case there's a problem) and the direction
- * that this interface represents
+ * that this interface represents.  txring_frames and txring_batch size
+ * this interface's TX_RING (0 for the defaults) and are otherwise ignored.
  */
 sendpacket_t *
-sendpacket_open(const char *device, char *errbuf, tcpr_dir_t direction)
+sendpacket_open(const char *device, char *errbuf, tcpr_dir_t direction,
+        u_int32_t txring_frames, u_int32_t txring_batch)
 {
     sendpacket_t *sp;
 
     assert(device);
     assert(errbuf);
 #if defined HAVE_PF_PACKET
-    sp = sendpacket_open_pf(device, errbuf);
+    sp = sendpacket_open_pf(device, errbuf, txring_frames, txring_batch);
 #elif defined HAVE_BPF
     sp = sendpacket_open_bpf(device, errbuf);
 #elif defined HAVE_LIBDNET
@@ -435,9 +587,51 @@ sendpacket_getstat(sendpacket_t *sp)
             "\tRetried packets (ENOBUFS): " COUNTER_SPEC "\n"
             "\tRetried packets (EAGAIN):  " COUNTER_SPEC "\n",
             sp->device, sp->attempt, sp->sent, sp->failed, sp->retry_enobufs, sp->retry_eagain);
+
+    if (sp->bursts > 0) {
+        sprintf(&buf[strlen(buf)],
+                "\tBursts flushed:            " COUNTER_SPEC "\n"
+                "\tAverage/max burst size:    %.1f/%u\n",
+                sp->bursts, (double)sp->burst_pkts / (double)sp->bursts, sp->burst_max);
+    }
+
+#if defined HAVE_PF_PACKET && defined HAVE_TX_RING
+    if (sp->handle_type == SP_TYPE_TX_RING) {
+        sprintf(&buf[strlen(buf)],
+                "\tRing full stalls:          " COUNTER_SPEC "\n",
+                sp->tx_ring->stalls);
+    }
+#endif
     return(buf);
 }
 
+/**
+ * Adds the packet stats of src to dst.  Used to fold the stats of the
+ * per-thread interfaces into the main one when replaying with --threads
+ */
+void
+sendpacket_addstats(sendpacket_t *dst, const sendpacket_t *src)
+{
+    assert(dst);
+    assert(src);
+
+    dst->retry_enobufs += src->retry_enobufs;
+    dst->retry_eagain += src->retry_eagain;
+    dst->failed += src->failed;
+    dst->sent += src->sent;
+    dst->bytes_sent += src->bytes_sent;
+    dst->attempt += src->attempt;
+    dst->bursts += src->bursts;
+    dst->burst_pkts += src->burst_pkts;
+    if (src->burst_max > dst->burst_max)
+        dst->burst_max = src->burst_max;
+
+#if defined HAVE_PF_PACKET && defined HAVE_TX_RING
+    if (dst->handle_type == SP_TYPE_TX_RING && src->handle_type == SP_TYPE_TX_RING)
+        dst->tx_ring->stalls += src->tx_ring->stalls;
+#endif
+}
+
 /**
  * close the given sendpacket
  */
@@ -452,8 +646,13 @@ sendpacket_close(sendpacket_t *sp)
 #endif
         break;
 
+    case SP_TYPE_TX_RING:
+#if defined HAVE_PF_PACKET && defined HAVE_TX_RING
+        txring_close(sp->tx_ring);
+        sp->tx_ring = NULL;
+#endif
+        /* fall through */
     case SP_TYPE_PF_PACKET:
-        case SP_TYPE_TX_RING:
 #ifdef HAVE_PF_PACKET
         close(sp->handle.fd);
 #endif
@@ -639,7 +838,8 @@ sendpacket_get_hwaddr_libdnet(sendpacket_t *sp)
  * Inner sendpacket_open() method for using Linux's PF_PACKET or TX_RING
  */
 static sendpacket_t *
-sendpacket_open_pf(const char *device, char *errbuf)
+sendpacket_open_pf(const char *device, char *errbuf, u_int32_t txring_frames,
+        u_int32_t txring_batch)
 {
     int mysocket;
     sendpacket_t *sp;
@@ -652,7 +852,7 @@ sendpacket_open_pf(const char *device, char *errbuf)
     assert(device);
     assert(errbuf);
 
-#if defined TX_RING
+#if defined HAVE_TX_RING
     dbg(1, "sendpacket: using TX_RING");
 #else
     dbg(1, "sendpacket: using PF_PACKET");
@@ -746,9 +946,11 @@ sendpacket_open_pf(const char *device, char *errbuf)
     mtu = ifr.ifr_ifru.ifru_mtu;
 
     /* Init TX ring for sp->handle.fd socket */
-    if ((sp->tx_ring = txring_init(sp->handle.fd, mtu)) == 0) { 
+    if ((sp->tx_ring = txring_init(sp->handle.fd, mtu, txring_frames,
+                    txring_batch)) == 0) {
         snprintf(errbuf, SENDPACKET_ERRBUF_SIZE, "txring_init: %s", strerror(errno));
         close(mysocket);
+        safe_free(sp);
         return NULL;
     }
     sp->handle_type = SP_TYPE_TX_RING;
@@ -20,12 +20,11 @@
 #include "config.h"
 #include "defines.h"
 
-#ifdef HAVE_PF_PACKET
-#include <netpacket/packet.h>
-#endif
-
 #ifdef HAVE_TX_RING
+/* txring.h pulls in linux/if_packet.h which clashes with netpacket/packet.h */
 #include "txring.h"
+#elif defined HAVE_PF_PACKET
+#include <netpacket/packet.h>
 #endif
 
 #ifdef HAVE_LIBDNET
@@ -40,6 +39,8 @@
 #ifndef _SENDPACKET_H_
 #define _SENDPACKET_H_
 
+#include <sys/uio.h>
+
 enum sendpacket_type_t {
     SP_TYPE_LIBNET,
     SP_TYPE_LIBDNET,
@@ -59,6 +60,9 @@ union sendpacket_handle {
 
 #define SENDPACKET_ERRBUF_SIZE 1024
 
+/* max number of frames handed to the kernel by a single sendpacket_batch() call */
+#define SENDPACKET_BURST_MAX 64
+
 struct sendpacket_s {
     tcpr_dir_t cache_dir;
     int open;
@@ -70,6 +74,9 @@ struct sendpacket_s {
     COUNTER sent;
     COUNTER bytes_sent;
     COUNTER attempt;
+    COUNTER bursts;         /* number of sendpacket_batch() flushes */
+    COUNTER burst_pkts;     /* packets sent via sendpacket_batch() */
+    u_int32_t burst_max;    /* largest single burst */
     enum sendpacket_type_t handle_type;
     union sendpacket_handle handle;
     struct tcpr_ether_addr ether;
@@ -85,10 +92,13 @@ struct sendpacket_s {
 typedef struct sendpacket_s sendpacket_t;
 
 int sendpacket(sendpacket_t *, const u_char *, size_t);
+int sendpacket_batch(sendpacket_t *, const struct iovec *, int);
 int sendpacket_close(sendpacket_t *);
 char *sendpacket_geterr(sendpacket_t *);
 char *sendpacket_getstat(sendpacket_t *);
-sendpacket_t *sendpacket_open(const char *, char *, tcpr_dir_t);
+void sendpacket_addstats(sendpacket_t *, const sendpacket_t *);
+sendpacket_t *sendpacket_open(const char *, char *, tcpr_dir_t, u_int32_t,
+        u_int32_t);
 struct tcpr_ether_addr *sendpacket_get_hwaddr(sendpacket_t *);
 int sendpacket_get_dlt(sendpacket_t *);
 const char *sendpacket_get_method();
@@ -197,6 +197,21 @@ void timesdiv(struct timespec *tvs, COUNTER div);
     typedef struct timeval delta_t;
 #endif
 
+#ifdef HAVE_CLOCK_GETTIME
+/*
+ * returns CLOCK_MONOTONIC in nanoseconds.  Unlike gettimeofday() this never
+ * jumps when someone sets the clock
+ */
+static inline u_int64_t
+get_monotonic_ns(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (u_int64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+}
+#endif
+
 /*
  * starts a timer so we can figure out how much time has passed
  * when we call get_delta_timer()
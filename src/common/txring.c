@@ -36,201 +36,239 @@
 #include <unistd.h>
 #include <string.h>
 #include <sys/mman.h>
+#include <sys/socket.h>
+#include <poll.h>
 #include <errno.h>
 
-volatile int shutdown_flag = 0;
-int tdata_offset = TPACKET_HDRLEN - sizeof(struct sockaddr_ll);
+static inline volatile struct tpacket2_hdr *
+txring_frame(txring_t *txp, unsigned int index)
+{
+    return (volatile struct tpacket2_hdr *)(txp->tx_head +
+            (size_t)txp->treq.tp_frame_size * index);
+}
+
+/**
+ * \brief Wait for the kernel to release the frame at the producer index
+ *
+ * Kicks any queued frames so the kernel has something to work on and then
+ * waits in poll() for POLLOUT.  Returns 0 once the frame is available, or
+ * -1 with errno = ENOBUFS if it's still owned by the kernel when we time
+ * out so the caller can check for an abort and retry.
+ */
+static int
+txring_wait(txring_t *txp, volatile struct tpacket2_hdr *hdr)
+{
+    struct pollfd pfd;
+
+    txp->stalls++;
+    txring_kick(txp);
+
+    pfd.fd = txp->fd;
+    pfd.events = POLLOUT;
+    pfd.revents = 0;
+    if (poll(&pfd, 1, TXRING_POLL_TIMEOUT) < 0 && errno != EINTR)
+        return -1;
+
+    if (hdr->tp_status != TP_STATUS_AVAILABLE) {
+        errno = ENOBUFS;
+        return -1;
+    }
 
+    return 0;
+}
 
 /**
- * This task will call send() procedure
+ * \brief Put data in the next TX ring frame
+ *
+ * Frames are handed to the kernel in order, so we only ever look at the
+ * frame at the producer index.  The kernel is kicked every txp->batch
+ * frames; call txring_kick() to flush a partial batch.  Packets which
+ * don't fit in a frame are rejected with EMSGSIZE rather than truncated.
  */
-void *
-txring_send(void *arg)
+int
+txring_put(txring_t *txp, const void * data, size_t length)
 {
-    int ec_send;
-    static int total = 0;
-    int fd_socket = (int)arg;
+    volatile struct tpacket2_hdr *hdr;
 
-    do {
-        /* send all buffers with TP_STATUS_SEND_REQUEST */
-        ec_send=sendto(fd_socket, NULL, 0, MSG_DONTWAIT,
-                (struct sockaddr *)NULL, sizeof(struct sockaddr_ll));
+    assert(txp);
 
-        if (ec_send > 0) {
-            total += ec_send;
-            dbgx(2, "Sent %d bytes (+%d bytes)", total, ec_send);
-        } else  {
-            /* nothing to do => schedule : useful if no SMP */
-            usleep(100);
-        }
+    if (length > txp->max_len) {
+        errno = EMSGSIZE;
+        return -1;
+    }
 
+    hdr = txring_frame(txp, txp->tx_index);
 
-    } while (!shutdown_flag);
+    if (hdr->tp_status == TP_STATUS_WRONG_FORMAT) {
+        warnx("TX ring frame %u was rejected by the kernel (len %u)",
+                txp->tx_index, hdr->tp_len);
+        hdr->tp_status = TP_STATUS_AVAILABLE;
+    }
 
-    //if(blocking) printf("end of task send()\n");
-    //printf("end of task send(ec=%x)\n", ec_send);
+    if (hdr->tp_status != TP_STATUS_AVAILABLE && txring_wait(txp, hdr) < 0)
+        return -1;
 
-    return (void*) ec_send;
+    memcpy((u_char *)hdr + txp->data_offset, data, length);
+    hdr->tp_len = length;
+
+    /* make sure the kernel sees the data before it sees the status */
+    __sync_synchronize();
+    hdr->tp_status = TP_STATUS_SEND_REQUEST;
+
+    if (++txp->tx_index == txp->treq.tp_frame_nr)
+        txp->tx_index = 0;
+
+    if (++txp->tx_pending >= txp->batch)
+        txring_kick(txp);
+
+    return (int)length;
 }
 
 /**
- * Put data in TX ring buffer and rotate it if necessary
+ * Tell the kernel to transmit all frames marked TP_STATUS_SEND_REQUEST.
+ * Used to flush a whole burst of frames with a single syscall.  If the
+ * kernel is busy (EAGAIN/ENOBUFS) the frames stay pending so that the
+ * next call kicks again instead of leaving them in the ring.
  */
 int
-txring_put(txring_t *txp, const void * data, size_t length)
+txring_kick(txring_t *txp)
 {
-    struct tpacket_hdr *ps_header;
-    char * to_data;
-    int loop = 1;
-    int first_loop = 1;
-    unsigned int start_index = txp->tx_index;
-
-    do {
-        ps_header = ((struct tpacket_hdr *)((void *)txp->tx_head + 
-                    (txp->treq->tp_frame_size * txp->tx_index)));
-        to_data = ((void*) ps_header) + tdata_offset;
-
-        switch ((volatile uint32_t)ps_header->tp_status) {
-            case TP_STATUS_WRONG_FORMAT:
-                warnx("TP_STATUS_WRONG_FORMAT occuries O_o. Frame %d, pkt len %d\n", 
-                        txp->tx_index, length);
-                break;
-
-            case TP_STATUS_AVAILABLE:
-                if (length > txp->treq->tp_frame_size) {
-                    //TODO Fragment packet
-                    warnx("[!] %d bytes from %d packet truncated\n",
-                            length-txp->treq->tp_frame_size, length);
-                    length = txp->treq->tp_frame_size;
-                }
-                memcpy(to_data, data, length);
-                ps_header->tp_len = length;
-                ps_header->tp_status = TP_STATUS_SEND_REQUEST;
-                loop = 0;
-                break;
-
-            default:
-                dbgx(2,"TPACKET status %u at frame %d with length %d\n",
-                        ps_header->tp_status, txp->tx_index, ps_header->tp_len);
-                usleep(0);
-                break;
-        }
-        txp->tx_index++;
-
-        if (txp->tx_index >= txp->treq->tp_frame_nr) {
-            txp->tx_index = 0;
-            first_loop = 0;
-        }
-
-        /* check if we've runned over all ring */
-        if ((txp->tx_index == start_index) && !first_loop) {
-            errno = ENOBUFS;
-            return -1;
-        }
-    } while(loop == 1);
-
-    return ps_header->tp_len;
-}
+    int ret;
+
+    if (txp->tx_pending == 0)
+        return 0;
+
+    ret = sendto(txp->fd, NULL, 0, MSG_DONTWAIT, NULL, 0);
+    if (ret < 0)
+        return (errno == EAGAIN || errno == ENOBUFS) ? 0 : ret;
 
+    txp->tx_pending = 0;
+    return ret;
+}
 
 /**
  * \brief Build TX ring buffer request structure
  *
  * This builds a ring buffer request structure making sure
- * that we have buffers big enough so that a frame which
- * is the size of the MTU doesn't get truncated. We also
- * need to structure things with minimum memory wastage 
+ * that we have frames big enough so that a frame which
+ * is the size of the MTU (plus a VLAN tag) doesn't get truncated.
+ * Blocks are the smallest power of two pages which hold at least one
+ * frame, and we allocate enough of them for nr_frames frames.
  */
-void
-txring_mkreq(struct tpacket_req* treq, unsigned int mtu)
+static void
+txring_mkreq(struct tpacket_req* treq, unsigned int mtu, unsigned int nr_frames)
 {
-    unsigned int pg,bs;
-    unsigned int s;
-    unsigned int mult = 1;
-    unsigned nr_blocks = 1000;
+    unsigned int pg, bs, fs, per_block;
+
+    pg = getpagesize();
+    fs = TPACKET_ALIGN(TPACKET2_HDRLEN + ETH_HLEN + 4 + mtu);
 
-    bs = pg = getpagesize();
-    s = mtu + TPACKET_HDRLEN;
+    bs = pg;
+    while (bs < fs)
+        bs <<= 1;
+
+    per_block = bs / fs;
 
     memset(treq, 0, sizeof(struct tpacket_req));
-    if (bs <= s) {
-        while(bs < s) {
-            bs += pg;
-            mult++;
-        }
-
-        treq->tp_block_size = bs;
-        treq->tp_frame_size = bs / mult;
-        treq->tp_block_nr   = nr_blocks;
-        treq->tp_frame_nr   = mult * nr_blocks;
-    } else {
-        while ((s * (mult + 1)) <=pg) {
-            mult++;
-        }
-        treq->tp_block_size = pg;
-        treq->tp_frame_size = pg / mult;
-        treq->tp_block_nr   = nr_blocks;
-        treq->tp_frame_nr   = mult * nr_blocks;
-    }
-    dbgx(1, "txring: block_size=%d block_nr=%d frame_size=%d frame_nr=%d", 
-            treq->tp_block_size, treq->tp_block_nr, treq->tp_frame_size, 
+    treq->tp_block_size = bs;
+    treq->tp_frame_size = fs;
+    treq->tp_block_nr   = (nr_frames + per_block - 1) / per_block;
+    treq->tp_frame_nr   = treq->tp_block_nr * per_block;
+
+    dbgx(1, "txring: block_size=%u block_nr=%u frame_size=%u frame_nr=%u",
+            treq->tp_block_size, treq->tp_block_nr, treq->tp_frame_size,
             treq->tp_frame_nr);
 }
 
 /**
  * \brief Create TX ring for socket and init indexes
  *
- * Creates our pthread for sending, currently hardcoded for priority = 20
+ * Switches the socket to TPACKET_V2, sets up and maps the ring.  frames is
+ * the minimum number of frames in the ring and batch is the number of
+ * frames queued before the kernel is kicked; 0 uses the defaults.  There
+ * is no background thread: txring_put() and txring_kick() drive the kernel
+ * directly from the caller.  Returns NULL on error.
  */
 txring_t *
-txring_init(int fd, unsigned int mtu)
+txring_init(int fd, unsigned int mtu, unsigned int frames, unsigned int batch)
 {
-    pthread_attr_t t_attr_send;
-    struct sched_param para_send;
     int mode_loss = 0;
+    int version = TPACKET_V2;
     txring_t *txp;
 
-    /* allocate memory for structure and fill it with different stuff*/
-    *txp = (txring_t *)safe_malloc(sizeof(txring_t));
-    txp->treq = (struct tpacket_req *)safe_malloc(sizeof(struct tpacket_req));
+    txp = (txring_t *)safe_malloc(sizeof(txring_t));
 
-    txring_mkreq(txp->treq, mtu);
-    txp->tx_size = txp->treq->tp_block_size * txp->treq->tp_block_nr;
-    txp->tx_index = 0; /* Set index on start*/
+    if (setsockopt(fd, SOL_PACKET, PACKET_VERSION, &version,
+                sizeof(version)) < 0) {
+        warn("setsockopt: PACKET_VERSION");
+        goto fail;
+    }
 
     /* Set PACKET_LOSS sockoption */
     if (setsockopt(fd, SOL_PACKET, PACKET_LOSS, (char *)&mode_loss,
                 sizeof(mode_loss)) < 0) {
-        perror("setsockopt: PACKET_LOSS");
-        return NULL;
+        warn("setsockopt: PACKET_LOSS");
+        goto fail;
     }
 
+    txring_mkreq(&txp->treq, mtu, frames > 0 ? frames : TXRING_DEFAULT_FRAMES);
+    txp->tx_size = (size_t)txp->treq.tp_block_size * txp->treq.tp_block_nr;
+    txp->data_offset = TPACKET2_HDRLEN - sizeof(struct sockaddr_ll);
+    txp->max_len = txp->treq.tp_frame_size - txp->data_offset;
+    txp->batch = batch > 0 ? batch : TXRING_DEFAULT_BATCH;
+    txp->fd = fd;
+
     /* Enable TX Ring */
-    if (setsockopt(fd, SOL_PACKET, PACKET_TX_RING, (char *)txp->treq,
+    if (setsockopt(fd, SOL_PACKET, PACKET_TX_RING, (char *)&txp->treq,
                 sizeof(struct tpacket_req)) < 0) {
-        perror("Can't setsockopt PACKET_TX_RING");
-        return NULL;
+        warn("Can't setsockopt PACKET_TX_RING");
+        goto fail;
     }
 
-
     /* mmap unswapped memory with TX ring buffer*/
     txp->tx_head = mmap(0, txp->tx_size, PROT_READ|PROT_WRITE, MAP_SHARED, fd, 0);
     if (txp->tx_head == MAP_FAILED) {
-        perror("mmap() failed ");
-        return NULL;
+        warn("mmap() of TX ring failed");
+        goto fail;
     }
 
-    /* Start poll thread*/
-    pthread_attr_init(&t_attr_send);
-    pthread_attr_setschedpolicy(&t_attr_send, SCHED_RR);
-    para_send.sched_priority = 20;
-    pthread_attr_setschedparam(&t_attr_send, &para_send);
+    return txp;
 
-    if (pthread_create(&txp->tx_send, &t_attr_send, txring_send, (void *)fd) != 0) {
-        perror("pthread_create() failed\n");
-        abort();
+fail:
+    safe_free(txp);
+    return NULL;
+}
+
+/**
+ * \brief Flush any queued frames and unmap the ring
+ *
+ * Waits (briefly) for the kernel to drain the ring so closing the socket
+ * doesn't throw away packets we've already counted as sent.
+ */
+void
+txring_close(txring_t *txp)
+{
+    struct pollfd pfd;
+    unsigned int last;
+    int tries = 100;
+
+    if (txp == NULL)
+        return;
+
+    txring_kick(txp);
+
+    /* the last frame we queued is the last one the kernel will release */
+    last = txp->tx_index == 0 ? txp->treq.tp_frame_nr - 1 : txp->tx_index - 1;
+    pfd.fd = txp->fd;
+    pfd.events = POLLOUT;
+    while (tries-- > 0 &&
+            (txring_frame(txp, last)->tp_status & TP_STATUS_SEND_REQUEST ||
+             txring_frame(txp, last)->tp_status & TP_STATUS_SENDING)) {
+        pfd.revents = 0;
+        poll(&pfd, 1, TXRING_POLL_TIMEOUT);
+        sendto(txp->fd, NULL, 0, MSG_DONTWAIT, NULL, 0);
     }
 
-    return txp;
+    munmap((void *)txp->tx_head, txp->tx_size);
+    safe_free(txp);
 }
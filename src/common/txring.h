@@ -36,28 +36,49 @@
 #include "config.h"
 #include "defines.h"
 
-#if __GLIBC__ >= 2 && __GLIBC_MINOR >= 1
-#include <netpacket/packet.h>
-#include <net/ethernet.h>       /* the L2 protocols */
-#else
-#include <asm/types.h>
+/*
+ * glibc's netpacket/packet.h lacks the TPACKET_V2 definitions and can't be
+ * included alongside linux/if_packet.h, so always use the kernel header
+ */
+#include <sys/socket.h>
 #include <linux/if_packet.h>
 #include <linux/if_ether.h>     /* The L2 protocols */
-#endif
-#include <pthread.h>
 
+/* default number of frames in the TX ring */
+#define TXRING_DEFAULT_FRAMES 2048
+
+/* default number of frames to queue before kicking the kernel */
+#define TXRING_DEFAULT_BATCH 32
+
+/* how long (ms) to poll() for a free frame before returning ENOBUFS */
+#define TXRING_POLL_TIMEOUT 10
+
+/*
+ * The kernel is the only consumer of the ring and it walks the frames in
+ * order, so the frame after the last one we filled is always the oldest.
+ * That means the producer index is all the state we need: no locks, no
+ * scanning and no poller thread.  Ownership of each frame is handed back
+ * and forth via tp_status.
+ */
 struct txring_s
 {
-    pthread_t tx_send; /*Poll TX thread*/
-
-    volatile struct tpacket_hdr * tx_head; /* Pointer to mmaped memory with TX ring */
-    struct tpacket_req* treq; /* TX ring parametrs */
-    volatile unsigned int tx_index; /* TX index */
-    int tx_size; /* Size of mmaped TX ring */
+    volatile u_char *tx_head;   /* Pointer to mmaped memory with TX ring */
+    struct tpacket_req treq;    /* TX ring parametrs */
+    size_t tx_size;             /* Size of mmaped TX ring */
+    unsigned int tx_index;      /* next frame the producer will fill */
+    unsigned int tx_pending;    /* frames filled since the last kick */
+    unsigned int batch;         /* kick the kernel every batch frames */
+    unsigned int data_offset;   /* offset of packet data in a frame */
+    unsigned int max_len;       /* largest packet which fits in a frame */
+    int fd;                     /* PF_PACKET socket the ring is attached to */
+    COUNTER stalls;             /* times we had to wait for a free frame */
 };
 typedef struct txring_s txring_t;
 
 int txring_put(txring_t *txp, const void * data, size_t length);
-txring_t* txring_init(int fd, unsigned int mtu);
+int txring_kick(txring_t *txp);
+txring_t* txring_init(int fd, unsigned int mtu, unsigned int frames,
+        unsigned int batch);
+void txring_close(txring_t *txp);
 
 #endif
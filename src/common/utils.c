@@ -113,6 +113,56 @@ _our_safe_free(void *ptr, const char *funcname, const int line, const char *file
     ptr = NULL;
 }
 
+/* upper bounds (nsec) of the jitter histogram buckets; the last one is open */
+static const u_int64_t jitter_limits[JITTER_BUCKETS - 1] = {
+    100, 250, 500, 1000, 2500, 5000, 10000, 50000, 1000000
+};
+
+static const char *jitter_labels[JITTER_BUCKETS] = {
+    "< 100ns", "< 250ns", "< 500ns", "< 1us", "< 2.5us", "< 5us",
+    "< 10us", "< 50us", "< 1ms", ">= 1ms"
+};
+
+/**
+ * Records how many nsec after its target time a packet was sent
+ */
+void
+add_jitter_stats(tcpreplay_stats_t *stats, u_int64_t late)
+{
+    int i;
+
+    assert(stats);
+
+    for (i = 0; i < JITTER_BUCKETS - 1 && late >= jitter_limits[i]; i++)
+        ;
+
+    stats->jitter[i]++;
+    stats->jitter_samples++;
+    stats->jitter_total += late;
+    if (late > stats->jitter_max)
+        stats->jitter_max = late;
+}
+
+/**
+ * Adds the jitter histogram of src to dst
+ */
+void
+merge_jitter_stats(tcpreplay_stats_t *dst, const tcpreplay_stats_t *src)
+{
+    int i;
+
+    assert(dst);
+    assert(src);
+
+    for (i = 0; i < JITTER_BUCKETS; i++)
+        dst->jitter[i] += src->jitter[i];
+
+    dst->jitter_samples += src->jitter_samples;
+    dst->jitter_total += src->jitter_total;
+    if (src->jitter_max > dst->jitter_max)
+        dst->jitter_max = src->jitter_max;
+}
+
 /**
  * Print various packet statistics
  */
@@ -145,6 +195,29 @@ packet_stats(const tcpreplay_stats_t *stats)
         printf(COUNTER_SPEC " write attempts failed from full buffers and were repeated\n",
               stats->failed);
 
+    if (stats->ring_samples)
+        printf("Pipeline: %.1f avg/%u max of %u slots used, " COUNTER_SPEC " underruns, "
+               COUNTER_SPEC " times full\n",
+               (double)stats->ring_occupancy / (double)stats->ring_samples,
+               stats->ring_max, stats->ring_size, stats->ring_underruns, stats->ring_full);
+
+    if (stats->read_ahead)
+        printf("Prefetch: " COUNTER_SPEC " bytes read ahead, " COUNTER_SPEC " read stalls\n",
+               stats->read_ahead, stats->read_stalls);
+
+    if (stats->jitter_samples) {
+        int i;
+
+        printf("Timing: packets sent %.0f nsec avg/" COUNTER_SPEC " nsec max after their target time\n",
+               (double)stats->jitter_total / (double)stats->jitter_samples,
+               (COUNTER)stats->jitter_max);
+        for (i = 0; i < JITTER_BUCKETS; i++) {
+            if (stats->jitter[i])
+                printf("\t%-8s " COUNTER_SPEC " (%.2f%%)\n", jitter_labels[i], stats->jitter[i],
+                       100.0 * (double)stats->jitter[i] / (double)stats->jitter_samples);
+        }
+    }
+
 }
 
 /**
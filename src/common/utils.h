@@ -25,6 +25,9 @@
 #include "defines.h"
 #include "common.h"
 
+/* # of buckets in the --timer=deadline jitter histogram */
+#define JITTER_BUCKETS 10
+
 typedef struct {
     char *active_pcap;
     COUNTER bytes_sent;
@@ -32,11 +35,28 @@ typedef struct {
     COUNTER failed;
     struct timeval start_time;
     struct timeval end_time;
+    /* --pipeline ring stats */
+    u_int32_t ring_size;
+    u_int32_t ring_max;
+    COUNTER ring_occupancy;
+    COUNTER ring_samples;
+    COUNTER ring_underruns;
+    COUNTER ring_full;
+    /* --prefetch read-ahead stats */
+    COUNTER read_ahead;         /* bytes */
+    COUNTER read_stalls;
+    /* how late packets went out vs. their --timer=deadline target */
+    COUNTER jitter[JITTER_BUCKETS];
+    COUNTER jitter_samples;
+    COUNTER jitter_total;       /* nsec */
+    u_int64_t jitter_max;       /* nsec */
 } tcpreplay_stats_t;
 
 
 int read_hexstring(const char *l2string, u_char *hex, const int hexlen);
 void packet_stats(const tcpreplay_stats_t *stats);
+void add_jitter_stats(tcpreplay_stats_t *stats, u_int64_t late);
+void merge_jitter_stats(tcpreplay_stats_t *dst, const tcpreplay_stats_t *src);
 
 /* our "safe" implimentations of functions which allocate memory */
 #define safe_malloc(x) _our_safe_malloc(x, __FUNCTION__, __LINE__, __FILE__)
@@ -103,6 +103,10 @@ parse_xX_str(tcpr_xX_t *xX, char *str, tcpr_bpf_t *bpf)
                 "Try using -xF:\"not <filter>\" instead");
     }
 
+    /* every packet gets checked against the list, so make that fast */
+    if (xX->cidr != NULL)
+        compile_cidr(xX->cidr);
+
     xX->mode = out;
     return xX->mode;
 }
@@ -24,7 +24,10 @@
 #cmakedefine HAVE_PCAP_GET_SELECTABLE_FD 1
 #cmakedefine HAVE_PCAP_LIB_VERSION 1
 #cmakedefine HAVE_PCAP_LIST_DATALINKS 1
+#cmakedefine HAVE_PCAP_OFFLINE_FILTER 1
 #cmakedefine HAVE_PCAP_OPEN_DEAD 1
+#cmakedefine HAVE_PCAP_OPEN_OFFLINE_WITH_TSTAMP_PRECISION 1
+#cmakedefine HAVE_PCAP_OPEN_DEAD_WITH_TSTAMP_PRECISION 1
 #cmakedefine HAVE_PCAP_SET_DATALINK 1
 #cmakedefine HAVE_PCAP_DUMP_FOPEN 1
 #cmakedefine HAVE_PCAP_SNAPSHOT 1
@@ -33,6 +36,9 @@
 /* Linux TX_RING support */
 #cmakedefine HAVE_TX_RING 1
 
+/* Linux sendmmsg() for batched PF_PACKET sends */
+#cmakedefine HAVE_SENDMMSG 1
+
 /* set to true to override the default */
 #cmakedefine FORCE_INJECT_BPF 1
 #cmakedefine FORCE_INJECT_PF 1
@@ -104,6 +110,12 @@
 #cmakedefine HAVE_INET_NTOP_PROTO 1
 #cmakedefine HAVE_ISSETUGID 1
 #cmakedefine HAVE_MMAP 1
+#cmakedefine HAVE_MADVISE 1
+#cmakedefine HAVE_PTHREAD 1
+#cmakedefine HAVE_PTHREAD_SETAFFINITY_NP 1
+#cmakedefine HAVE_CLOCK_GETTIME 1
+#cmakedefine HAVE_X86_CPU_DISPATCH 1
+#cmakedefine HAVE_AVX512F 1
 #cmakedefine HAVE_MPROTECT 1
 #cmakedefine HAVE_SYSCONF 1
 #cmakedefine HAVE_ABSOLUTE_TIME 1
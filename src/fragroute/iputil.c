@@ -81,13 +81,96 @@ inet_add_option_6(void *buf, size_t len, int proto, const void *optbuf, size_t o
 }
 
 
+/*
+ * L4 half of libdnet's ip_checksum()/ip6_checksum(). pseudo is the
+ * partial sum of the pseudo header, if the protocol covers one.
+ */
+static void
+inet_checksum_l4(int proto, u_char *p, size_t len, uint32_t pseudo)
+{
+    struct tcp_hdr *tcp;
+    struct udp_hdr *udp;
+    struct icmp_hdr *icmp;
+
+    /* the pseudo header also covers the protocol & L4 length */
+    pseudo += htons(proto + len);
+
+    if (proto == IP_PROTO_TCP) {
+        if (len >= TCP_HDR_LEN) {
+            tcp = (struct tcp_hdr *)p;
+            tcp->th_sum = 0;
+            tcp->th_sum = csum_fold(csum_partial(tcp, len, pseudo));
+        }
+    } else if (proto == IP_PROTO_UDP) {
+        if (len >= UDP_HDR_LEN) {
+            udp = (struct udp_hdr *)p;
+            udp->uh_sum = 0;
+            udp->uh_sum = csum_fold(csum_partial(udp, len, pseudo));
+            if (!udp->uh_sum)
+                udp->uh_sum = 0xffff;   /* RFC 768 */
+        }
+    } else if (proto == IP_PROTO_ICMPV6) {
+        if (len >= ICMP_HDR_LEN) {
+            icmp = (struct icmp_hdr *)p;
+            icmp->icmp_cksum = 0;
+            icmp->icmp_cksum = csum_fold(csum_partial(icmp, len, pseudo));
+        }
+    } else if (proto == IP_PROTO_ICMP || proto == IP_PROTO_IGMP) {
+        if (len >= ICMP_HDR_LEN) {
+            icmp = (struct icmp_hdr *)p;
+            icmp->icmp_cksum = 0;
+            icmp->icmp_cksum = csum_fold(csum_partial(icmp, len, 0));
+        }
+    }
+}
+
+/*
+ * Same as libdnet's ip_checksum()/ip6_checksum(), but uses the SIMD
+ * checksum kernels in common/csum.c
+ */
 void
 inet_checksum(uint16_t eth_type, void *buf, size_t len)
 {
+    struct ip_hdr *ip;
+    struct ip6_hdr *ip6;
+    struct ip6_ext_hdr *ext;
+    u_char nxt;
+    int hl, off;
+    size_t i;
+
     if (eth_type == ETH_TYPE_IP) {
-        return ip_checksum(buf, len);
+        if (len < IP_HDR_LEN)
+            return;
+
+        ip = (struct ip_hdr *)buf;
+        hl = ip->ip_hl << 2;
+        ip->ip_sum = 0;
+        ip->ip_sum = csum_fold(csum_partial(ip, hl, 0));
+
+        /* fragments don't have a (complete) L4 header */
+        off = htons(ip->ip_off);
+        if ((off & IP_OFFMASK) != 0 || (off & IP_MF) != 0)
+            return;
+
+        inet_checksum_l4(ip->ip_p, (u_char *)buf + hl, len - hl,
+                csum_partial(&ip->ip_src, 8, 0));
     } else if (eth_type == ETH_TYPE_IPV6) {
-        return ip6_checksum(buf, len);
+        ip6 = (struct ip6_hdr *)buf;
+        nxt = ip6->ip6_nxt;
+
+        /* skip over the extension headers */
+        for (i = IP6_HDR_LEN; IP6_IS_EXT(nxt); i += (ext->ext_len + 1) << 3) {
+            if (i >= len)
+                return;
+            ext = (struct ip6_ext_hdr *)((u_char *)buf + i);
+            nxt = ext->ext_nxt;
+        }
+
+        if (i > len)
+            return;
+
+        inet_checksum_l4(nxt, (u_char *)buf + i, len - i,
+                csum_partial(&ip6->ip6_src, 32, 0));
     }
 }
 
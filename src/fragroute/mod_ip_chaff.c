@@ -15,6 +15,7 @@
 #include "mod.h"
 #include "pkt.h"
 #include "randutil.h"
+#include "iputil.h"
 
 #define CHAFF_TYPE_DUP	 1
 #define CHAFF_TYPE_OPT	 2
@@ -88,7 +89,7 @@ ip_chaff_apply(void *d, struct pktq *pktq)
 		case CHAFF_TYPE_DUP:
 			new->pkt_ts.tv_usec = 1;
 			if (eth_type == ETH_TYPE_IP) {
-			ip_checksum(new->pkt_ip, new->pkt_ip_data -
+			inet_checksum(ETH_TYPE_IP, new->pkt_ip, new->pkt_ip_data -
 			    new->pkt_eth_data);
 			}
 			break;
@@ -103,7 +104,7 @@ ip_chaff_apply(void *d, struct pktq *pktq)
 			*(uint32_t *)new->pkt_ip_data = rand_uint32(data->rnd);
 			new->pkt_ip_data += i;
 			new->pkt_end += i;
-			ip_checksum(new->pkt_ip, new->pkt_ip_data -
+			inet_checksum(ETH_TYPE_IP, new->pkt_ip, new->pkt_ip_data -
 			    new->pkt_eth_data);
 			} else if (eth_type == ETH_TYPE_IPV6) {
 				continue;
@@ -111,7 +112,7 @@ ip_chaff_apply(void *d, struct pktq *pktq)
 		case CHAFF_TYPE_TTL:
 			if (eth_type == ETH_TYPE_IP) {
 			new->pkt_ip->ip_ttl = data->ttl;
-			ip_checksum(new->pkt_ip, new->pkt_ip_data -
+			inet_checksum(ETH_TYPE_IP, new->pkt_ip, new->pkt_ip_data -
 			    new->pkt_eth_data);
 			} else if (eth_type == ETH_TYPE_IPV6) {
 			    pkt->pkt_ip6->ip6_hlim = data->ttl;
@@ -17,6 +17,7 @@
 #include "mod.h"
 #include "pkt.h"
 #include "randutil.h"
+#include "iputil.h"
 
 #ifndef MAX
 #define MAX(a,b)	(((a)>(b))?(a):(b))
@@ -165,7 +166,7 @@ ip_frag_apply_ipv4(void *d, struct pktq *pktq)
 				    ((p + fraglen < pkt->pkt_end) ? IP_MF: 0));
 			}
 			new->pkt_ip->ip_len = htons(hl + fraglen);
-			ip_checksum(new->pkt_ip, hl + fraglen);
+			inet_checksum(ETH_TYPE_IP, new->pkt_ip, hl + fraglen);
 			
 			memcpy(new->pkt_ip_data, p1, fraglen);
 			new->pkt_end = new->pkt_ip_data + fraglen;
@@ -176,7 +177,7 @@ ip_frag_apply_ipv4(void *d, struct pktq *pktq)
 				new->pkt_ts.tv_usec = 1;
 				new->pkt_ip->ip_off = htons(IP_MF | off);
 				new->pkt_ip->ip_len = htons(hl + (fraglen<<1));
-				ip_checksum(new->pkt_ip, hl + (fraglen<<1));
+				inet_checksum(ETH_TYPE_IP, new->pkt_ip, hl + (fraglen<<1));
 				
 				memcpy(new->pkt_ip_data, p, fraglen);
 				memcpy(new->pkt_ip_data+fraglen, p2, fraglen);
@@ -85,7 +85,7 @@ ip_opt_apply(void *d, struct pktq *pktq)
 		if (len > 0) {
 			pkt->pkt_end += len;
 			pkt_decorate(pkt);
-			ip_checksum(pkt->pkt_ip,
+			inet_checksum(ETH_TYPE_IP, pkt->pkt_ip,
 			    pkt->pkt_end - pkt->pkt_eth_data);
 		}
 	}
@@ -15,6 +15,7 @@
 #include "argv.h"
 #include "mod.h"
 #include "pkt.h"
+#include "iputil.h"
 
 struct ip_tos_data {
 	int	tos;
@@ -58,7 +59,7 @@ ip_tos_apply(void *d, struct pktq *pktq)
 		if (eth_type == ETH_TYPE_IP) {
 		pkt->pkt_ip->ip_tos = data->tos;
 		/* XXX - do incremental checksum */
-		ip_checksum(pkt->pkt_ip, pkt->pkt_ip_data - pkt->pkt_eth_data);
+		inet_checksum(ETH_TYPE_IP, pkt->pkt_ip, pkt->pkt_ip_data - pkt->pkt_eth_data);
 	}
 	}
 	return (0);
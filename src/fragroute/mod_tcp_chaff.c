@@ -172,7 +172,7 @@ tcp_chaff_apply(void *d, struct pktq *pktq)
 		case CHAFF_TYPE_TTL:
 			if (eth_type == ETH_TYPE_IP) {
 			new->pkt_ip->ip_ttl = data->ttl;
-				ip_checksum(new->pkt_ip,
+				inet_checksum(ETH_TYPE_IP, new->pkt_ip,
 						new->pkt_ip_data - new->pkt_eth_data);
 			} else if (eth_type == ETH_TYPE_IPV6) {
 				new->pkt_ip6->ip6_hlim = data->ttl;
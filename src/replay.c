@@ -28,6 +28,7 @@
 
 
 static int replay_file(tcpreplay_t *ctx, int idx);
+static void seek_start_packet(tcpreplay_t *ctx, mmpcap_t *mm);
 static int replay_two_files(tcpreplay_t *ctx, int idx1, int idx2);
 static int replay_cache(tcpreplay_t *ctx, int idx);
 static int replay_two_caches(tcpreplay_t *ctx, int idx1, int idx2);
@@ -47,8 +48,8 @@ tcpr_replay_index(tcpreplay_t *ctx, int idx)
 
     /* only process a single file */
     if (! ctx->options->dualfile) {
-        /* process each pcap file in order */
-        for (idx = 0; idx < ctx->options->source_cnt; idx++) {
+        /* process each pcap file in order (--threads workers take every Nth) */
+        for (idx = ctx->source_first; idx < ctx->options->source_cnt; idx += ctx->source_stride) {
             /* reset cache markers for each iteration */
             ctx->cache_byte = 0;
             ctx->cache_bit = 0;
@@ -104,6 +105,35 @@ tcpr_replay_index(tcpreplay_t *ctx, int idx)
 }
 
 
+/**
+ * \brief Moves the reader to the --start-packet of the pcap
+ *
+ * Uses the packet index of the tcpprep cache when there is one, otherwise
+ * reads the packets before it and throws them away.
+ */
+static void
+seek_start_packet(tcpreplay_t *ctx, mmpcap_t *mm)
+{
+    struct pcap_pkthdr pkthdr;
+    COUNTER skip = ctx->options->start_packet - 1;
+    u_int64_t offset;
+
+    offset = cache_offset(&ctx->options->cache, ctx->options->start_packet);
+    if (offset > 0 && mmpcap_seek(mm, (size_t)offset)) {
+        dbgx(1, "Seeked to packet " COUNTER_SPEC " at offset %llu",
+                ctx->options->start_packet, (unsigned long long)offset);
+        return;
+    }
+
+    skip -= mmpcap_skip(mm, skip);
+    while (skip > 0 && mmpcap_next(mm, &pkthdr) != NULL)
+        skip--;
+
+    if (skip > 0)
+        warnx("pcap has fewer than " COUNTER_SPEC " packets, nothing to send",
+                ctx->options->start_packet);
+}
+
 /**
  * \brief replay a pcap file out interface(s)
  *
@@ -114,6 +144,7 @@ replay_file(tcpreplay_t *ctx, int idx)
 {
     char *path;
     pcap_t *pcap = NULL;
+    mmpcap_t *mm = NULL;
     char ebuf[PCAP_ERRBUF_SIZE];
     int dlt;
 
@@ -128,7 +159,7 @@ replay_file(tcpreplay_t *ctx, int idx)
 
     /* read from pcap file if we haven't cached things yet */
     if (!(ctx->options->enable_file_cache || ctx->options->preload_pcap)) {
-        if ((pcap = pcap_open_offline(path, ebuf)) == NULL) {
+        if ((pcap = tcpr_pcap_open_offline(path, ebuf)) == NULL) {
             tcpreplay_seterr(ctx, "Error opening pcap file: %s", ebuf);
             return -1;
         }
@@ -141,7 +172,7 @@ replay_file(tcpreplay_t *ctx, int idx)
 
     } else {
         if (!ctx->options->file_cache[idx].cached)
-            if ((pcap = pcap_open_offline(path, ebuf)) == NULL) {
+            if ((pcap = tcpr_pcap_open_offline(path, ebuf)) == NULL) {
                 tcpreplay_seterr(ctx, "Error opening pcap file: %s", ebuf);
                 return -1;
             }
@@ -156,7 +187,7 @@ replay_file(tcpreplay_t *ctx, int idx)
     if (ctx->options->verbose) {
         /* in cache mode, we may not have opened the file */
         if (pcap == NULL)
-            if ((pcap = pcap_open_offline(path, ebuf)) == NULL) {
+            if ((pcap = tcpr_pcap_open_offline(path, ebuf)) == NULL) {
                tcpreplay_seterr("Error opening pcap file: %s", ebuf);
                return -1;
             }
@@ -177,9 +208,22 @@ replay_file(tcpreplay_t *ctx, int idx)
 #endif
     }
 
+    /* read packets straight out of a mapping of the file when we can */
+    if (pcap != NULL) {
+        mm = mmpcap_open(path, pcap);
+        if (ctx->options->start_packet > 1)
+            seek_start_packet(ctx, mm);
+        mmpcap_prefetch(mm, ctx->options->prefetch);
+    }
+
     ctx->stats.active_pcap = ctx->options->sources[idx].filename;
-    send_packets(ctx, pcap, idx);
+    send_packets(ctx, mm, idx);
 
+    if (mm != NULL) {
+        ctx->stats.read_ahead += mmpcap_prefetched(mm);
+        ctx->stats.read_stalls += mmpcap_stalls(mm);
+    }
+    mmpcap_close(mm);
     if (pcap != NULL)
         pcap_close(pcap);
 
@@ -202,6 +246,7 @@ replay_two_files(tcpreplay_t *ctx, int idx1, int idx2)
 {
     char *path1, *path2;
     pcap_t *pcap1  = NULL, *pcap2 = NULL;
+    mmpcap_t *mm1 = NULL, *mm2 = NULL;
     char ebuf[PCAP_ERRBUF_SIZE];
     int dlt1, dlt2, rcode = 0;
 
@@ -222,23 +267,23 @@ replay_two_files(tcpreplay_t *ctx, int idx1, int idx2)
 
     /* read from first pcap file if we haven't cached things yet */
     if (! (ctx->options->enable_file_cache || ctx->options->preload_pcap)) {
-        if ((pcap1 = pcap_open_offline(path1, ebuf)) == NULL) {
+        if ((pcap1 = tcpr_pcap_open_offline(path1, ebuf)) == NULL) {
             tcpreplay_seterr(ctx, "Error opening pcap file: %s", ebuf);
             return -1;
         }
-        if ((pcap2 = pcap_open_offline(path2, ebuf)) == NULL) {
+        if ((pcap2 = tcpr_pcap_open_offline(path2, ebuf)) == NULL) {
             tcpreplay_seterr(ctx, "Error opening pcap file: %s", ebuf);
             return -1;
         }
     } else {
         if (!ctx->options->file_cache[idx1].cached) {
-            if ((pcap1 = pcap_open_offline(path1, ebuf)) == NULL) {
+            if ((pcap1 = tcpr_pcap_open_offline(path1, ebuf)) == NULL) {
                 tcpreplay_seterr(ctx, "Error opening pcap file: %s", ebuf);
                 return -1;
             }
         }
         if (!ctx->options->file_cache[idx2].cached) {
-            if ((pcap2 = pcap_open_offline(path2, ebuf)) == NULL) {
+            if ((pcap2 = tcpr_pcap_open_offline(path2, ebuf)) == NULL) {
                 tcpreplay_seterr(ctx, "Error opening pcap file: %s", ebuf);
                 return -1;
             }
@@ -288,7 +333,7 @@ replay_two_files(tcpreplay_t *ctx, int idx1, int idx2)
 
         /* in cache mode, we may not have opened the file */
         if (pcap1 == NULL)
-            if ((pcap1 = pcap_open_offline(path1, ebuf)) == NULL) {
+            if ((pcap1 = tcpr_pcap_open_offline(path1, ebuf)) == NULL) {
                 tcpreplay_seterr(ctx, "Error opening pcap file: %s", ebuf);
                 return -1;
             }
@@ -299,7 +344,27 @@ replay_two_files(tcpreplay_t *ctx, int idx1, int idx2)
 #endif
 
 
-    send_dual_packets(ctx, pcap1, idx1, pcap2, idx2);
+    if (pcap1 != NULL) {
+        mm1 = mmpcap_open(path1, pcap1);
+        mmpcap_prefetch(mm1, ctx->options->prefetch);
+    }
+    if (pcap2 != NULL) {
+        mm2 = mmpcap_open(path2, pcap2);
+        mmpcap_prefetch(mm2, ctx->options->prefetch);
+    }
+
+    send_dual_packets(ctx, mm1, idx1, mm2, idx2);
+
+    if (mm1 != NULL) {
+        ctx->stats.read_ahead += mmpcap_prefetched(mm1);
+        ctx->stats.read_stalls += mmpcap_stalls(mm1);
+    }
+    if (mm2 != NULL) {
+        ctx->stats.read_ahead += mmpcap_prefetched(mm2);
+        ctx->stats.read_stalls += mmpcap_stalls(mm2);
+    }
+    mmpcap_close(mm1);
+    mmpcap_close(mm2);
 
     if (pcap1 != NULL)
         pcap_close(pcap1);
@@ -31,6 +31,14 @@
 #include <stdlib.h>
 #include <unistd.h>
 #include <fcntl.h>
+#include <sys/stat.h>
+#ifdef HAVE_MMAP
+#include <sys/mman.h>
+#endif
+#ifdef HAVE_PTHREAD
+#include <pthread.h>
+#include <sched.h>
+#endif
 
 #include "tcpreplay_api.h"
 
@@ -53,12 +61,75 @@ extern tcpedit_t *tcpedit;
 extern int debug;
 #endif
 
+/* packets queued up to go out a single interface with one sendpacket_batch() */
+typedef struct {
+    sendpacket_t *sp;
+    int cnt;
+    int max;
+    u_char *buf;
+    struct iovec iov[SENDPACKET_BURST_MAX];
+} send_burst_t;
+
+/* reader side of send_packets(), run on its own thread with --pipeline */
+typedef struct {
+    tcpreplay_t *ctx;
+    mmpcap_t *pcap;
+    int idx;
+    COUNTER cache_pos, *cache_ptr;
+    COUNTER packetnum;          /* # of packets read, for the tcpprep cache */
+    COUNTER last;               /* packet # read_packet() returned last */
+    COUNTER dirs_first;         /* packet # of dirs[0] */
+    COUNTER dirs_cnt;
+    u_char dirs[CACHE_DECODE_BLOCK]; /* tcpprep cache, decoded a block at a time */
+    pktring_t *ring;
+    struct pcap_pkthdr pkthdr;
+#if defined TCPREPLAY && defined TCPREPLAY_EDIT
+    /* packets read ahead & edited together by tcpedit_packet_batch() */
+    int edit_max;
+    int edit_cnt;
+    int edit_pos;
+    u_char *editbuf;            /* edit_max * MAXPACKET */
+    struct pcap_pkthdr edit_pkthdr[TCPEDIT_BATCH_MAX];
+    struct pcap_pkthdr *edit_hdr[TCPEDIT_BATCH_MAX];
+    u_char *edit_data[TCPEDIT_BATCH_MAX];
+    tcpr_dir_t edit_dir[TCPEDIT_BATCH_MAX];
+    int edit_rcode[TCPEDIT_BATCH_MAX];
+    sendpacket_t *edit_sp[TCPEDIT_BATCH_MAX];
+    COUNTER edit_num[TCPEDIT_BATCH_MAX];
+#endif
+} packet_reader_t;
+
 static void do_sleep(tcpreplay_t *ctx, struct timeval *time, 
         struct timeval *last, int len, tcpreplay_accurate accurate, 
         sendpacket_t *sp, COUNTER counter, delta_t *delta_ctx, bool *skip_timestamp);
-static const u_char *get_next_packet(tcpreplay_t *ctx, pcap_t *pcap, 
-        struct pcap_pkthdr *pkthdr, int file_idx, packet_cache_t **prev_packet);
+static const u_char *get_next_packet(tcpreplay_t *ctx, mmpcap_t *pcap, 
+        struct pcap_pkthdr *pkthdr, int file_idx, COUNTER *cache_pos);
+static void file_cache_append(tcpreplay_t *ctx, file_cache_t *cache,
+        const struct pcap_pkthdr *pkthdr, const u_char *pktdata);
 static u_int32_t get_user_count(tcpreplay_t *ctx, sendpacket_t *sp, COUNTER counter);
+#ifdef HAVE_CLOCK_GETTIME
+static void deadline_wait(tcpreplay_t *ctx, const struct timeval *time,
+        const struct timeval *last, int len, COUNTER counter);
+static const u_int64_t *file_cache_schedule(tcpreplay_t *ctx, int idx);
+static void schedule_wait(tcpreplay_t *ctx, u_int64_t offset, u_int64_t *start_ns);
+#endif
+static void burst_init(tcpreplay_t *ctx, send_burst_t *burst);
+static void burst_queue(send_burst_t *burst, sendpacket_t *sp, const u_char *pktdata,
+        u_int32_t pktlen);
+static void burst_flush(send_burst_t *burst);
+static u_int32_t flow_hash(const u_char *pktdata, u_int32_t caplen, int dlt);
+static const u_char *read_packet(packet_reader_t *rd, struct pcap_pkthdr **pkthdr,
+        sendpacket_t **spp);
+static tcpr_dir_t cache_lookup(packet_reader_t *rd, COUNTER packetnum);
+#if defined TCPREPLAY && defined TCPREPLAY_EDIT
+static const u_char *edit_packet_copy(struct pcap_pkthdr **pkthdr, const u_char *pktdata,
+        u_char *editbuf, tcpr_dir_t dir, COUNTER packetnum);
+static void edit_queue(packet_reader_t *rd, const u_char *pktdata, sendpacket_t *sp,
+        COUNTER packetnum);
+static void edit_batch(packet_reader_t *rd, file_cache_t *cache);
+static const u_char *edit_next(packet_reader_t *rd, struct pcap_pkthdr **pkthdr,
+        sendpacket_t **spp);
+#endif
 
 /**
  * \brief Preloads the memory cache for the given pcap file_idx 
@@ -71,12 +142,17 @@ preload_pcap_file(tcpreplay_t *ctx, int idx)
 {
     char *path = ctx->options->sources[idx].filename;
     pcap_t *pcap = NULL;
+    mmpcap_t *mm;
     char ebuf[PCAP_ERRBUF_SIZE];
     const u_char *pktdata = NULL;
     struct pcap_pkthdr pkthdr;
-    packet_cache_t *cached_packet = NULL;
-    packet_cache_t **prev_packet = &cached_packet;
+    COUNTER cache_pos = 0;
     COUNTER packetnum = 0;
+#if defined TCPREPLAY && defined TCPREPLAY_EDIT
+    file_cache_t *cache = &ctx->options->file_cache[idx];
+    struct pcap_pkthdr *pkthdr_ptr;
+    u_char *editbuf;
+#endif
 
 
     /* close stdin if reading from it (needed for some OS's) */
@@ -84,118 +160,444 @@ preload_pcap_file(tcpreplay_t *ctx, int idx)
         if (close(1) == -1)
             warnx("unable to close stdin: %s", strerror(errno));
 
-    if ((pcap = pcap_open_offline(path, ebuf)) == NULL)
+    if ((pcap = tcpr_pcap_open_offline(path, ebuf)) == NULL)
         errx(-1, "Error opening pcap file: %s", ebuf);
 
+    mm = mmpcap_open(path, pcap);
+
+#if defined TCPREPLAY && defined TCPREPLAY_EDIT
+    /* tcpreplay-edit caches the edited frames, just like read_packet() */
+    if (ctx->intf2 == NULL && ctx->intf1 != NULL) {
+        editbuf = (u_char *)safe_malloc(MAXPACKET);
+        cache->arena_len = 0;
+        cache->pkt_cnt = 0;
+
+        while ((pktdata = get_next_packet(ctx, mm, &pkthdr, idx, NULL)) != NULL) {
+            pkthdr_ptr = &pkthdr;
+            pktdata = edit_packet_copy(&pkthdr_ptr, pktdata, editbuf,
+                    ctx->intf1->cache_dir, ++packetnum);
+            file_cache_append(ctx, cache, pkthdr_ptr, pktdata);
+        }
+
+        cache->edited = true;
+        safe_free(editbuf);
+    } else
+#endif
     /* loop through the pcap.  get_next_packet() builds the cache for us! */
-    while ((pktdata = get_next_packet(ctx, pcap, &pkthdr, idx, prev_packet)) != NULL) {
+    while ((pktdata = get_next_packet(ctx, mm, &pkthdr, idx, &cache_pos)) != NULL) {
         packetnum++;
     }
 
     /* mark this file as cached */
     ctx->options->file_cache[idx].cached = TRUE;
+    mmpcap_close(mm);
     pcap_close(pcap);
 }
 
+/**
+ * Returns the next packet to send from the reader's pcap along with the
+ * interface it goes out of: skips the flows of other --threads workers and
+ * --cachefile NOSEND packets, edits the packet (tcpreplay-edit) and prints
+ * it (--verbose).  Everything that isn't timing or sending lives here so
+ * that --pipeline can run it on its own thread.
+ *
+ * tcpreplay-edit reads up to rd->edit_max packets ahead and edits them with
+ * a single tcpedit_packet_batch() call, then hands them out one at a time.
+ */
+static const u_char *
+read_packet(packet_reader_t *rd, struct pcap_pkthdr **pkthdr, sendpacket_t **spp)
+{
+    tcpreplay_t *ctx = rd->ctx;
+    const u_char *pktdata;
+    sendpacket_t *sp = ctx->intf1;
+    COUNTER packetnum, *cache_ptr = rd->cache_ptr;
+#if defined TCPREPLAY && defined TCPREPLAY_EDIT
+    file_cache_t *cache = NULL;
+
+    /* the rest of the last batch goes first */
+    if (rd->edit_pos < rd->edit_cnt)
+        return edit_next(rd, pkthdr, spp);
+
+    rd->edit_cnt = rd->edit_pos = 0;
+
+    /*
+     * Without a tcpprep cache every packet is edited the same way each
+     * loop, so the file cache keeps the frames after editing and loops
+     * 2..N send them as is.  Those are appended below rather then by
+     * get_next_packet().
+     */
+    if (cache_ptr != NULL && ctx->intf2 == NULL) {
+        cache = &ctx->options->file_cache[rd->idx];
+        if (!cache->cached) {
+            if (*cache_ptr == 0) {
+                cache->arena_len = 0;
+                cache->pkt_cnt = 0;
+                cache->edited = true;
+            }
+            cache_ptr = NULL;
+        }
+    }
+#endif
+
+    while ((pktdata = get_next_packet(ctx, rd->pcap, &rd->pkthdr, rd->idx, cache_ptr)) != NULL) {
+        *pkthdr = &rd->pkthdr;
+        packetnum = rd->packetnum + 1;
+
+        /* --threads: skip flows which belong to another worker */
+        if (ctx->flow_cnt > 1 &&
+                flow_hash(pktdata, rd->pkthdr.caplen, ctx->flow_dlt) % ctx->flow_cnt != (u_int32_t)ctx->flow_id)
+            continue;
+
+        /* Dual nic processing */
+        if (ctx->intf2 != NULL) {
+
+            sp = (sendpacket_t *) cache_mode(ctx, cache_lookup(rd, packetnum), packetnum);
+
+            /* sometimes we should not send the packet */
+            if (sp == TCPR_DIR_NOSEND)
+                continue;
+        }
+
+        rd->packetnum++;
+
+#if defined TCPREPLAY && defined TCPREPLAY_EDIT
+        if (cache == NULL || !cache->cached || !cache->edited) {
+            edit_queue(rd, pktdata, sp, packetnum);
+            if (rd->edit_cnt < rd->edit_max)
+                continue;
+            break;
+        }
+#endif
+
+        /* do we need to print the packet via tcpdump? */
+#ifdef ENABLE_VERBOSE
+        if (ctx->options->verbose)
+            tcpdump_print(ctx->options->tcpdump, *pkthdr, pktdata);
+#endif
+
+        rd->last = packetnum;
+        *spp = sp;
+        return pktdata;
+    }
+
+#if defined TCPREPLAY && defined TCPREPLAY_EDIT
+    if (rd->edit_cnt > 0) {
+        edit_batch(rd, cache);
+        return edit_next(rd, pkthdr, spp);
+    }
+#endif
+
+    return NULL;
+}
+
+#if defined TCPREPLAY && defined TCPREPLAY_EDIT
+/**
+ * Runs a copy of the packet in editbuf through tcpedit and returns the
+ * edited frame.  Never edit the file cache or the read only pcap mapping
+ * in place!
+ */
+static const u_char *
+edit_packet_copy(struct pcap_pkthdr **pkthdr, const u_char *pktdata,
+        u_char *editbuf, tcpr_dir_t dir, COUNTER packetnum)
+{
+    u_char *packet = editbuf;
+
+    memcpy(editbuf, pktdata, (*pkthdr)->caplen);
+    if (tcpedit_packet(tcpedit, pkthdr, &packet, dir) == -1) {
+        errx(-1, "Error editing packet #" COUNTER_SPEC ": %s", packetnum, tcpedit_geterr(tcpedit));
+    }
+
+    return packet;
+}
+
+/**
+ * Copies a packet into the next free slot of the reader's edit batch
+ */
+static void
+edit_queue(packet_reader_t *rd, const u_char *pktdata, sendpacket_t *sp,
+        COUNTER packetnum)
+{
+    int i = rd->edit_cnt++;
+
+    memcpy(&rd->edit_pkthdr[i], &rd->pkthdr, sizeof(struct pcap_pkthdr));
+    memcpy(rd->editbuf + (i * MAXPACKET), pktdata, rd->pkthdr.caplen);
+    rd->edit_hdr[i] = &rd->edit_pkthdr[i];
+    rd->edit_data[i] = rd->editbuf + (i * MAXPACKET);
+    rd->edit_dir[i] = sp->cache_dir;
+    rd->edit_sp[i] = sp;
+    rd->edit_num[i] = packetnum;
+}
+
+/**
+ * Edits the queued packets with one tcpedit_packet_batch() call and adds
+ * them to the file cache if it is being built
+ */
+static void
+edit_batch(packet_reader_t *rd, file_cache_t *cache)
+{
+    int i;
+
+    tcpedit_packet_batch(tcpedit, rd->edit_hdr, rd->edit_data, rd->edit_dir,
+            rd->edit_rcode, rd->edit_cnt);
+
+    for (i = 0; i < rd->edit_cnt; i++) {
+        if (rd->edit_rcode[i] == TCPEDIT_ERROR)
+            errx(-1, "Error editing packet #" COUNTER_SPEC ": %s", rd->edit_num[i],
+                    tcpedit_geterr(tcpedit));
+
+        if (cache != NULL && !cache->cached) {
+            file_cache_append(rd->ctx, cache, rd->edit_hdr[i], rd->edit_data[i]);
+            (*rd->cache_ptr)++;
+        }
+    }
+}
+
+/**
+ * Hands out the next packet of the edited batch
+ */
+static const u_char *
+edit_next(packet_reader_t *rd, struct pcap_pkthdr **pkthdr, sendpacket_t **spp)
+{
+    int i = rd->edit_pos++;
+
+    *pkthdr = rd->edit_hdr[i];
+    *spp = rd->edit_sp[i];
+    rd->last = rd->edit_num[i];
+
+    /* do we need to print the packet via tcpdump? */
+#ifdef ENABLE_VERBOSE
+    if (rd->ctx->options->verbose)
+        tcpdump_print(rd->ctx->options->tcpdump, *pkthdr, rd->edit_data[i]);
+#endif
+
+    return rd->edit_data[i];
+}
+#endif
+
+#ifdef HAVE_PTHREAD
+/**
+ * pins the calling thread to the given CPU, if any
+ */
+static void
+pin_thread(int cpu)
+{
+#ifdef HAVE_PTHREAD_SETAFFINITY_NP
+    cpu_set_t set;
+
+    if (cpu < 0)
+        return;
+
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    if ((errno = pthread_setaffinity_np(pthread_self(), sizeof(set), &set)) != 0)
+        warnx("Unable to pin thread to CPU %d: %s", cpu, strerror(errno));
+#else
+    if (cpu >= 0)
+        warnx("%s", "Pinning threads to a CPU is not supported on this platform");
+#endif
+}
+
+/**
+ * --pipeline reader thread: reads/edits packets into the ring for
+ * send_packets() to transmit
+ */
+static void *
+pipeline_reader(void *arg)
+{
+    packet_reader_t *rd = (packet_reader_t *)arg;
+    struct pcap_pkthdr *pkthdr;
+    const u_char *pktdata;
+    sendpacket_t *sp;
+    u_char *buf;
+
+    pin_thread(rd->ctx->options->pipeline_cpu_reader);
+
+    while (!rd->ring->abort && (pktdata = read_packet(rd, &pkthdr, &sp)) != NULL) {
+        if (pkthdr->caplen > PKTRING_MAX_PKTLEN) {
+            warnx("Skipping packet #" COUNTER_SPEC ": %u bytes is too large",
+                    rd->last, pkthdr->caplen);
+            continue;
+        }
+
+        if ((buf = pktring_reserve(rd->ring, pkthdr->caplen)) == NULL)
+            break;
+
+        memcpy(buf, pktdata, pkthdr->caplen);
+        pktring_commit(rd->ring, pkthdr, sp);
+    }
+
+    pktring_eof(rd->ring);
+    return NULL;
+}
+
+/**
+ * adds the pipeline ring counters to stats
+ */
+static void
+pipeline_stats(tcpreplay_stats_t *stats, const pktring_t *ring)
+{
+    stats->ring_size = pktring_size(ring);
+    if (ring->max_occupancy > stats->ring_max)
+        stats->ring_max = ring->max_occupancy;
+    stats->ring_occupancy += ring->occupancy;
+    stats->ring_samples += ring->samples;
+    stats->ring_underruns += ring->underruns;
+    stats->ring_full += ring->full;
+}
+#endif /* HAVE_PTHREAD */
+
 /**
  * the main loop function for tcpreplay.  This is where we figure out
  * what to do with each packet
+ *
+ * With --pipeline, reading & editing happens on a separate thread which
+ * feeds the packets to this one through a pktring_t, so I/O or editing
+ * stalls don't throw off the send timing.
  */
 void
-send_packets(tcpreplay_t *ctx, pcap_t *pcap, int idx)
+send_packets(tcpreplay_t *ctx, mmpcap_t *pcap, int idx)
 {
     struct timeval last = { 0, 0 }, last_print_time = { 0, 0 }, print_delta;
     COUNTER packetnum = 0;
-    struct pcap_pkthdr pkthdr;
+    struct pcap_pkthdr *pkthdr;
     const u_char *pktdata = NULL;
     sendpacket_t *sp = ctx->intf1;
     u_int32_t pktlen;
-    packet_cache_t *cached_packet = NULL;
-    packet_cache_t **prev_packet = NULL;
-#if defined TCPREPLAY && defined TCPREPLAY_EDIT
-    struct pcap_pkthdr *pkthdr_ptr;
-#endif
+    packet_reader_t rd;
+    pktring_t *ring = NULL;
+    void *cookie;
     delta_t delta_ctx;
-    bool skip_timestamp = false;
+    bool skip_timestamp = false, complete = true;
+    send_burst_t burst;
+#ifdef HAVE_PTHREAD
+    pthread_t reader;
+    tcpreplay_stats_t stats;
+#endif
+#ifdef HAVE_CLOCK_GETTIME
+    const u_int64_t *schedule;
+    u_int64_t schedule_start = 0;
+#endif
 
     init_delta_time(&delta_ctx);
+    burst_init(ctx, &burst);
+#ifdef HAVE_CLOCK_GETTIME
+    schedule = file_cache_schedule(ctx, idx);
+#endif
 
-    if (ctx->options->enable_file_cache) {
-        prev_packet = &cached_packet;
-    } else {
-        prev_packet = NULL;
+    memset(&rd, 0, sizeof(rd));
+    rd.ctx = ctx;
+    rd.pcap = pcap;
+    rd.idx = idx;
+    rd.packetnum = ctx->stats.pkts_sent;
+    if (ctx->options->start_packet > 1)
+        rd.packetnum += ctx->options->start_packet - 1;
+    if (ctx->options->enable_file_cache)
+        rd.cache_ptr = &rd.cache_pos;
+
+#if defined TCPREPLAY && defined TCPREPLAY_EDIT
+    /*
+     * edit a burst at a time, or as many as tcpedit takes at once when the
+     * --pipeline reader runs ahead anyway.  Timed replays don't burst so
+     * each packet is still edited just before it is due.
+     */
+    rd.edit_max = burst.max;
+#ifdef HAVE_PTHREAD
+    if (ctx->options->pipeline)
+        rd.edit_max = TCPEDIT_BATCH_MAX;
+#endif
+    if (rd.edit_max > TCPEDIT_BATCH_MAX)
+        rd.edit_max = TCPEDIT_BATCH_MAX;
+#ifdef HAVE_CLOCK_GETTIME
+    /* the schedule is indexed by rd.cache_pos, which can't run ahead */
+    if (schedule != NULL)
+        rd.edit_max = 1;
+#endif
+    rd.editbuf = (u_char *)safe_malloc(rd.edit_max * MAXPACKET);
+#endif
+
+#ifdef HAVE_PTHREAD
+    if (ctx->options->pipeline) {
+        ring = rd.ring = pktring_open(ctx->options->pipeline_slots);
+        if ((errno = pthread_create(&reader, NULL, pipeline_reader, &rd)) != 0)
+            errx(-1, "Unable to start pipeline reader thread: %s", strerror(errno));
+
+        pin_thread(ctx->options->pipeline_cpu_sender);
     }
+#endif
 
     /* MAIN LOOP
      * Keep sending while we have packets or until
      * we've sent enough packets
      */
-    while ((pktdata = get_next_packet(ctx, pcap, &pkthdr, idx, prev_packet)) != NULL) {
+    while (1) {
+        if (ring != NULL) {
+            pktdata = pktring_peek(ring, &pkthdr, &cookie);
+            sp = (sendpacket_t *)cookie;
+        } else {
+            pktdata = read_packet(&rd, &pkthdr, &sp);
+        }
+
+        if (pktdata == NULL)
+            break;
+
         /* die? */
-        if (ctx->abort)
-            return;
+        if (ctx->abort) {
+            complete = false;
+            break;
+        }
 
         /* stop sending based on the limit -L? */
         packetnum = ctx->stats.pkts_sent + 1;
-        if (ctx->options->limit_send > 0 && packetnum > ctx->options->limit_send)
-            return;
+        if (ctx->options->limit_send > 0) {
+            /* workers have to reserve their packet against the shared limit */
+            if ((ctx->budget != NULL ? __sync_add_and_fetch(&ctx->budget->pkts_reserved, 1) :
+                        packetnum) > ctx->options->limit_send) {
+                complete = false;
+                break;
+            }
+        }
 
 #if defined TCPREPLAY || defined TCPREPLAY_EDIT
         /* do we use the snaplen (caplen) or the "actual" packet len? */
-        pktlen = ctx->options->use_pkthdr_len ? pkthdr.len : pkthdr.caplen;
+        pktlen = ctx->options->use_pkthdr_len ? pkthdr->len : pkthdr->caplen;
 #elif TCPBRIDGE
-        pktlen = pkthdr.caplen;
+        pktlen = pkthdr->caplen;
 #else
 #error WTF???  We should not be here!
 #endif
 
         dbgx(2, "packet " COUNTER_SPEC " caplen %d", packetnum, pktlen);
 
-        /* Dual nic processing */
-        if (ctx->intf2 != NULL) {
-
-            sp = (sendpacket_t *) cache_mode(ctx, ctx->options->cachedata, packetnum);
-
-            /* sometimes we should not send the packet */
-            if (sp == TCPR_DIR_NOSEND)
-                continue;
-        }
-
-#if defined TCPREPLAY && defined TCPREPLAY_EDIT
-        pkthdr_ptr = &pkthdr;
-        if (tcpedit_packet(tcpedit, &pkthdr_ptr, &pktdata, sp->cache_dir) == -1) {
-            errx(-1, "Error editing packet #" COUNTER_SPEC ": %s", packetnum, tcpedit_geterr(tcpedit));
-        }
-        pktlen = ctx->options->use_pkthdr_len ? pkthdr_ptr->len : pkthdr_ptr->caplen;
-#endif
-
-        /* do we need to print the packet via tcpdump? */
-#ifdef ENABLE_VERBOSE
-        if (ctx->options->verbose)
-            tcpdump_print(ctx->options->tcpdump, &pkthdr, pktdata);
-#endif
-
         /*
          * we have to cast the ts, since OpenBSD sucks
          * had to be special and use bpf_timeval.
          * Only sleep if we're not in top speed mode (-t)
          */
+#ifdef HAVE_CLOCK_GETTIME
+        if (schedule != NULL) {
+            /* read_packet() has already moved cache_pos past this packet */
+            schedule_wait(ctx, schedule[rd.cache_pos - 1], &schedule_start);
+        } else
+#endif
         if (ctx->options->speed.mode != speed_topspeed &&
         		!(ctx->options->speed.mode == speed_mbpsrate && !ctx->options->speed.speed)) {
-            do_sleep(ctx, (struct timeval *)&pkthdr.ts, &last, pktlen, 
+            do_sleep(ctx, (struct timeval *)&pkthdr->ts, &last, pktlen, 
                     ctx->options->accurate, sp, packetnum, &delta_ctx,
                     &skip_timestamp);
 
-            if (!skip_timestamp)
+            if (!skip_timestamp && ctx->options->accurate != accurate_deadline)
                 /* mark the time when we send the last packet */
                 start_delta_time(&delta_ctx);
         }
 
         dbgx(2, "Sending packet #" COUNTER_SPEC, packetnum);
 
-        /* write packet out on network */
-        if (sendpacket(sp, pktdata, pktlen) < (int)pktlen)
+        /* write packet out on network, or queue it up for the next burst */
+        if (burst.max > 1) {
+            burst_queue(&burst, sp, pktdata, pktlen);
+        } else if (sendpacket(sp, pktdata, pktlen) < (int)pktlen) {
             warnx("Unable to send packet: %s", sendpacket_geterr(sp));
+        }
 
         /*
          * track the time of the "last packet sent".  Again, because of OpenBSD
@@ -204,13 +606,22 @@ send_packets(tcpreplay_t *ctx, pcap_t *pcap, int idx)
          * A number of 3rd party tools generate bad timestamps which go backwards
          * in time.  Hence, don't update the "last" unless pkthdr.ts > last
          */
-        if (timercmp(&last, &pkthdr.ts, <))
-            memcpy(&last, &pkthdr.ts, sizeof(struct timeval));
+        if (timercmp(&last, &pkthdr->ts, <))
+            memcpy(&last, &pkthdr->ts, sizeof(struct timeval));
         ctx->stats.pkts_sent ++;
         ctx->stats.bytes_sent += pktlen;
 
-        /* print stats during the run? */
-        if (ctx->options->stats > 0) {
+        /* burst_queue() copied the packet, so the ring slot can be reused */
+        if (ring != NULL)
+            pktring_release(ring);
+
+        if (ctx->budget != NULL) {
+            __sync_fetch_and_add(&ctx->budget->pkts_sent, 1);
+            __sync_fetch_and_add(&ctx->budget->bytes_sent, pktlen);
+        }
+
+        /* print stats during the run?  (workers leave this to the main thread) */
+        if (ctx->options->stats > 0 && ctx->parent == NULL) {
             if (gettimeofday(&ctx->stats.end_time, NULL) < 0)
                 errx(-1, "gettimeofday() failed: %s",  strerror(errno));
 
@@ -219,14 +630,37 @@ send_packets(tcpreplay_t *ctx, pcap_t *pcap, int idx)
             } else {
                 timersub(&ctx->stats.end_time, &last_print_time, &print_delta);
                 if (print_delta.tv_sec >= ctx->options->stats) {
+#ifdef HAVE_PTHREAD
+                    memcpy(&stats, &ctx->stats, sizeof(stats));
+                    if (ring != NULL)
+                        pipeline_stats(&stats, ring);
+                    packet_stats(&stats);
+#else
                     packet_stats(&ctx->stats);
+#endif
                     memcpy(&last_print_time, &ctx->stats.end_time, sizeof(struct timeval));
                 }
             }
         }
     } /* while */
 
-    if (ctx->options->enable_file_cache) {
+    burst_flush(&burst);
+
+#ifdef HAVE_PTHREAD
+    if (ring != NULL) {
+        /* stop the reader if we bailed out early */
+        pktring_abort(ring);
+        pthread_join(reader, NULL);
+        pipeline_stats(&ctx->stats, ring);
+        pktring_close(ring);
+    }
+#endif
+
+#if defined TCPREPLAY && defined TCPREPLAY_EDIT
+    safe_free(rd.editbuf);
+#endif
+
+    if (complete && ctx->options->enable_file_cache) {
         ctx->options->file_cache[idx].cached = TRUE;
     }
 }
@@ -236,7 +670,7 @@ send_packets(tcpreplay_t *ctx, pcap_t *pcap, int idx)
  * what to do with each packet when processing two files a the same time
  */
 void 
-send_dual_packets(tcpreplay_t *ctx, pcap_t *pcap1, int idx1, pcap_t *pcap2, int idx2)
+send_dual_packets(tcpreplay_t *ctx, mmpcap_t *pcap1, int idx1, mmpcap_t *pcap2, int idx2)
 {
     struct timeval last = { 0, 0 }, last_print_time = { 0, 0 }, print_delta;
     COUNTER packetnum = 0;
@@ -244,27 +678,27 @@ send_dual_packets(tcpreplay_t *ctx, pcap_t *pcap1, int idx1, pcap_t *pcap2, int
     const u_char *pktdata1 = NULL, *pktdata2 = NULL, *pktdata = NULL;
     sendpacket_t *sp = ctx->intf1;
     u_int32_t pktlen;
-    packet_cache_t *cached_packet1 = NULL, *cached_packet2 = NULL;
-    packet_cache_t **prev_packet1 = NULL, **prev_packet2 = NULL, **prev_packet = NULL;
+    COUNTER cache_pos1 = 0, cache_pos2 = 0;
+    COUNTER *cache_ptr1 = NULL, *cache_ptr2 = NULL;
+#if defined TCPREPLAY && defined TCPREPLAY_EDIT
+    u_char editbuf[MAXPACKET];
+#endif
     delta_t delta_ctx;
     /* ???? */
-    int idx;
-    pcap_t *pcap;
     bool skip_timestamp = false;
+    send_burst_t burst;
 
     init_delta_time(&delta_ctx);
+    burst_init(ctx, &burst);
 
     if (ctx->options->enable_file_cache) {
-        prev_packet1 = &cached_packet1;
-        prev_packet2 = &cached_packet2;
-    } else {
-        prev_packet1 = NULL;
-        prev_packet2 = NULL;
+        cache_ptr1 = &cache_pos1;
+        cache_ptr2 = &cache_pos2;
     }
 
 
-    pktdata1 = get_next_packet(ctx, pcap1, &pkthdr1, idx1, prev_packet1);
-    pktdata2 = get_next_packet(ctx, pcap2, &pkthdr2, idx2, prev_packet2);
+    pktdata1 = get_next_packet(ctx, pcap1, &pkthdr1, idx1, cache_ptr1);
+    pktdata2 = get_next_packet(ctx, pcap2, &pkthdr2, idx2, cache_ptr2);
 
     /* MAIN LOOP 
      * Keep sending while we have packets or until
@@ -277,8 +711,10 @@ send_dual_packets(tcpreplay_t *ctx, pcap_t *pcap1, int idx1, pcap_t *pcap2, int
 
         /* stop sending based on the limit -L? */
         packetnum = ctx->stats.pkts_sent + 1;
-        if (ctx->options->limit_send > 0 && packetnum > ctx->options->limit_send)
+        if (ctx->options->limit_send > 0 && packetnum > ctx->options->limit_send) {
+            burst_flush(&burst);
             return;
+        }
 
         /* figure out which pcap file we need to process next 
          * when get_next_packet() returns null for pktdata, the pkthdr 
@@ -289,34 +725,22 @@ send_dual_packets(tcpreplay_t *ctx, pcap_t *pcap1, int idx1, pcap_t *pcap2, int
         if (pktdata1 == NULL) {
             /* file 2 is next */
             sp = ctx->intf2;
-            pcap = pcap2;
             pkthdr_ptr = &pkthdr2;
-            prev_packet = prev_packet2;
-            idx = idx2;
             pktdata = pktdata2;
         } else if (pktdata2 == NULL) {
             /* file 1 is next */
             sp = ctx->intf1;
-            pcap = pcap1;
             pkthdr_ptr = &pkthdr1;
-            prev_packet = prev_packet1;
-            idx = idx1;
             pktdata = pktdata1;
         } else if (timercmp(&pkthdr1.ts, &pkthdr2.ts, <=)) {
             /* file 1 is next */
             sp = ctx->intf1;
-            pcap = pcap1;
             pkthdr_ptr = &pkthdr1;
-            prev_packet = prev_packet1;
-            idx = idx1;
             pktdata = pktdata1;
         } else {
             /* file 2 is next */
             sp = ctx->intf2;
-            pcap = pcap2;
             pkthdr_ptr = &pkthdr2;
-            prev_packet = prev_packet2;
-            idx = idx2;
             pktdata = pktdata2;
         }
 
@@ -334,9 +758,7 @@ send_dual_packets(tcpreplay_t *ctx, pcap_t *pcap1, int idx1, pcap_t *pcap2, int
 
 
 #if defined TCPREPLAY && defined TCPREPLAY_EDIT
-        if (tcpedit_packet(tcpedit, &pkthdr_ptr, &pktdata, sp->cache_dir) == -1) {
-            errx(-1, "Error editing packet #" COUNTER_SPEC ": %s", packetnum, tcpedit_geterr(tcpedit));
-        }
+        pktdata = edit_packet_copy(&pkthdr_ptr, pktdata, editbuf, sp->cache_dir, packetnum);
         pktlen = ctx->options->use_pkthdr_len ? pkthdr_ptr->len : pkthdr_ptr->caplen;
 #endif
 
@@ -356,16 +778,19 @@ send_dual_packets(tcpreplay_t *ctx, pcap_t *pcap1, int idx1, pcap_t *pcap2, int
             do_sleep(ctx, (struct timeval *)&pkthdr_ptr->ts, &last, pktlen,
                     ctx->options->accurate, sp, packetnum, &delta_ctx, &skip_timestamp);
 
-            if (!skip_timestamp)
+            if (!skip_timestamp && ctx->options->accurate != accurate_deadline)
                 /* mark the time when we send the last packet */
                 start_delta_time(&delta_ctx);
         }
 
         dbgx(2, "Sending packet #" COUNTER_SPEC, packetnum);
 
-        /* write packet out on network */
-        if (sendpacket(sp, pktdata, pktlen) < (int)pktlen)
+        /* write packet out on network, or queue it up for the next burst */
+        if (burst.max > 1) {
+            burst_queue(&burst, sp, pktdata, pktlen);
+        } else if (sendpacket(sp, pktdata, pktlen) < (int)pktlen) {
             warnx("Unable to send packet: %s", sendpacket_geterr(sp));
+        }
 
         /*
          * track the time of the "last packet sent".  Again, because of OpenBSD
@@ -397,12 +822,14 @@ send_dual_packets(tcpreplay_t *ctx, pcap_t *pcap1, int idx1, pcap_t *pcap2, int
 
         /* get the next packet for this file handle depending on which we last used */
         if (sp == ctx->intf2) {
-            pktdata2 = get_next_packet(ctx, pcap2, &pkthdr2, idx2, prev_packet2);
+            pktdata2 = get_next_packet(ctx, pcap2, &pkthdr2, idx2, cache_ptr2);
         } else {
-            pktdata1 = get_next_packet(ctx, pcap1, &pkthdr1, idx1, prev_packet1);
+            pktdata1 = get_next_packet(ctx, pcap1, &pkthdr1, idx1, cache_ptr1);
         }
     } /* while */
 
+    burst_flush(&burst);
+
     if (ctx->options->enable_file_cache) {
         ctx->options->file_cache[idx1].cached = TRUE;
         ctx->options->file_cache[idx2].cached = TRUE;
@@ -411,84 +838,243 @@ send_dual_packets(tcpreplay_t *ctx, pcap_t *pcap1, int idx1, pcap_t *pcap2, int
 
 
 
+#if defined HAVE_MMAP && defined MAP_HUGETLB
+/**
+ * Returns the default huge page size from /proc/meminfo, or 2MB if it
+ * can't be read
+ */
+static size_t
+hugepage_size(void)
+{
+    static size_t hpsize = 0;
+    char line[128];
+    unsigned long kb;
+    FILE *fp;
+
+    if (hpsize > 0)
+        return hpsize;
+
+    hpsize = 2 * 1024 * 1024;
+    if ((fp = fopen("/proc/meminfo", "r")) != NULL) {
+        while (fgets(line, sizeof(line), fp) != NULL) {
+            if (sscanf(line, "Hugepagesize: %lu kB", &kb) == 1 && kb > 0) {
+                hpsize = (size_t)kb * 1024;
+                break;
+            }
+        }
+        fclose(fp);
+    }
+
+    return hpsize;
+}
+#endif
+
+/**
+ * Allocates *size bytes for a file cache arena.  Big arenas are mmap()'d so
+ * they can be backed by huge pages if the user asked for them.  Huge page
+ * mappings are rounded up to a whole number of huge pages and *size is
+ * updated to match, since that's the length munmap() needs.
+ */
+static u_char *
+file_cache_alloc(tcpreplay_t *ctx, size_t *size, bool *mapped)
+{
+#ifdef HAVE_MMAP
+    void *arena;
+
+    if (ctx->options->cache_hugepages) {
+#ifdef MAP_HUGETLB
+        size_t hpsize = hugepage_size();
+        size_t hplen = (*size + hpsize - 1) & ~(hpsize - 1);
+
+        arena = mmap(NULL, hplen, PROT_READ|PROT_WRITE,
+                MAP_PRIVATE|MAP_ANONYMOUS|MAP_HUGETLB, -1, 0);
+        if (arena != MAP_FAILED) {
+            *size = hplen;
+            *mapped = true;
+            return (u_char *)arena;
+        }
+        dbgx(1, "Unable to allocate %zu bytes of huge pages: %s", hplen, strerror(errno));
+#endif
+        arena = mmap(NULL, *size, PROT_READ|PROT_WRITE,
+                MAP_PRIVATE|MAP_ANONYMOUS, -1, 0);
+        if (arena == MAP_FAILED)
+            errx(-1, "Unable to mmap() %zu bytes for the file cache: %s",
+                    *size, strerror(errno));
+#if defined HAVE_MADVISE && defined MADV_HUGEPAGE
+        if (madvise(arena, *size, MADV_HUGEPAGE) < 0)
+            dbgx(1, "madvise(MADV_HUGEPAGE) failed: %s", strerror(errno));
+#endif
+        *mapped = true;
+        return (u_char *)arena;
+    }
+#endif
+
+    *mapped = false;
+    return (u_char *)safe_malloc(*size);
+}
+
+/**
+ * Frees an arena from file_cache_alloc(), size must be the length it
+ * returned
+ */
+static void
+file_cache_release(u_char *arena, size_t size, bool mapped)
+{
+    if (arena == NULL)
+        return;
+
+#ifdef HAVE_MMAP
+    if (mapped) {
+        munmap(arena, size);
+        return;
+    }
+#endif
+    safe_free(arena);
+}
+
+/**
+ * \brief Free the packet arena & index of a file cache
+ */
+void
+free_file_cache(file_cache_t *cache)
+{
+    assert(cache);
+
+    file_cache_release(cache->arena, cache->arena_size, cache->arena_mapped);
+    safe_free(cache->offsets);
+    safe_free(cache->schedule);
+    cache->arena = NULL;
+    cache->offsets = NULL;
+    cache->schedule = NULL;
+    cache->arena_len = cache->arena_size = 0;
+    cache->offsets_size = cache->pkt_cnt = 0;
+    cache->cached = FALSE;
+    cache->edited = false;
+}
+
+/**
+ * Appends a packet to the end of the file cache arena, growing the arena and
+ * the offset index as needed.  The first allocation is sized off the pcap
+ * file so most files never need to be copied.  Only caplen bytes are stored
+ * since that's all libpcap gives us.
+ */
+static void
+file_cache_append(tcpreplay_t *ctx, file_cache_t *cache,
+        const struct pcap_pkthdr *pkthdr, const u_char *pktdata)
+{
+    packet_cache_t *rec;
+    size_t reclen, need, newsize;
+    u_char *arena;
+    bool mapped;
+    struct stat statbuf;
+
+    reclen = (sizeof(packet_cache_t) + pkthdr->caplen + PACKET_CACHE_ALIGN - 1) &
+            ~((size_t)PACKET_CACHE_ALIGN - 1);
+
+    /*
+     * leave MAXPACKET bytes of slack after the last record so sending with
+     * --pktlen never reads past the end of the arena
+     */
+    need = cache->arena_len + reclen + MAXPACKET;
+    if (need > cache->arena_size) {
+        newsize = cache->arena_size * 2;
+        if (newsize == 0) {
+            newsize = 1024 * 1024;
+            if (stat(ctx->options->sources[cache->index].filename, &statbuf) == 0 &&
+                    S_ISREG(statbuf.st_mode))
+                newsize += (size_t)statbuf.st_size + (size_t)statbuf.st_size / 2;
+        }
+        while (newsize < need)
+            newsize *= 2;
+
+        dbgx(1, "Growing file cache %d arena to %zu bytes", cache->index, newsize);
+        arena = file_cache_alloc(ctx, &newsize, &mapped);
+        if (cache->arena != NULL)
+            memcpy(arena, cache->arena, cache->arena_len);
+        file_cache_release(cache->arena, cache->arena_size, cache->arena_mapped);
+        cache->arena = arena;
+        cache->arena_size = newsize;
+        cache->arena_mapped = mapped;
+    }
+
+    if (cache->pkt_cnt == cache->offsets_size) {
+        cache->offsets_size = cache->offsets_size ? cache->offsets_size * 2 : 4096;
+        cache->offsets = (size_t *)safe_realloc(cache->offsets,
+                cache->offsets_size * sizeof(size_t));
+    }
+
+    rec = (packet_cache_t *)(cache->arena + cache->arena_len);
+    memcpy(&rec->pkthdr, pkthdr, sizeof(struct pcap_pkthdr));
+    memcpy(rec->pktdata, pktdata, pkthdr->caplen);
+
+    cache->offsets[cache->pkt_cnt++] = cache->arena_len;
+    cache->arena_len += reclen;
+}
+
 /**
  * Gets the next packet to be sent out. This will either read from the pcap file
  * or will retrieve the packet from the internal cache.
  *
- * The parameter prev_packet is used as the parent of the new entry in the cache list.
- * This should be NULL on the first call to this function for each file and
- * will be updated as new entries are added (or retrieved) from the cache list.
+ * cache_pos is the index of the next packet in the file cache and should
+ * point to 0 on the first call for each file.  Pass NULL to bypass the
+ * cache entirely.
  */
 const u_char *
-get_next_packet(tcpreplay_t *ctx, pcap_t *pcap, struct pcap_pkthdr *pkthdr, int idx, 
-    packet_cache_t **prev_packet)
+get_next_packet(tcpreplay_t *ctx, mmpcap_t *pcap, struct pcap_pkthdr *pkthdr, int idx, 
+    COUNTER *cache_pos)
 {
     u_char *pktdata = NULL;
-    u_int32_t pktlen;
+    file_cache_t *cache;
+    packet_cache_t *rec;
 
     /* pcap may be null in cache mode! */
-    /* packet_cache_t may be null in file read mode! */
+    /* cache_pos may be null in file read mode! */
     assert(pkthdr);
 
     /*
      * Check if we're caching files
      */
-    if (ctx->options->enable_file_cache && (prev_packet != NULL)) {
+    if (ctx->options->enable_file_cache && (cache_pos != NULL)) {
+        cache = &ctx->options->file_cache[idx];
+
         /*
          * Yes we are caching files - has this one been cached?
          */
-        if (ctx->options->file_cache[idx].cached) {
-            if (*prev_packet == NULL) {
-                /*
-                 * Get the first packet in the cache list directly from the file
-                 */
-                *prev_packet = ctx->options->file_cache[idx].packet_cache;
-            } else {
-                /*
-                 * Get the next packet in the cache list
-                 */
-                *prev_packet = (*prev_packet)->next;
-            }
+        if (cache->cached) {
+            if (*cache_pos < cache->pkt_cnt) {
+                rec = (packet_cache_t *)(cache->arena + cache->offsets[*cache_pos]);
+
+                /* records are sequential, so pull in the ones we'll want next */
+                if (*cache_pos + 2 < cache->pkt_cnt) {
+                    __builtin_prefetch(cache->arena + cache->offsets[*cache_pos + 1]);
+                    __builtin_prefetch(cache->arena + cache->offsets[*cache_pos + 2]);
+                }
 
-            if (*prev_packet != NULL) {
-                pktdata = (*prev_packet)->pktdata;
-                memcpy(pkthdr, &((*prev_packet)->pkthdr), sizeof(struct pcap_pkthdr));
+                (*cache_pos)++;
+                pktdata = rec->pktdata;
+                memcpy(pkthdr, &rec->pkthdr, sizeof(struct pcap_pkthdr));
             }
         } else {
             /*
-             * We should read the pcap file, and cache the results
+             * We should read the pcap file, and cache the results.  If a
+             * previous pass was interrupted, start the cache over.
              */
-            pktdata = (u_char *)pcap_next(pcap, pkthdr);
-            if (pktdata != NULL) {
-                if (*prev_packet == NULL) {
-                    /*
-                     * Create the first packet in the list
-                     */
-                    *prev_packet = safe_malloc(sizeof(packet_cache_t));
-                    ctx->options->file_cache[idx].packet_cache = *prev_packet;
-                } else {
-                    /*
-                     * Add a packet to the end of the list
-                     */
-                    (*prev_packet)->next = safe_malloc(sizeof(packet_cache_t));
-                    *prev_packet = (*prev_packet)->next;
-                }
-
-                if (*prev_packet != NULL) {
-                    (*prev_packet)->next = NULL;
-                    pktlen = pkthdr->len;
+            if (*cache_pos == 0) {
+                cache->arena_len = 0;
+                cache->pkt_cnt = 0;
+            }
 
-                    (*prev_packet)->pktdata = safe_malloc(pktlen);
-                    memcpy((*prev_packet)->pktdata, pktdata, pktlen);
-                    memcpy(&((*prev_packet)->pkthdr), pkthdr, sizeof(struct pcap_pkthdr));
-                }
+            pktdata = (u_char *)mmpcap_next(pcap, pkthdr);
+            if (pktdata != NULL) {
+                file_cache_append(ctx, cache, pkthdr, pktdata);
+                (*cache_pos)++;
             }
         }
     } else {
         /*
          * Read pcap file as normal
          */
-        pktdata = (u_char *)pcap_next(pcap, pkthdr);
+        pktdata = (u_char *)mmpcap_next(pcap, pkthdr);
     }
 
     /* this get's casted to a const on the way out */
@@ -496,23 +1082,46 @@ get_next_packet(tcpreplay_t *ctx, pcap_t *pcap, struct pcap_pkthdr *pkthdr, int
 }
 
 /**
- * determines based upon the cachedata which interface the given packet 
- * should go out.  Also rewrites any layer 2 data we might need to adjust.
- * Returns a void cased pointer to the ctx->intfX of the corresponding 
- * interface or NULL on error
+ * returns the tcpprep cache direction of a packet.  The cache is expanded
+ * CACHE_DECODE_BLOCK packets at a time into rd->dirs, so most packets are
+ * a single array lookup.  Returns TCPR_DIR_ERROR past the end of the cache.
+ */
+static tcpr_dir_t
+cache_lookup(packet_reader_t *rd, COUNTER packetnum)
+{
+    tcpr_cache_map_t *cache = &rd->ctx->options->cache;
+
+    if (packetnum - rd->dirs_first >= rd->dirs_cnt) {
+        if (packetnum == 0 || packetnum > cache->packets)
+            return TCPR_DIR_ERROR;
+
+        rd->dirs_first = ((packetnum - 1) & ~(COUNTER)(CACHE_DECODE_BLOCK - 1)) + 1;
+        rd->dirs_cnt = cache->packets - rd->dirs_first + 1;
+        if (rd->dirs_cnt > CACHE_DECODE_BLOCK)
+            rd->dirs_cnt = CACHE_DECODE_BLOCK;
+
+        decode_cache(cache->data, rd->dirs_first, rd->dirs_cnt, rd->dirs);
+    }
+
+    return (tcpr_dir_t)rd->dirs[packetnum - rd->dirs_first];
+}
+
+/**
+ * determines based upon the cache direction (see cache_lookup()) which
+ * interface the given packet should go out.  Also rewrites any layer 2
+ * data we might need to adjust.  Returns a void cased pointer to the
+ * ctx->intfX of the corresponding interface or NULL on error
  */
 void *
-cache_mode(tcpreplay_t *ctx, char *cachedata, COUNTER packet_num)
+cache_mode(tcpreplay_t *ctx, tcpr_dir_t result, COUNTER packet_num)
 {
     void *sp = NULL;
-    int result;
 
-    if (packet_num > ctx->options->cache_packets) {
+    if (result == TCPR_DIR_ERROR) {
         tcpreplay_seterr(ctx, "%s", "Exceeded number of packets in cache file.");
         return NULL;
     }
 
-    result = check_cache(cachedata, packet_num);
     if (result == TCPR_DIR_NOSEND) {
         dbgx(2, "Cache: Not sending packet " COUNTER_SPEC ".", packet_num);
         return TCPR_DIR_NOSEND;
@@ -534,6 +1143,161 @@ cache_mode(tcpreplay_t *ctx, char *cachedata, COUNTER packet_num)
 }
 
 
+/**
+ * Hashes the flow a packet belongs to so that --threads can split a single
+ * pcap between workers without reordering any connection.  The hash is
+ * symmetric (both directions of a flow land on the same worker) and only
+ * looks at IPv4/IPv6 addresses plus TCP/UDP ports.  Fragments are hashed
+ * on addresses alone since only the first one carries the ports.  Anything
+ * we can't parse goes to worker 0.
+ */
+static u_int32_t
+flow_hash(const u_char *pktdata, u_int32_t caplen, int dlt)
+{
+    const u_char *l3, *l4 = NULL;
+    u_int32_t hash = 0, word;
+    u_int16_t proto;
+    int l2len, i;
+    u_char nh = 0;
+
+    l2len = get_l2len(pktdata, caplen, dlt);
+    if (l2len < 0 || (u_int32_t)l2len >= caplen)
+        return 0;
+
+    proto = ntohs(get_l2protocol(pktdata, caplen, dlt));
+    l3 = pktdata + l2len;
+    caplen -= l2len;
+
+    if (proto == ETHERTYPE_IP && caplen >= sizeof(ipv4_hdr_t)) {
+        ipv4_hdr_t ip;
+
+        memcpy(&ip, l3, sizeof(ip));
+        hash = ip.ip_src.s_addr ^ ip.ip_dst.s_addr;
+        nh = ip.ip_p;
+        if ((ntohs(ip.ip_off) & (IP_MF | IP_OFFMASK)) == 0 &&
+                caplen >= (u_int32_t)(ip.ip_hl << 2) + 4)
+            l4 = l3 + (ip.ip_hl << 2);
+    } else if (proto == ETHERTYPE_IP6 && caplen >= sizeof(ipv6_hdr_t)) {
+        ipv6_hdr_t ip6;
+
+        memcpy(&ip6, l3, sizeof(ip6));
+        for (i = 0; i < 4; i++)
+            hash ^= ip6.ip_src.__u6_addr.__u6_addr32[i] ^ ip6.ip_dst.__u6_addr.__u6_addr32[i];
+        /* extension headers are rare enough that we don't chase them */
+        nh = ip6.ip_nh;
+        if (caplen >= sizeof(ipv6_hdr_t) + 4)
+            l4 = l3 + sizeof(ipv6_hdr_t);
+    } else {
+        return 0;
+    }
+
+    if (l4 != NULL && (nh == IPPROTO_TCP || nh == IPPROTO_UDP)) {
+        u_int16_t sport, dport;
+
+        memcpy(&sport, l4, 2);
+        memcpy(&dport, l4 + 2, 2);
+        hash ^= (u_int32_t)(sport ^ dport);
+    }
+
+    /* mix the bits so the modulo spreads evenly (murmur3 finalizer) */
+    word = hash ^ nh;
+    word ^= word >> 16;
+    word *= 0x85ebca6b;
+    word ^= word >> 13;
+    word *= 0xc2b2ae35;
+    word ^= word >> 16;
+
+    return word;
+}
+
+/**
+ * Figures out how many packets we can queue before flushing them to the
+ * network and sets up the burst queue.  Bursting is only possible when the
+ * timing model doesn't require sleeping between packets: top speed, or
+ * --pps-multi where each group goes out back to back.  In that case each
+ * burst is exactly one group so we never nap with packets still queued.
+ */
+static void
+burst_init(tcpreplay_t *ctx, send_burst_t *burst)
+{
+    tcpreplay_speed_t *speed = &ctx->options->speed;
+    int max = ctx->options->burst;
+
+    memset(burst, 0, sizeof(send_burst_t));
+
+    if (max > SENDPACKET_BURST_MAX)
+        max = SENDPACKET_BURST_MAX;
+
+    if (speed->mode == speed_topspeed ||
+            (speed->mode == speed_mbpsrate && !speed->speed)) {
+        burst->max = max;
+    } else if (speed->mode == speed_packetrate && speed->pps_multi > 1 &&
+            speed->pps_multi <= max) {
+        burst->max = speed->pps_multi;
+    } else {
+        burst->max = 1;
+    }
+
+    /*
+     * queued packets have to be copied since libpcap and tcpedit reuse their
+     * buffers.  The copy buffer lives as long as the context does.
+     */
+    if (burst->max > 1 && ctx->burst_buf == NULL)
+        ctx->burst_buf = (u_char *)safe_malloc(SENDPACKET_BURST_MAX * MAXPACKET);
+
+    burst->buf = ctx->burst_buf;
+    dbgx(1, "Sending packets in bursts of up to %d", burst->max);
+}
+
+/**
+ * Queues a packet to be sent out sp, flushing the queue when it is full
+ * or when the packet is for a different interface
+ */
+static void
+burst_queue(send_burst_t *burst, sendpacket_t *sp, const u_char *pktdata,
+        u_int32_t pktlen)
+{
+    u_char *slot;
+
+    /* each burst goes out a single interface */
+    if (burst->cnt > 0 && burst->sp != sp)
+        burst_flush(burst);
+
+    /* anything bigger then a slot is sent on it's own */
+    if (pktlen > MAXPACKET) {
+        burst_flush(burst);
+        if (sendpacket(sp, pktdata, pktlen) < (int)pktlen)
+            warnx("Unable to send packet: %s", sendpacket_geterr(sp));
+        return;
+    }
+
+    slot = burst->buf + (burst->cnt * MAXPACKET);
+    memcpy(slot, pktdata, pktlen);
+    burst->iov[burst->cnt].iov_base = slot;
+    burst->iov[burst->cnt].iov_len = pktlen;
+    burst->sp = sp;
+    burst->cnt ++;
+
+    if (burst->cnt >= burst->max)
+        burst_flush(burst);
+}
+
+/**
+ * Sends all the queued packets
+ */
+static void
+burst_flush(send_burst_t *burst)
+{
+    if (burst->cnt == 0)
+        return;
+
+    dbgx(2, "Flushing burst of %d packets", burst->cnt);
+    if (sendpacket_batch(burst->sp, burst->iov, burst->cnt) < burst->cnt)
+        warnx("Unable to send packet: %s", sendpacket_geterr(burst->sp));
+
+    burst->cnt = 0;
+}
+
 /**
  * Given the timestamp on the current packet and the last packet sent,
  * calculate the appropriate amount of time to sleep and do so.
@@ -543,18 +1307,11 @@ do_sleep(tcpreplay_t *ctx, struct timeval *time, struct timeval *last,
         int len, tcpreplay_accurate accurate, sendpacket_t *sp, 
         COUNTER counter, delta_t *delta_ctx, bool *skip_timestamp)
 {
-#ifdef DEBUG
-    static struct timeval totalsleep = { 0, 0 };
-#endif
     struct timespec adjuster = { 0, 0 };
-    static struct timespec nap = { 0, 0 }, delta_time = {0, 0};
-    struct timeval nap_for;
+    tcpreplay_sleep_t *state = &ctx->sleep;
     struct timespec nap_this_time;
-    static int32_t nsec_adjuster = -1, nsec_times = -1;
-    static u_int32_t send = 0;      /* accellerator.   # of packets to send w/o sleeping */
     u_int64_t ppnsec; /* packets per nsec */
-    static int first_time = 1;      /* need to track the first time through for the pps accelerator */
-    static COUNTER skip_length = 0;
+    COUNTER bytes_sent;
 
 
 #ifdef TCPREPLAY
@@ -564,24 +1321,31 @@ do_sleep(tcpreplay_t *ctx, struct timeval *time, struct timeval *last,
     adjuster.tv_nsec = 0;
 #endif
 
+#ifdef HAVE_CLOCK_GETTIME
+    if (accurate == accurate_deadline && ctx->options->speed.mode != speed_oneatatime) {
+        deadline_wait(ctx, time, last, len, counter);
+        return;
+    }
+#endif
+
     /*
      * this accelerator improves performance by avoiding expensive
      * time stamps during periods where we have fallen behind in our
      * sending
      */
     if (*skip_timestamp) {
-        if ((COUNTER)len < skip_length) {
-            skip_length -= len;
+        if ((COUNTER)len < state->skip_length) {
+            state->skip_length -= len;
             return;
         }
 
-        skip_length = 0;
+        state->skip_length = 0;
         *skip_timestamp = false;
     }
 
     /* accelerator time? */
-    if (send > 0) {
-        send --;
+    if (state->send > 0) {
+        state->send --;
         return;
     }
 
@@ -590,9 +1354,9 @@ do_sleep(tcpreplay_t *ctx, struct timeval *time, struct timeval *last,
      * and hence requires the funky math to get the expected timings.
      */
     if (ctx->options->speed.mode == speed_packetrate && ctx->options->speed.pps_multi) {
-        send = ctx->options->speed.pps_multi - 1;
-        if (first_time) {
-            first_time = 0;
+        state->send = ctx->options->speed.pps_multi - 1;
+        if (state->first_time) {
+            state->first_time = 0;
             return;
         }
     }
@@ -612,20 +1376,18 @@ do_sleep(tcpreplay_t *ctx, struct timeval *time, struct timeval *last,
             if (timercmp(time, last, <)) {
                 /* Packet has gone back in time!  Don't sleep and warn user */
                 warnx("Packet #" COUNTER_SPEC " has gone back in time!", counter);
-                timesclear(&nap); 
+                timesclear(&state->nap); 
             } else {
                 /* time has increased or is the same, so handle normally */
-                timersub(time, last, &nap_for);
-                dbgx(3, "original packet delta time: " TIMEVAL_FORMAT, nap_for.tv_sec, nap_for.tv_usec);
-
-                TIMEVAL_TO_TIMESPEC(&nap_for, &nap);
-                dbgx(3, "original packet delta timv: " TIMESPEC_FORMAT, nap.tv_sec, nap.tv_nsec);
-                timesdiv_float(&nap, ctx->options->speed.multiplier);
-                dbgx(3, "original packet delta/div: " TIMESPEC_FORMAT, nap.tv_sec, nap.tv_nsec);
+                /* pcap ts may be in nsec, so take the delta in nsec */
+                NANOSEC_TO_TIMESPEC(PKTHDR_TS_TO_NANOSEC(time) - PKTHDR_TS_TO_NANOSEC(last), &state->nap);
+                dbgx(3, "original packet delta timv: " TIMESPEC_FORMAT, state->nap.tv_sec, state->nap.tv_nsec);
+                timesdiv_float(&state->nap, ctx->options->speed.multiplier);
+                dbgx(3, "original packet delta/div: " TIMESPEC_FORMAT, state->nap.tv_sec, state->nap.tv_nsec);
             }
         } else {
             /* Don't sleep if this is our first packet */
-            timesclear(&nap);
+            timesclear(&state->nap);
         }
         break;
 
@@ -635,47 +1397,66 @@ do_sleep(tcpreplay_t *ctx, struct timeval *time, struct timeval *last,
          * a constant 'rate' (bytes per second).
          */
         if (timerisset(delta_ctx)) {
-            COUNTER next_tx_us = (ctx->stats.bytes_sent + len) * 8 * 1000000;
+            /* with --threads the rate applies to all the workers combined */
+            bytes_sent = ctx->budget != NULL ? ctx->budget->bytes_sent : ctx->stats.bytes_sent;
+            COUNTER next_tx_us = (bytes_sent + len) * 8 * 1000000;
             do_div(next_tx_us, ctx->options->speed.speed);  /* bits divided by Mbps = microseconds */
             COUNTER tx_us = TIMEVAL_TO_MICROSEC(delta_ctx) - TIMEVAL_TO_MICROSEC(&ctx->stats.start_time);
             COUNTER delta_us = (next_tx_us >= tx_us) ? next_tx_us - tx_us : 0;
             if (delta_us)
                 /* have to sleep */
-                NANOSEC_TO_TIMESPEC(delta_us * 1000, &nap);
+                NANOSEC_TO_TIMESPEC(delta_us * 1000, &state->nap);
             else {
                 /*
                  * calculate how many bytes we are behind and don't bother
                  * time stamping until we have caught up
                  */
-                timesclear(&nap);
-                skip_length = (tx_us - next_tx_us) * ctx->options->speed.speed;
-                do_div(skip_length, 8 * 1000000);
+                timesclear(&state->nap);
+                state->skip_length = (tx_us - next_tx_us) * ctx->options->speed.speed;
+                do_div(state->skip_length, 8 * 1000000);
                 *skip_timestamp = true;
             }
         }
-        dbgx(3, "packet size %d\t\tnap " TIMESPEC_FORMAT, len, nap.tv_sec, nap.tv_nsec);
+        dbgx(3, "packet size %d\t\tnap " TIMESPEC_FORMAT, len, state->nap.tv_sec, state->nap.tv_nsec);
         break;
 
     case speed_packetrate:
+        if (ctx->budget != NULL) {
+            /*
+             * with --threads the workers share the packet rate, so rather
+             * then sleeping a fixed interval, sleep until the aggregate
+             * schedule says the next packet is due
+             */
+            timesclear(&state->nap);
+            if (timerisset(delta_ctx)) {
+                COUNTER next_tx_us = (ctx->budget->pkts_sent + 1) * 1000000;
+                do_div(next_tx_us, ctx->options->speed.speed);
+                COUNTER tx_us = TIMEVAL_TO_MICROSEC(delta_ctx) - TIMEVAL_TO_MICROSEC(&ctx->stats.start_time);
+                if (next_tx_us > tx_us)
+                    NANOSEC_TO_TIMESPEC((next_tx_us - tx_us) * 1000, &state->nap);
+            }
+            break;
+        }
+
         /* only need to calculate this the first time */
-        if (! timesisset(&nap)) {
+        if (! timesisset(&state->nap)) {
             /* run in packets/sec */
             ppnsec = 1000000000 / ctx->options->speed.speed * (ctx->options->speed.pps_multi > 0 ? ctx->options->speed.pps_multi : 1);
-            NANOSEC_TO_TIMESPEC(ppnsec, &nap);
-            dbgx(1, "sending %d packet(s) per %lu nsec", (ctx->options->speed.pps_multi > 0 ? ctx->options->speed.pps_multi : 1), nap.tv_nsec);
+            NANOSEC_TO_TIMESPEC(ppnsec, &state->nap);
+            dbgx(1, "sending %d packet(s) per %lu nsec", (ctx->options->speed.pps_multi > 0 ? ctx->options->speed.pps_multi : 1), state->nap.tv_nsec);
         }
         break;
 
     case speed_oneatatime:
         /* do we skip prompting for a key press? */
-        if (send == 0) {
-            send = get_user_count(ctx, sp, counter);
+        if (state->send == 0) {
+            state->send = get_user_count(ctx, sp, counter);
         }
 
         /* decrement our send counter */
         printf("Sending packet " COUNTER_SPEC " out: %s\n", counter,
                sp == ctx->intf1 ? ctx->options->intf1_name : ctx->options->intf2_name);
-        send --;
+        state->send --;
 
         /* leave do_sleep() */
         return;
@@ -690,8 +1471,8 @@ do_sleep(tcpreplay_t *ctx, struct timeval *time, struct timeval *last,
     /* 
      * since we apply the adjuster to the sleep time, we can't modify nap
      */
-    nap_this_time.tv_sec = nap.tv_sec;
-    nap_this_time.tv_nsec = nap.tv_nsec;
+    nap_this_time.tv_sec = state->nap.tv_sec;
+    nap_this_time.tv_nsec = state->nap.tv_nsec;
 
     dbgx(2, "nap_time before rounding:   " TIMESPEC_FORMAT, nap_this_time.tv_sec, nap_this_time.tv_nsec);
 
@@ -704,26 +1485,37 @@ do_sleep(tcpreplay_t *ctx, struct timeval *time, struct timeval *last,
         switch (ctx->options->speed.mode) {
             /* Mbps & Multipler are dynamic timings, so we round to the nearest usec */
             case speed_mbpsrate:
-            case speed_multiplier:
                 ROUND_TIMESPEC_TO_MICROSEC(&nap_this_time);
                 break;
 
+            /* ...but nanosleep() can honour the sub-usec gaps of a nsec pcap */
+            case speed_multiplier:
+                if (accurate != accurate_nanosleep)
+                    ROUND_TIMESPEC_TO_MICROSEC(&nap_this_time);
+                break;
+
             /* Packets/sec is static, so we weight packets for .1usec accuracy */
             case speed_packetrate:
-                if (nsec_adjuster < 0)
-                    nsec_adjuster = (nap_this_time.tv_nsec % 10000) / 1000;
+                if (ctx->budget != NULL) {
+                    /* ...unless it's shared by --threads workers */
+                    ROUND_TIMESPEC_TO_MICROSEC(&nap_this_time);
+                    break;
+                }
+
+                if (state->nsec_adjuster < 0)
+                    state->nsec_adjuster = (nap_this_time.tv_nsec % 10000) / 1000;
 
                 /* update in the range of 0-9 */
-                nsec_times = (nsec_times + 1) % 10;
+                state->nsec_times = (state->nsec_times + 1) % 10;
 
-                if (nsec_times < nsec_adjuster) {
+                if (state->nsec_times < state->nsec_adjuster) {
                     /* sorta looks like a no-op, but gives us a nice round usec number */
                     nap_this_time.tv_nsec = (nap_this_time.tv_nsec / 1000 * 1000) + 1000;
                 } else {
                     nap_this_time.tv_nsec -= (nap_this_time.tv_nsec % 1000);
                 }
 
-                dbgx(3, "(%d)\tnsec_times = %d\tnap adjust: %lu -> %lu", nsec_adjuster, nsec_times, nap.tv_nsec, nap_this_time.tv_nsec);            
+                dbgx(3, "(%d)\tnsec_times = %d\tnap adjust: %lu -> %lu", state->nsec_adjuster, state->nsec_times, state->nap.tv_nsec, nap_this_time.tv_nsec);            
                 break;
 
             default:
@@ -736,16 +1528,16 @@ do_sleep(tcpreplay_t *ctx, struct timeval *time, struct timeval *last,
         return;
 
     dbgx(2, "nap_time before delta calc: " TIMESPEC_FORMAT, nap_this_time.tv_sec, nap_this_time.tv_nsec);
-    get_delta_time(delta_ctx, &delta_time);
-    dbgx(2, "delta:                      " TIMESPEC_FORMAT, delta_time.tv_sec, delta_time.tv_nsec);
+    get_delta_time(delta_ctx, &state->delta_time);
+    dbgx(2, "delta:                      " TIMESPEC_FORMAT, state->delta_time.tv_sec, state->delta_time.tv_nsec);
 
-    if (timesisset(&delta_time)) {
-        if (timescmp(&nap_this_time, &delta_time, >)) {
-            timessub(&nap_this_time, &delta_time, &nap_this_time);
-            dbgx(3, "timesub: %lu %lu", delta_time.tv_sec, delta_time.tv_nsec);
+    if (timesisset(&state->delta_time)) {
+        if (timescmp(&nap_this_time, &state->delta_time, >)) {
+            timessub(&nap_this_time, &state->delta_time, &nap_this_time);
+            dbgx(3, "timesub: %lu %lu", state->delta_time.tv_sec, state->delta_time.tv_nsec);
         } else { 
             timesclear(&nap_this_time);
-            dbgx(3, "timesclear: " TIMESPEC_FORMAT, delta_time.tv_sec, delta_time.tv_nsec);
+            dbgx(3, "timesclear: " TIMESPEC_FORMAT, state->delta_time.tv_sec, state->delta_time.tv_nsec);
         }
     }
 
@@ -801,13 +1593,225 @@ do_sleep(tcpreplay_t *ctx, struct timeval *time, struct timeval *last,
         errx(-1, "Unknown timer mode %d", accurate);
     }
 
-#ifdef DEBUG
-    dbgx(4, "Total sleep time: " TIMEVAL_FORMAT, totalsleep.tv_sec, totalsleep.tv_usec);
+    dbgx(2, "sleep delta: " TIMESPEC_FORMAT, state->delta_time.tv_sec, state->delta_time.tv_nsec);
+
+}
+
+#ifdef HAVE_CLOCK_GETTIME
+/**
+ * accurate_deadline: rather then napping for the gap since the last packet
+ * (where every oversleep adds up over a long run) work out when this packet
+ * is due, in nsec since the start of the run, and sleep until then.
+ * Records how late we actually were in the jitter histogram.
+ */
+static void
+deadline_wait(tcpreplay_t *ctx, const struct timeval *time,
+        const struct timeval *last, int len, COUNTER counter)
+{
+    tcpreplay_sleep_t *state = &ctx->sleep;
+    tcpreplay_speed_t *speed = &ctx->options->speed;
+    u_int64_t now, deadline, accel;
+    COUNTER pkts, bytes, group;
+    u_int64_t pkt_delta;
+
+    now = get_monotonic_ns();
+
+    /* with --threads the rate applies to all the workers combined */
+    pkts = ctx->budget != NULL ? ctx->budget->pkts_sent : ctx->stats.pkts_sent;
+    bytes = ctx->budget != NULL ? ctx->budget->bytes_sent : ctx->stats.bytes_sent;
+
+    if (state->start_ns == 0) {
+        state->start_ns = now;
+        state->start_pkts = pkts;
+        state->start_bytes = bytes;
+    }
+
+    pkts -= state->start_pkts;
+    bytes -= state->start_bytes;
+
+    switch (speed->mode) {
+    case speed_multiplier:
+        /* the first packet of each file restarts the schedule */
+        if (!timerisset(last)) {
+            state->base_ns = now;
+            memcpy(&state->base_ts, time, sizeof(struct timeval));
+            return;
+        }
+
+        if (timercmp(time, last, <))
+            warnx("Packet #" COUNTER_SPEC " has gone back in time!", counter);
+
+        if (timercmp(time, &state->base_ts, <)) {
+            deadline = now;
+        } else {
+            pkt_delta = PKTHDR_TS_TO_NANOSEC(time) - PKTHDR_TS_TO_NANOSEC(&state->base_ts);
+            deadline = state->base_ns + (u_int64_t)((double)pkt_delta / speed->multiplier);
+        }
+        break;
+
+    case speed_mbpsrate:
+        /* each packet is due once all of the previous bytes would be on the wire */
+        deadline = state->start_ns + (u_int64_t)((double)bytes * 8 * 1000000000 / (double)speed->speed);
+        break;
+
+    case speed_packetrate:
+        /* --pps-multi sends each group of packets back to back */
+        group = speed->pps_multi > 0 ? speed->pps_multi : 1;
+        pkts -= pkts % group;
+        deadline = state->start_ns + (u_int64_t)((double)pkts * 1000000000 / (double)speed->speed);
+        break;
+
+    default:
+        errx(-1, "Unknown/supported speed mode: %d", speed->mode);
+        break;
+    }
+
+    /* --sleep-accel */
+    accel = (u_int64_t)ctx->options->sleep_accel * 1000;
+    deadline = deadline > accel ? deadline - accel : 0;
+
+    dbgx(3, "packet " COUNTER_SPEC " len %d due in %lld nsec", counter, len,
+            (long long)deadline - (long long)now);
+
+    if (deadline > now)
+        now = deadline_sleep(deadline, ctx->options->spin_threshold);
+
+    add_jitter_stats(&ctx->stats, now > deadline ? now - deadline : 0);
+}
+
+/**
+ * Returns the transmit schedule of a cached file: for every record, how many
+ * nsec after the first packet it is due at the current speed.  Building it
+ * once means looped replays of the cache skip all the per-packet time math
+ * in do_sleep() and every loop is timed exactly like the first.  The
+ * schedule is built the first time it's needed and rebuilt if the speed
+ * settings change.
+ *
+ * Returns NULL if the file isn't cached yet or the replay needs more then
+ * a fixed schedule: a different timer, a per-packet decision (-o), the
+ * shared --threads budget or the --pipeline ring (which hides the cache
+ * position).  With a tcpprep cache (or tcpreplay-edit caching unedited
+ * packets) the rate modes also depend on which packets are sent & how big
+ * they are after editing, so only --multiplier is precomputed.
+ */
+static const u_int64_t *
+file_cache_schedule(tcpreplay_t *ctx, int idx)
+{
+    tcpreplay_opt_t *options = ctx->options;
+    tcpreplay_speed_t *speed = &options->speed;
+    file_cache_t *cache = &options->file_cache[idx];
+    const struct pcap_pkthdr *pkthdr;
+    u_int64_t first_ts = 0, ts, due, bytes = 0;
+    COUNTER i, group;
+
+    if (!options->enable_file_cache || !cache->cached || cache->pkt_cnt == 0)
+        return NULL;
+
+    if (options->accurate != accurate_deadline || ctx->budget != NULL)
+        return NULL;
+
+#ifdef HAVE_PTHREAD
+    if (options->pipeline)
+        return NULL;
 #endif
 
-    dbgx(2, "sleep delta: " TIMESPEC_FORMAT, delta_time.tv_sec, delta_time.tv_nsec);
+    switch (speed->mode) {
+    case speed_multiplier:
+        break;
+
+    case speed_mbpsrate:
+        if (speed->speed == 0)
+            return NULL;
+#ifdef TCPREPLAY_EDIT
+        if (!cache->edited)
+            return NULL;
+#endif
+        /* fall through */
+
+    case speed_packetrate:
+        if (ctx->intf2 != NULL)
+            return NULL;
+        break;
+
+    default:
+        return NULL;
+    }
+
+    if (cache->schedule != NULL) {
+        if (memcmp(&cache->schedule_speed, speed, sizeof(tcpreplay_speed_t)) == 0)
+            return cache->schedule;
+
+        safe_free(cache->schedule);
+    }
+
+    dbgx(1, "Building transmit schedule for " COUNTER_SPEC " cached packets of file %d",
+            cache->pkt_cnt, idx);
+
+    cache->schedule = (u_int64_t *)safe_malloc(cache->pkt_cnt * sizeof(u_int64_t));
+    memcpy(&cache->schedule_speed, speed, sizeof(tcpreplay_speed_t));
+    group = speed->pps_multi > 0 ? speed->pps_multi : 1;
+
+    for (i = 0; i < cache->pkt_cnt; i++) {
+        pkthdr = &((packet_cache_t *)(cache->arena + cache->offsets[i]))->pkthdr;
+
+        switch (speed->mode) {
+        case speed_multiplier:
+            ts = PKTHDR_TS_TO_NANOSEC(&pkthdr->ts);
+            if (i == 0)
+                first_ts = ts;
+
+            due = ts > first_ts ? (u_int64_t)((double)(ts - first_ts) / speed->multiplier) : 0;
+            break;
+
+        case speed_mbpsrate:
+            /* due once all of the previous bytes would be on the wire */
+            due = (u_int64_t)((double)bytes * 8 * 1000000000 / (double)speed->speed);
+            bytes += options->use_pkthdr_len ? pkthdr->len : pkthdr->caplen;
+            break;
+
+        case speed_packetrate:
+            due = (u_int64_t)((double)(i - i % group) * 1000000000 / (double)speed->speed);
+            break;
+
+        default:
+            assert(0);
+            due = 0;
+        }
+
+        /* packets which go back in time are sent right away */
+        if (i > 0 && due < cache->schedule[i - 1])
+            due = cache->schedule[i - 1];
+
+        cache->schedule[i] = due;
+    }
+
+    return cache->schedule;
+}
+
+/**
+ * Sleeps until a packet is due according to the file cache schedule.
+ * start_ns is when the first packet of this pass went out (0 until then).
+ */
+static void
+schedule_wait(tcpreplay_t *ctx, u_int64_t offset, u_int64_t *start_ns)
+{
+    u_int64_t now, deadline, accel;
+
+    now = get_monotonic_ns();
+    if (*start_ns == 0)
+        *start_ns = now;
+
+    /* --sleep-accel */
+    accel = (u_int64_t)ctx->options->sleep_accel * 1000;
+    deadline = *start_ns + offset;
+    deadline = deadline > accel ? deadline - accel : 0;
+
+    if (deadline > now)
+        now = deadline_sleep(deadline, ctx->options->spin_threshold);
 
+    add_jitter_stats(&ctx->stats, now > deadline ? now - deadline : 0);
 }
+#endif /* HAVE_CLOCK_GETTIME */
 
 /**
  * Ask the user how many packets they want to send.
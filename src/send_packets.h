@@ -23,9 +23,10 @@
 #ifndef __SEND_PACKETS_H__
 #define __SEND_PACKETS_H__
 
-void send_packets(tcpreplay_t *ctx, pcap_t *pcap, int idx);
-void send_dual_packets(tcpreplay_t *ctx, pcap_t *pcap1, int idx1, pcap_t *pcap2, int idx2);
-void *cache_mode(tcpreplay_t *ctx, char *cachedata, COUNTER packet_num);
+void send_packets(tcpreplay_t *ctx, mmpcap_t *pcap, int idx);
+void send_dual_packets(tcpreplay_t *ctx, mmpcap_t *pcap1, int idx1, mmpcap_t *pcap2, int idx2);
+void *cache_mode(tcpreplay_t *ctx, tcpr_dir_t result, COUNTER packet_num);
 void preload_pcap_file(tcpreplay_t *ctx, int idx);
+void free_file_cache(file_cache_t *cache);
 
 #endif
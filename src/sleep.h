@@ -52,6 +52,33 @@ nanosleep_sleep(struct timespec nap)
 }
 
 
+#ifdef HAVE_CLOCK_GETTIME
+/*
+ * Sleeps until the given CLOCK_MONOTONIC time (nsec): nanosleep() gets us
+ * to within spin nsec of the deadline, then we busy wait the rest.  The
+ * kernel usually wakes us up tens of usec late, so spinning the last bit
+ * gives sub-usec accuracy while only burning the CPU for a short while per
+ * packet.  Returns the time we actually woke up.
+ */
+static inline u_int64_t
+deadline_sleep(u_int64_t deadline, u_int64_t spin)
+{
+    struct timespec wake;
+    u_int64_t now = get_monotonic_ns();
+
+    if (deadline > now + spin) {
+        NANOSEC_TO_TIMESPEC(deadline - spin, &wake);
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &wake, NULL) == EINTR)
+            ;
+    }
+
+    while (now < deadline)
+        now = get_monotonic_ns();
+
+    return now;
+}
+#endif /* HAVE_CLOCK_GETTIME */
+
 /*
  * Straight forward... keep calling gettimeofday() unti the apporpriate amount
  * of time has passed.  Pretty damn accurate from 1 to 100Mbps
@@ -70,6 +70,9 @@ main(int argc, char *argv[])
 
     post_args(argc, argv);
 
+    /* pick the checksum kernel up front, out of the packet path */
+    csum_init();
+
     /* init tcpedit context */
     if (tcpedit_init(&tcpedit, pcap_datalink(options.pcap1)) < 0) {
         errx(-1, "Error initializing tcpedit: %s", tcpedit_geterr(tcpedit));
@@ -201,7 +204,7 @@ post_args(_U_ int argc, _U_ char *argv[])
      * if user doesn't specify MAC address on CLI, query for it 
      */
     if (memcmp(options.intf1_mac, "\00\00\00\00\00\00", ETHER_ADDR_LEN) == 0) {
-        if ((sp = sendpacket_open(options.intf1, ebuf, TCPR_DIR_C2S)) == NULL)
+        if ((sp = sendpacket_open(options.intf1, ebuf, TCPR_DIR_C2S, 0, 0)) == NULL)
             errx(-1, "Unable to open interface %s: %s", options.intf1, ebuf);
 
         if ((eth_buff = sendpacket_get_hwaddr(sp)) == NULL) {
@@ -213,7 +216,7 @@ post_args(_U_ int argc, _U_ char *argv[])
     }
 
     if (memcmp(options.intf2_mac, "\00\00\00\00\00\00", ETHER_ADDR_LEN) == 0) {
-        if ((sp = sendpacket_open(options.intf2, ebuf, TCPR_DIR_S2C)) == NULL)
+        if ((sp = sendpacket_open(options.intf2, ebuf, TCPR_DIR_S2C, 0, 0)) == NULL)
             errx(-1, "Unable to open interface %s: %s", options.intf2, ebuf);
 
         if ((eth_buff = sendpacket_get_hwaddr(sp)) == NULL) {
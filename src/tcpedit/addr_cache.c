@@ -0,0 +1,169 @@
+/* $Id$ */
+
+/*
+ *   Copyright (c) 2001-2010 Aaron Turner <aturner at synfin dot net>
+ *
+ *   The Tcpreplay Suite of tools is free software: you can redistribute it 
+ *   and/or modify it under the terms of the GNU General Public License as 
+ *   published by the Free Software Foundation, either version 3 of the 
+ *   License, or with the authors permission any later version.
+ *
+ *   The Tcpreplay Suite is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with the Tcpreplay Suite.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/*
+ * A small, fixed size cache of original to rewritten IP addresses.
+ * 
+ * Rewriting an address for --pnat, --srcipmap, --dstipmap, --endpoints and
+ * --seed only depends on the address, whether it's the source or
+ * destination and the direction of the packet.  Real traffic reuses the
+ * same handful of addresses over and over, so we remember the result in an
+ * open addressing hash table (linear probing) rather then redoing the work
+ * for every packet.  When all the slots we probe are taken, the first one is
+ * simply overwritten, so the cache never grows.
+ */
+
+#include "config.h"
+#include "defines.h"
+#include "common.h"
+
+#include <string.h>
+
+#include "tcpedit.h"
+#include "addr_cache.h"
+
+static inline int
+addr_words(u_int8_t flags)
+{
+    return (flags & ADDR_CACHE_IPV6) ? 4 : 1;
+}
+
+static inline u_int32_t
+addr_cache_hash(u_int8_t flags, const u_int32_t *key)
+{
+    u_int32_t hash = flags;
+    int i;
+
+    for (i = 0; i < addr_words(flags); i++)
+        hash = (hash ^ key[i]) * 0x9e3779b1;
+
+    return (hash ^ (hash >> 16)) & (ADDR_CACHE_SIZE - 1);
+}
+
+/**
+ * \brief Allocates the cache entries
+ */
+void
+addr_cache_init(tcpedit_addr_cache_t *cache)
+{
+    assert(cache);
+
+    if (cache->entries == NULL)
+        cache->entries = (tcpedit_addr_cache_entry_t *)safe_malloc(
+                sizeof(tcpedit_addr_cache_entry_t) * ADDR_CACHE_SIZE);
+    cache->hits = 0;
+    cache->misses = 0;
+}
+
+void
+addr_cache_free(tcpedit_addr_cache_t *cache)
+{
+    assert(cache);
+
+    if (cache->entries != NULL) {
+        safe_free(cache->entries);
+        cache->entries = NULL;
+    }
+}
+
+/**
+ * \brief Looks up the rewritten address
+ *
+ * flags must have ADDR_CACHE_USED set.  On a hit the rewritten address is
+ * copied to value, the number of changes the rewrite made to changes and
+ * returns true.  Always misses if the cache hasn't been initialized.
+ */
+bool
+addr_cache_lookup(tcpedit_addr_cache_t *cache, u_int8_t flags,
+        const u_int32_t *key, u_int32_t *value, int *changes)
+{
+    tcpedit_addr_cache_entry_t *entry;
+    u_int32_t slot;
+    int i, words;
+
+    assert(cache);
+    assert(flags & ADDR_CACHE_USED);
+
+    if (cache->entries == NULL)
+        return false;
+
+    words = addr_words(flags);
+    slot = addr_cache_hash(flags, key);
+    for (i = 0; i < ADDR_CACHE_PROBES; i++) {
+        entry = &cache->entries[(slot + i) & (ADDR_CACHE_SIZE - 1)];
+        if (entry->flags == 0)
+            break;
+
+        if (entry->flags == flags &&
+                memcmp(entry->key, key, words * sizeof(u_int32_t)) == 0) {
+            memcpy(value, entry->value, words * sizeof(u_int32_t));
+            *changes = entry->changes;
+            cache->hits++;
+            return true;
+        }
+    }
+
+    cache->misses++;
+    return false;
+}
+
+/**
+ * \brief Remembers the rewritten address for key
+ */
+void
+addr_cache_insert(tcpedit_addr_cache_t *cache, u_int8_t flags,
+        const u_int32_t *key, const u_int32_t *value, int changes)
+{
+    tcpedit_addr_cache_entry_t *entry = NULL;
+    u_int32_t slot;
+    int i, words;
+
+    assert(cache);
+    assert(flags & ADDR_CACHE_USED);
+
+    if (cache->entries == NULL)
+        return;
+
+    words = addr_words(flags);
+    slot = addr_cache_hash(flags, key);
+    for (i = 0; i < ADDR_CACHE_PROBES; i++) {
+        entry = &cache->entries[(slot + i) & (ADDR_CACHE_SIZE - 1)];
+        if (entry->flags == 0)
+            break;
+        entry = NULL;
+    }
+
+    /* full, so evict whatever is in the home slot */
+    if (entry == NULL)
+        entry = &cache->entries[slot];
+
+    entry->flags = flags;
+    memcpy(entry->key, key, words * sizeof(u_int32_t));
+    memcpy(entry->value, value, words * sizeof(u_int32_t));
+    entry->changes = (u_int8_t)changes;
+}
+
+/*
+ Local Variables:
+ mode:c
+ indent-tabs-mode:nil
+ c-basic-offset:4
+ End:
+*/
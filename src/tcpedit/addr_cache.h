@@ -0,0 +1,50 @@
+/* $Id$ */
+
+/*
+ *   Copyright (c) 2001-2010 Aaron Turner <aturner at synfin dot net>
+ *
+ *   The Tcpreplay Suite of tools is free software: you can redistribute it 
+ *   and/or modify it under the terms of the GNU General Public License as 
+ *   published by the Free Software Foundation, either version 3 of the 
+ *   License, or with the authors permission any later version.
+ *
+ *   The Tcpreplay Suite is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with the Tcpreplay Suite.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "tcpedit_types.h"
+
+#ifndef __ADDR_CACHE_H__
+#define __ADDR_CACHE_H__
+
+#define ADDR_CACHE_SIZE     4096    /* entries, must be a power of 2 */
+#define ADDR_CACHE_PROBES   8       /* max slots we look at per lookup */
+
+/* entry flags: which address & direction the rewrite was done for */
+#define ADDR_CACHE_USED     0x01
+#define ADDR_CACHE_IPV6     0x02
+#define ADDR_CACHE_SRC      0x04
+#define ADDR_CACHE_S2C      0x08
+
+void addr_cache_init(tcpedit_addr_cache_t *cache);
+void addr_cache_free(tcpedit_addr_cache_t *cache);
+bool addr_cache_lookup(tcpedit_addr_cache_t *cache, u_int8_t flags,
+        const u_int32_t *key, u_int32_t *value, int *changes);
+void addr_cache_insert(tcpedit_addr_cache_t *cache, u_int8_t flags,
+        const u_int32_t *key, const u_int32_t *value, int changes);
+
+#endif
+
+/*
+ Local Variables:
+ mode:c
+ indent-tabs-mode:nil
+ c-basic-offset:4
+ End:
+*/
@@ -26,7 +26,9 @@
 #include "tcpedit.h"
 #include "checksum.h"
 
-static int do_checksum_math(uint16_t *, int);
+#include <string.h>
+
+static uint16_t checksum_adjust(uint16_t, uint32_t);
 
 
 /**
@@ -36,16 +38,10 @@ int
 do_checksum(tcpedit_t *tcpedit, uint8_t *data, int proto, int len) {
     ipv4_hdr_t *ipv4;
     ipv6_hdr_t *ipv6;
-    tcp_hdr_t *tcp;
-    udp_hdr_t *udp;
-    icmpv4_hdr_t *icmp;
-    icmpv6_hdr_t *icmp6;
+    uint8_t *l4;
     int ip_hl;
     int sum;
 
-    sum = 0;
-    ipv4 = NULL;
-    ipv6 = NULL;
     assert(data);
 
     if (len <= 0) {
@@ -56,23 +52,70 @@ do_checksum(tcpedit_t *tcpedit, uint8_t *data, int proto, int len) {
     ipv4 = (ipv4_hdr_t *)data;
     if (ipv4->ip_v == 6) {
         ipv6 = (ipv6_hdr_t *)data;
-        ipv4 = NULL;
 
         proto = get_ipv6_l4proto(ipv6, len);
         dbgx(3, "layer4 proto is 0x%hhu", proto);
 
-        ip_hl = (u_char*)get_layer4_v6(ipv6, len) - (u_char*)data;
+        if ((l4 = get_layer4_v6(ipv6, len)) == NULL) {
+            tcpedit_setwarn(tcpedit, "Unable to checksum IPv6 packet with no L4 header: 0x%x", proto);
+            return TCPEDIT_WARN;
+        }
+        ip_hl = l4 - data;
         dbgx(3, "ip_hl proto is 0x%d", ip_hl);
 
         len -= (ip_hl - TCPR_IPV6_H);
     } else {
         ip_hl = ipv4->ip_hl << 2;
+
+        if (proto == IPPROTO_IP) {
+            ipv4->ip_sum = 0;
+            sum = csum_partial(data, ip_hl, 0);
+            ipv4->ip_sum = CHECKSUM_CARRY(sum);
+            return TCPEDIT_OK;
+        }
+    }
+
+    return do_checksum_l4(tcpedit, data, data + ip_hl, proto, len);
+}
+
+/**
+ * Recalculates the L4 checksum of an already parsed packet: data is the
+ * IPv4/IPv6 header (for the pseudo header), l4 the L4 header of the given
+ * protocol and len the number of bytes of L4 header + payload.
+ * Returns -1 on error and 0 on success, 1 on warn
+ */
+int
+do_checksum_l4(tcpedit_t *tcpedit, uint8_t *data, uint8_t *l4, int proto, int len)
+{
+    ipv4_hdr_t *ipv4;
+    ipv6_hdr_t *ipv6;
+    tcp_hdr_t *tcp;
+    udp_hdr_t *udp;
+    icmpv4_hdr_t *icmp;
+    icmpv6_hdr_t *icmp6;
+    int sum;
+
+    sum = 0;
+    ipv4 = NULL;
+    ipv6 = NULL;
+    assert(data);
+    assert(l4);
+
+    if (len <= 0) {
+        tcpedit_setwarn(tcpedit, "%s", "Unable to checksum packets with no L4 data");
+        return TCPEDIT_WARN;
+    }
+
+    ipv4 = (ipv4_hdr_t *)data;
+    if (ipv4->ip_v == 6) {
+        ipv6 = (ipv6_hdr_t *)data;
+        ipv4 = NULL;
     }
 
     switch (proto) {
 
         case IPPROTO_TCP:
-            tcp = (tcp_hdr_t *)(data + ip_hl);
+            tcp = (tcp_hdr_t *)l4;
 #ifdef STUPID_SOLARIS_CHECKSUM_BUG
             tcp->th_sum = tcp->th_off << 2;
             return (TCPEDIT_OK);
@@ -83,60 +126,53 @@ do_checksum(tcpedit_t *tcpedit, uint8_t *data, int proto, int len) {
              * length is 2x a single IP
              */
             if (ipv6 != NULL) {
-                sum = do_checksum_math((uint16_t *)&ipv6->ip_src, 32);
+                sum = csum_partial(&ipv6->ip_src, 32, 0);
             } else {
-                sum = do_checksum_math((uint16_t *)&ipv4->ip_src, 8);
+                sum = csum_partial(&ipv4->ip_src, 8, 0);
             }
             sum += ntohs(IPPROTO_TCP + len);
-            sum += do_checksum_math((uint16_t *)tcp, len);
+            sum += csum_partial(tcp, len, 0);
             tcp->th_sum = CHECKSUM_CARRY(sum);
             break;
 
         case IPPROTO_UDP:
-            udp = (udp_hdr_t *)(data + ip_hl);
+            udp = (udp_hdr_t *)l4;
             /* No need to recalculate UDP checksums if already 0 */
             if (udp->uh_sum == 0) 
                 break; 
             udp->uh_sum = 0;
             if (ipv6 != NULL) {
-                sum = do_checksum_math((uint16_t *)&ipv6->ip_src, 32);
+                sum = csum_partial(&ipv6->ip_src, 32, 0);
             } else {
-                sum = do_checksum_math((uint16_t *)&ipv4->ip_src, 8);
+                sum = csum_partial(&ipv4->ip_src, 8, 0);
             }
             sum += ntohs(IPPROTO_UDP + len);
-            sum += do_checksum_math((uint16_t *)udp, len);
+            sum += csum_partial(udp, len, 0);
             udp->uh_sum = CHECKSUM_CARRY(sum);
             break;
 
         case IPPROTO_ICMP:
-            icmp = (icmpv4_hdr_t *)(data + ip_hl);
+            icmp = (icmpv4_hdr_t *)l4;
             icmp->icmp_sum = 0;
             if (ipv6 != NULL) {
-                sum = do_checksum_math((uint16_t *)&ipv6->ip_src, 32);
+                sum = csum_partial(&ipv6->ip_src, 32, 0);
                 icmp->icmp_sum = CHECKSUM_CARRY(sum);                
             }
-            sum += do_checksum_math((uint16_t *)icmp, len);
+            sum += csum_partial(icmp, len, 0);
             icmp->icmp_sum = CHECKSUM_CARRY(sum);
             break;
 
         case IPPROTO_ICMP6:
-            icmp6 = (icmpv6_hdr_t *)(data + ip_hl);
+            icmp6 = (icmpv6_hdr_t *)l4;
             icmp6->icmp_sum = 0;
             if (ipv6 != NULL) {
-                sum = do_checksum_math((u_int16_t *)&ipv6->ip_src, 32);
+                sum = csum_partial(&ipv6->ip_src, 32, 0);
             }
             sum += ntohs(IPPROTO_ICMP6 + len);
-            sum += do_checksum_math((u_int16_t *)icmp6, len);
+            sum += csum_partial(icmp6, len, 0);
             icmp6->icmp_sum = CHECKSUM_CARRY(sum);
             break;
 
-
-        case IPPROTO_IP:
-            ipv4->ip_sum = 0;
-            sum = do_checksum_math((uint16_t *)data, ip_hl);
-            ipv4->ip_sum = CHECKSUM_CARRY(sum);
-            break;
-
         case IPPROTO_IGMP:
         case IPPROTO_GRE:
         case IPPROTO_OSPF:
@@ -153,28 +189,131 @@ do_checksum(tcpedit_t *tcpedit, uint8_t *data, int proto, int len) {
 }
 
 /**
- * code to do a ones-compliment checksum
+ * RFC 1624 eqn. 3: HC' = ~(~HC + ~m + m') where delta is the sum of ~m + m'
+ * over every 16bit word which changed
  */
-static int
-do_checksum_math(uint16_t *data, int len)
+static uint16_t
+checksum_adjust(uint16_t sum, uint32_t delta)
 {
-    int sum = 0;
-    union {
-        uint16_t s;
-        uint8_t b[2];
-    } pad;
-
-    while (len > 1) {
-        sum += *data++;
-        len -= 2;
-    }
+    uint32_t x = (uint16_t)~sum + delta;
 
-    if (len == 1) {
-        pad.b[0] = *(uint8_t *)data;
-        pad.b[1] = 0;
-        sum += pad.s;
+    x = (x >> 16) + (x & 0xffff);
+    x += x >> 16;
+    return (uint16_t)~x;
+}
+
+/**
+ * Saves the IPv4/IPv6 header at data and the TCP/UDP ports at ports
+ * (unless it's NULL).  Call before editing and pass to do_checksum_update()
+ * afterwards.
+ */
+void
+checksum_snapshot(csum_snapshot_t *snap, const uint8_t *data, const uint8_t *ports)
+{
+    const ipv4_hdr_t *ipv4 = (const ipv4_hdr_t *)data;
+
+    assert(snap);
+    assert(data);
+
+    if (ipv4->ip_v == 6) {
+        snap->l3words = TCPR_IPV6_H / 2;
+    } else {
+        snap->l3words = ipv4->ip_hl * 2;
     }
+    memcpy(snap->l3, data, snap->l3words * 2);
 
-    return (sum);
+    snap->has_ports = false;
+    if (ports != NULL) {
+        memcpy(snap->ports, ports, sizeof(snap->ports));
+        snap->has_ports = true;
+    }
 }
 
+/**
+ * Incrementally updates the IPv4 header checksum and the TCP/UDP/ICMPv6
+ * checksum of the proto header at l4hdr (unless it's NULL) for whatever
+ * changed since checksum_snapshot().
+ * Only valid if the packet length and the L4 protocol didn't change, and
+ * of course only gives a good checksum if the original one was.
+ * Returns TCPEDIT_OK
+ */
+int
+do_checksum_update(tcpedit_t *tcpedit, const csum_snapshot_t *snap, uint8_t *data,
+        uint8_t *l4hdr, int proto)
+{
+    ipv4_hdr_t *ipv4 = (ipv4_hdr_t *)data;
+    const uint16_t *now = (const uint16_t *)data;
+    uint32_t ip_delta = 0, l4_delta = 0, delta;
+    tcp_hdr_t *tcp;
+    udp_hdr_t *udp;
+    icmpv6_hdr_t *icmp6;
+    int i, pseudo_first, pseudo_last;
+
+    assert(tcpedit);
+    assert(snap);
+    assert(data);
+
+    /* which header words are in the TCP/UDP pseudo header (the addresses) */
+    if (ipv4->ip_v == 6) {
+        pseudo_first = 4;
+        pseudo_last = 19;
+    } else {
+        pseudo_first = 6;
+        pseudo_last = 9;
+    }
+
+    for (i = 0; i < snap->l3words; i++) {
+        if (now[i] == snap->l3[i])
+            continue;
+
+        delta = (uint16_t)~snap->l3[i] + now[i];
+        ip_delta += delta;
+        if (i >= pseudo_first && i <= pseudo_last)
+            l4_delta += delta;
+    }
+
+    /* the IPv4 header checksum itself is word 5 */
+    if (ipv4->ip_v == 4 && ip_delta != 0)
+        ipv4->ip_sum = checksum_adjust(ipv4->ip_sum, ip_delta);
+
+    if (l4hdr == NULL)
+        return TCPEDIT_OK;
+
+    if (snap->has_ports) {
+        for (i = 0; i < 2; i++) {
+            if (((uint16_t *)l4hdr)[i] != snap->ports[i])
+                l4_delta += (uint16_t)~snap->ports[i] + ((uint16_t *)l4hdr)[i];
+        }
+    }
+
+    if (l4_delta == 0)
+        return TCPEDIT_OK;
+
+    switch (proto) {
+        case IPPROTO_TCP:
+            tcp = (tcp_hdr_t *)l4hdr;
+            tcp->th_sum = checksum_adjust(tcp->th_sum, l4_delta);
+            break;
+
+        case IPPROTO_UDP:
+            udp = (udp_hdr_t *)l4hdr;
+            /* 0 means the sender didn't checksum it, so leave it alone */
+            if (udp->uh_sum == 0)
+                break;
+            udp->uh_sum = checksum_adjust(udp->uh_sum, l4_delta);
+            if (udp->uh_sum == 0)
+                udp->uh_sum = 0xffff;
+            break;
+
+        case IPPROTO_ICMP6:
+            icmp6 = (icmpv6_hdr_t *)l4hdr;
+            icmp6->icmp_sum = checksum_adjust(icmp6->icmp_sum, l4_delta);
+            break;
+
+        default:
+            /* ICMPv4 & friends don't cover the IP addresses */
+            break;
+    }
+
+    return TCPEDIT_OK;
+}
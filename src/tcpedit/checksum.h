@@ -24,5 +24,21 @@
     (x = (x >> 16) + (x & 0xffff), (~(x + (x >> 16)) & 0xffff))
 
 int do_checksum(tcpedit_t *, u_int8_t *, int, int);
+int do_checksum_l4(tcpedit_t *, u_int8_t *, u_int8_t *, int, int);
+
+/*
+ * copy of the checksummed header fields tcpedit may rewrite, taken before
+ * editing so do_checksum_update() can patch the checksums afterwards
+ * (RFC 1624) rather then recomputing them over the whole packet
+ */
+typedef struct {
+    u_int16_t l3[30];           /* IPv4 header (up to 60 bytes) or IPv6 header */
+    int l3words;
+    u_int16_t ports[2];         /* TCP/UDP src & dst port */
+    bool has_ports;
+} csum_snapshot_t;
+
+void checksum_snapshot(csum_snapshot_t *, const u_int8_t *, const u_int8_t *);
+int do_checksum_update(tcpedit_t *, const csum_snapshot_t *, u_int8_t *, u_int8_t *, int);
 
 #endif
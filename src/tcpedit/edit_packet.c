@@ -34,6 +34,8 @@
 #include <netinet/in.h>
 #include <arpa/inet.h>
 
+#include "addr_cache.h"
+
 static uint32_t randomize_ipv4_addr(tcpedit_t *tcpedit, uint32_t ip);
 static uint32_t remap_ipv4(tcpedit_t *tcpedit, tcpr_cidr_t *cidr, const uint32_t original);
 static int is_unicast_ipv4(tcpedit_t *tcpedit, uint32_t ip);
@@ -42,6 +44,111 @@ static void randomize_ipv6_addr(tcpedit_t *tcpedit, struct tcpr_in6_addr *addr);
 static int remap_ipv6(tcpedit_t *tcpedit, tcpr_cidr_t *cidr, struct tcpr_in6_addr *addr);
 static int is_multicast_ipv6(tcpedit_t *tcpedit, struct tcpr_in6_addr *addr);
 
+/**
+ * \brief Parses the L3 & L4 headers of a packet
+ *
+ * Fills in pkt for the packet whose L3 data (len bytes of it) is at l3data,
+ * walking the IPv6 extension headers once so nothing else has to.
+ */
+void
+decode_packet(tcpedit_packet_t *pkt, int l2len, int l2proto, u_char *l3data, int len)
+{
+    ipv4_hdr_t *ip_hdr;
+    struct tcpr_ipv6_ext_hdr_base *exthdr;
+    u_char *ptr, *end;
+    u_int8_t proto;
+
+    assert(pkt);
+
+    memset(pkt, 0, sizeof(*pkt));
+    pkt->l2len = l2len;
+    pkt->l2proto = l2proto;
+
+    if (l3data == NULL || (l2proto != htons(ETHERTYPE_IP) && l2proto != htons(ETHERTYPE_IP6)))
+        return;
+
+    pkt->l3data = l3data;
+    end = l3data + len;
+
+    if (l2proto == htons(ETHERTYPE_IP)) {
+        ip_hdr = (ipv4_hdr_t *)l3data;
+        pkt->l4proto = ip_hdr->ip_p;
+
+        /* only the first fragment has the L4 header */
+        if ((ntohs(ip_hdr->ip_off) & IP_OFFMASK) != 0) {
+            pkt->fragment = true;
+            return;
+        }
+
+        ptr = l3data + (ip_hdr->ip_hl << 2);
+        if (ptr <= end)
+            pkt->l4data = ptr;
+        return;
+    }
+
+    pkt->ipv6 = true;
+    proto = ((ipv6_hdr_t *)l3data)->ip_nh;
+    ptr = l3data + TCPR_IPV6_H;
+
+    while (ptr <= end) {
+        switch (proto) {
+        /* v6-in-v6: keep going with the inner header */
+        case TCPR_IPV6_NH_IPV6:
+            if (ptr + TCPR_IPV6_H > end)
+                return;
+            pkt->tunnel = true;
+            proto = ((ipv6_hdr_t *)ptr)->ip_nh;
+            ptr += TCPR_IPV6_H;
+            break;
+
+        case TCPR_IPV6_NH_AH:
+        case TCPR_IPV6_NH_ROUTING:
+        case TCPR_IPV6_NH_DESTOPTS:
+        case TCPR_IPV6_NH_HBH:
+            if (ptr + sizeof(*exthdr) > end)
+                return;
+            exthdr = (struct tcpr_ipv6_ext_hdr_base *)ptr;
+            proto = exthdr->ip_nh;
+            ptr += IPV6_EXTLEN_TO_BYTES(exthdr->ip_len);
+            break;
+
+        /* nothing we can parse beyond these */
+        case TCPR_IPV6_NH_FRAGMENT:
+            pkt->fragment = true;
+            pkt->l4proto = proto;
+            return;
+
+        case TCPR_IPV6_NH_ESP:
+            pkt->l4proto = proto;
+            return;
+
+        /* TCP, UDP, ICMPv6, etc... */
+        default:
+            pkt->l4proto = proto;
+            pkt->l4data = ptr;
+            return;
+        }
+    }
+}
+
+/**
+ * returns the number of bytes of L4 header + payload according to the
+ * IPv4/IPv6 header
+ */
+static int
+packet_l4len(const tcpedit_packet_t *pkt)
+{
+    int l3len;
+
+    if (pkt->ipv6) {
+        l3len = ntohs(((ipv6_hdr_t *)pkt->l3data)->ip_len) + TCPR_IPV6_H;
+    } else {
+        l3len = ntohs(((ipv4_hdr_t *)pkt->l3data)->ip_len);
+    }
+
+    return l3len - (int)(pkt->l4data - pkt->l3data);
+}
+
 /**
  * this code re-calcs the IP and Layer 4 checksums
  * the IMPORTANT THING is that the Layer 4 header 
@@ -49,21 +156,33 @@ static int is_multicast_ipv6(tcpedit_t *tcpedit, struct tcpr_in6_addr *addr);
  * writing to the layer 4 header via the ip_hdr ptr.
  * (Yes, this sucks, but that's the way libnet works, and
  * I was too lazy to re-invent the wheel.
+ * If snap is set, only the header fields which changed since
+ * checksum_snapshot() are patched into the existing checksums.
  * Returns 0 on sucess, -1 on error
  */
 int
-fix_ipv4_checksums(tcpedit_t *tcpedit, struct pcap_pkthdr *pkthdr, ipv4_hdr_t *ip_hdr)
+fix_ipv4_checksums(tcpedit_t *tcpedit, struct pcap_pkthdr *pkthdr, const tcpedit_packet_t *pkt,
+        const csum_snapshot_t *snap)
 {
     int ret1 = 0, ret2 = 0;
+    ipv4_hdr_t *ip_hdr;
+    u_char *l4 = NULL;
     assert(tcpedit);
     assert(pkthdr);
-    assert(ip_hdr);
-    
+    assert(pkt);
+    assert(pkt->l3data);
 
+    ip_hdr = (ipv4_hdr_t *)pkt->l3data;
+    
     /* calc the L4 checksum if we have the whole packet && not a frag or first frag */
-    if (pkthdr->caplen == pkthdr->len && (htons(ip_hdr->ip_off) & IP_OFFMASK) == 0) {
-        ret1 = do_checksum(tcpedit, (u_char *) ip_hdr, 
-                ip_hdr->ip_p, ntohs(ip_hdr->ip_len) - (ip_hdr->ip_hl << 2));
+    if (pkthdr->caplen == pkthdr->len)
+        l4 = pkt->l4data;
+
+    if (snap != NULL)
+        return do_checksum_update(tcpedit, snap, (u_char *)ip_hdr, l4, pkt->l4proto);
+
+    if (l4 != NULL) {
+        ret1 = do_checksum_l4(tcpedit, (u_char *)ip_hdr, l4, pkt->l4proto, packet_l4len(pkt));
         if (ret1 < 0)
             return TCPEDIT_ERROR;
     }
@@ -81,18 +200,25 @@ fix_ipv4_checksums(tcpedit_t *tcpedit, struct pcap_pkthdr *pkthdr, ipv4_hdr_t *i
 }
 
 int
-fix_ipv6_checksums(tcpedit_t *tcpedit, struct pcap_pkthdr *pkthdr, ipv6_hdr_t *ip6_hdr)
+fix_ipv6_checksums(tcpedit_t *tcpedit, struct pcap_pkthdr *pkthdr, const tcpedit_packet_t *pkt,
+        const csum_snapshot_t *snap)
 {
     int ret = 0;
+    u_char *l4 = NULL;
     assert(tcpedit);
     assert(pkthdr);
-    assert(ip6_hdr);
+    assert(pkt);
+    assert(pkt->l3data);
 
+    /* calc the L4 checksum if we have the whole packet && not a frag */
+    if (pkthdr->caplen == pkthdr->len)
+        l4 = pkt->l4data;
 
-    /* calc the L4 checksum if we have the whole packet && not a frag or first frag */
-    if (pkthdr->caplen == pkthdr->len) {
-        ret = do_checksum(tcpedit, (u_char *) ip6_hdr, ip6_hdr->ip_nh,
-            htons(ip6_hdr->ip_len));
+    if (snap != NULL)
+        return do_checksum_update(tcpedit, snap, pkt->l3data, l4, pkt->l4proto);
+
+    if (l4 != NULL) {
+        ret = do_checksum_l4(tcpedit, pkt->l3data, l4, pkt->l4proto, packet_l4len(pkt));
         if (ret < 0)
             return TCPEDIT_ERROR;
     }
@@ -240,12 +366,23 @@ randomize_ipv6(tcpedit_t *tcpedit, struct pcap_pkthdr *pkthdr,
 
 int
 untrunc_packet(tcpedit_t *tcpedit, struct pcap_pkthdr *pkthdr, 
-        u_char *pktdata, ipv4_hdr_t *ip_hdr, ipv6_hdr_t *ip6_hdr)
+        u_char *pktdata, const tcpedit_packet_t *pkt)
 {
+    ipv4_hdr_t *ip_hdr = NULL;
+    ipv6_hdr_t *ip6_hdr = NULL;
     int l2len;
     assert(tcpedit);
     assert(pkthdr);
     assert(pktdata);
+    assert(pkt);
+
+    if (pkt->l3data != NULL) {
+        if (pkt->ipv6) {
+            ip6_hdr = (ipv6_hdr_t *)pkt->l3data;
+        } else {
+            ip_hdr = (ipv4_hdr_t *)pkt->l3data;
+        }
+    }
 
     /* if actual len == cap len or there's no IP header, don't do anything */
     if ((pkthdr->caplen == pkthdr->len) || (ip_hdr == NULL && ip6_hdr == NULL)) {
@@ -254,7 +391,7 @@ untrunc_packet(tcpedit_t *tcpedit, struct pcap_pkthdr *pkthdr,
             return(0);
     }
     
-    if ((l2len = layer2len(tcpedit)) < 0) {
+    if ((l2len = pkt->l2len) < 0) {
         tcpedit_seterr(tcpedit, "Non-sensical layer 2 length: %d", l2len);
         return -1;
     }
@@ -549,22 +686,23 @@ int
 rewrite_ipv4l3(tcpedit_t *tcpedit, ipv4_hdr_t *ip_hdr, tcpr_dir_t direction)
 {
     tcpr_cidrmap_t *cidrmap1 = NULL, *cidrmap2 = NULL;
-    int didsrc = 0, diddst = 0, loop = 1;
+    tcpr_cidr_t *cidr;
+    int didsrc = 0, diddst = 0;
 
     assert(tcpedit);
     assert(ip_hdr);
 
     /* first check the src/dst IP maps */
     if (tcpedit->srcipmap != NULL) {
-        if (ip_in_cidr(tcpedit->srcipmap->from, ip_hdr->ip_src.s_addr)) {
-            ip_hdr->ip_src.s_addr = remap_ipv4(tcpedit, tcpedit->srcipmap->to, ip_hdr->ip_src.s_addr);
+        if ((cidr = cidr_map_lookup4(tcpedit->srcipmap, ip_hdr->ip_src.s_addr)) != NULL) {
+            ip_hdr->ip_src.s_addr = remap_ipv4(tcpedit, cidr, ip_hdr->ip_src.s_addr);
             dbgx(2, "Remapped src addr to: %s", get_addr2name4(ip_hdr->ip_src.s_addr, RESOLVE));
         }
     }
 
     if (tcpedit->dstipmap != NULL) {
-        if (ip_in_cidr(tcpedit->dstipmap->from, ip_hdr->ip_dst.s_addr)) {
-            ip_hdr->ip_dst.s_addr = remap_ipv4(tcpedit, tcpedit->dstipmap->to, ip_hdr->ip_dst.s_addr);
+        if ((cidr = cidr_map_lookup4(tcpedit->dstipmap, ip_hdr->ip_dst.s_addr)) != NULL) {
+            ip_hdr->ip_dst.s_addr = remap_ipv4(tcpedit, cidr, ip_hdr->ip_dst.s_addr);
             dbgx(2, "Remapped src addr to: %s", get_addr2name4(ip_hdr->ip_dst.s_addr, RESOLVE));
         }
     }
@@ -583,43 +721,22 @@ rewrite_ipv4l3(tcpedit_t *tcpedit, ipv4_hdr_t *ip_hdr, tcpr_dir_t direction)
     }
     
 
-    /* loop through the cidrmap to rewrite */
-    do {
-        if ((! diddst) && ip_in_cidr(cidrmap2->from, ip_hdr->ip_dst.s_addr)) {
-            ip_hdr->ip_dst.s_addr = remap_ipv4(tcpedit, cidrmap2->to, ip_hdr->ip_dst.s_addr);
-            dbgx(2, "Remapped dst addr to: %s", get_addr2name4(ip_hdr->ip_dst.s_addr, RESOLVE));
-            diddst = 1;
-        }
-        if ((! didsrc) && ip_in_cidr(cidrmap1->from, ip_hdr->ip_src.s_addr)) {
-            ip_hdr->ip_src.s_addr = remap_ipv4(tcpedit, cidrmap1->to, ip_hdr->ip_src.s_addr);
-            dbgx(2, "Remapped src addr to: %s", get_addr2name4(ip_hdr->ip_src.s_addr, RESOLVE));
-            didsrc = 1;
-        }
-
-        /*
-         * loop while we haven't modified both src/dst AND
-         * at least one of the cidr maps have a next pointer
-         */
-        if ((! (diddst && didsrc)) &&
-            (! ((cidrmap1->next == NULL) && (cidrmap2->next == NULL)))) {
-
-            /* increment our ptr's if possible */
-            if (cidrmap1->next != NULL)
-                cidrmap1 = cidrmap1->next;
-
-            if (cidrmap2->next != NULL)
-                cidrmap2 = cidrmap2->next;
-
-        } else {
-            loop = 0;
-        }
-
-        /* Later on we should support various IP protocols which embed
-         * the IP address in the application layer.  Things like
-         * DNS and FTP.
-         */
+    /* the first matching entry of each cidrmap wins */
+    if ((cidr = cidr_map_lookup4(cidrmap2, ip_hdr->ip_dst.s_addr)) != NULL) {
+        ip_hdr->ip_dst.s_addr = remap_ipv4(tcpedit, cidr, ip_hdr->ip_dst.s_addr);
+        dbgx(2, "Remapped dst addr to: %s", get_addr2name4(ip_hdr->ip_dst.s_addr, RESOLVE));
+        diddst = 1;
+    }
+    if ((cidr = cidr_map_lookup4(cidrmap1, ip_hdr->ip_src.s_addr)) != NULL) {
+        ip_hdr->ip_src.s_addr = remap_ipv4(tcpedit, cidr, ip_hdr->ip_src.s_addr);
+        dbgx(2, "Remapped src addr to: %s", get_addr2name4(ip_hdr->ip_src.s_addr, RESOLVE));
+        didsrc = 1;
+    }
 
-    } while (loop);
+    /* Later on we should support various IP protocols which embed
+     * the IP address in the application layer.  Things like
+     * DNS and FTP.
+     */
 
     /* return how many changes we made */
     return (diddst + didsrc);
@@ -629,22 +746,23 @@ int
 rewrite_ipv6l3(tcpedit_t *tcpedit, ipv6_hdr_t *ip6_hdr, tcpr_dir_t direction)
 {
     tcpr_cidrmap_t *cidrmap1 = NULL, *cidrmap2 = NULL;
-    int didsrc = 0, diddst = 0, loop = 1;
+    tcpr_cidr_t *cidr;
+    int didsrc = 0, diddst = 0;
 
     assert(tcpedit);
     assert(ip6_hdr);
 
     /* first check the src/dst IP maps */
     if (tcpedit->srcipmap != NULL) {
-        if (ip6_in_cidr(tcpedit->srcipmap->from, &ip6_hdr->ip_src)) {
-            remap_ipv6(tcpedit, tcpedit->srcipmap->to, &ip6_hdr->ip_src);
+        if ((cidr = cidr_map_lookup6(tcpedit->srcipmap, &ip6_hdr->ip_src)) != NULL) {
+            remap_ipv6(tcpedit, cidr, &ip6_hdr->ip_src);
             dbgx(2, "Remapped src addr to: %s", get_addr2name6(&ip6_hdr->ip_src, RESOLVE));
         }
     }
 
     if (tcpedit->dstipmap != NULL) {
-        if (ip6_in_cidr(tcpedit->dstipmap->from, &ip6_hdr->ip_dst)) {
-            remap_ipv6(tcpedit, tcpedit->dstipmap->to, &ip6_hdr->ip_dst);
+        if ((cidr = cidr_map_lookup6(tcpedit->dstipmap, &ip6_hdr->ip_dst)) != NULL) {
+            remap_ipv6(tcpedit, cidr, &ip6_hdr->ip_dst);
             dbgx(2, "Remapped src addr to: %s", get_addr2name6(&ip6_hdr->ip_dst, RESOLVE));
         }
     }
@@ -663,46 +781,175 @@ rewrite_ipv6l3(tcpedit_t *tcpedit, ipv6_hdr_t *ip6_hdr, tcpr_dir_t direction)
     }
 
 
-    /* loop through the cidrmap to rewrite */
-    do {
-        if ((! diddst) && ip6_in_cidr(cidrmap2->from, &ip6_hdr->ip_dst)) {
-            remap_ipv6(tcpedit, cidrmap2->to, &ip6_hdr->ip_dst);
-            dbgx(2, "Remapped dst addr to: %s", get_addr2name6(&ip6_hdr->ip_dst, RESOLVE));
-            diddst = 1;
+    /* the first matching entry of each cidrmap wins */
+    if ((cidr = cidr_map_lookup6(cidrmap2, &ip6_hdr->ip_dst)) != NULL) {
+        remap_ipv6(tcpedit, cidr, &ip6_hdr->ip_dst);
+        dbgx(2, "Remapped dst addr to: %s", get_addr2name6(&ip6_hdr->ip_dst, RESOLVE));
+        diddst = 1;
+    }
+    if ((cidr = cidr_map_lookup6(cidrmap1, &ip6_hdr->ip_src)) != NULL) {
+        remap_ipv6(tcpedit, cidr, &ip6_hdr->ip_src);
+        dbgx(2, "Remapped src addr to: %s", get_addr2name6(&ip6_hdr->ip_src, RESOLVE));
+        didsrc = 1;
+    }
+
+    /* Later on we should support various IP protocols which embed
+     * the IP address in the application layer.  Things like
+     * DNS and FTP.
+     */
+
+    /* return how many changes we made */
+    return (diddst + didsrc);
+}
+
+/**
+ * runs all the enabled rewrites (--srcipmap/--dstipmap, --pnat/--endpoints
+ * and --seed) on a single IPv4 address, in the same order as 
+ * rewrite_ipv4l3() followed by randomize_ipv4().  Returns the number of
+ * changes made.
+ */
+static int
+map_ipv4_addr(tcpedit_t *tcpedit, uint32_t *ip, bool src, tcpr_dir_t direction)
+{
+    tcpr_cidrmap_t *cidrmap;
+    tcpr_cidr_t *cidr;
+    int changes = 0;
+
+    if (tcpedit->rewrite_ip) {
+        cidrmap = src ? tcpedit->srcipmap : tcpedit->dstipmap;
+        if ((cidr = cidr_map_lookup4(cidrmap, *ip)) != NULL) {
+            *ip = remap_ipv4(tcpedit, cidr, *ip);
+            changes++;
         }
-        if ((! didsrc) && ip6_in_cidr(cidrmap1->from, &ip6_hdr->ip_src)) {
-            remap_ipv6(tcpedit, cidrmap1->to, &ip6_hdr->ip_src);
-            dbgx(2, "Remapped src addr to: %s", get_addr2name6(&ip6_hdr->ip_src, RESOLVE));
-            didsrc = 1;
+
+        /* source is mapped with cidrmap1 for C2S and cidrmap2 for S2C */
+        if (tcpedit->cidrmap1 != NULL) {
+            cidrmap = (src == (direction == TCPR_DIR_C2S)) ? tcpedit->cidrmap1 : tcpedit->cidrmap2;
+            if ((cidr = cidr_map_lookup4(cidrmap, *ip)) != NULL) {
+                *ip = remap_ipv4(tcpedit, cidr, *ip);
+                changes++;
+            }
         }
+    }
 
-        /*
-         * loop while we haven't modified both src/dst AND
-         * at least one of the cidr maps have a next pointer
-         */
-        if ((! (diddst && didsrc)) &&
-            (! ((cidrmap1->next == NULL) && (cidrmap2->next == NULL)))) {
+    if (tcpedit->seed) {
+        *ip = randomize_ipv4_addr(tcpedit, *ip);
+        changes++;
+    }
 
-            /* increment our ptr's if possible */
-            if (cidrmap1->next != NULL)
-                cidrmap1 = cidrmap1->next;
+    return changes;
+}
 
-            if (cidrmap2->next != NULL)
-                cidrmap2 = cidrmap2->next;
+static int
+map_ipv6_addr(tcpedit_t *tcpedit, struct tcpr_in6_addr *addr, bool src, tcpr_dir_t direction)
+{
+    tcpr_cidrmap_t *cidrmap;
+    tcpr_cidr_t *cidr;
+    int changes = 0;
+
+    if (tcpedit->rewrite_ip) {
+        cidrmap = src ? tcpedit->srcipmap : tcpedit->dstipmap;
+        if ((cidr = cidr_map_lookup6(cidrmap, addr)) != NULL) {
+            remap_ipv6(tcpedit, cidr, addr);
+            changes++;
+        }
 
-        } else {
-            loop = 0;
+        if (tcpedit->cidrmap1 != NULL) {
+            cidrmap = (src == (direction == TCPR_DIR_C2S)) ? tcpedit->cidrmap1 : tcpedit->cidrmap2;
+            if ((cidr = cidr_map_lookup6(cidrmap, addr)) != NULL) {
+                remap_ipv6(tcpedit, cidr, addr);
+                changes++;
+            }
         }
+    }
 
-        /* Later on we should support various IP protocols which embed
-         * the IP address in the application layer.  Things like
-         * DNS and FTP.
-         */
+    if (tcpedit->seed) {
+        if (!tcpedit->skip_broadcast || !is_multicast_ipv6(tcpedit, addr))
+            randomize_ipv6_addr(tcpedit, addr);
+        changes++;
+    }
 
-    } while (loop);
+    return changes;
+}
 
-    /* return how many changes we made */
-    return (diddst + didsrc);
+static inline u_int8_t
+addr_cache_flags(bool ipv6, bool src, tcpr_dir_t direction)
+{
+    return ADDR_CACHE_USED | (ipv6 ? ADDR_CACHE_IPV6 : 0) |
+        (src ? ADDR_CACHE_SRC : 0) | (direction == TCPR_DIR_S2C ? ADDR_CACHE_S2C : 0);
+}
+
+/**
+ * rewrites the IPv4 source & destination address for all of the enabled
+ * address rewrites, remembering the results in the address cache.
+ * return 0 if no change, > 0 if changed
+ */
+int
+rewrite_ipv4_addrs(tcpedit_t *tcpedit, ipv4_hdr_t *ip_hdr, tcpr_dir_t direction)
+{
+    tcpedit_addr_cache_t *cache;
+    uint32_t orig;
+    u_int8_t flags;
+    int changes, total = 0;
+
+    assert(tcpedit);
+    assert(ip_hdr);
+    cache = &tcpedit->runtime.addr_cache;
+
+    flags = addr_cache_flags(false, false, direction);
+    if (! addr_cache_lookup(cache, flags, &ip_hdr->ip_dst.s_addr, &ip_hdr->ip_dst.s_addr, &changes)) {
+        orig = ip_hdr->ip_dst.s_addr;
+        changes = map_ipv4_addr(tcpedit, &ip_hdr->ip_dst.s_addr, false, direction);
+        addr_cache_insert(cache, flags, &orig, &ip_hdr->ip_dst.s_addr, changes);
+    }
+    total += changes;
+
+    flags = addr_cache_flags(false, true, direction);
+    if (! addr_cache_lookup(cache, flags, &ip_hdr->ip_src.s_addr, &ip_hdr->ip_src.s_addr, &changes)) {
+        orig = ip_hdr->ip_src.s_addr;
+        changes = map_ipv4_addr(tcpedit, &ip_hdr->ip_src.s_addr, true, direction);
+        addr_cache_insert(cache, flags, &orig, &ip_hdr->ip_src.s_addr, changes);
+    }
+    total += changes;
+
+    dbgx(2, "Rewrote src/dst addrs to: %s/%s", get_addr2name4(ip_hdr->ip_src.s_addr, RESOLVE),
+            get_addr2name4(ip_hdr->ip_dst.s_addr, RESOLVE));
+    return total;
+}
+
+int
+rewrite_ipv6_addrs(tcpedit_t *tcpedit, ipv6_hdr_t *ip6_hdr, tcpr_dir_t direction)
+{
+    tcpedit_addr_cache_t *cache;
+    struct tcpr_in6_addr orig;
+    u_int8_t flags;
+    int changes, total = 0;
+
+    assert(tcpedit);
+    assert(ip6_hdr);
+    cache = &tcpedit->runtime.addr_cache;
+
+    flags = addr_cache_flags(true, false, direction);
+    if (! addr_cache_lookup(cache, flags, ip6_hdr->ip_dst.tcpr_s6_addr32,
+            ip6_hdr->ip_dst.tcpr_s6_addr32, &changes)) {
+        orig = ip6_hdr->ip_dst;
+        changes = map_ipv6_addr(tcpedit, &ip6_hdr->ip_dst, false, direction);
+        addr_cache_insert(cache, flags, orig.tcpr_s6_addr32, ip6_hdr->ip_dst.tcpr_s6_addr32, changes);
+    }
+    total += changes;
+
+    flags = addr_cache_flags(true, true, direction);
+    if (! addr_cache_lookup(cache, flags, ip6_hdr->ip_src.tcpr_s6_addr32,
+            ip6_hdr->ip_src.tcpr_s6_addr32, &changes)) {
+        orig = ip6_hdr->ip_src;
+        changes = map_ipv6_addr(tcpedit, &ip6_hdr->ip_src, true, direction);
+        addr_cache_insert(cache, flags, orig.tcpr_s6_addr32, ip6_hdr->ip_src.tcpr_s6_addr32, changes);
+    }
+    total += changes;
+
+    dbgx(2, "Rewrote src addr to: %s", get_addr2name6(&ip6_hdr->ip_src, RESOLVE));
+    dbgx(2, "Rewrote dst addr to: %s", get_addr2name6(&ip6_hdr->ip_dst, RESOLVE));
+    return total;
 }
 
 /**
@@ -763,7 +1010,8 @@ rewrite_iparp(tcpedit_t *tcpedit, arp_hdr_t *arp_hdr, int cache_mode)
     uint32_t *ip1 = NULL, *ip2 = NULL;
     uint32_t newip = 0;
     tcpr_cidrmap_t *cidrmap1 = NULL, *cidrmap2 = NULL;
-    int didsrc = 0, diddst = 0, loop = 1;
+    tcpr_cidr_t *cidr;
+    int didsrc = 0, diddst = 0;
 #ifdef FORCE_ALIGN
     uint32_t iptemp;
 #endif
@@ -807,59 +1055,38 @@ rewrite_iparp(tcpedit_t *tcpedit, arp_hdr_t *arp_hdr, int cache_mode)
 #endif
         
 
-        /* loop through the cidrmap to rewrite */
-        do {
-            /* arp request ? */
-            if (ntohs(arp_hdr->ar_op) == ARPOP_REQUEST) {
-                if ((!diddst) && ip_in_cidr(cidrmap2->from, *ip1)) {
-                    newip = remap_ipv4(tcpedit, cidrmap2->to, *ip1);
-                    memcpy(ip1, &newip, 4);
-                    diddst = 1;
-                }
-                if ((!didsrc) && ip_in_cidr(cidrmap1->from, *ip2)) {
-                    newip = remap_ipv4(tcpedit, cidrmap1->to, *ip2);
-                    memcpy(ip2, &newip, 4);
-                    didsrc = 1;
-                }
-            } 
-            /* else it's an arp reply */
-            else {
-                if ((!diddst) && ip_in_cidr(cidrmap2->from, *ip2)) {
-                    newip = remap_ipv4(tcpedit, cidrmap2->to, *ip2);
-                    memcpy(ip2, &newip, 4);
-                    diddst = 1;
-                }
-                if ((!didsrc) && ip_in_cidr(cidrmap1->from, *ip1)) {
-                    newip = remap_ipv4(tcpedit, cidrmap1->to, *ip1);
-                    memcpy(ip1, &newip, 4);
-                    didsrc = 1;
-                }
+        /* the first matching entry of each cidrmap wins */
+        /* arp request ? */
+        if (ntohs(arp_hdr->ar_op) == ARPOP_REQUEST) {
+            if ((cidr = cidr_map_lookup4(cidrmap2, *ip1)) != NULL) {
+                newip = remap_ipv4(tcpedit, cidr, *ip1);
+                memcpy(ip1, &newip, 4);
+                diddst = 1;
+            }
+            if ((cidr = cidr_map_lookup4(cidrmap1, *ip2)) != NULL) {
+                newip = remap_ipv4(tcpedit, cidr, *ip2);
+                memcpy(ip2, &newip, 4);
+                didsrc = 1;
             }
+        } 
+        /* else it's an arp reply */
+        else {
+            if ((cidr = cidr_map_lookup4(cidrmap2, *ip2)) != NULL) {
+                newip = remap_ipv4(tcpedit, cidr, *ip2);
+                memcpy(ip2, &newip, 4);
+                diddst = 1;
+            }
+            if ((cidr = cidr_map_lookup4(cidrmap1, *ip1)) != NULL) {
+                newip = remap_ipv4(tcpedit, cidr, *ip1);
+                memcpy(ip1, &newip, 4);
+                didsrc = 1;
+            }
+        }
 
 #ifdef FORCE_ALIGN
-            /* copy temporary IP to IP2 location in buffer */
-            memcpy(add_hdr, &iptemp, sizeof(uint32_t));
+        /* copy temporary IP to IP2 location in buffer */
+        memcpy(add_hdr, &iptemp, sizeof(uint32_t));
 #endif
-
-            /*
-             * loop while we haven't modified both src/dst AND
-             * at least one of the cidr maps have a next pointer
-             */
-            if ((! (diddst && didsrc)) &&
-                (! ((cidrmap1->next == NULL) && (cidrmap2->next == NULL)))) {
-                
-                /* increment our ptr's if possible */
-                if (cidrmap1->next != NULL)
-                    cidrmap1 = cidrmap1->next;
-                
-                if (cidrmap2->next != NULL)
-                    cidrmap2 = cidrmap2->next;
-                
-            } else {
-                loop = 0;
-            }
-
-        } while (loop);
         
     } else {
         warn("ARP packet isn't for IPv4!  Can't rewrite IP's");
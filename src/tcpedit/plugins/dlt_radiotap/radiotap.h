@@ -42,6 +42,7 @@ u_char *dlt_radiotap_get_mac(tcpeditdlt_t *ctx, tcpeditdlt_mac_type_t mac, const
  * Example: Ethernet VLAN tag info
  */
 struct radiotap_extra_s {
+    COUNTER lastpacket;         /* packet # copied into packet */
     u_char packet[MAXPACKET];
 };
 typedef struct radiotap_extra_s radiotap_extra_t;
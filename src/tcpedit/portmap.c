@@ -271,6 +271,46 @@ map_port(tcpedit_portmap_t *portmap_data, long port)
     return(newport);
 }
 
+/**
+ * \brief Compiles a portmap chain into a 65536 entry lookup table
+ *
+ * The table is indexed by the port in network byte order and holds the
+ * new port (also in network byte order), so a lookup is a single array
+ * load.  Later entries override earlier ones, just like map_port().
+ * Caller is responsible for freeing the table.
+ */
+u_int16_t *
+compile_portmap(tcpedit_portmap_t *portmap_data)
+{
+    tcpedit_portmap_t *portmap_ptr;
+    u_int16_t *table;
+    u_int32_t i;
+
+    assert(portmap_data);
+
+    table = (u_int16_t *)safe_malloc(sizeof(u_int16_t) * 65536);
+    for (i = 0; i < 65536; i++)
+        table[i] = (u_int16_t)i;
+
+    for (portmap_ptr = portmap_data; portmap_ptr != NULL; portmap_ptr = portmap_ptr->next)
+        table[(u_int16_t)portmap_ptr->from] = (u_int16_t)portmap_ptr->to;
+
+    return table;
+}
+
+/**
+ * returns the new port for the given port, via the compiled table if
+ * tcpedit_validate() has built one
+ */
+static inline u_int16_t
+lookup_port(tcpedit_t *tcpedit, u_int16_t port)
+{
+    if (tcpedit->portmap_table != NULL)
+        return tcpedit->portmap_table[port];
+
+    return (u_int16_t)map_port(tcpedit->portmap, port);
+}
+
 /**
  * rewrites the TCP or UDP ports based on a portmap
  * returns 1 for changes made or 0 for none
@@ -283,24 +323,22 @@ rewrite_ports(tcpedit_t *tcpedit, u_char protocol, u_char *layer4)
     udp_hdr_t *udp_hdr = NULL;
     int changes = 0;
     uint16_t newport;
-    tcpedit_portmap_t *portmap;
 
     assert(tcpedit);
     assert(tcpedit->portmap);
-    portmap = tcpedit->portmap;
 
     if (protocol == IPPROTO_TCP) {
         tcp_hdr = (tcp_hdr_t *)layer4;
 
         /* check if we need to remap the destination port */
-        newport = map_port(portmap, tcp_hdr->th_dport);
+        newport = lookup_port(tcpedit, tcp_hdr->th_dport);
         if (newport != tcp_hdr->th_dport) {
             tcp_hdr->th_dport = newport;
             changes ++;
         }
 
         /* check if we need to remap the source port */
-        newport = map_port(portmap, tcp_hdr->th_sport);
+        newport = lookup_port(tcpedit, tcp_hdr->th_sport);
         if (newport != tcp_hdr->th_sport) {
             tcp_hdr->th_sport = newport;
             changes ++;
@@ -310,14 +348,14 @@ rewrite_ports(tcpedit_t *tcpedit, u_char protocol, u_char *layer4)
         udp_hdr = (udp_hdr_t *)layer4;
 
         /* check if we need to remap the destination port */
-        newport = map_port(portmap, udp_hdr->uh_dport);
+        newport = lookup_port(tcpedit, udp_hdr->uh_dport);
         if (newport != udp_hdr->uh_dport) {
             udp_hdr->uh_dport = newport;
             changes ++;
         }
 
         /* check if we need to remap the source port */
-        newport = map_port(portmap, udp_hdr->uh_sport);
+        newport = lookup_port(tcpedit, udp_hdr->uh_sport);
         if (newport != udp_hdr->uh_sport) {
             udp_hdr->uh_sport = newport;
             changes ++;
@@ -358,6 +396,25 @@ rewrite_ipv6_ports(tcpedit_t *tcpedit, ipv6_hdr_t **ip6_hdr)
     return 0;
 }
 
+/**
+ * rewrites the TCP or UDP ports of a packet already parsed by
+ * decode_packet(), so the L4 header doesn't have to be found again
+ */
+int
+rewrite_packet_ports(tcpedit_t *tcpedit, const tcpedit_packet_t *pkt)
+{
+    assert(tcpedit);
+    assert(pkt);
+
+    if (pkt->l4data == NULL)
+        return 0;
+
+    if (pkt->l4proto == IPPROTO_TCP || pkt->l4proto == IPPROTO_UDP)
+        return rewrite_ports(tcpedit, pkt->l4proto, pkt->l4data);
+
+    return 0;
+}
+
 /*
  Local Variables:
  mode:c
@@ -27,8 +27,10 @@ int parse_portmap(tcpedit_portmap_t **portmapdata, const char *ourstr);
 void free_portmap(tcpedit_portmap_t *portmap);
 void print_portmap(tcpedit_portmap_t *portmap);
 long map_port(tcpedit_portmap_t *portmap , long port);
+u_int16_t *compile_portmap(tcpedit_portmap_t *portmap);
 int rewrite_ipv4_ports(tcpedit_t *tcpedit, ipv4_hdr_t **ip_hdr);
 int rewrite_ipv6_ports(tcpedit_t *tcpedit, ipv6_hdr_t **ip_hdr);
+int rewrite_packet_ports(tcpedit_t *tcpedit, const tcpedit_packet_t *pkt);
 
 #endif
 
@@ -31,6 +31,7 @@
 
 #include "tcpedit_stub.h"
 #include "portmap.h"
+#include "addr_cache.h"
 #include "common.h"
 #include "edit_packet.h"
 #include "parse_args.h"
@@ -67,38 +68,39 @@ tcpedit_checkdir(tcpedit_t *tcpedit, tcpr_dir_t direction)
 }
 
 
+/*
+ * per packet state carried from one tcpedit_packet() stage to the next
+ */
+typedef struct {
+    tcpedit_packet_t pkt;
+    csum_snapshot_t snap;
+    int dst_dlt;
+    int needtorecalc;               /* did the packet change? if so, checksum */
+    bool fullcsum;                  /* ...from scratch rather then incrementally */
+    int retval;
+} tcpedit_pktstate_t;
+
 /**
- * \brief Edit the given packet
+ * \brief First stage of tcpedit_packet(): rewrites Layer 2
  *
- * Processs a given packet and edit the pkthdr/pktdata structures
- * according to the rules in tcpedit
- * Returns: TCPEDIT_ERROR on error
- *          TCPEDIT_SOFT_ERROR on remove packet
- *          0 on no change
- *          1 on change
+ * Also parses the L3/L4 headers of the (rewritten) packet and takes the
+ * checksum snapshot for the later stages.
+ * Returns TCPEDIT_OK, TCPEDIT_SOFT_ERROR or TCPEDIT_ERROR
  */
-int
-tcpedit_packet(tcpedit_t *tcpedit, struct pcap_pkthdr **pkthdr,
-        u_char **pktdata, tcpr_dir_t direction)
+static int
+tcpedit_packet_l2(tcpedit_t *tcpedit, tcpedit_pktstate_t *state, 
+        struct pcap_pkthdr *pkthdr, u_char **pktdata, tcpr_dir_t direction)
 {
-    ipv4_hdr_t *ip_hdr = NULL;
-    ipv6_hdr_t *ip6_hdr = NULL;
-    arp_hdr_t *arp_hdr = NULL;
-    int l2len = 0, l2proto, retval = 0, dst_dlt, src_dlt, pktlen, lendiff;
-    int ipflags = 0, tclass = 0;
-    int needtorecalc = 0;           /* did the packet change? if so, checksum */
-    u_char *packet = *pktdata;
-    assert(tcpedit);
-    assert(pkthdr);
-    assert(*pkthdr);
-    assert(pktdata);
-    assert(packet);
-    assert(tcpedit->validated);
+    u_char *l3data = NULL;
+    int l2len, l2proto, src_dlt, pktlen, lendiff;
 
+    state->needtorecalc = 0;
+    state->fullcsum = tcpedit->fixcsum;
+    state->retval = 0;
 
     tcpedit->runtime.packetnum++;
     dbgx(3, "packet " COUNTER_SPEC " caplen %d", 
-            tcpedit->runtime.packetnum, (*pkthdr)->caplen);
+            tcpedit->runtime.packetnum, pkthdr->caplen);
 
 
     /*
@@ -108,21 +110,21 @@ tcpedit_packet(tcpedit_t *tcpedit, struct pcap_pkthdr **pkthdr,
      * just removed 2 bytes of ACTUAL PACKET DATA.  Sucks to be them.
      */
     if (tcpedit->efcs > 0) {
-        (*pkthdr)->caplen -= 4;
-        (*pkthdr)->len -= 4;
+        pkthdr->caplen -= 4;
+        pkthdr->len -= 4;
     }
 
     src_dlt = tcpedit_dlt_src(tcpedit->dlt_ctx);
     
     /* not everything has a L3 header, so check for errors.  returns proto in network byte order */
-    if ((l2proto = tcpedit_dlt_proto(tcpedit->dlt_ctx, src_dlt, packet, (*pkthdr)->caplen)) < 0) {
+    if ((l2proto = tcpedit_dlt_proto(tcpedit->dlt_ctx, src_dlt, *pktdata, pkthdr->caplen)) < 0) {
         dbg(2, "Packet has no L3+ header");
     } else {
         dbgx(2, "Layer 3 protocol type is: 0x%04x", ntohs(l2proto));
     }
         
     /* rewrite Layer 2 */
-    if ((pktlen = tcpedit_dlt_process(tcpedit->dlt_ctx, pktdata, (*pkthdr)->caplen, direction)) == TCPEDIT_ERROR)
+    if ((pktlen = tcpedit_dlt_process(tcpedit->dlt_ctx, pktdata, pkthdr->caplen, direction)) == TCPEDIT_ERROR)
         errx(-1, "%s", tcpedit_geterr(tcpedit));
 
     /* unable to edit packet, most likely 802.11 management or data QoS frame */
@@ -132,32 +134,69 @@ tcpedit_packet(tcpedit_t *tcpedit, struct pcap_pkthdr **pkthdr,
     }
 
     /* update our packet lengths (real/captured) based on L2 length changes */
-    lendiff = pktlen - (*pkthdr)->caplen;
-    (*pkthdr)->caplen += lendiff;
-    (*pkthdr)->len += lendiff;
+    lendiff = pktlen - pkthdr->caplen;
+    pkthdr->caplen += lendiff;
+    pkthdr->len += lendiff;
     
-    dst_dlt = tcpedit_dlt_dst(tcpedit->dlt_ctx);
-    l2len = tcpedit_dlt_l2len(tcpedit->dlt_ctx, dst_dlt, packet, (*pkthdr)->caplen);
+    state->dst_dlt = tcpedit_dlt_dst(tcpedit->dlt_ctx);
+    l2len = tcpedit_dlt_l2len(tcpedit->dlt_ctx, state->dst_dlt, *pktdata, pkthdr->caplen);
 
-    dbgx(2, "dst_dlt = %04x\tsrc_dlt = %04x\tproto = %04x\tl2len = %d", dst_dlt, src_dlt, ntohs(l2proto), l2len);
+    dbgx(2, "dst_dlt = %04x\tsrc_dlt = %04x\tproto = %04x\tl2len = %d", state->dst_dlt, src_dlt, ntohs(l2proto), l2len);
 
     /* does packet have an IP header?  if so set our pointer to it */
-    if (l2proto == htons(ETHERTYPE_IP)) {
-        ip_hdr = (ipv4_hdr_t *)tcpedit_dlt_l3data(tcpedit->dlt_ctx, dst_dlt, packet, (*pkthdr)->caplen);
-        if (ip_hdr == NULL) {
+    if (l2proto == htons(ETHERTYPE_IP) || l2proto == htons(ETHERTYPE_IP6)) {
+        l3data = tcpedit_dlt_l3data(tcpedit->dlt_ctx, state->dst_dlt, *pktdata, pkthdr->caplen);
+        if (l3data == NULL) {
             return TCPEDIT_ERROR;
         }        
-        dbgx(3, "Packet has an IPv4 header: %p...", ip_hdr);
-    } else if (l2proto == htons(ETHERTYPE_IP6)) {
-        ip6_hdr = (ipv6_hdr_t *)tcpedit_dlt_l3data(tcpedit->dlt_ctx, dst_dlt, packet, (*pkthdr)->caplen);
-        if (ip6_hdr == NULL) {
-            return TCPEDIT_ERROR;
-        }
-        dbgx(3, "Packet has an IPv6 header: %p...", ip6_hdr);
+        dbgx(3, "Packet has an IPv%d header: %p...", 
+                l2proto == htons(ETHERTYPE_IP) ? 4 : 6, l3data);
     } else {
         dbgx(3, "Packet isn't IPv4 or IPv6: 0x%04x", l2proto);
-        /* non-IP packets have a NULL ip_hdr struct */
-        ip_hdr = NULL;
+    }
+
+    /* find the L4 header once, every stage below works off of pkt */
+    decode_packet(&state->pkt, l2len, l2proto, l3data, pkthdr->caplen - l2len);
+
+    /* remember the checksummed fields, so edits to them can be patched in */
+    if (state->pkt.l3data != NULL) {
+        checksum_snapshot(&state->snap, state->pkt.l3data,
+                (tcpedit->portmap != NULL && state->pkt.l4data != NULL &&
+                 (state->pkt.l4proto == IPPROTO_TCP || state->pkt.l4proto == IPPROTO_UDP)) ?
+                state->pkt.l4data : NULL);
+
+        /* v6-in-v6 L4 checksums don't cover the outer addresses */
+        if (state->pkt.tunnel)
+            state->fullcsum = true;
+    }
+
+#ifdef STUPID_SOLARIS_CHECKSUM_BUG
+    state->fullcsum = true;
+#endif
+
+    return TCPEDIT_OK;
+}
+
+/**
+ * \brief Second stage of tcpedit_packet(): edits Layer 3 & 4 headers
+ *
+ * Returns TCPEDIT_OK or TCPEDIT_ERROR
+ */
+static int
+tcpedit_packet_l3(tcpedit_t *tcpedit, tcpedit_pktstate_t *state, 
+        struct pcap_pkthdr *pkthdr, u_char *packet, tcpr_dir_t direction)
+{
+    ipv4_hdr_t *ip_hdr = NULL;
+    ipv6_hdr_t *ip6_hdr = NULL;
+    arp_hdr_t *arp_hdr = NULL;
+    int retval, ipflags = 0, tclass = 0;
+
+    if (state->pkt.l3data != NULL) {
+        if (state->pkt.ipv6) {
+            ip6_hdr = (ipv6_hdr_t *)state->pkt.l3data;
+        } else {
+            ip_hdr = (ipv4_hdr_t *)state->pkt.l3data;
+        }
     }
 
     /* The following edits only apply for IPv4 */
@@ -166,23 +205,24 @@ tcpedit_packet(tcpedit_t *tcpedit, struct pcap_pkthdr **pkthdr,
         /* set TOS ? */
         if (tcpedit->tos > -1) {
             ip_hdr->ip_tos = tcpedit->tos;
-            needtorecalc += 1;
+            state->needtorecalc += 1;
         }
             
         /* rewrite the TTL */
-        needtorecalc += rewrite_ipv4_ttl(tcpedit, ip_hdr);
+        state->needtorecalc += rewrite_ipv4_ttl(tcpedit, ip_hdr);
 
         /* rewrite TCP/UDP ports */
         if (tcpedit->portmap != NULL) {
-            if ((retval = rewrite_ipv4_ports(tcpedit, &ip_hdr)) < 0)
+            if ((retval = rewrite_packet_ports(tcpedit, &state->pkt)) < 0)
                 return TCPEDIT_ERROR;
-            needtorecalc += retval;
+            state->needtorecalc += retval;
+            state->retval = retval;
         }
     }
     /* IPv6 edits */
     else if (ip6_hdr != NULL) {
         /* rewrite the hop limit */
-        needtorecalc += rewrite_ipv6_hlim(tcpedit, ip6_hdr);
+        state->needtorecalc += rewrite_ipv6_hlim(tcpedit, ip6_hdr);
 
         /* set traffic class? */
         if (tcpedit->tclass > -1) {
@@ -199,7 +239,7 @@ tcpedit_packet(tcpedit_t *tcpedit, struct pcap_pkthdr **pkthdr,
             ipflags += tclass; 
             ipflags = htonl(ipflags);
             memcpy(&ip6_hdr->ip_flags, &ipflags, 4);
-            needtorecalc ++;
+            state->needtorecalc ++;
         }
 
         /* set the flow label? */
@@ -209,40 +249,47 @@ tcpedit_packet(tcpedit_t *tcpedit, struct pcap_pkthdr **pkthdr,
             ipflags += tcpedit->flowlabel;
             ipflags = htonl(ipflags);
             memcpy(&ip6_hdr->ip_flags, &ipflags, 4);
-            needtorecalc ++;
+            state->needtorecalc ++;
         }
 
         /* rewrite TCP/UDP ports */
         if (tcpedit->portmap != NULL) {
-            if ((retval = rewrite_ipv6_ports(tcpedit, &ip6_hdr)) < 0)
+            if ((retval = rewrite_packet_ports(tcpedit, &state->pkt)) < 0)
                 return TCPEDIT_ERROR;
-            needtorecalc += retval;
+            state->needtorecalc += retval;
+            state->retval = retval;
         }
     }
 
     /* (Un)truncate or MTU truncate packet? */
     if (tcpedit->fixlen || tcpedit->mtu_truncate) {
-        if ((retval = untrunc_packet(tcpedit, *pkthdr, packet, ip_hdr, ip6_hdr)) < 0)
+        if ((retval = untrunc_packet(tcpedit, pkthdr, packet, &state->pkt)) < 0)
             return TCPEDIT_ERROR;
-        needtorecalc += retval;
+        state->needtorecalc += retval;
+        state->retval = retval;
+
+        /* the length changed, so the checksums have to be redone */
+        if (retval > 0)
+            state->fullcsum = true;
     }
     
-    /* rewrite IP addresses in IPv4/IPv6 or ARP */
-    if (tcpedit->rewrite_ip) {
-        /* IP packets */
+    /* 
+     * rewrite & spoof (--seed) IP addresses in IPv4/IPv6, going through the
+     * address cache so we only do the work once per address
+     */
+    if (tcpedit->rewrite_ip || tcpedit->seed) {
         if (ip_hdr != NULL) {
-            if ((retval = rewrite_ipv4l3(tcpedit, ip_hdr, direction)) < 0)
-                return TCPEDIT_ERROR;
-            needtorecalc += retval;
+            state->needtorecalc += rewrite_ipv4_addrs(tcpedit, ip_hdr, direction);
         } else if (ip6_hdr != NULL) {
-            if ((retval = rewrite_ipv6l3(tcpedit, ip6_hdr, direction)) < 0)
-                return TCPEDIT_ERROR;
-            needtorecalc += retval;
+            state->needtorecalc += rewrite_ipv6_addrs(tcpedit, ip6_hdr, direction);
         }
+    }
 
+    /* rewrite IP addresses in ARP */
+    if (tcpedit->rewrite_ip && ip_hdr == NULL && ip6_hdr == NULL) {
         /* ARP packets */
-        else if (l2proto == htons(ETHERTYPE_ARP)) {
-            arp_hdr = (arp_hdr_t *)&(packet[l2len]);
+        if (state->pkt.l2proto == htons(ETHERTYPE_ARP)) {
+            arp_hdr = (arp_hdr_t *)&(packet[state->pkt.l2len]);
             /* unlike, rewrite_ipl3, we don't care if the packet changed
              * because we never need to recalc the checksums for an ARP
              * packet.  So ignore the return value
@@ -253,56 +300,161 @@ tcpedit_packet(tcpedit_t *tcpedit, struct pcap_pkthdr **pkthdr,
     }
 
 
-    /* do we need to spoof the src/dst IP address in IPv4 or ARP? */
-    if (tcpedit->seed) {
-        /* IPv4 Packets */
-        if (ip_hdr != NULL) {
-            if ((retval = randomize_ipv4(tcpedit, *pkthdr, packet, 
-                    ip_hdr)) < 0)
-                return TCPEDIT_ERROR;
-            needtorecalc += retval;
-
-        } else if (ip6_hdr != NULL) {
-            if ((retval = randomize_ipv6(tcpedit, *pkthdr, packet,
-                    ip6_hdr)) < 0)
-                return TCPEDIT_ERROR;
-            needtorecalc += retval;
-
+    /* do we need to spoof the src/dst IP address in ARP? */
+    if (tcpedit->seed && ip_hdr == NULL && ip6_hdr == NULL) {
         /* ARP packets */
-        } else if (l2proto == htons(ETHERTYPE_ARP)) {
+        if (state->pkt.l2proto == htons(ETHERTYPE_ARP)) {
             if (direction == TCPR_DIR_C2S) {
-                if (randomize_iparp(tcpedit, *pkthdr, packet, 
+                if (randomize_iparp(tcpedit, pkthdr, packet, 
                         tcpedit->runtime.dlt1) < 0)
                     return TCPEDIT_ERROR;
             } else {
-                if (randomize_iparp(tcpedit, *pkthdr, packet, 
+                if (randomize_iparp(tcpedit, pkthdr, packet, 
                         tcpedit->runtime.dlt2) < 0)
                     return TCPEDIT_ERROR;
             }
         }
     }
 
-    /* do we need to fix checksums? -- must always do this last! */
-    if ((tcpedit->fixcsum || needtorecalc)) {
-        if (ip_hdr != NULL) {
-            retval = fix_ipv4_checksums(tcpedit, *pkthdr, ip_hdr);
-        } else if (ip6_hdr != NULL) {
-            retval = fix_ipv6_checksums(tcpedit, *pkthdr, ip6_hdr);
+    return TCPEDIT_OK;
+}
+
+/**
+ * \brief Last stage of tcpedit_packet(): fixes the checksums
+ *
+ * Returns TCPEDIT_ERROR on error, otherwise what tcpedit_packet() returns
+ */
+static int
+tcpedit_packet_csum(tcpedit_t *tcpedit, tcpedit_pktstate_t *state, 
+        struct pcap_pkthdr *pkthdr, u_char *packet)
+{
+    tcpedit_packet_t *pkt = &state->pkt;
+    const csum_snapshot_t *snap = state->fullcsum ? NULL : &state->snap;
+
+    /*
+     * do we need to fix checksums? -- must always do this last!
+     * Header only edits are patched in (RFC 1624), which keeps them O(1)
+     * no matter how big the packet is
+     */
+    if ((tcpedit->fixcsum || state->needtorecalc)) {
+        if (pkt->l3data == NULL) {
+            state->retval = TCPEDIT_OK;
+        } else if (pkt->ipv6) {
+            state->retval = fix_ipv6_checksums(tcpedit, pkthdr, pkt, snap);
         } else {
-            retval = TCPEDIT_OK;
+            state->retval = fix_ipv4_checksums(tcpedit, pkthdr, pkt, snap);
         }
-        if (retval < 0) {
+        if (state->retval < 0) {
             return TCPEDIT_ERROR;
-        } else if (retval == TCPEDIT_WARN) {
+        } else if (state->retval == TCPEDIT_WARN) {
             warnx("%s", tcpedit_getwarn(tcpedit));
         }
     }
 
-    tcpedit_dlt_merge_l3data(tcpedit->dlt_ctx, dst_dlt, packet, (*pkthdr)->caplen, (u_char *)ip_hdr);
+    tcpedit_dlt_merge_l3data(tcpedit->dlt_ctx, state->dst_dlt, packet, pkthdr->caplen, pkt->l3data);
 
-    tcpedit->runtime.total_bytes += (*pkthdr)->caplen;
+    tcpedit->runtime.total_bytes += pkthdr->caplen;
     tcpedit->runtime.pkts_edited ++;
-    return retval;
+    return state->retval;
+}
+
+/**
+ * \brief Edit the given packet
+ *
+ * Processs a given packet and edit the pkthdr/pktdata structures
+ * according to the rules in tcpedit
+ * Returns: TCPEDIT_ERROR on error
+ *          TCPEDIT_SOFT_ERROR on remove packet
+ *          0 on no change
+ *          1 on change
+ */
+int
+tcpedit_packet(tcpedit_t *tcpedit, struct pcap_pkthdr **pkthdr,
+        u_char **pktdata, tcpr_dir_t direction)
+{
+    tcpedit_pktstate_t state;
+    int rcode;
+    assert(tcpedit);
+    assert(pkthdr);
+    assert(*pkthdr);
+    assert(pktdata);
+    assert(*pktdata);
+    assert(tcpedit->validated);
+
+    if ((rcode = tcpedit_packet_l2(tcpedit, &state, *pkthdr, pktdata, direction)) != TCPEDIT_OK)
+        return rcode;
+
+    if (tcpedit_packet_l3(tcpedit, &state, *pkthdr, *pktdata, direction) < 0)
+        return TCPEDIT_ERROR;
+
+    return tcpedit_packet_csum(tcpedit, &state, *pkthdr, *pktdata);
+}
+
+/**
+ * \brief Edit a batch of packets
+ *
+ * Same as calling tcpedit_packet() on each of the count packets, but each
+ * stage (L2, L3/L4, checksums) is run over the whole batch before the next
+ * one, which keeps the code for each stage hot.  The result of each packet
+ * (as tcpedit_packet() would return it) is stored in results.
+ * Returns TCPEDIT_ERROR if any packet had an error, otherwise TCPEDIT_OK
+ */
+int
+tcpedit_packet_batch(tcpedit_t *tcpedit, struct pcap_pkthdr **pkthdrs,
+        u_char **pktdata, const tcpr_dir_t *directions, int *results, int count)
+{
+#ifndef FORCE_ALIGN
+    tcpedit_pktstate_t state[TCPEDIT_BATCH_MAX];
+    int base, n;
+#endif
+    int i, ret = TCPEDIT_OK;
+    assert(tcpedit);
+    assert(pkthdrs);
+    assert(pktdata);
+    assert(directions);
+    assert(results);
+    assert(count >= 0);
+    assert(tcpedit->validated);
+
+#ifdef FORCE_ALIGN
+    /* 
+     * the DLT plugins share one buffer for aligning the L3 data, so each
+     * packet has to be finished before starting the next one
+     */
+    for (i = 0; i < count; i++) {
+        if ((results[i] = tcpedit_packet(tcpedit, &pkthdrs[i], &pktdata[i], directions[i])) == TCPEDIT_ERROR)
+            ret = TCPEDIT_ERROR;
+    }
+#else
+    for (base = 0; base < count; base += TCPEDIT_BATCH_MAX) {
+        n = count - base < TCPEDIT_BATCH_MAX ? count - base : TCPEDIT_BATCH_MAX;
+
+        for (i = 0; i < n; i++)
+            results[base + i] = tcpedit_packet_l2(tcpedit, &state[i], pkthdrs[base + i], 
+                    &pktdata[base + i], directions[base + i]);
+
+        for (i = 0; i < n; i++) {
+            if (results[base + i] != TCPEDIT_OK)
+                continue;
+            results[base + i] = tcpedit_packet_l3(tcpedit, &state[i], pkthdrs[base + i],
+                    pktdata[base + i], directions[base + i]);
+        }
+
+        for (i = 0; i < n; i++) {
+            if (results[base + i] != TCPEDIT_OK)
+                continue;
+            results[base + i] = tcpedit_packet_csum(tcpedit, &state[i], pkthdrs[base + i], 
+                    pktdata[base + i]);
+        }
+
+        for (i = 0; i < n; i++) {
+            if (results[base + i] == TCPEDIT_ERROR)
+                ret = TCPEDIT_ERROR;
+        }
+    }
+#endif
+
+    return ret;
 }
 
 /**
@@ -366,9 +518,20 @@ tcpedit_validate(tcpedit_t *tcpedit)
     assert(tcpedit);
     tcpedit->validated = 1;
 
-    /* we used to do a bunch of things here, but not anymore...
-     * maybe I should find something to do or just get ride of it
-     */
+    /* remember rewritten addresses, most traffic reuses a few of them */
+    if (tcpedit->rewrite_ip || tcpedit->seed)
+        addr_cache_init(&tcpedit->runtime.addr_cache);
+
+    /* compile the --pnat, --srcipmap, --dstipmap & --endpoints maps */
+    compile_cidr_map(tcpedit->cidrmap1);
+    compile_cidr_map(tcpedit->cidrmap2);
+    compile_cidr_map(tcpedit->srcipmap);
+    compile_cidr_map(tcpedit->dstipmap);
+
+    /* turn the portmap list into a table so lookups are O(1) per packet */
+    if (tcpedit->portmap != NULL && tcpedit->portmap_table == NULL)
+        tcpedit->portmap_table = compile_portmap(tcpedit->portmap);
+
     return 0;
 }
 
@@ -503,6 +666,18 @@ tcpedit_close(tcpedit_t *tcpedit)
     safe_free(tcpedit->runtime.l3buff);
 #endif
 
+    if (tcpedit->portmap_table != NULL) {
+        safe_free(tcpedit->portmap_table);
+        tcpedit->portmap_table = NULL;
+    }
+
+    if (tcpedit->runtime.addr_cache.entries != NULL) {
+        dbgx(1, "tcpedit address cache: " COUNTER_SPEC " hits, " COUNTER_SPEC
+                " misses", tcpedit->runtime.addr_cache.hits,
+                tcpedit->runtime.addr_cache.misses);
+        addr_cache_free(&tcpedit->runtime.addr_cache);
+    }
+
     return 0;
 }
 
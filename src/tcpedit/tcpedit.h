@@ -47,6 +47,12 @@ int tcpedit_validate(tcpedit_t *tcpedit);
 int tcpedit_packet(tcpedit_t *tcpedit, struct pcap_pkthdr **pkthdr, 
         u_char **pktdata, tcpr_dir_t direction);
 
+/* max # of packets tcpedit_packet_batch() runs through each stage at once */
+#define TCPEDIT_BATCH_MAX 32
+
+int tcpedit_packet_batch(tcpedit_t *tcpedit, struct pcap_pkthdr **pkthdrs,
+        u_char **pktdata, const tcpr_dir_t *directions, int *results, int count);
+
 int tcpedit_close(tcpedit_t *tcpedit);
 int tcpedit_get_output_dlt(tcpedit_t *tcpedit);
 
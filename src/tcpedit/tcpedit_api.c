@@ -337,6 +337,12 @@ tcpedit_set_port_map(tcpedit_t *tcpedit, char *value)
 {
     assert(tcpedit);
 
+    /* force tcpedit_validate() to recompile the lookup table */
+    if (tcpedit->portmap_table != NULL) {
+        safe_free(tcpedit->portmap_table);
+        tcpedit->portmap_table = NULL;
+    }
+
     if (! parse_portmap(&tcpedit->portmap, value)) {
         tcpedit_seterr(tcpedit, 
                 "Unable to parse portmap: %s", value);
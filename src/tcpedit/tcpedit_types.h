@@ -60,10 +60,27 @@ typedef enum {
 
 
 #define TCPEDIT_ERRSTR_LEN 1024
+/*
+ * cache of original -> rewritten IP addresses, see addr_cache.c
+ */
+typedef struct {
+    u_int32_t key[4];           /* original address, IPv4 only uses key[0] */
+    u_int32_t value[4];         /* rewritten address */
+    u_int8_t flags;             /* ADDR_CACHE_* or 0 if unused */
+    u_int8_t changes;
+} tcpedit_addr_cache_entry_t;
+
+typedef struct {
+    tcpedit_addr_cache_entry_t *entries;
+    COUNTER hits;
+    COUNTER misses;
+} tcpedit_addr_cache_t;
+
 typedef struct {
     COUNTER packetnum;
     COUNTER total_bytes;
     COUNTER pkts_edited;
+    tcpedit_addr_cache_t addr_cache;
     int dlt1;
     int dlt2;
     char errstr[TCPEDIT_ERRSTR_LEN];
@@ -74,19 +91,18 @@ typedef struct {
 } tcpedit_runtime_t;
 
 /*
- * need to track some packet info at runtime
+ * parsed packet: filled in once per packet by decode_packet() so the
+ * edit & checksum routines don't each have to walk the headers again
  */
 typedef struct {
-    int l2len;
-    int l3len;
-    int datalen;
-    u_int8_t l4proto;
-    u_char *l4data;
-    u_int16_t sport, dport;
-    union {
-        u_int32_t ipv4;
-        struct tcpr_in6_addr ipv6;
-    } sip, dip;
+    int l2len;              /* length of the (rewritten) L2 header */
+    int l2proto;            /* L3 protocol in network byte order or -1 */
+    u_char *l3data;         /* IPv4/IPv6 header or NULL if neither */
+    bool ipv6;
+    u_char *l4data;         /* L4 header or NULL if we can't get to it */
+    u_int8_t l4proto;       /* L4 protocol, past any IPv6 extension headers */
+    bool fragment;          /* IPv4 non-first fragment or IPv6 fragment */
+    bool tunnel;            /* IPv6 in IPv6 */
 } tcpedit_packet_t;
 
 /*
@@ -104,7 +120,6 @@ typedef struct tcpedit_portmap_s {
 typedef struct {
     bool validated;  /* have we run tcpedit_validate()? */
     struct tcpeditdlt_s *dlt_ctx;
-    tcpedit_packet_t *packet;
     
     /* runtime variables, don't mess with these */
     tcpedit_runtime_t runtime;
@@ -150,6 +165,7 @@ typedef struct {
     
     /* rewrite tcp/udp ports */
     tcpedit_portmap_t *portmap;
+    u_int16_t *portmap_table;   /* portmap compiled by tcpedit_validate() */
     
     int mtu;                /* Deal with different MTU's */
     bool mtu_truncate;       /* Should we truncate frames > MTU? */
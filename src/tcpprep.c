@@ -41,6 +41,10 @@
 #include <string.h>
 #include <unistd.h>
 #include <errno.h>
+#include <arpa/inet.h>
+#ifdef HAVE_PTHREAD
+#include <pthread.h>
+#endif
 
 #include "tcpprep.h"
 #include "tcpprep_api.h"
@@ -66,13 +70,58 @@ char *ourregex = NULL;
 char *cidr = NULL;
 tcpr_data_tree_t treeroot;
 
+/*
+ * The first pass of auto mode logs a key per packet so the cache can be
+ * built from the tree afterwards without reading the pcap a second time
+ */
+#define KEYLOG_DONT_SEND 0      /* excluded by -x/-X */
+#define KEYLOG_NONIP 1          /* not IPv4/v6 */
+#define KEYLOG_HOST 2           /* + index of the source in keylog.hosts */
+#define KEYLOG_BLOCK 65536      /* keys kept in memory before spilling to disk */
+
+typedef struct keylog_s {
+    u_int32_t *keys;
+    int nkeys;
+    FILE *spill;                /* full blocks of keys */
+    tcpr_tree_t **hosts;        /* source address of each KEYLOG_HOST key */
+    u_int32_t nhosts;
+    u_int32_t maxhosts;
+} keylog_t;
+
+/*
+ * A run of records from the pcap, classified by one thread with --threads.
+ * Each worker builds its own cache (or auto mode hosts and key log) which
+ * are merged in packet order once all the workers are done.
+ */
+typedef struct tcpprep_worker_s {
+    mmpcap_t *mm;
+    COUNTER first;              /* # of the packet before the first one */
+    COUNTER packets;            /* # of packets processed */
+    tcpr_cache_t *cachedata;
+    tcpr_cache_t *lastcache;
+    tcpr_data_tree_t *tree;     /* auto mode hosts */
+    keylog_t keylog;
+    u_int64_t *index;           /* pcap offset of each packet for --index */
+    COUNTER index_size;
+#ifdef HAVE_PTHREAD
+    pthread_t thread;
+#endif
+} tcpprep_worker_t;
+
 void print_comment(const char *);
 void print_info(const char *);
 void print_stats(const char *);
 static int check_ipv4_regex(const unsigned long ip);
 static int check_ipv6_regex(const struct tcpr_in6_addr *addr);
-static COUNTER process_raw_packets(pcap_t * pcap);
+static COUNTER process_raw_packets(tcpprep_worker_t *worker);
 static int check_dst_port(ipv4_hdr_t *ip_hdr, ipv6_hdr_t *ip6_hdr, int len);
+static void keylog_add(keylog_t *keylog, u_int32_t key);
+static void keylog_add_host(keylog_t *keylog, tcpr_tree_t *host);
+static void keylog_build_cache(keylog_t *keylog, tcpr_cache_t **cachedata);
+static void skip_packet(tcpprep_worker_t *worker);
+static void index_packet(tcpprep_worker_t *worker, COUNTER packetnum);
+static int split_pcap(mmpcap_t *mm, tcpprep_worker_t *workers, int threads);
+static COUNTER run_workers(tcpprep_worker_t *workers, int nworkers);
 
 
 /*
@@ -86,6 +135,12 @@ main(int argc, char *argv[])
     char errbuf[PCAP_ERRBUF_SIZE];
     int optct = 0;
     tcpprep_opt_t *options;
+    mmpcap_t *mm;
+    tcpprep_worker_t *workers;
+    tcpr_cache_t *lastcache = NULL;
+    u_int64_t *index = NULL;
+    COUNTER packets;
+    int nworkers, i;
  
     tcpprep = tcpprep_init();
     options = tcpprep->options;
@@ -103,9 +158,15 @@ main(int argc, char *argv[])
         errx(-1, "Unable to open cache file %s for writing: %s", 
             OPT_ARG(CACHEFILE), strerror(errno));
 
-  readpcap:
-    /* open the pcap file */
-    if ((options->pcap = pcap_open_offline(OPT_ARG(PCAP), errbuf)) == NULL)
+    /* --cidr is checked for every packet */
+    if (options->cidrdata != NULL)
+        compile_cidr(options->cidrdata);
+
+    /*
+     * open the pcap file.  mmpcap_next() returns the same timestamp units
+     * as this handle, which is also what the tcpdump pipe is told to expect
+     */
+    if ((options->pcap = tcpr_pcap_open_offline(OPT_ARG(PCAP), errbuf)) == NULL)
         errx(-1, "Error opening file: %s", errbuf);
 
 #ifdef HAVE_PCAP_SNAPSHOT
@@ -146,18 +207,51 @@ main(int argc, char *argv[])
         pcap_setfilter(options->pcap, &options->bpf.program);
     }
 
-    if ((totpackets = process_raw_packets(options->pcap)) == 0) {
-        pcap_close(options->pcap);
-        err(-1, "No packets were processed.  Filter too limiting?");
+    /* read packets straight out of a mapping of the file when we can */
+    mm = mmpcap_open(OPT_ARG(PCAP), options->pcap);
+    if (options->bpf.filter != NULL)
+        mmpcap_setfilter(mm, &options->bpf.program);
+
+    /* we only know where packets are in the file when it's mapped */
+    if (options->index && !mmpcap_mapped(mm)) {
+        warnx("Unable to index %s, it isn't a regular, uncompressed pcap file",
+                OPT_ARG(PCAP));
+        options->index = false;
     }
+
+    workers = (tcpprep_worker_t *)safe_malloc(options->threads * sizeof(tcpprep_worker_t));
+    nworkers = split_pcap(mm, workers, options->threads);
+    totpackets = run_workers(workers, nworkers);
+
+    for (i = 0; i < nworkers; i++) {
+        if (workers[i].mm != mm)
+            mmpcap_close(workers[i].mm);
+    }
+    mmpcap_close(mm);
     pcap_close(options->pcap);
 
+    if (totpackets == 0)
+        err(-1, "No packets were processed.  Filter too limiting?");
+
+    if (options->index) {
+        index = (u_int64_t *)safe_malloc(totpackets * sizeof(u_int64_t));
+        for (i = 0, packets = 0; i < nworkers; i++) {
+            memcpy(index + packets, workers[i].index,
+                    workers[i].packets * sizeof(u_int64_t));
+            packets += workers[i].packets;
+            safe_free(workers[i].index);
+        }
+    }
+
 #ifdef ENABLE_VERBOSE
     tcpdump_close(&tcpprep->tcpdump);
 #endif
 
-    /* we need to process the pcap file twice in HASH/AUTO mode */
+    /* now that we've seen every host, work out the direction of each packet */
     if (options->mode == AUTO_MODE) {
+        for (i = 1; i < nworkers; i++)
+            tree_merge(&treeroot, workers[i].tree);
+
         options->mode = options->automode;
         if (options->mode == ROUTER_MODE) {  /* do we need to convert TREE->CIDR? */
             if (info)
@@ -177,12 +271,19 @@ main(int argc, char *argv[])
 
         if (info)
             notice("Buliding cache file...\n");
-        /* 
-         * re-process files, but this time generate
-         * cache 
-         */
-        goto readpcap;
+        for (i = 0; i < nworkers; i++)
+            keylog_build_cache(&workers[i].keylog, &options->cachedata);
+
+        /* the key logs point at these hosts, so they go last */
+        for (i = 1; i < nworkers; i++) {
+            tree_free(workers[i].tree);
+            safe_free(workers[i].tree);
+        }
+    } else {
+        for (i = 0; i < nworkers; i++)
+            append_cache(&options->cachedata, &lastcache, workers[i].cachedata);
     }
+    safe_free(workers);
 #ifdef DEBUG
     if (debug && (options->cidrdata != NULL))
         print_cidr(options->cidrdata);
@@ -190,7 +291,8 @@ main(int argc, char *argv[])
 
     /* write cache data */
     totpackets = write_cache(options->cachedata, out_file, totpackets, 
-        options->comment);
+        options->comment, index);
+    safe_free(index);
     if (info)
         notice("Done.\nCached " COUNTER_SPEC " packets.\n", totpackets);
 
@@ -200,6 +302,278 @@ main(int argc, char *argv[])
 
 }
 
+/**
+ * records the key of the next packet in the auto mode key log
+ */
+static void
+keylog_add(keylog_t *keylog, u_int32_t key)
+{
+    if (keylog->keys == NULL)
+        keylog->keys = (u_int32_t *)safe_malloc(KEYLOG_BLOCK * sizeof(u_int32_t));
+
+    if (keylog->nkeys == KEYLOG_BLOCK) {
+        if (keylog->spill == NULL && (keylog->spill = tmpfile()) == NULL)
+            errx(-1, "Unable to create auto mode temp file: %s", strerror(errno));
+
+        if (fwrite(keylog->keys, sizeof(u_int32_t), KEYLOG_BLOCK, keylog->spill) != KEYLOG_BLOCK)
+            errx(-1, "Unable to write auto mode temp file: %s", strerror(errno));
+
+        keylog->nkeys = 0;
+    }
+
+    keylog->keys[keylog->nkeys++] = key;
+}
+
+/**
+ * records a packet sent by the given host, adding the host to the
+ * address table the first time we see it
+ */
+static void
+keylog_add_host(keylog_t *keylog, tcpr_tree_t *host)
+{
+    assert(host);
+
+    if (host->key == 0) {
+        if (keylog->nhosts == keylog->maxhosts) {
+            keylog->maxhosts = keylog->maxhosts ? keylog->maxhosts * 2 : 1024;
+            keylog->hosts = (tcpr_tree_t **)safe_realloc(keylog->hosts,
+                    keylog->maxhosts * sizeof(tcpr_tree_t *));
+        }
+        keylog->hosts[keylog->nhosts++] = host;
+        host->key = keylog->nhosts;
+    }
+
+    keylog_add(keylog, KEYLOG_HOST + host->key - 1);
+}
+
+/**
+ * adds a key from the log to the cache using the direction of each host
+ */
+static void
+keylog_cache_key(const keylog_t *keylog, tcpr_cache_t **cachedata,
+        const tcpr_dir_t *dirs, u_int32_t key)
+{
+    tcpprep_opt_t *options = tcpprep->options;
+
+    if (key == KEYLOG_DONT_SEND) {
+        add_cache(cachedata, DONT_SEND, 0);
+    } else if (key == KEYLOG_NONIP) {
+        add_cache(cachedata, SEND, options->nonip);
+    } else {
+        assert(key - KEYLOG_HOST < keylog->nhosts);
+        add_cache(cachedata, SEND, dirs[key - KEYLOG_HOST]);
+    }
+}
+
+/**
+ * second phase of auto mode: look up each host in the tree once and
+ * build the cache from the key log
+ */
+static void
+keylog_build_cache(keylog_t *keylog, tcpr_cache_t **cachedata)
+{
+    tcpprep_opt_t *options = tcpprep->options;
+    tcpr_dir_t *dirs = NULL;
+    tcpr_tree_t *host;
+    u_int32_t i;
+    int unknown, j;
+    size_t n;
+
+    /* what to do with hosts which aren't a client or server */
+    switch (options->mode) {
+    case ROUTER_MODE:
+        unknown = options->nonip;
+        break;
+    case SERVER_MODE:
+        unknown = DIR_SERVER;
+        break;
+    case CLIENT_MODE:
+        unknown = DIR_CLIENT;
+        break;
+    case BRIDGE_MODE:
+    case FIRST_MODE:
+        unknown = DIR_UNKNOWN;
+        break;
+    default:
+        errx(-1, "Whops!  What mode are we in anyways? %d", options->mode);
+    }
+
+    if (keylog->nhosts > 0)
+        dirs = (tcpr_dir_t *)safe_malloc(keylog->nhosts * sizeof(tcpr_dir_t));
+
+    for (i = 0; i < keylog->nhosts; i++) {
+        host = keylog->hosts[i];
+        if (host->family == AF_INET) {
+            dirs[i] = check_ip_tree(unknown, host->u.ip);
+        } else {
+            dirs[i] = check_ip6_tree(unknown, &host->u.ip6);
+        }
+    }
+
+    /* blocks which didn't fit in memory first */
+    if (keylog->spill != NULL) {
+        u_int32_t *block = (u_int32_t *)safe_malloc(KEYLOG_BLOCK * sizeof(u_int32_t));
+
+        rewind(keylog->spill);
+        while ((n = fread(block, sizeof(u_int32_t), KEYLOG_BLOCK, keylog->spill)) > 0) {
+            for (j = 0; j < (int)n; j++)
+                keylog_cache_key(keylog, cachedata, dirs, block[j]);
+        }
+        if (ferror(keylog->spill))
+            errx(-1, "Unable to read auto mode temp file: %s", strerror(errno));
+
+        safe_free(block);
+        fclose(keylog->spill);
+        keylog->spill = NULL;
+    }
+
+    for (j = 0; j < keylog->nkeys; j++)
+        keylog_cache_key(keylog, cachedata, dirs, keylog->keys[j]);
+
+    safe_free(dirs);
+    safe_free(keylog->keys);
+    safe_free(keylog->hosts);
+    memset(keylog, 0, sizeof(keylog_t));
+}
+
+/**
+ * marks the current packet as excluded by -x/-X
+ */
+static void
+skip_packet(tcpprep_worker_t *worker)
+{
+    tcpprep_opt_t *options = tcpprep->options;
+
+    if (options->mode == AUTO_MODE) {
+        keylog_add(&worker->keylog, KEYLOG_DONT_SEND);
+    } else {
+        add_cache_r(&worker->cachedata, &worker->lastcache, DONT_SEND, 0);
+    }
+}
+
+/**
+ * records where the current packet is in the pcap for --index
+ */
+static void
+index_packet(tcpprep_worker_t *worker, COUNTER packetnum)
+{
+    COUNTER i = packetnum - worker->first - 1;
+
+    if (i == worker->index_size) {
+        worker->index_size = worker->index_size ? worker->index_size * 2 : 65536;
+        worker->index = (u_int64_t *)safe_realloc(worker->index,
+                worker->index_size * sizeof(u_int64_t));
+    }
+
+    worker->index[i] = (u_int64_t)mmpcap_last(worker->mm);
+}
+
+/**
+ * splits the pcap between up to threads workers.  Each gets a whole number
+ * of cache entries worth of records so their caches can simply be linked
+ * together.  Returns the number of workers.
+ */
+static int
+split_pcap(mmpcap_t *mm, tcpprep_worker_t *workers, int threads)
+{
+    tcpprep_opt_t *options = tcpprep->options;
+    size_t *offsets = NULL;
+    COUNTER skipped;
+    int nodes = 0, maxnodes = 0, i, first, last;
+
+    memset(workers, 0, threads * sizeof(tcpprep_worker_t));
+    workers[0].mm = mm;
+    workers[0].tree = &treeroot;
+
+    if (threads < 2)
+        return 1;
+
+    if (!mmpcap_mapped(mm)) {
+        warnx("Unable to split %s between threads, using one", OPT_ARG(PCAP));
+        return 1;
+    }
+
+    /* with a filter we don't know the packet numbers -x/-X need up front */
+    if (options->bpf.filter != NULL && options->xX.list != NULL) {
+        warnx("%s", "Unable to use threads with both a filter and a packet list, using one");
+        return 1;
+    }
+
+    /* find the start of every CACHE_PACKETS_PER_NODE records */
+    do {
+        if (nodes == maxnodes) {
+            maxnodes = maxnodes ? maxnodes * 2 : 1024;
+            offsets = (size_t *)safe_realloc(offsets, (maxnodes + 1) * sizeof(size_t));
+        }
+        offsets[nodes] = mmpcap_tell(mm);
+        if ((skipped = mmpcap_skip(mm, CACHE_PACKETS_PER_NODE)) > 0)
+            nodes++;
+    } while (skipped == CACHE_PACKETS_PER_NODE);
+    offsets[nodes] = mmpcap_tell(mm);
+
+    if (threads > nodes)
+        threads = nodes > 0 ? nodes : 1;
+
+    for (i = 0; i < threads; i++) {
+        first = (int)((COUNTER)nodes * i / threads);
+        last = (int)((COUNTER)nodes * (i + 1) / threads);
+
+        /* the last one goes to EOF to report any partial record */
+        workers[i].mm = mmpcap_slice(mm, offsets[first],
+                i == threads - 1 ? mmpcap_size(mm) : offsets[last]);
+        workers[i].first = (COUNTER)first * CACHE_PACKETS_PER_NODE;
+        if (i > 0)
+            workers[i].tree = (tcpr_data_tree_t *)safe_malloc(sizeof(tcpr_data_tree_t));
+    }
+
+    dbgx(1, "Split %s into %d runs of up to %d packets", OPT_ARG(PCAP), threads,
+            (nodes + threads - 1) / threads * CACHE_PACKETS_PER_NODE);
+
+    safe_free(offsets);
+    return threads;
+}
+
+#ifdef HAVE_PTHREAD
+static void *
+worker_thread(void *arg)
+{
+    tcpprep_worker_t *worker = (tcpprep_worker_t *)arg;
+
+    worker->packets = process_raw_packets(worker);
+    return NULL;
+}
+#endif
+
+/**
+ * classifies the packets of each worker, on a thread each if there's more
+ * than one.  Returns the total number of packets.
+ */
+static COUNTER
+run_workers(tcpprep_worker_t *workers, int nworkers)
+{
+    COUNTER packets = 0;
+    int i;
+
+#ifdef HAVE_PTHREAD
+    if (nworkers > 1) {
+        for (i = 0; i < nworkers; i++) {
+            if ((errno = pthread_create(&workers[i].thread, NULL, worker_thread,
+                            &workers[i])) != 0)
+                errx(-1, "Unable to start worker thread: %s", strerror(errno));
+        }
+
+        for (i = 0; i < nworkers; i++)
+            pthread_join(workers[i].thread, NULL);
+    } else
+#endif
+        workers[0].packets = process_raw_packets(&workers[0]);
+
+    for (i = 0; i < nworkers; i++)
+        packets += workers[i].packets;
+
+    return packets;
+}
+
 
 /**
  * checks the dst port to see if this is destined for a server port.
@@ -281,13 +655,22 @@ check_ipv4_regex(const unsigned long ip)
 {
     int eflags = 0;
     u_char src_ip[16];
+#ifdef HAVE_INET_NTOP
+    struct in_addr addr;
+#endif
     size_t nmatch = 0;
     regmatch_t *pmatch = NULL;
     tcpprep_opt_t *options = tcpprep->options;
 
     memset(src_ip, '\0', 16);
+#ifdef HAVE_INET_NTOP
+    /* get_addr2name4()'s static buffer isn't safe to use with --threads */
+    addr.s_addr = ip;
+    inet_ntop(AF_INET, &addr, (char *)src_ip, sizeof(src_ip));
+#else
     strlcpy((char *)src_ip, (char *)get_addr2name4(ip, RESOLVE),
             sizeof(src_ip));
+#endif
     if (regexec(&options->preg, (char *)src_ip, nmatch, pmatch, eflags) == 0) {
         return 1;
     } else {
@@ -306,7 +689,11 @@ check_ipv6_regex(const struct tcpr_in6_addr *addr)
     tcpprep_opt_t *options = tcpprep->options;
 
     memset(src_ip, '\0', 16);
+#ifdef HAVE_INET_NTOP
+    inet_ntop(AF_INET6, addr, (char *)src_ip, sizeof(src_ip));
+#else
     strlcpy((char *)src_ip, (char *)get_addr2name6(addr, RESOLVE), sizeof(src_ip));
+#endif
     if (regexec(&options->preg, (char *)src_ip, nmatch, pmatch, eflags) == 0) {
         return 1;
     } else {
@@ -319,17 +706,19 @@ check_ipv6_regex(const struct tcpr_in6_addr *addr)
  * the cache file.
  */
 static COUNTER
-process_raw_packets(pcap_t * pcap)
+process_raw_packets(tcpprep_worker_t *worker)
 {
+    mmpcap_t *pcap = worker->mm;
     ipv4_hdr_t *ip_hdr = NULL;
     ipv6_hdr_t *ip6_hdr = NULL;
     eth_hdr_t *eth_hdr = NULL;
     struct pcap_pkthdr pkthdr;
     const u_char *pktdata = NULL;
-    COUNTER packetnum = 0;
-    int l2len, cache_result = 0;
+    COUNTER packetnum = worker->first;
+    int l2len, dlt, cache_result = 0;
     u_char ipbuff[MAXPACKET], *buffptr;
     tcpr_dir_t direction;
+    tcpr_tree_t *host;
     tcpprep_opt_t *options = tcpprep->options;
 
 #ifdef ENABLE_VERBOSE
@@ -341,22 +730,27 @@ process_raw_packets(pcap_t * pcap)
 #endif
     
     assert(pcap);
+
+    dlt = pcap_datalink(pcap->pcap);
     
-    while ((pktdata = pcap_next(pcap, &pkthdr)) != NULL) {
+    while ((pktdata = mmpcap_next(pcap, &pkthdr)) != NULL) {
         packetnum++;
 
         dbgx(1, "Packet " COUNTER_SPEC, packetnum);
 
+        if (options->index)
+            index_packet(worker, packetnum);
+
         /* look for include or exclude LIST match */
         if (options->xX.list != NULL) {
             if (options->xX.mode < xXExclude) {
                 if (!check_list(options->xX.list, packetnum)) {
-                    add_cache(&(options->cachedata), DONT_SEND, 0);
+                    skip_packet(worker);
                     continue;
                 }
             }
             else if (check_list(options->xX.list, packetnum)) {
-                add_cache(&(options->cachedata), DONT_SEND, 0);
+                skip_packet(worker);
                 continue;
             }
         }
@@ -377,14 +771,14 @@ process_raw_packets(pcap_t * pcap)
     
             /* first look for IPv4 */
             if ((ip_hdr = (ipv4_hdr_t *)get_ipv4(pktdata, pkthdr.caplen, 
-                    pcap_datalink(pcap), &buffptr))) {
+                    dlt, &buffptr))) {
                 dbg(2, "Packet is IPv4");
                     
             } 
             
             /* then look for IPv6 */
             else if ((ip6_hdr = (ipv6_hdr_t *)get_ipv6(pktdata, pkthdr.caplen,
-                    pcap_datalink(pcap), &buffptr))) {
+                    dlt, &buffptr))) {
                 dbg(2, "Packet is IPv6");    
             } 
             
@@ -392,28 +786,30 @@ process_raw_packets(pcap_t * pcap)
             else {
                 dbg(2, "Packet isn't IPv4/v6");
 
-                /* we don't want to cache these packets twice */
-                if (options->mode != AUTO_MODE) {
+                /* auto mode doesn't know the --nonip direction yet */
+                if (options->mode == AUTO_MODE) {
+                    keylog_add(&worker->keylog, KEYLOG_NONIP);
+                } else {
                     dbg(3, "Adding to cache using options for Non-IP packets");
-                    add_cache(&options->cachedata, SEND, options->nonip);
+                    add_cache_r(&worker->cachedata, &worker->lastcache, SEND, options->nonip);
                 }
 
                 /* go to next packet */
                 continue;
             }
     
-            l2len = get_l2len(pktdata, pkthdr.caplen, pcap_datalink(pcap));
+            l2len = get_l2len(pktdata, pkthdr.caplen, dlt);
 
             /* look for include or exclude CIDR match */
             if (options->xX.cidr != NULL) {
                 if (ip_hdr) {
                     if (!process_xX_by_cidr_ipv4(options->xX.mode, options->xX.cidr, ip_hdr)) {
-                        add_cache(&options->cachedata, DONT_SEND, 0);
+                        skip_packet(worker);
                         continue;
                     }
                 } else if (ip6_hdr) {
                     if (!process_xX_by_cidr_ipv6(options->xX.mode, options->xX.cidr, ip6_hdr)) {
-                        add_cache(&options->cachedata, DONT_SEND, 0);
+                        skip_packet(worker);
                         continue;
                     }
                 }
@@ -433,7 +829,7 @@ process_raw_packets(pcap_t * pcap)
             if (HAVE_OPT(REVERSE) && (direction == TCPR_DIR_C2S || direction == TCPR_DIR_S2C))
                 direction = direction == TCPR_DIR_C2S ? TCPR_DIR_S2C : TCPR_DIR_C2S;
 
-            cache_result = add_cache(&options->cachedata, SEND, direction); 
+            cache_result = add_cache_r(&worker->cachedata, &worker->lastcache, SEND, direction); 
             break;
 
         case CIDR_MODE:
@@ -448,7 +844,7 @@ process_raw_packets(pcap_t * pcap)
             if (HAVE_OPT(REVERSE) && (direction == TCPR_DIR_C2S || direction == TCPR_DIR_S2C))
                 direction = direction == TCPR_DIR_C2S ? TCPR_DIR_S2C : TCPR_DIR_C2S;
 
-            cache_result = add_cache(&options->cachedata, SEND, direction);
+            cache_result = add_cache_r(&worker->cachedata, &worker->lastcache, SEND, direction);
             break;
 
         case MAC_MODE:
@@ -459,7 +855,7 @@ process_raw_packets(pcap_t * pcap)
             if (HAVE_OPT(REVERSE) && (direction == TCPR_DIR_C2S || direction == TCPR_DIR_S2C))
                 direction = direction == TCPR_DIR_C2S ? TCPR_DIR_S2C : TCPR_DIR_C2S;
 
-            cache_result = add_cache(&options->cachedata, SEND, direction);
+            cache_result = add_cache_r(&worker->cachedata, &worker->lastcache, SEND, direction);
             break;
 
         case AUTO_MODE:
@@ -467,77 +863,20 @@ process_raw_packets(pcap_t * pcap)
             /* first run through in auto mode: create tree */
             if (options->automode != FIRST_MODE) {
                 if (ip_hdr) {
-                    add_tree_ipv4(ip_hdr->ip_src.s_addr, pktdata);
-                } else if (ip6_hdr) {
-                    add_tree_ipv6(&ip6_hdr->ip_src, pktdata);
+                    host = add_tree_ipv4(worker->tree, ip_hdr->ip_src.s_addr, pktdata);
+                } else {
+                    host = add_tree_ipv6(worker->tree, &ip6_hdr->ip_src, pktdata);
                 }
             } else {
                 if (ip_hdr) {
-                    add_tree_first_ipv4(pktdata);
-                } else if (ip6_hdr) {
-                    add_tree_first_ipv6(pktdata);
+                    host = add_tree_first_ipv4(worker->tree, pktdata);
+                } else {
+                    host = add_tree_first_ipv6(worker->tree, pktdata);
                 }
-            }  
-            break;
-
-        case ROUTER_MODE:
-            /* 
-             * second run through in auto mode: create route
-             * based cache
-             */
-            dbg(2, "processing second pass of auto: router mode...");
-            if (ip_hdr) {
-                cache_result = add_cache(&options->cachedata, SEND,
-                    check_ip_tree(options->nonip, ip_hdr->ip_src.s_addr));
-            } else {
-                cache_result = add_cache(&options->cachedata, SEND,
-                    check_ip6_tree(options->nonip, &ip6_hdr->ip_src));
             }
-            break;
 
-        case BRIDGE_MODE:
-            /*
-             * second run through in auto mode: create bridge
-             * based cache
-             */
-            dbg(2, "processing second pass of auto: bridge mode...");
-            if (ip_hdr) {
-                cache_result = add_cache(&options->cachedata, SEND,
-                    check_ip_tree(DIR_UNKNOWN, ip_hdr->ip_src.s_addr));
-            } else {
-                cache_result = add_cache(&options->cachedata, SEND,
-                    check_ip6_tree(DIR_UNKNOWN, &ip6_hdr->ip_src));
-            }
-            break;
-
-        case SERVER_MODE:
-            /* 
-             * second run through in auto mode: create bridge
-             * where unknowns are servers
-             */
-            dbg(2, "processing second pass of auto: server mode...");
-            if (ip_hdr) {
-                cache_result = add_cache(&options->cachedata, SEND,
-                    check_ip_tree(DIR_SERVER, ip_hdr->ip_src.s_addr));
-            } else {
-                cache_result = add_cache(&options->cachedata, SEND,
-                    check_ip6_tree(DIR_SERVER, &ip6_hdr->ip_src));
-            }
-            break;
-
-        case CLIENT_MODE:
-            /* 
-             * second run through in auto mode: create bridge
-             * where unknowns are clients
-             */
-            dbg(2, "processing second pass of auto: client mode...");
-            if (ip_hdr) {
-                cache_result = add_cache(&options->cachedata, SEND,
-                    check_ip_tree(DIR_CLIENT, ip_hdr->ip_src.s_addr));
-            } else {
-                cache_result = add_cache(&options->cachedata, SEND,
-                    check_ip6_tree(DIR_CLIENT, &ip6_hdr->ip_src));
-            }
+            /* and remember who sent it for when we build the cache */
+            keylog_add_host(&worker->keylog, host);
             break;
 
         case PORT_MODE:
@@ -545,25 +884,10 @@ process_raw_packets(pcap_t * pcap)
              * process ports based on their destination port
              */
             dbg(2, "processing port mode...");
-            cache_result = add_cache(&options->cachedata, SEND, 
+            cache_result = add_cache_r(&worker->cachedata, &worker->lastcache, SEND, 
                 check_dst_port(ip_hdr, ip6_hdr, (pkthdr.caplen - l2len)));
             break;
 
-        case FIRST_MODE:
-            /*
-             * First packet mode, looks at each host and picks clients
-             * by the ones which send the first packet in a session
-             */
-            dbg(2, "processing second pass of auto: first packet mode...");
-            if (ip_hdr) {
-                cache_result = add_cache(&options->cachedata, SEND,
-                    check_ip_tree(DIR_UNKNOWN, ip_hdr->ip_src.s_addr));
-            } else {
-                cache_result = add_cache(&options->cachedata, SEND,
-                    check_ip6_tree(DIR_UNKNOWN, &ip6_hdr->ip_src));
-            }
-            break;
-            
         default:
             errx(-1, "Whops!  What mode are we in anyways? %d", options->mode);
         }
@@ -573,7 +897,7 @@ process_raw_packets(pcap_t * pcap)
 #endif
     }
 
-    return packetnum;
+    return packetnum - worker->first;
 }
 
 
@@ -583,13 +907,16 @@ process_raw_packets(pcap_t * pcap)
 void
 print_comment(const char *file)
 {
-    char *cachedata = NULL;
-    char *comment = NULL;
-    COUNTER count = 0;
+    tcpr_cache_map_t cache;
 
-    count = read_cache(&cachedata, file, &comment);
-    printf("tcpprep args: %s\n", comment);
-    printf("Cache contains data for " COUNTER_SPEC " packets\n", count);
+    open_cache(&cache, file);
+    if (verify_cache(&cache) < 0)
+        errx(-1, "Unable to process %s: cache file checksum missmatch", file);
+
+    printf("tcpprep args: %s\n", cache.comment);
+    printf("Cache contains data for " COUNTER_SPEC " packets\n", cache.packets);
+    if (cache.index != NULL)
+        printf("Cache has an index of the packets in the pcap\n");
 
     exit(0);
 }
@@ -58,6 +58,7 @@ tcpprep_init()
     ctx->options = safe_malloc(sizeof(tcpprep_opt_t));
 
     ctx->options->bpf.optimize = BPF_OPTIMIZE;
+    ctx->options->threads = 1;
 
     for (i = DEFAULT_LOW_SERVER_PORT; i <= DEFAULT_HIGH_SERVER_PORT; i++) {
         ctx->options->services.tcp[i] = 1;
@@ -247,6 +248,49 @@ tcpprep_set_nonip_is_secondary(tcpprep_t *ctx, bool value)
     return 0;
 }
 
+/**
+ * Set the number of threads to classify packets with
+ */
+int
+tcpprep_set_threads(tcpprep_t *ctx, int value)
+{
+    assert(ctx);
+
+#ifdef HAVE_PTHREAD
+    if (value < 1) {
+        tcpprep_seterr(ctx, "%s", "number of threads must be at least 1");
+        return -1;
+    }
+
+#ifdef ENABLE_VERBOSE
+    if (value > 1 && ctx->options->verbose) {
+        tcpprep_seterr(ctx, "%s", "verbose mode can't be used with multiple threads");
+        return -1;
+    }
+#endif
+
+    ctx->options->threads = value;
+    return 0;
+#else
+    if (value == 1)
+        return 0;
+
+    tcpprep_seterr(ctx, "%s", "tcpprep_api not compiled with pthread support");
+    return -1;
+#endif
+}
+
+/**
+ * Save the offset of each packet in the pcap to the cache file
+ */
+int
+tcpprep_set_index(tcpprep_t *ctx, bool value)
+{
+    assert(ctx);
+    ctx->options->index = value;
+    return 0;
+}
+
 #ifdef ENABLE_VERBOSE
 /**
  * Enable verbose (tcpdump)
@@ -402,6 +446,13 @@ tcpprep_post_args(tcpprep_t *ctx, int argc, char *argv[])
         ctx->tcpdump.args = safe_strdup(OPT_ARG(DECODE));
 #endif
 
+#ifdef HAVE_PTHREAD
+    if (HAVE_OPT(THREADS) && tcpprep_set_threads(ctx, OPT_VALUE_THREADS) < 0)
+        errx(-1, "%s", tcpprep_geterr(ctx));
+#endif
+
+    if (HAVE_OPT(INDEX))
+        tcpprep_set_index(ctx, true);
 
     /* 
      * if we are to include the cli args, then prep it for the
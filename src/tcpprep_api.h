@@ -59,6 +59,8 @@ typedef struct tcpprep_opt_s {
     double ratio;
     regex_t preg;
     bool nonip;
+    int threads;              /* # of threads to classify packets with */
+    bool index;               /* write the offset of each packet to the cache */
 } tcpprep_opt_t;
 
 typedef struct tcpprep_s {
@@ -96,6 +98,8 @@ int tcpprep_set_max_mask(tcpprep_t *, int);
 int tcpprep_set_ratio(tcpprep_t *, double);
 int tcpprep_set_regex(tcpprep_t *, char *);
 int tcpprep_set_nonip_is_secondary(tcpprep_t *, bool);
+int tcpprep_set_threads(tcpprep_t *, int);
+int tcpprep_set_index(tcpprep_t *, bool);
 
 #ifdef ENABLE_VERBOSE
 int tcpprep_set_verbose(tcpprep_t *, bool);
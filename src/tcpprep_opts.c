@@ -79,7 +79,7 @@ extern tcpprep_t *tcpprep;
 /*
  *  tcpprep option static const strings
  */
-static char const tcpprep_opt_strs[3082] =
+static char const tcpprep_opt_strs[3209] =
 /*     0 */ "tcpprep (tcpprep)\n"
             "Copyright (C) 2000-2010 Aaron Turner, all rights reserved.\n"
             "This is free software. It is licensed for use, modification and\n"
@@ -166,33 +166,39 @@ static char const tcpprep_opt_strs[3082] =
 /*  1948 */ "Arguments passed to tcpdump decoder\0"
 /*  1984 */ "DECODE\0"
 /*  1991 */ "decode\0"
-/*  1998 */ "Print version information\0"
-/*  2024 */ "VERSION\0"
-/*  2032 */ "version\0"
-/*  2040 */ "Display less usage information and exit\0"
-/*  2080 */ "LESS_HELP\0"
-/*  2090 */ "less-help\0"
-/*  2100 */ "Display extended usage information and exit\0"
-/*  2144 */ "help\0"
-/*  2149 */ "Extended usage information passed thru pager\0"
-/*  2194 */ "more-help\0"
-/*  2204 */ "Save the option state to a config file\0"
-/*  2243 */ "save-opts\0"
-/*  2253 */ "Load options from a config file\0"
-/*  2285 */ "LOAD_OPTS\0"
-/*  2295 */ "no-load-opts\0"
-/*  2308 */ "no\0"
-/*  2311 */ "TCPPREP\0"
-/*  2319 */ "tcpprep (tcpprep) - Create a tcpreplay cache cache file from a pcap file.\n"
+/*  1998 */ "Number of threads to classify packets with\0"
+/*  2041 */ "THREADS\0"
+/*  2049 */ "threads\0"
+/*  2057 */ "Save where each packet is in the pcap to the cache file\0"
+/*  2113 */ "INDEX\0"
+/*  2119 */ "index\0"
+/*  2125 */ "Print version information\0"
+/*  2151 */ "VERSION\0"
+/*  2159 */ "version\0"
+/*  2167 */ "Display less usage information and exit\0"
+/*  2207 */ "LESS_HELP\0"
+/*  2217 */ "less-help\0"
+/*  2227 */ "Display extended usage information and exit\0"
+/*  2271 */ "help\0"
+/*  2276 */ "Extended usage information passed thru pager\0"
+/*  2321 */ "more-help\0"
+/*  2331 */ "Save the option state to a config file\0"
+/*  2370 */ "save-opts\0"
+/*  2380 */ "Load options from a config file\0"
+/*  2412 */ "LOAD_OPTS\0"
+/*  2422 */ "no-load-opts\0"
+/*  2435 */ "no\0"
+/*  2438 */ "TCPPREP\0"
+/*  2446 */ "tcpprep (tcpprep) - Create a tcpreplay cache cache file from a pcap file.\n"
             "USAGE:  %s [ -<flag> [<val>] | --<name>[{=| }<val>] ]...\n\0"
-/*  2451 */ "$$/\0"
-/*  2455 */ ".tcppreprc\0"
-/*  2466 */ "tcpreplay-users@lists.sourceforge.net\0"
-/*  2504 */ "\n"
+/*  2578 */ "$$/\0"
+/*  2582 */ ".tcppreprc\0"
+/*  2593 */ "tcpreplay-users@lists.sourceforge.net\0"
+/*  2631 */ "\n"
             "tcpprep is a ``pcap(3)'' file pre-processor which creates a cache file\n"
             "which provides \"rules\" for ``tcprewrite(1)'' and ``tcpreplay(1)'' on how to\n"
             "process and send packets.\n\0"
-/*  2679 */ "\n"
+/*  2806 */ "\n"
             "The basic operation of tcpreplay is to resend all packets from the input\n"
             "file(s) out a single file.  Tcpprep processes a pcap file and applies a set\n"
             "of user-specified rules to create a cache file which tells tcpreplay wether\n"
@@ -484,42 +490,69 @@ static int const aDecodeMustList[] = {
 #define DECODE_name      NULL
 #endif  /* ENABLE_VERBOSE */
 
+/*
+ *  threads option description:
+ */
+#ifdef HAVE_PTHREAD
+#define THREADS_DESC      (tcpprep_opt_strs+1998)
+#define THREADS_NAME      (tcpprep_opt_strs+2041)
+#define THREADS_name      (tcpprep_opt_strs+2049)
+#define THREADS_DFT_ARG   ((char const*)1)
+#define THREADS_FLAGS     (OPTST_DISABLED \
+        | OPTST_SET_ARGTYPE(OPARG_TYPE_NUMERIC))
+
+#else   /* disable threads */
+#define THREADS_FLAGS     (OPTST_OMITTED | OPTST_NO_INIT)
+#define THREADS_DFT_ARG   NULL
+#define THREADS_NAME      NULL
+#define THREADS_DESC      NULL
+#define THREADS_name      NULL
+#endif  /* HAVE_PTHREAD */
+
+/*
+ *  index option description:
+ */
+#define INDEX_DESC      (tcpprep_opt_strs+2057)
+#define INDEX_NAME      (tcpprep_opt_strs+2113)
+#define INDEX_name      (tcpprep_opt_strs+2119)
+#define INDEX_FLAGS     (OPTST_DISABLED)
+
 /*
  *  version option description:
  */
-#define VERSION_DESC      (tcpprep_opt_strs+1998)
-#define VERSION_NAME      (tcpprep_opt_strs+2024)
-#define VERSION_name      (tcpprep_opt_strs+2032)
+#define VERSION_DESC      (tcpprep_opt_strs+2125)
+#define VERSION_NAME      (tcpprep_opt_strs+2151)
+#define VERSION_name      (tcpprep_opt_strs+2159)
 #define VERSION_FLAGS     (OPTST_DISABLED)
 
 /*
  *  less-help option description:
  */
-#define LESS_HELP_DESC      (tcpprep_opt_strs+2040)
-#define LESS_HELP_NAME      (tcpprep_opt_strs+2080)
-#define LESS_HELP_name      (tcpprep_opt_strs+2090)
+#define LESS_HELP_DESC      (tcpprep_opt_strs+2167)
+#define LESS_HELP_NAME      (tcpprep_opt_strs+2207)
+#define LESS_HELP_name      (tcpprep_opt_strs+2217)
 #define LESS_HELP_FLAGS     (OPTST_DISABLED | OPTST_IMM)
 
 /*
  *  Help/More_Help option descriptions:
  */
-#define HELP_DESC       (tcpprep_opt_strs+2100)
-#define HELP_name       (tcpprep_opt_strs+2144)
+#define HELP_DESC       (tcpprep_opt_strs+2227)
+#define HELP_name       (tcpprep_opt_strs+2271)
 #ifdef HAVE_WORKING_FORK
-#define MORE_HELP_DESC  (tcpprep_opt_strs+2149)
-#define MORE_HELP_name  (tcpprep_opt_strs+2194)
+#define MORE_HELP_DESC  (tcpprep_opt_strs+2276)
+#define MORE_HELP_name  (tcpprep_opt_strs+2321)
 #define MORE_HELP_FLAGS (OPTST_IMM | OPTST_NO_INIT)
 #else
 #define MORE_HELP_DESC  NULL
 #define MORE_HELP_name  NULL
 #define MORE_HELP_FLAGS (OPTST_OMITTED | OPTST_NO_INIT)
 #endif
-#define SAVE_OPTS_DESC  (tcpprep_opt_strs+2204)
-#define SAVE_OPTS_name  (tcpprep_opt_strs+2243)
-#define LOAD_OPTS_DESC     (tcpprep_opt_strs+2253)
-#define LOAD_OPTS_NAME     (tcpprep_opt_strs+2285)
-#define NO_LOAD_OPTS_name  (tcpprep_opt_strs+2295)
-#define LOAD_OPTS_pfx      (tcpprep_opt_strs+2308)
+#define SAVE_OPTS_DESC  (tcpprep_opt_strs+2331)
+#define SAVE_OPTS_name  (tcpprep_opt_strs+2370)
+#define LOAD_OPTS_DESC     (tcpprep_opt_strs+2380)
+#define LOAD_OPTS_NAME     (tcpprep_opt_strs+2412)
+#define NO_LOAD_OPTS_name  (tcpprep_opt_strs+2422)
+#define LOAD_OPTS_pfx      (tcpprep_opt_strs+2435)
 #define LOAD_OPTS_name     (NO_LOAD_OPTS_name + 3)
 /*
  *  Declare option callback procedures
@@ -529,6 +562,11 @@ static int const aDecodeMustList[] = {
 #else /* not DEBUG */
 # define doOptDbug NULL
 #endif /* def/not DEBUG */
+#ifdef HAVE_PTHREAD
+  static tOptProc doOptThreads;
+#else /* not HAVE_PTHREAD */
+# define doOptThreads NULL
+#endif /* def/not HAVE_PTHREAD */
 extern tOptProc
     optionBooleanVal,   optionNestedVal,    optionNumericVal,
     optionPagedUsage,   optionPrintVersion, optionResetOpt,
@@ -825,8 +863,32 @@ static tOptDesc optDesc[OPTION_CT] = {
      /* desc, NAME, name */ DECODE_DESC, DECODE_NAME, DECODE_name,
      /* disablement strs */ NULL, NULL },
 
-  {  /* entry idx, value */ 23, VALUE_OPT_VERSION,
-     /* equiv idx, value */ 23, VALUE_OPT_VERSION,
+  {  /* entry idx, value */ 23, VALUE_OPT_THREADS,
+     /* equiv idx, value */ 23, VALUE_OPT_THREADS,
+     /* equivalenced to  */ NO_EQUIVALENT,
+     /* min, max, act ct */ 0, 1, 0,
+     /* opt state flags  */ THREADS_FLAGS, 0,
+     /* last opt argumnt */ { THREADS_DFT_ARG },
+     /* arg list/cookie  */ NULL,
+     /* must/cannot opts */ NULL, NULL,
+     /* option proc      */ doOptThreads,
+     /* desc, NAME, name */ THREADS_DESC, THREADS_NAME, THREADS_name,
+     /* disablement strs */ NULL, NULL },
+
+  {  /* entry idx, value */ 24, VALUE_OPT_INDEX,
+     /* equiv idx, value */ 24, VALUE_OPT_INDEX,
+     /* equivalenced to  */ NO_EQUIVALENT,
+     /* min, max, act ct */ 0, 1, 0,
+     /* opt state flags  */ INDEX_FLAGS, 0,
+     /* last opt argumnt */ { NULL }, /* --index */
+     /* arg list/cookie  */ NULL,
+     /* must/cannot opts */ NULL, NULL,
+     /* option proc      */ NULL,
+     /* desc, NAME, name */ INDEX_DESC, INDEX_NAME, INDEX_name,
+     /* disablement strs */ NULL, NULL },
+
+  {  /* entry idx, value */ 25, VALUE_OPT_VERSION,
+     /* equiv idx, value */ 25, VALUE_OPT_VERSION,
      /* equivalenced to  */ NO_EQUIVALENT,
      /* min, max, act ct */ 0, 1, 0,
      /* opt state flags  */ VERSION_FLAGS, 0,
@@ -837,8 +899,8 @@ static tOptDesc optDesc[OPTION_CT] = {
      /* desc, NAME, name */ VERSION_DESC, VERSION_NAME, VERSION_name,
      /* disablement strs */ NULL, NULL },
 
-  {  /* entry idx, value */ 24, VALUE_OPT_LESS_HELP,
-     /* equiv idx, value */ 24, VALUE_OPT_LESS_HELP,
+  {  /* entry idx, value */ 26, VALUE_OPT_LESS_HELP,
+     /* equiv idx, value */ 26, VALUE_OPT_LESS_HELP,
      /* equivalenced to  */ NO_EQUIVALENT,
      /* min, max, act ct */ 0, 1, 0,
      /* opt state flags  */ LESS_HELP_FLAGS, 0,
@@ -905,15 +967,15 @@ static tOptDesc optDesc[OPTION_CT] = {
  *
  *  Define the tcpprep Option Environment
  */
-#define zPROGNAME       (tcpprep_opt_strs+2311)
-#define zUsageTitle     (tcpprep_opt_strs+2319)
-#define zRcName         (tcpprep_opt_strs+2455)
+#define zPROGNAME       (tcpprep_opt_strs+2438)
+#define zUsageTitle     (tcpprep_opt_strs+2446)
+#define zRcName         (tcpprep_opt_strs+2582)
 static char const * const apzHomeList[2] = {
-    tcpprep_opt_strs+2451,
+    tcpprep_opt_strs+2578,
     NULL };
-#define zBugsAddr       (tcpprep_opt_strs+2466)
-#define zExplain        (tcpprep_opt_strs+2504)
-#define zDetail         (tcpprep_opt_strs+2679)
+#define zBugsAddr       (tcpprep_opt_strs+2593)
+#define zExplain        (tcpprep_opt_strs+2631)
+#define zDetail         (tcpprep_opt_strs+2806)
 #define zFullVersion    (NULL)
 /* extracted from optcode.tlib near line 350 */
 
@@ -1306,6 +1368,43 @@ emit_ranges:
     optionShowRange(pOptions, pOptDesc, (void *)rng, 1);
 }
 
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+/**
+ * Code to handle the threads option, when HAVE_PTHREAD is #define-d.
+ *
+ * @param pOptions the tcpprep options data structure
+ * @param pOptDesc the option descriptor for this option.
+ */
+#ifdef HAVE_PTHREAD
+static void
+doOptThreads(tOptions* pOptions, tOptDesc* pOptDesc)
+{
+    static struct {long rmin, rmax;} const rng[1] = {
+        { 1, 64 } };
+    int  ix;
+
+    if (pOptions <= OPTPROC_EMIT_LIMIT)
+        goto emit_ranges;
+    optionNumericVal(pOptions, pOptDesc);
+
+    for (ix = 0; ix < 1; ix++) {
+        if (pOptDesc->optArg.argInt < rng[ix].rmin)
+            continue;  /* ranges need not be ordered. */
+        if (pOptDesc->optArg.argInt == rng[ix].rmin)
+            return;
+        if (rng[ix].rmax == LONG_MIN)
+            continue;
+        if (pOptDesc->optArg.argInt <= rng[ix].rmax)
+            return;
+    }
+
+    option_usage_fp = stderr;
+
+emit_ranges:
+    optionShowRange(pOptions, pOptDesc, (void *)rng, 1);
+}
+#endif /* defined HAVE_PTHREAD */
+
 /* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
 /**
  * Code to handle the version option.
@@ -1316,7 +1415,7 @@ emit_ranges:
 static void
 doOptVersion(tOptions* pOptions, tOptDesc* pOptDesc)
 {
-    /* extracted from tcpprep_opts.def, line 595 */
+    /* extracted from tcpprep_opts.def, line 624 */
 
     fprintf(stderr, "tcpprep version: %s (build %s)", VERSION, git_version());
 #ifdef DEBUG
@@ -1362,7 +1461,7 @@ doOptVersion(tOptions* pOptions, tOptDesc* pOptDesc)
 static void
 doOptLess_Help(tOptions* pOptions, tOptDesc* pOptDesc)
 {
-    /* extracted from tcpprep_opts.def, line 636 */
+    /* extracted from tcpprep_opts.def, line 665 */
 
     USAGE(EXIT_FAILURE);
 
@@ -1431,7 +1530,7 @@ tOptions tcpprepOptions = {
       NO_EQUIVALENT, /* '-#' option index */
       NO_EQUIVALENT /* index of default opt */
     },
-    29 /* full option count */, 25 /* user option count */,
+    31 /* full option count */, 27 /* user option count */,
     tcpprep_full_usage, tcpprep_short_usage,
     NULL, NULL,
     PKGDATADIR, tcpprep_packager_info
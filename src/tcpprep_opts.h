@@ -90,15 +90,17 @@ typedef enum {
     INDEX_OPT_MAXMASK         = 20,
     INDEX_OPT_VERBOSE         = 21,
     INDEX_OPT_DECODE          = 22,
-    INDEX_OPT_VERSION         = 23,
-    INDEX_OPT_LESS_HELP       = 24,
-    INDEX_OPT_HELP            = 25,
-    INDEX_OPT_MORE_HELP       = 26,
-    INDEX_OPT_SAVE_OPTS       = 27,
-    INDEX_OPT_LOAD_OPTS       = 28
+    INDEX_OPT_THREADS         = 23,
+    INDEX_OPT_INDEX           = 24,
+    INDEX_OPT_VERSION         = 25,
+    INDEX_OPT_LESS_HELP       = 26,
+    INDEX_OPT_HELP            = 27,
+    INDEX_OPT_MORE_HELP       = 28,
+    INDEX_OPT_SAVE_OPTS       = 29,
+    INDEX_OPT_LOAD_OPTS       = 30
 } teOptIndex;
 
-#define OPTION_CT    29
+#define OPTION_CT    31
 
 /*
  *  Interface defines for all options.  Replace "n" with the UPPER_CASED
@@ -172,6 +174,11 @@ typedef enum {
         DESC(VERBOSE).fOptState |= OPTST_SET )
 #endif /* ENABLE_VERBOSE */
 #define VALUE_OPT_DECODE         'A'
+#define VALUE_OPT_THREADS        23
+#ifdef HAVE_PTHREAD
+#define OPT_VALUE_THREADS        (DESC(THREADS).optArg.argInt)
+#endif /* HAVE_PTHREAD */
+#define VALUE_OPT_INDEX          24
 #define VALUE_OPT_VERSION        'V'
 #define VALUE_OPT_LESS_HELP      'h'
 #define VALUE_OPT_HELP          'H'
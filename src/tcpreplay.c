@@ -88,6 +88,9 @@ main(int argc, char *argv[])
         errx(-1, "Unable to parse args: %s", tcpreplay_geterr(ctx));
     }
 
+    /* pick the checksum kernel before any worker threads start */
+    csum_init();
+
 #ifdef TCPREPLAY_EDIT
     /* init tcpedit context */
     if (tcpedit_init(&tcpedit, sendpacket_get_dlt(ctx->intf1)) < 0) {
@@ -119,9 +122,8 @@ main(int argc, char *argv[])
     if (ctx->options->enable_file_cache || ctx->options->preload_pcap) {
         /* Initialise each of the file cache structures */
         for (i = 0; i < argc; i++) {
+            memset(&ctx->options->file_cache[i], 0, sizeof(file_cache_t));
             ctx->options->file_cache[i].index = i;
-            ctx->options->file_cache[i].cached = FALSE;
-            ctx->options->file_cache[i].packet_cache = NULL;
         }
     }
 
@@ -137,47 +139,9 @@ main(int argc, char *argv[])
     /* init the signal handlers */
     init_signal_handlers();
 
-    if (gettimeofday(&ctx->stats.start_time, NULL) < 0)
-        errx(-1, "gettimeofday() failed: %s",  strerror(errno));
-
-    /* main loop, when not looping forever */
-    if (ctx->options->loop > 0) {
-        while (ctx->options->loop--) {  /* limited loop */
-            if (ctx->options->dualfile) {
-                /* process two files at a time for network taps */
-                for (i = 0; i < argc; i += 2) {
-                    tcpr_replay_index(ctx, i);
-                }
-            } else {
-                /* process each pcap file in order */
-                for (i = 0; i < argc; i++) {
-                    /* reset cache markers for each iteration */
-                    ctx->cache_byte = 0;
-                    ctx->cache_bit = 0;
-                    tcpr_replay_index(ctx, i);
-                }
-            }
-        }
-    }
-    else {
-        /* loop forever */
-        while (1) {
-            if (ctx->options->dualfile) {
-                /* process two files at a time for network taps */
-                for (i = 0; i < argc; i += 2) {
-                    tcpr_replay_index(ctx, i);
-                }
-            } else {
-                /* process each pcap file in order */
-                for (i = 0; i < argc; i++) {
-                    /* reset cache markers for each iteration */
-                    ctx->cache_byte = 0;
-                    ctx->cache_bit = 0;
-                    tcpr_replay_index(ctx, i);
-                }
-            }
-        }
-    }
+    /* replay every source --loop times, with --threads workers if asked */
+    if (tcpreplay_replay(ctx, 0) < 0)
+        errx(-1, "Error replaying packets: %s", tcpreplay_geterr(ctx));
 
     if (ctx->stats.bytes_sent > 0) {
         if (gettimeofday(&ctx->stats.end_time, NULL) < 0)
@@ -30,6 +30,9 @@
 #include <unistd.h>
 #include <errno.h>
 #include <stdarg.h>
+#ifdef HAVE_PTHREAD
+#include <pthread.h>
+#endif
 
 #include "tcpreplay_api.h"
 #include "send_packets.h"
@@ -43,7 +46,18 @@
 #endif
 #endif
 
+#ifdef HAVE_PTHREAD
+/* a --threads worker: its own context & interface, sharing our options */
+struct tcpreplay_worker_s {
+    tcpreplay_t ctx;
+    pthread_t thread;
+    int rcode;
+    volatile bool done;
+};
 
+static int tcpr_replay_threaded(tcpreplay_t *ctx);
+static void free_workers(tcpreplay_t *ctx);
+#endif
 
 /**
  * \brief Returns a string describing the last error.
@@ -102,6 +116,7 @@ tcpreplay_init()
     ctx->options->accurate = accurate_gtod;
 #endif
     ctx->options->rdtsc_clicks = -1;
+    ctx->options->spin_threshold = TCPREPLAY_SPIN_THRESHOLD;
 
     /* set the default MTU size */
     ctx->options->mtu = DEFAULT_MTU;
@@ -109,6 +124,26 @@ tcpreplay_init()
     /* disable limit send */
     ctx->options->limit_send = -1;
 
+    /* flush packets in bursts when the timing allows it */
+    ctx->options->burst = TCPREPLAY_BURST_DEFAULT;
+
+    /* single threaded, replay every source */
+    ctx->options->threads = 1;
+    ctx->options->pipeline_slots = PKTRING_DEFAULT_SLOTS;
+    ctx->options->pipeline_cpu_reader = -1;
+    ctx->options->pipeline_cpu_sender = -1;
+    ctx->source_stride = 1;
+
+    /* do_sleep() starts from scratch */
+    ctx->sleep.nsec_adjuster = -1;
+    ctx->sleep.nsec_times = -1;
+    ctx->sleep.first_time = true;
+
+#ifdef HAVE_TX_RING
+    ctx->options->txring_frames = TXRING_DEFAULT_FRAMES;
+    ctx->options->txring_batch = TXRING_DEFAULT_BATCH;
+#endif
+
 #ifdef ENABLE_VERBOSE
     /* clear out tcpdump struct */
     ctx->options->tcpdump = (tcpdump_t *)safe_malloc(sizeof(tcpdump_t));
@@ -163,6 +198,44 @@ tcpreplay_post_args(tcpreplay_t *ctx, int argc)
     if (HAVE_OPT(LIMIT))
         options->limit_send = OPT_VALUE_LIMIT;
 
+    if (HAVE_OPT(START_PACKET))
+        options->start_packet = OPT_VALUE_START_PACKET;
+
+    if (HAVE_OPT(BURST))
+        options->burst = OPT_VALUE_BURST;
+
+#ifdef HAVE_PTHREAD
+#ifndef TCPREPLAY_EDIT
+    if (HAVE_OPT(THREADS) && tcpreplay_set_threads(ctx, OPT_VALUE_THREADS) < 0)
+        return -1;
+#endif
+
+    if (HAVE_OPT(PIPELINE)) {
+        if (tcpreplay_set_pipeline(ctx, true, OPT_VALUE_PIPELINE_SLOTS) < 0)
+            return -1;
+
+        if (HAVE_OPT(PIPELINE_CPUS)) {
+            int reader, sender;
+
+            if (sscanf(OPT_ARG(PIPELINE_CPUS), "%d,%d", &reader, &sender) != 2) {
+                tcpreplay_seterr(ctx, "Invalid --pipeline-cpus value: %s", OPT_ARG(PIPELINE_CPUS));
+                return -1;
+            }
+
+            if (tcpreplay_set_pipeline_cpus(ctx, reader, sender) < 0)
+                return -1;
+        }
+    }
+
+    if (HAVE_OPT(PREFETCH) &&
+            tcpreplay_set_prefetch(ctx, (size_t)OPT_VALUE_PREFETCH * 1024 * 1024) < 0)
+        return -1;
+#endif /* HAVE_PTHREAD */
+
+#ifdef HAVE_TX_RING
+    tcpreplay_set_txring(ctx, OPT_VALUE_TXRING_FRAMES, OPT_VALUE_TXRING_BATCH);
+#endif
+
     if (HAVE_OPT(TOPSPEED)) {
         options->speed.mode = speed_topspeed;
         options->speed.speed = 0;
@@ -211,6 +284,9 @@ tcpreplay_post_args(tcpreplay_t *ctx, int argc)
         options->enable_file_cache = true;
     }
 
+    if (HAVE_OPT(CACHE_HUGEPAGES))
+        options->cache_hugepages = true;
+
     /* Dual file mode */
     if (HAVE_OPT(DUALFILE)) {
         options->dualfile = true;
@@ -252,6 +328,13 @@ tcpreplay_post_args(tcpreplay_t *ctx, int argc)
             options->accurate = accurate_gtod;
         } else if (strcmp(OPT_ARG(TIMER), "nano") == 0) {
             options->accurate = accurate_nanosleep;
+        } else if (strcmp(OPT_ARG(TIMER), "deadline") == 0) {
+#ifdef HAVE_CLOCK_GETTIME
+            options->accurate = accurate_deadline;
+#else
+            tcpreplay_seterr(ctx, "%s", "tcpreplay_api not compiled with clock_gettime() support");
+            return -1;
+#endif
         } else if (strcmp(OPT_ARG(TIMER), "abstime") == 0) {
 #ifdef HAVE_ABSOLUTE_TIME
             options->accurate = accurate_abs_time;
@@ -269,6 +352,9 @@ tcpreplay_post_args(tcpreplay_t *ctx, int argc)
         }
     }
 
+    if (HAVE_OPT(SPIN_THRESHOLD))
+        options->spin_threshold = OPT_VALUE_SPIN_THRESHOLD * 1000;
+
 #ifdef HAVE_RDTSC
     if (HAVE_OPT(RDTSC_CLICKS)) {
         rdtsc_calibrate(OPT_VALUE_RDTSC_CLICKS);
@@ -289,7 +375,8 @@ tcpreplay_post_args(tcpreplay_t *ctx, int argc)
     options->intf1_name = safe_strdup(intname);
 
     /* open interfaces for writing */
-    if ((ctx->intf1 = sendpacket_open(options->intf1_name, ebuf, TCPR_DIR_C2S)) == NULL) {
+    if ((ctx->intf1 = sendpacket_open(options->intf1_name, ebuf, TCPR_DIR_C2S,
+                    options->txring_frames, options->txring_batch)) == NULL) {
         tcpreplay_seterr(ctx, "Can't open %s: %s", options->intf1_name, ebuf);
         return -1;
     }
@@ -305,7 +392,8 @@ tcpreplay_post_args(tcpreplay_t *ctx, int argc)
         options->intf2_name = safe_strdup(intname);
 
         /* open interface for writing */
-        if ((ctx->intf2 = sendpacket_open(options->intf2_name, ebuf, TCPR_DIR_S2C)) == NULL) {
+        if ((ctx->intf2 = sendpacket_open(options->intf2_name, ebuf, TCPR_DIR_S2C,
+                        options->txring_frames, options->txring_batch)) == NULL) {
             tcpreplay_seterr(ctx, "Can't open %s: %s", options->intf2_name, ebuf);
         }
 
@@ -320,8 +408,7 @@ tcpreplay_post_args(tcpreplay_t *ctx, int argc)
 
     if (HAVE_OPT(CACHEFILE)) {
         temp = safe_strdup(OPT_ARG(CACHEFILE));
-        options->cache_packets = read_cache(&options->cachedata, temp,
-            &options->comment);
+        open_cache(&options->cache, temp);
         safe_free(temp);
     }
 
@@ -346,19 +433,23 @@ tcpreplay_close(tcpreplay_t *ctx)
 {
     tcpreplay_opt_t *options;
     interface_list_t *intlist, *intlistnext;
-    packet_cache_t *packet_cache, *next;
+    int i;
 
     assert(ctx);
     assert(ctx->options);
     options = ctx->options;
 
+#ifdef HAVE_PTHREAD
+    free_workers(ctx);
+#endif
+
     safe_free(options->intf1_name);
     safe_free(options->intf2_name);
     sendpacket_close(ctx->intf1);
     if (ctx->intf2 != NULL)
         sendpacket_close(ctx->intf2);
-    safe_free(options->cachedata);
-    safe_free(options->comment);
+    close_cache(&options->cache);
+    safe_free(ctx->burst_buf);
 
 #ifdef ENABLE_VERBOSE
     safe_free(options->tcpdump_args);
@@ -366,15 +457,8 @@ tcpreplay_close(tcpreplay_t *ctx)
 #endif
 
     /* free the file cache */
-    if (options->file_cache != NULL) {
-        packet_cache = options->file_cache->packet_cache;
-        while (packet_cache != NULL) {
-            next = packet_cache->next;
-            safe_free(packet_cache->pktdata);
-            safe_free(packet_cache);
-            packet_cache = next;
-        }
-    }
+    for (i = 0; i < options->source_cnt; i++)
+        free_file_cache(&options->file_cache[i]);
 
     /* free our interface list */
     if (ctx->intlist != NULL) {
@@ -413,7 +497,8 @@ tcpreplay_set_interface(tcpreplay_t *ctx, tcpreplay_intf intf, char *value)
         ctx->options->intf1_name = safe_strdup(intname);
 
         /* open interfaces for writing */
-        if ((ctx->intf1 = sendpacket_open(ctx->options->intf1_name, ebuf, TCPR_DIR_C2S)) == NULL) {
+        if ((ctx->intf1 = sendpacket_open(ctx->options->intf1_name, ebuf, TCPR_DIR_C2S,
+                        ctx->options->txring_frames, ctx->options->txring_batch)) == NULL) {
             tcpreplay_seterr(ctx, "Can't open %s: %s", ctx->options->intf1_name, ebuf);
             return -1;
         }
@@ -428,7 +513,8 @@ tcpreplay_set_interface(tcpreplay_t *ctx, tcpreplay_intf intf, char *value)
         ctx->options->intf2_name = safe_strdup(intname);
 
         /* open interface for writing */
-        if ((ctx->intf2 = sendpacket_open(ctx->options->intf2_name, ebuf, TCPR_DIR_S2C)) == NULL) {
+        if ((ctx->intf2 = sendpacket_open(ctx->options->intf2_name, ebuf, TCPR_DIR_S2C,
+                        ctx->options->txring_frames, ctx->options->txring_batch)) == NULL) {
             tcpreplay_seterr(ctx, "Can't open %s: %s", ctx->options->intf2_name, ebuf);
             return -1;
         }
@@ -555,6 +641,22 @@ tcpreplay_set_rdtsc_clicks(tcpreplay_t *ctx, int value)
     return 0;
 }
 
+/**
+ * \brief Sets how long accurate_deadline busy waits
+ *
+ * With accurate_deadline we nanosleep() until this many nsec before a
+ * packet is due and then spin on the clock.  Larger values are more
+ * accurate at the cost of CPU time; it should be at least the usual
+ * nanosleep() oversleep of the OS (tens of usec on Linux).
+ */
+int
+tcpreplay_set_spin_threshold(tcpreplay_t *ctx, u_int32_t value)
+{
+    assert(ctx);
+    ctx->options->spin_threshold = value;
+    return 0;
+}
+
 /**
  * Sets the number of seconds between printing stats
  */
@@ -612,6 +714,21 @@ tcpreplay_set_preload_pcap(tcpreplay_t *ctx, bool value)
     return 0;
 }
 
+/**
+ * \brief Back the file cache with huge pages
+ *
+ * Large caches are allocated with mmap() and use explicit huge pages if the
+ * system has any reserved, falling back to transparent huge pages.  Cuts
+ * down on TLB misses when replaying multi-GB pcaps from RAM.
+ */
+int
+tcpreplay_set_cache_hugepages(tcpreplay_t *ctx, bool value)
+{
+    assert(ctx);
+    ctx->options->cache_hugepages = value;
+    return 0;
+}
+
 /**
  * \brief Add a pcap file to be sent via tcpreplay
  *
@@ -633,9 +750,8 @@ tcpreplay_add_pcapfile(tcpreplay_t *ctx, char *pcap_file)
          * file caching for this pcap (that is controlled globally via
          * tcpreplay_set_file_cache())
          */
+        memset(&ctx->options->file_cache[ctx->options->source_cnt], 0, sizeof(file_cache_t));
         ctx->options->file_cache[ctx->options->source_cnt].index = ctx->options->source_cnt;
-        ctx->options->file_cache[ctx->options->source_cnt].cached = false;
-        ctx->options->file_cache[ctx->options->source_cnt].packet_cache = NULL;
 
         ctx->options->source_cnt += 1;
 
@@ -658,6 +774,184 @@ tcpreplay_set_limit_send(tcpreplay_t *ctx, COUNTER value)
     return 0;
 }
 
+/**
+ * \brief Start sending at the given packet (1 is the first) of the pcap
+ *
+ * Seeks straight to it with the index of a tcpprep cache created with
+ * --index, otherwise the packets before it are read and thrown away.
+ * Not supported with the file cache or two files.
+ */
+int
+tcpreplay_set_start_packet(tcpreplay_t *ctx, COUNTER value)
+{
+    assert(ctx);
+
+    if (value < 1) {
+        tcpreplay_seterr(ctx, "%s", "start packet must be 1 or greater");
+        return -1;
+    }
+
+    ctx->options->start_packet = value;
+    return 0;
+}
+
+/**
+ * \brief Set the max number of packets to send per burst
+ *
+ * When the speed mode doesn't require sleeping between packets, up to this
+ * many packets are queued and then sent with a single sendpacket_batch()
+ * call.  Set to 1 to disable bursting.
+ */
+int
+tcpreplay_set_burst(tcpreplay_t *ctx, int value)
+{
+    assert(ctx);
+
+    if (value < 1 || value > SENDPACKET_BURST_MAX) {
+        tcpreplay_seterr(ctx, "burst must be between 1 and %d", SENDPACKET_BURST_MAX);
+        return -1;
+    }
+
+    ctx->options->burst = value;
+    return 0;
+}
+
+/**
+ * \brief Set the number of threads to replay with
+ *
+ * Each thread opens its own socket on the output interface (and hence gets
+ * its own TX queue/ring).  With at least as many pcap files as threads the
+ * files are split between the threads, otherwise every thread reads all of
+ * the files and only sends the flows which hash to it so that packets within
+ * a flow stay in order.  Rate limits and --limit apply to the sum of all
+ * threads.  Only single file/single interface replays can be threaded.
+ */
+int
+tcpreplay_set_threads(tcpreplay_t *ctx, int value)
+{
+    assert(ctx);
+
+    if (value < 1 || value > TCPREPLAY_MAX_THREADS) {
+        tcpreplay_seterr(ctx, "threads must be between 1 and %d", TCPREPLAY_MAX_THREADS);
+        return -1;
+    }
+
+#ifndef HAVE_PTHREAD
+    if (value > 1) {
+        tcpreplay_seterr(ctx, "%s", "tcpreplay_api not compiled with pthread support");
+        return -1;
+    }
+#endif
+
+    ctx->options->threads = value;
+    return 0;
+}
+
+/**
+ * \brief Enable/disable the reader/sender pipeline
+ *
+ * When enabled, packets are read (and edited by tcpreplay-edit) on a
+ * separate thread and handed to the sending thread through a lock-free
+ * ring of the given number of packets (0 keeps the current size).  The
+ * sending thread then only has to deal with timing and the network.
+ */
+int
+tcpreplay_set_pipeline(tcpreplay_t *ctx, bool value, u_int32_t slots)
+{
+    assert(ctx);
+
+#ifdef HAVE_PTHREAD
+    ctx->options->pipeline = value;
+    if (slots > 0)
+        ctx->options->pipeline_slots = slots;
+    return 0;
+#else
+    if (!value)
+        return 0;
+
+    tcpreplay_seterr(ctx, "%s", "tcpreplay_api not compiled with pthread support");
+    return -1;
+#endif
+}
+
+/**
+ * \brief Pin the pipeline reader & sender threads to the given CPUs
+ *
+ * Use -1 to let the OS schedule a thread on any CPU
+ */
+int
+tcpreplay_set_pipeline_cpus(tcpreplay_t *ctx, int reader, int sender)
+{
+    assert(ctx);
+
+#ifndef HAVE_PTHREAD_SETAFFINITY_NP
+    if (reader >= 0 || sender >= 0) {
+        tcpreplay_seterr(ctx, "%s", "pinning threads to a CPU is not supported on this platform");
+        return -1;
+    }
+#endif
+
+    if (reader < -1 || sender < -1) {
+        tcpreplay_seterr(ctx, "%s", "invalid pipeline CPU number");
+        return -1;
+    }
+
+    ctx->options->pipeline_cpu_reader = reader;
+    ctx->options->pipeline_cpu_sender = sender;
+    return 0;
+}
+
+/**
+ * \brief Set how many bytes of the pcap to read ahead of the sender
+ *
+ * A separate thread pages in the (mapped) pcap up to this many bytes ahead
+ * of where we're reading, so files which aren't cached don't stall the
+ * sender waiting on the disk.  0 disables the read-ahead thread.
+ */
+int
+tcpreplay_set_prefetch(tcpreplay_t *ctx, size_t bytes)
+{
+    assert(ctx);
+
+#ifdef HAVE_PTHREAD
+    ctx->options->prefetch = bytes;
+    return 0;
+#else
+    if (bytes == 0)
+        return 0;
+
+    tcpreplay_seterr(ctx, "%s", "tcpreplay_api not compiled with pthread support");
+    return -1;
+#endif
+}
+
+/**
+ * \brief Set the Linux TX_RING size and kick batch
+ *
+ * frames is the number of frames in the ring and batch is how many frames
+ * are queued before the kernel is told to transmit them.  Pass 0 to keep
+ * the current value.  Only affects interfaces opened afterwards, so call
+ * this before tcpreplay_set_interface().  Returns -1 if TX_RING isn't
+ * supported.
+ */
+int
+tcpreplay_set_txring(tcpreplay_t *ctx, u_int32_t frames, u_int32_t batch)
+{
+    assert(ctx);
+
+#ifdef HAVE_TX_RING
+    if (frames > 0)
+        ctx->options->txring_frames = frames;
+    if (batch > 0)
+        ctx->options->txring_batch = batch;
+
+    return 0;
+#else
+    tcpreplay_seterr(ctx, "%s", "TX_RING is not supported on this platform");
+    return -1;
+#endif
+}
+
 /**
  * \brief Specify the tcpprep cache file to use for replaying with two NICs
  *
@@ -676,8 +970,8 @@ tcpreplay_set_tcpprep_cache(tcpreplay_t *ctx, char *file)
     }
 
     tcpprep_file = safe_strdup(file);
-    ctx->options->cache_packets = read_cache(&ctx->options->cachedata, 
-        tcpprep_file, &ctx->options->comment);
+    close_cache(&ctx->options->cache);
+    open_cache(&ctx->options->cache, tcpprep_file);
 
     free(tcpprep_file);
 
@@ -917,12 +1211,12 @@ tcpreplay_prepare(tcpreplay_t *ctx)
         }
     }
 
-    if (ctx->options->dualfile && ctx->options->cachedata != NULL) {
+    if (ctx->options->dualfile && ctx->options->cache.data != NULL) {
         tcpreplay_seterr(ctx, "%s", "Can't use dual file mode and tcpprep cache file together");
         return -1;
     }
 
-    if ((ctx->options->dualfile || ctx->options->cachedata != NULL) && 
+    if ((ctx->options->dualfile || ctx->options->cache.data != NULL) && 
            ctx->options->intf2_name == NULL) {
         tcpreplay_seterr(ctx, "%s", "dual file mode and tcpprep cache files require two interfaces");
     }
@@ -953,6 +1247,12 @@ tcpreplay_prepare(tcpreplay_t *ctx)
         ioport_sleep_init();
     }
 #endif
+#ifndef HAVE_CLOCK_GETTIME
+    if (ctx->options->accurate == accurate_deadline) {
+        tcpreplay_seterr(ctx, "%s", "tcpreplay_api not compiled with clock_gettime() support");
+        return -1;
+    }
+#endif
 #ifndef HAVE_ABSOLUTE_TIME
     if (ctx->options->accurate == accurate_abs_time) {
         tcpreplay_seterr(ctx, "%s", "tcpreplay_api only supports absolute time on Apple OS X");
@@ -966,7 +1266,8 @@ tcpreplay_prepare(tcpreplay_t *ctx)
     }
 
     /* open interfaces for writing */
-    if ((ctx->intf1 = sendpacket_open(ctx->options->intf1_name, ebuf, TCPR_DIR_C2S)) == NULL) {
+    if ((ctx->intf1 = sendpacket_open(ctx->options->intf1_name, ebuf, TCPR_DIR_C2S,
+                    ctx->options->txring_frames, ctx->options->txring_batch)) == NULL) {
         tcpreplay_seterr(ctx, "Can't open %s: %s", ctx->options->intf1_name, ebuf);
         return -1;
     }
@@ -980,7 +1281,8 @@ tcpreplay_prepare(tcpreplay_t *ctx)
         }
 
         /* open interfaces for writing */
-        if ((ctx->intf2 = sendpacket_open(ctx->options->intf2_name, ebuf, TCPR_DIR_C2S)) == NULL) {
+        if ((ctx->intf2 = sendpacket_open(ctx->options->intf2_name, ebuf, TCPR_DIR_C2S,
+                        ctx->options->txring_frames, ctx->options->txring_batch)) == NULL) {
             tcpreplay_seterr(ctx, "Can't open %s: %s", ctx->options->intf2_name, ebuf);
             return -1;
         }
@@ -1000,9 +1302,8 @@ tcpreplay_prepare(tcpreplay_t *ctx)
     if (ctx->options->enable_file_cache && ctx->options->file_cache == NULL) {
         /* Initialise each of the file cache structures */
         for (i = 0; i < ctx->options->source_cnt; i++) {
+            memset(&ctx->options->file_cache[i], 0, sizeof(file_cache_t));
             ctx->options->file_cache[i].index = i;
-            ctx->options->file_cache[i].cached = FALSE;
-            ctx->options->file_cache[i].packet_cache = NULL;
         }
     }
 
@@ -1041,16 +1342,27 @@ tcpreplay_replay(tcpreplay_t *ctx, int idx)
         return -1;
     }
 
+    /* the deadline schedule starts over with the first packet */
+    ctx->sleep.start_ns = 0;
+
     ctx->running = true;
 
+#ifdef HAVE_PTHREAD
+    if (ctx->options->threads > 1) {
+        rcode = tcpr_replay_threaded(ctx);
+        ctx->running = false;
+        return rcode;
+    }
+#endif
+
     /* main loop, when not looping forever */
     if (ctx->options->loop > 0) {
-        while (ctx->options->loop--) {  /* limited loop */
+        while (ctx->options->loop-- && !ctx->abort) {  /* limited loop */
             if ((rcode = tcpr_replay_index(ctx, idx)) < 0)
                 return rcode;
         }
     } else {
-        while (1) { /* loop forever */
+        while (!ctx->abort) { /* loop forever */
             if ((rcode = tcpr_replay_index(ctx, idx)) < 0)
                 return rcode;
         }
@@ -1060,6 +1372,239 @@ tcpreplay_replay(tcpreplay_t *ctx, int idx)
     return 0;
 }
 
+#ifdef HAVE_PTHREAD
+/**
+ * thread entry point for a --threads worker.  Loops over its share of the
+ * sources just like tcpreplay_replay() does for a single thread
+ */
+static void *
+tcpr_worker_main(void *arg)
+{
+    struct tcpreplay_worker_s *worker = (struct tcpreplay_worker_s *)arg;
+    tcpreplay_t *ctx = &worker->ctx;
+    u_int32_t loop = ctx->options->loop;
+
+    ctx->running = true;
+    while (!ctx->abort && (ctx->options->loop == 0 || loop-- > 0)) {
+        if ((worker->rcode = tcpr_replay_index(ctx, 0)) < 0)
+            break;
+    }
+
+    ctx->running = false;
+    worker->done = true;
+    return NULL;
+}
+
+/**
+ * sums the per-worker counters into the main context
+ */
+static void
+merge_worker_stats(tcpreplay_t *ctx)
+{
+    int i;
+
+    ctx->stats.pkts_sent = 0;
+    ctx->stats.bytes_sent = 0;
+    ctx->stats.failed = 0;
+    ctx->stats.read_ahead = 0;
+    ctx->stats.read_stalls = 0;
+    ctx->stats.jitter_samples = 0;
+    ctx->stats.jitter_total = 0;
+    ctx->stats.jitter_max = 0;
+    memset(ctx->stats.jitter, 0, sizeof(ctx->stats.jitter));
+    for (i = 0; i < ctx->worker_cnt; i++) {
+        ctx->stats.pkts_sent += ctx->workers[i].ctx.stats.pkts_sent;
+        ctx->stats.bytes_sent += ctx->workers[i].ctx.stats.bytes_sent;
+        ctx->stats.failed += ctx->workers[i].ctx.stats.failed;
+        ctx->stats.read_ahead += ctx->workers[i].ctx.stats.read_ahead;
+        ctx->stats.read_stalls += ctx->workers[i].ctx.stats.read_stalls;
+        merge_jitter_stats(&ctx->stats, &ctx->workers[i].ctx.stats);
+    }
+}
+
+/**
+ * closes the worker interfaces & frees the workers
+ */
+static void
+free_workers(tcpreplay_t *ctx)
+{
+    int i;
+
+    for (i = 0; i < ctx->worker_cnt; i++) {
+        if (ctx->workers[i].ctx.intf1 != NULL)
+            sendpacket_close(ctx->workers[i].ctx.intf1);
+        safe_free(ctx->workers[i].ctx.burst_buf);
+    }
+
+    safe_free(ctx->workers);
+    safe_free(ctx->budget);
+    ctx->worker_cnt = 0;
+}
+
+/**
+ * Replays with ctx->options->threads worker threads.  The sources are split
+ * between the workers if there are enough of them, otherwise every worker
+ * reads every source and keeps its own share of the flows.  The calling
+ * thread just waits, prints the --stats and merges the counters.
+ */
+static int
+tcpr_replay_threaded(tcpreplay_t *ctx)
+{
+    tcpreplay_opt_t *options = ctx->options;
+    struct tcpreplay_worker_s *worker;
+    struct timeval now, last_print_time, print_delta;
+    struct timespec poll_nap = { 0, 10000000 };
+    char ebuf[SENDPACKET_ERRBUF_SIZE];
+    int threads = options->threads, started = 0, running, i, rcode = 0;
+    u_int64_t start_ns = 0;
+    bool flows;
+
+    if (options->dualfile || options->cache.data != NULL || ctx->intf2 != NULL) {
+        tcpreplay_seterr(ctx, "%s", "--threads only supports replaying out a single interface");
+        return -1;
+    }
+
+    if (options->speed.mode == speed_oneatatime) {
+        tcpreplay_seterr(ctx, "%s", "--threads can't be used with --oneatatime");
+        return -1;
+    }
+
+    if (options->pipeline) {
+        tcpreplay_seterr(ctx, "%s", "--threads can't be used with --pipeline");
+        return -1;
+    }
+
+#ifdef ENABLE_VERBOSE
+    if (options->verbose) {
+        tcpreplay_seterr(ctx, "%s", "--threads can't be used with --verbose");
+        return -1;
+    }
+#endif
+
+    /* throw away the workers of an earlier tcpreplay_replay() */
+    free_workers(ctx);
+
+    /* one source per worker at minimum, otherwise split by flow */
+    flows = options->source_cnt < threads;
+
+    /* workers share the file cache, so it has to be filled up front */
+    if (flows && options->enable_file_cache) {
+        for (i = 0; i < options->source_cnt; i++) {
+            if (!options->file_cache[i].cached)
+                preload_pcap_file(ctx, i);
+        }
+    }
+
+    ctx->budget = (tcpreplay_budget_t *)safe_malloc(sizeof(tcpreplay_budget_t));
+    ctx->workers = (struct tcpreplay_worker_s *)safe_malloc(sizeof(struct tcpreplay_worker_s) * threads);
+    ctx->worker_cnt = threads;
+
+#ifdef HAVE_CLOCK_GETTIME
+    start_ns = get_monotonic_ns();
+#endif
+
+    for (i = 0; i < threads; i++) {
+        worker = &ctx->workers[i];
+        worker->ctx.options = options;
+        worker->ctx.intlist = ctx->intlist;
+        worker->ctx.parent = ctx;
+        worker->ctx.budget = ctx->budget;
+        worker->ctx.sleep.nsec_adjuster = -1;
+        worker->ctx.sleep.nsec_times = -1;
+        worker->ctx.sleep.first_time = true;
+        memcpy(&worker->ctx.stats.start_time, &ctx->stats.start_time, sizeof(struct timeval));
+        /* workers share one deadline schedule for the combined rate */
+        worker->ctx.sleep.start_ns = start_ns;
+
+        if (flows) {
+            worker->ctx.source_first = 0;
+            worker->ctx.source_stride = 1;
+            worker->ctx.flow_id = i;
+            worker->ctx.flow_cnt = threads;
+            worker->ctx.flow_dlt = sendpacket_get_dlt(ctx->intf1);
+            if (worker->ctx.flow_dlt < 0)
+                worker->ctx.flow_dlt = DLT_EN10MB;
+        } else {
+            worker->ctx.source_first = i;
+            worker->ctx.source_stride = threads;
+        }
+
+        /* every worker gets its own socket so the kernel can use a TX queue per thread */
+        if ((worker->ctx.intf1 = sendpacket_open(options->intf1_name, ebuf, TCPR_DIR_C2S,
+                        options->txring_frames, options->txring_batch)) == NULL) {
+            tcpreplay_seterr(ctx, "Can't open %s: %s", options->intf1_name, ebuf);
+            rcode = -1;
+            break;
+        }
+    }
+
+    if (rcode == 0) {
+        for (started = 0; started < threads; started++) {
+            if ((errno = pthread_create(&ctx->workers[started].thread, NULL,
+                    tcpr_worker_main, &ctx->workers[started])) != 0) {
+                tcpreplay_seterr(ctx, "Unable to start worker thread: %s", strerror(errno));
+                rcode = -1;
+                tcpreplay_abort(ctx);
+                break;
+            }
+        }
+    }
+
+    /* wait for the workers, passing on aborts & printing stats */
+    timerclear(&last_print_time);
+    do {
+        running = 0;
+        for (i = 0; i < started; i++) {
+            if (!ctx->workers[i].done)
+                running++;
+        }
+
+        if (ctx->abort) {
+            for (i = 0; i < started; i++)
+                tcpreplay_abort(&ctx->workers[i].ctx);
+        }
+
+        if (options->stats > 0) {
+            if (gettimeofday(&now, NULL) < 0)
+                errx(-1, "gettimeofday() failed: %s",  strerror(errno));
+
+            if (! timerisset(&last_print_time)) {
+                memcpy(&last_print_time, &now, sizeof(struct timeval));
+            } else {
+                timersub(&now, &last_print_time, &print_delta);
+                if (print_delta.tv_sec >= options->stats) {
+                    merge_worker_stats(ctx);
+                    memcpy(&ctx->stats.end_time, &now, sizeof(struct timeval));
+                    packet_stats(&ctx->stats);
+                    memcpy(&last_print_time, &now, sizeof(struct timeval));
+                }
+            }
+        }
+
+        if (running > 0)
+            nanosleep(&poll_nap, NULL);
+    } while (running > 0);
+
+    for (i = 0; i < started; i++) {
+        pthread_join(ctx->workers[i].thread, NULL);
+        if (ctx->workers[i].rcode < 0 && rcode == 0) {
+            strlcpy(ctx->errstr, ctx->workers[i].ctx.errstr, sizeof(ctx->errstr));
+            rcode = -1;
+        }
+
+        sendpacket_addstats(ctx->intf1, ctx->workers[i].ctx.intf1);
+    }
+
+    merge_worker_stats(ctx);
+    if (gettimeofday(&ctx->stats.end_time, NULL) < 0) {
+        tcpreplay_seterr(ctx, "gettimeofday() failed: %s",  strerror(errno));
+        return -1;
+    }
+
+    return rcode;
+}
+#endif /* HAVE_PTHREAD */
+
 /**
  * \brief Abort the tcpreplay_replay execution.
  *
@@ -1073,6 +1618,17 @@ tcpreplay_abort(tcpreplay_t *ctx)
     assert(ctx);
     ctx->abort = true;
 
+#ifdef HAVE_PTHREAD
+    {
+        int i;
+        for (i = 0; i < ctx->worker_cnt; i++) {
+            ctx->workers[i].ctx.abort = true;
+            if (ctx->workers[i].ctx.intf1 != NULL)
+                sendpacket_abort(ctx->workers[i].ctx.intf1);
+        }
+    }
+#endif
+
     if (ctx->intf1 != NULL)
         sendpacket_abort(ctx->intf1);
 
@@ -41,20 +41,6 @@ extern "C" {
 
 struct tcpreplay_s; /* forward declare */
 
-/* in memory packet cache struct */
-typedef struct packet_cache_s {
-    struct pcap_pkthdr pkthdr;
-    u_char *pktdata;
-    struct packet_cache_s *next;
-} packet_cache_t;
-
-/* packet cache header */
-typedef struct file_cache_s {
-    int index;
-    int cached;
-    packet_cache_t *packet_cache;
-} file_cache_t;
-
 /* speed mode selector */
 typedef enum {
     speed_multiplier = 1,
@@ -74,6 +60,37 @@ typedef struct {
     u_int32_t (*manual_callback)(struct tcpreplay_s *, char *, COUNTER);
 } tcpreplay_speed_t;
 
+/* every record in the file cache arena starts on this boundary */
+#define PACKET_CACHE_ALIGN 64
+
+/*
+ * in memory packet cache record.  The captured packet data immediately
+ * follows the header in the arena.
+ */
+typedef struct packet_cache_s {
+    struct pcap_pkthdr pkthdr;
+    u_char pktdata[];
+} packet_cache_t;
+
+/*
+ * packet cache header.  All the packets of a file are packed into a single
+ * arena in file order and located via the offset index
+ */
+typedef struct file_cache_s {
+    int index;
+    int cached;
+    u_char *arena;              /* packet_cache_t records */
+    size_t arena_len;           /* bytes used */
+    size_t arena_size;          /* bytes allocated */
+    bool arena_mapped;          /* arena is mmap()'d rather than malloc()'d */
+    size_t *offsets;            /* arena offset of each record */
+    COUNTER offsets_size;       /* # of entries allocated in offsets */
+    COUNTER pkt_cnt;            /* # of records in the arena */
+    bool edited;                /* tcpreplay-edit: records are already edited */
+    u_int64_t *schedule;        /* nsec each record is due after the first */
+    tcpreplay_speed_t schedule_speed; /* speed settings the schedule is for */
+} file_cache_t;
+
 /* accurate mode selector */
 typedef enum {
     accurate_gtod = 0,
@@ -81,9 +98,13 @@ typedef enum {
     accurate_rdtsc = 2,
     accurate_ioport = 3,
     accurate_nanosleep = 4,
-    accurate_abs_time = 5
+    accurate_abs_time = 5,
+    accurate_deadline = 6
 } tcpreplay_accurate;
 
+/* default # of nsec accurate_deadline busy waits before each deadline */
+#define TCPREPLAY_SPIN_THRESHOLD 50000
+
 typedef enum {
     source_filename = 1,
     source_fd = 2,
@@ -96,6 +117,39 @@ typedef struct {
     char *filename;
 } tcpreplay_source_t;
 
+/* default number of packets to queue before flushing them out the interface */
+#define TCPREPLAY_BURST_DEFAULT 32
+
+/* max # of --threads workers */
+#define TCPREPLAY_MAX_THREADS 64
+
+/* do_sleep() state carried from one packet to the next */
+typedef struct {
+    struct timespec nap;
+    struct timespec delta_time;
+    int32_t nsec_adjuster;
+    int32_t nsec_times;
+    u_int32_t send;             /* # of packets to send w/o sleeping */
+    bool first_time;            /* for the pps_multi accelerator */
+    COUNTER skip_length;
+    /* accurate_deadline schedule: packets are due relative to start_ns */
+    u_int64_t start_ns;
+    COUNTER start_pkts;
+    COUNTER start_bytes;
+    u_int64_t base_ns;          /* --multiplier: when the first packet of the file went out */
+    struct timeval base_ts;     /* ...and its pcap timestamp */
+} tcpreplay_sleep_t;
+
+/*
+ * counters shared by all the --threads workers so that the rate and
+ * --limit apply to the sum of the workers.  Updated atomically.
+ */
+typedef struct {
+    volatile COUNTER pkts_sent;
+    volatile COUNTER bytes_sent;
+    volatile COUNTER pkts_reserved;     /* for --limit */
+} tcpreplay_budget_t;
+
 /* run-time options */
 typedef struct tcpreplay_opt_s {
     /* input/output */
@@ -110,9 +164,7 @@ typedef struct tcpreplay_opt_s {
     bool use_pkthdr_len;
 
     /* tcpprep cache data */
-    COUNTER cache_packets;
-    char *cachedata;
-    char *comment; /* tcpprep comment */
+    tcpr_cache_map_t cache;
 
     /* deal with MTU/packet len issues */
     int mtu;
@@ -120,14 +172,38 @@ typedef struct tcpreplay_opt_s {
     /* accurate mode to use */
     tcpreplay_accurate accurate;
     int rdtsc_clicks;
+    u_int32_t spin_threshold;   /* nsec */
 
     /* limit # of packets to send */
     COUNTER limit_send;
 
+    /* first packet of the pcap to send, 0 = the start of the file */
+    COUNTER start_packet;
+
+    /* max # of packets to flush per sendpacket_batch() call */
+    int burst;
+
+    /* # of worker threads to replay with */
+    int threads;
+
+    /* read/edit on one thread & send on another, pinned to the given CPUs (-1 = any) */
+    bool pipeline;
+    u_int32_t pipeline_slots;
+    int pipeline_cpu_reader;
+    int pipeline_cpu_sender;
+
+    /* # of bytes to page in ahead of the reader, 0 = no read-ahead thread */
+    size_t prefetch;
+
+    /* Linux TX_RING size & # of frames to queue before kicking the kernel */
+    u_int32_t txring_frames;
+    u_int32_t txring_batch;
+
     /* pcap file caching */
     bool enable_file_cache;
     file_cache_t file_cache[MAX_FILES];
     bool preload_pcap;
+    bool cache_hugepages;
 
     /* pcap files/sources to replay */
     int source_cnt;
@@ -152,6 +228,8 @@ typedef enum {
     intf2
 } tcpreplay_intf;
 
+struct tcpreplay_worker_s; /* private to tcpreplay_api.c */
+
 /* tcpreplay context variable */
 #define TCPREPLAY_ERRSTR_LEN 1024
 typedef struct tcpreplay_s {
@@ -166,6 +244,27 @@ typedef struct tcpreplay_s {
     int cache_byte;
     int current_source; /* current source input being replayed */
 
+    /* copy of queued packets waiting for sendpacket_batch() */
+    u_char *burst_buf;
+
+    /* timing state for do_sleep() */
+    tcpreplay_sleep_t sleep;
+
+    /*
+     * --threads: the main context owns the workers.  Each worker replays
+     * every source_stride'th source starting at source_first and, if
+     * flow_cnt > 1, only the flows which hash to flow_id.
+     */
+    struct tcpreplay_s *parent;
+    struct tcpreplay_worker_s *workers;
+    int worker_cnt;
+    int source_first;
+    int source_stride;
+    int flow_id;
+    int flow_cnt;
+    int flow_dlt;
+    tcpreplay_budget_t *budget;
+
     /* counter stats */
     tcpreplay_stats_t stats;
     tcpreplay_stats_t static_stats; /* stats returned by tcpreplay_get_stats() */
@@ -211,12 +310,21 @@ int tcpreplay_set_use_pkthdr_len(tcpreplay_t *, bool);
 int tcpreplay_set_mtu(tcpreplay_t *, int);
 int tcpreplay_set_accurate(tcpreplay_t *, tcpreplay_accurate);
 int tcpreplay_set_rdtsc_clicks(tcpreplay_t *, int);
+int tcpreplay_set_spin_threshold(tcpreplay_t *, u_int32_t);
 int tcpreplay_set_limit_send(tcpreplay_t *, COUNTER);
+int tcpreplay_set_start_packet(tcpreplay_t *, COUNTER);
+int tcpreplay_set_burst(tcpreplay_t *, int);
+int tcpreplay_set_threads(tcpreplay_t *, int);
+int tcpreplay_set_pipeline(tcpreplay_t *, bool, u_int32_t);
+int tcpreplay_set_pipeline_cpus(tcpreplay_t *, int, int);
+int tcpreplay_set_prefetch(tcpreplay_t *, size_t);
+int tcpreplay_set_txring(tcpreplay_t *, u_int32_t, u_int32_t);
 int tcpreplay_set_file_cache(tcpreplay_t *, bool);
 int tcpreplay_set_dualfile(tcpreplay_t *, bool);
 int tcpreplay_set_tcpprep_cache(tcpreplay_t *, char *);
 int tcpreplay_add_pcapfile(tcpreplay_t *, char *);
 int tcpreplay_set_preload_pcap(tcpreplay_t *, bool);
+int tcpreplay_set_cache_hugepages(tcpreplay_t *, bool);
 
 /* information */
 int tcpreplay_get_source_count(tcpreplay_t *);
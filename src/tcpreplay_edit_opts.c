@@ -78,7 +78,7 @@ extern FILE * option_usage_fp;
 /*
  *  tcpreplay-edit option static const strings
  */
-static char const tcpreplay_edit_opt_strs[5111] =
+static char const tcpreplay_edit_opt_strs[5833] =
 /*     0 */ "tcpreplay-edit (tcpreplay)\n"
             "Copyright (C) 2000-2010 Aaron Turner, all rights reserved.\n"
             "This is free software. It is licensed for use, modification and\n"
@@ -186,103 +186,133 @@ static char const tcpreplay_edit_opt_strs[5111] =
 /*  2589 */ "Quiet mode\0"
 /*  2600 */ "QUIET\0"
 /*  2606 */ "quiet\0"
-/*  2612 */ "Select packet timing mode: select, ioport, rdtsc, gtod, nano, abstime\0"
-/*  2682 */ "TIMER\0"
-/*  2688 */ "timer\0"
-/*  2694 */ "gtod\0"
-/*  2699 */ "Reduce the amount of time to sleep by specified usec\0"
-/*  2752 */ "SLEEP_ACCEL\0"
-/*  2764 */ "sleep-accel\0"
-/*  2776 */ "Specify the RDTSC clicks/usec\0"
-/*  2806 */ "RDTSC_CLICKS\0"
-/*  2819 */ "rdtsc-clicks\0"
-/*  2832 */ "Print decoded packets via tcpdump to STDOUT\0"
-/*  2876 */ "VERBOSE\0"
-/*  2884 */ "verbose\0"
-/*  2892 */ "Arguments passed to tcpdump decoder\0"
-/*  2928 */ "DECODE\0"
-/*  2935 */ "decode\0"
-/*  2942 */ "Enable caching of packets to internal memory\0"
-/*  2987 */ "ENABLE_FILE_CACHE\0"
-/*  3005 */ "enable-file-cache\0"
-/*  3023 */ "Preloads packets into RAM before sending\0"
-/*  3064 */ "PRELOAD_PCAP\0"
-/*  3077 */ "preload-pcap\0"
-/*  3090 */ "Split traffic via a tcpprep cache file\0"
-/*  3129 */ "CACHEFILE\0"
-/*  3139 */ "cachefile\0"
-/*  3149 */ "Replay two files at a time from a network tap\0"
-/*  3195 */ "DUALFILE\0"
-/*  3204 */ "dualfile\0"
-/*  3213 */ "Server/primary traffic output interface\0"
-/*  3253 */ "INTF1\0"
-/*  3259 */ "intf1\0"
-/*  3265 */ "Client/secondary traffic output interface\0"
-/*  3307 */ "INTF2\0"
-/*  3313 */ "intf2\0"
-/*  3319 */ "List available network interfaces and exit\0"
-/*  3362 */ "LISTNICS\0"
-/*  3371 */ "listnics\0"
-/*  3380 */ "Loop through the capture file X times\0"
-/*  3418 */ "LOOP\0"
-/*  3423 */ "loop\0"
-/*  3428 */ "Override the snaplen and use the actual packet len\0"
-/*  3479 */ "PKTLEN\0"
-/*  3486 */ "pktlen\0"
-/*  3493 */ "Limit the number of packets to send\0"
-/*  3529 */ "LIMIT\0"
-/*  3535 */ "limit\0"
-/*  3541 */ "Modify replay speed to a given multiple\0"
-/*  3581 */ "MULTIPLIER\0"
-/*  3592 */ "multiplier\0"
-/*  3603 */ "Replay packets at a given packets/sec\0"
-/*  3641 */ "PPS\0"
-/*  3645 */ "pps\0"
-/*  3649 */ "Replay packets at a given Mbps\0"
-/*  3680 */ "MBPS\0"
-/*  3685 */ "mbps\0"
-/*  3690 */ "Replay packets as fast as possible\0"
-/*  3725 */ "TOPSPEED\0"
-/*  3734 */ "topspeed\0"
-/*  3743 */ "Replay one packet at a time for each user input\0"
-/*  3791 */ "ONEATATIME\0"
-/*  3802 */ "oneatatime\0"
-/*  3813 */ "Number of packets to send for each time interval\0"
-/*  3862 */ "PPS_MULTI\0"
-/*  3872 */ "pps-multi\0"
-/*  3882 */ "Print the PID of tcpreplay at startup\0"
-/*  3920 */ "PID\0"
-/*  3924 */ "pid\0"
-/*  3928 */ "Print statistics every X seconds\0"
-/*  3961 */ "STATS\0"
-/*  3967 */ "stats\0"
-/*  3973 */ "Print version information\0"
-/*  3999 */ "VERSION\0"
-/*  4007 */ "version\0"
-/*  4015 */ "Display less usage information and exit\0"
-/*  4055 */ "LESS_HELP\0"
-/*  4065 */ "less-help\0"
-/*  4075 */ "Display extended usage information and exit\0"
-/*  4119 */ "help\0"
-/*  4124 */ "Extended usage information passed thru pager\0"
-/*  4169 */ "more-help\0"
-/*  4179 */ "Save the option state to a config file\0"
-/*  4218 */ "save-opts\0"
-/*  4228 */ "Load options from a config file\0"
-/*  4260 */ "LOAD_OPTS\0"
-/*  4270 */ "no-load-opts\0"
-/*  4283 */ "no\0"
-/*  4286 */ "TCPREPLAY_EDIT\0"
-/*  4301 */ "tcpreplay-edit (tcpreplay) - Replay network traffic stored in pcap files\n"
+/*  2612 */ "Select packet timing mode: select, ioport, rdtsc, gtod, nano, abstime, deadline\0"
+/*  2692 */ "TIMER\0"
+/*  2698 */ "timer\0"
+/*  2704 */ "gtod\0"
+/*  2709 */ "usec to spin before each packet with --timer=deadline\0"
+/*  2763 */ "SPIN_THRESHOLD\0"
+/*  2778 */ "spin-threshold\0"
+/*  2793 */ "Reduce the amount of time to sleep by specified usec\0"
+/*  2846 */ "SLEEP_ACCEL\0"
+/*  2858 */ "sleep-accel\0"
+/*  2870 */ "Specify the RDTSC clicks/usec\0"
+/*  2900 */ "RDTSC_CLICKS\0"
+/*  2913 */ "rdtsc-clicks\0"
+/*  2926 */ "Print decoded packets via tcpdump to STDOUT\0"
+/*  2970 */ "VERBOSE\0"
+/*  2978 */ "verbose\0"
+/*  2986 */ "Arguments passed to tcpdump decoder\0"
+/*  3022 */ "DECODE\0"
+/*  3029 */ "decode\0"
+/*  3036 */ "Enable caching of packets to internal memory\0"
+/*  3081 */ "ENABLE_FILE_CACHE\0"
+/*  3099 */ "enable-file-cache\0"
+/*  3117 */ "Preloads packets into RAM before sending\0"
+/*  3158 */ "PRELOAD_PCAP\0"
+/*  3171 */ "preload-pcap\0"
+/*  3184 */ "Back the file cache with huge pages\0"
+/*  3220 */ "CACHE_HUGEPAGES\0"
+/*  3236 */ "cache-hugepages\0"
+/*  3252 */ "Split traffic via a tcpprep cache file\0"
+/*  3291 */ "CACHEFILE\0"
+/*  3301 */ "cachefile\0"
+/*  3311 */ "Replay two files at a time from a network tap\0"
+/*  3357 */ "DUALFILE\0"
+/*  3366 */ "dualfile\0"
+/*  3375 */ "Server/primary traffic output interface\0"
+/*  3415 */ "INTF1\0"
+/*  3421 */ "intf1\0"
+/*  3427 */ "Client/secondary traffic output interface\0"
+/*  3469 */ "INTF2\0"
+/*  3475 */ "intf2\0"
+/*  3481 */ "List available network interfaces and exit\0"
+/*  3524 */ "LISTNICS\0"
+/*  3533 */ "listnics\0"
+/*  3542 */ "Loop through the capture file X times\0"
+/*  3580 */ "LOOP\0"
+/*  3585 */ "loop\0"
+/*  3590 */ "Override the snaplen and use the actual packet len\0"
+/*  3641 */ "PKTLEN\0"
+/*  3648 */ "pktlen\0"
+/*  3655 */ "Limit the number of packets to send\0"
+/*  3691 */ "LIMIT\0"
+/*  3697 */ "limit\0"
+/*  3703 */ "Start sending at the given packet of the pcap\0"
+/*  3749 */ "START_PACKET\0"
+/*  3762 */ "start-packet\0"
+/*  3775 */ "Modify replay speed to a given multiple\0"
+/*  3815 */ "MULTIPLIER\0"
+/*  3826 */ "multiplier\0"
+/*  3837 */ "Replay packets at a given packets/sec\0"
+/*  3875 */ "PPS\0"
+/*  3879 */ "pps\0"
+/*  3883 */ "Replay packets at a given Mbps\0"
+/*  3914 */ "MBPS\0"
+/*  3919 */ "mbps\0"
+/*  3924 */ "Replay packets as fast as possible\0"
+/*  3959 */ "TOPSPEED\0"
+/*  3968 */ "topspeed\0"
+/*  3977 */ "Replay one packet at a time for each user input\0"
+/*  4025 */ "ONEATATIME\0"
+/*  4036 */ "oneatatime\0"
+/*  4047 */ "Number of packets to send for each time interval\0"
+/*  4096 */ "PPS_MULTI\0"
+/*  4106 */ "pps-multi\0"
+/*  4116 */ "Max number of packets to send per burst\0"
+/*  4156 */ "BURST\0"
+/*  4162 */ "burst\0"
+/*  4168 */ "Read and send packets on separate threads\0"
+/*  4210 */ "PIPELINE\0"
+/*  4219 */ "pipeline\0"
+/*  4228 */ "Number of packets the pipeline ring holds\0"
+/*  4270 */ "PIPELINE_SLOTS\0"
+/*  4285 */ "pipeline-slots\0"
+/*  4300 */ "Pin the pipeline reader & sender threads to CPUs\0"
+/*  4349 */ "PIPELINE_CPUS\0"
+/*  4363 */ "pipeline-cpus\0"
+/*  4377 */ "Read ahead this many MB of the pcap on a separate thread\0"
+/*  4434 */ "PREFETCH\0"
+/*  4443 */ "prefetch\0"
+/*  4452 */ "Number of frames in the Linux TX_RING\0"
+/*  4490 */ "TXRING_FRAMES\0"
+/*  4504 */ "txring-frames\0"
+/*  4518 */ "Number of TX_RING frames to queue before kicking the kernel\0"
+/*  4578 */ "TXRING_BATCH\0"
+/*  4591 */ "txring-batch\0"
+/*  4604 */ "Print the PID of tcpreplay at startup\0"
+/*  4642 */ "PID\0"
+/*  4646 */ "pid\0"
+/*  4650 */ "Print statistics every X seconds\0"
+/*  4683 */ "STATS\0"
+/*  4689 */ "stats\0"
+/*  4695 */ "Print version information\0"
+/*  4721 */ "VERSION\0"
+/*  4729 */ "version\0"
+/*  4737 */ "Display less usage information and exit\0"
+/*  4777 */ "LESS_HELP\0"
+/*  4787 */ "less-help\0"
+/*  4797 */ "Display extended usage information and exit\0"
+/*  4841 */ "help\0"
+/*  4846 */ "Extended usage information passed thru pager\0"
+/*  4891 */ "more-help\0"
+/*  4901 */ "Save the option state to a config file\0"
+/*  4940 */ "save-opts\0"
+/*  4950 */ "Load options from a config file\0"
+/*  4982 */ "LOAD_OPTS\0"
+/*  4992 */ "no-load-opts\0"
+/*  5005 */ "no\0"
+/*  5008 */ "TCPREPLAY_EDIT\0"
+/*  5023 */ "tcpreplay-edit (tcpreplay) - Replay network traffic stored in pcap files\n"
             "USAGE:  %s [ -<flag> [<val>] | --<name>[{=| }<val>] ]... \\\n"
             "\t\t<pcap_file(s)>\n\0"
-/*  4451 */ "$$/\0"
-/*  4455 */ ".tcpreplay_editrc\0"
-/*  4473 */ "tcpreplay-users@lists.sourceforge.net\0"
-/*  4511 */ "\n"
+/*  5173 */ "$$/\0"
+/*  5177 */ ".tcpreplay_editrc\0"
+/*  5195 */ "tcpreplay-users@lists.sourceforge.net\0"
+/*  5233 */ "\n"
             "tcpreplay is a tool for replaying network traffic from files saved with\n"
             "tcpdump or other tools which write pcap(3) files.\n\0"
-/*  4635 */ "\n"
+/*  5357 */ "\n"
             "The basic operation of tcpreplay is to resend all packets from the input\n"
             "file(s) at the speed at which they were recorded, or a specified data rate,\n"
             "up to as fast as the hardware is capable.\n\n"
@@ -606,18 +636,28 @@ static int const aEnet_Vlan_PriMustList[] = {
  *  timer option description:
  */
 #define TIMER_DESC      (tcpreplay_edit_opt_strs+2612)
-#define TIMER_NAME      (tcpreplay_edit_opt_strs+2682)
-#define TIMER_name      (tcpreplay_edit_opt_strs+2688)
-#define TIMER_DFT_ARG   (tcpreplay_edit_opt_strs+2694)
+#define TIMER_NAME      (tcpreplay_edit_opt_strs+2692)
+#define TIMER_name      (tcpreplay_edit_opt_strs+2698)
+#define TIMER_DFT_ARG   (tcpreplay_edit_opt_strs+2704)
 #define TIMER_FLAGS     (OPTST_DISABLED \
         | OPTST_SET_ARGTYPE(OPARG_TYPE_STRING))
 
+/*
+ *  spin-threshold option description:
+ */
+#define SPIN_THRESHOLD_DESC      (tcpreplay_edit_opt_strs+2709)
+#define SPIN_THRESHOLD_NAME      (tcpreplay_edit_opt_strs+2763)
+#define SPIN_THRESHOLD_name      (tcpreplay_edit_opt_strs+2778)
+#define SPIN_THRESHOLD_DFT_ARG   ((char const*)50)
+#define SPIN_THRESHOLD_FLAGS     (OPTST_DISABLED \
+        | OPTST_SET_ARGTYPE(OPARG_TYPE_NUMERIC))
+
 /*
  *  sleep-accel option description:
  */
-#define SLEEP_ACCEL_DESC      (tcpreplay_edit_opt_strs+2699)
-#define SLEEP_ACCEL_NAME      (tcpreplay_edit_opt_strs+2752)
-#define SLEEP_ACCEL_name      (tcpreplay_edit_opt_strs+2764)
+#define SLEEP_ACCEL_DESC      (tcpreplay_edit_opt_strs+2793)
+#define SLEEP_ACCEL_NAME      (tcpreplay_edit_opt_strs+2846)
+#define SLEEP_ACCEL_name      (tcpreplay_edit_opt_strs+2858)
 #define SLEEP_ACCEL_DFT_ARG   ((char const*)0)
 #define SLEEP_ACCEL_FLAGS     (OPTST_DISABLED \
         | OPTST_SET_ARGTYPE(OPARG_TYPE_NUMERIC))
@@ -625,9 +665,9 @@ static int const aEnet_Vlan_PriMustList[] = {
 /*
  *  rdtsc-clicks option description:
  */
-#define RDTSC_CLICKS_DESC      (tcpreplay_edit_opt_strs+2776)
-#define RDTSC_CLICKS_NAME      (tcpreplay_edit_opt_strs+2806)
-#define RDTSC_CLICKS_name      (tcpreplay_edit_opt_strs+2819)
+#define RDTSC_CLICKS_DESC      (tcpreplay_edit_opt_strs+2870)
+#define RDTSC_CLICKS_NAME      (tcpreplay_edit_opt_strs+2900)
+#define RDTSC_CLICKS_name      (tcpreplay_edit_opt_strs+2913)
 #define RDTSC_CLICKS_DFT_ARG   ((char const*)0)
 #define RDTSC_CLICKS_FLAGS     (OPTST_DISABLED \
         | OPTST_SET_ARGTYPE(OPARG_TYPE_NUMERIC))
@@ -636,9 +676,9 @@ static int const aEnet_Vlan_PriMustList[] = {
  *  verbose option description:
  */
 #ifdef ENABLE_VERBOSE
-#define VERBOSE_DESC      (tcpreplay_edit_opt_strs+2832)
-#define VERBOSE_NAME      (tcpreplay_edit_opt_strs+2876)
-#define VERBOSE_name      (tcpreplay_edit_opt_strs+2884)
+#define VERBOSE_DESC      (tcpreplay_edit_opt_strs+2926)
+#define VERBOSE_NAME      (tcpreplay_edit_opt_strs+2970)
+#define VERBOSE_name      (tcpreplay_edit_opt_strs+2978)
 #define VERBOSE_FLAGS     (OPTST_DISABLED | OPTST_IMM)
 
 #else   /* disable verbose */
@@ -653,9 +693,9 @@ static int const aEnet_Vlan_PriMustList[] = {
  *  "Must also have options" and "Incompatible options":
  */
 #ifdef ENABLE_VERBOSE
-#define DECODE_DESC      (tcpreplay_edit_opt_strs+2892)
-#define DECODE_NAME      (tcpreplay_edit_opt_strs+2928)
-#define DECODE_name      (tcpreplay_edit_opt_strs+2935)
+#define DECODE_DESC      (tcpreplay_edit_opt_strs+2986)
+#define DECODE_NAME      (tcpreplay_edit_opt_strs+3022)
+#define DECODE_name      (tcpreplay_edit_opt_strs+3029)
 static int const aDecodeMustList[] = {
     INDEX_OPT_VERBOSE, NO_EQUIVALENT };
 #define DECODE_FLAGS     (OPTST_DISABLED \
@@ -673,9 +713,9 @@ static int const aDecodeMustList[] = {
  *  enable_file_cache option description with
  *  "Must also have options" and "Incompatible options":
  */
-#define ENABLE_FILE_CACHE_DESC      (tcpreplay_edit_opt_strs+2942)
-#define ENABLE_FILE_CACHE_NAME      (tcpreplay_edit_opt_strs+2987)
-#define ENABLE_FILE_CACHE_name      (tcpreplay_edit_opt_strs+3005)
+#define ENABLE_FILE_CACHE_DESC      (tcpreplay_edit_opt_strs+3036)
+#define ENABLE_FILE_CACHE_NAME      (tcpreplay_edit_opt_strs+3081)
+#define ENABLE_FILE_CACHE_name      (tcpreplay_edit_opt_strs+3099)
 static int const aEnable_File_CacheMustList[] = {
     INDEX_OPT_LOOP, NO_EQUIVALENT };
 #define ENABLE_FILE_CACHE_FLAGS     (OPTST_DISABLED)
@@ -683,18 +723,26 @@ static int const aEnable_File_CacheMustList[] = {
 /*
  *  preload_pcap option description:
  */
-#define PRELOAD_PCAP_DESC      (tcpreplay_edit_opt_strs+3023)
-#define PRELOAD_PCAP_NAME      (tcpreplay_edit_opt_strs+3064)
-#define PRELOAD_PCAP_name      (tcpreplay_edit_opt_strs+3077)
+#define PRELOAD_PCAP_DESC      (tcpreplay_edit_opt_strs+3117)
+#define PRELOAD_PCAP_NAME      (tcpreplay_edit_opt_strs+3158)
+#define PRELOAD_PCAP_name      (tcpreplay_edit_opt_strs+3171)
 #define PRELOAD_PCAP_FLAGS     (OPTST_DISABLED)
 
+/*
+ *  cache_hugepages option description:
+ */
+#define CACHE_HUGEPAGES_DESC      (tcpreplay_edit_opt_strs+3184)
+#define CACHE_HUGEPAGES_NAME      (tcpreplay_edit_opt_strs+3220)
+#define CACHE_HUGEPAGES_name      (tcpreplay_edit_opt_strs+3236)
+#define CACHE_HUGEPAGES_FLAGS     (OPTST_DISABLED)
+
 /*
  *  cachefile option description with
  *  "Must also have options" and "Incompatible options":
  */
-#define CACHEFILE_DESC      (tcpreplay_edit_opt_strs+3090)
-#define CACHEFILE_NAME      (tcpreplay_edit_opt_strs+3129)
-#define CACHEFILE_name      (tcpreplay_edit_opt_strs+3139)
+#define CACHEFILE_DESC      (tcpreplay_edit_opt_strs+3252)
+#define CACHEFILE_NAME      (tcpreplay_edit_opt_strs+3291)
+#define CACHEFILE_name      (tcpreplay_edit_opt_strs+3301)
 static int const aCachefileMustList[] = {
     INDEX_OPT_INTF2, NO_EQUIVALENT };
 static int const aCachefileCantList[] = {
@@ -706,9 +754,9 @@ static int const aCachefileCantList[] = {
  *  dualfile option description with
  *  "Must also have options" and "Incompatible options":
  */
-#define DUALFILE_DESC      (tcpreplay_edit_opt_strs+3149)
-#define DUALFILE_NAME      (tcpreplay_edit_opt_strs+3195)
-#define DUALFILE_name      (tcpreplay_edit_opt_strs+3204)
+#define DUALFILE_DESC      (tcpreplay_edit_opt_strs+3311)
+#define DUALFILE_NAME      (tcpreplay_edit_opt_strs+3357)
+#define DUALFILE_name      (tcpreplay_edit_opt_strs+3366)
 static int const aDualfileMustList[] = {
     INDEX_OPT_INTF2, NO_EQUIVALENT };
 static int const aDualfileCantList[] = {
@@ -718,18 +766,18 @@ static int const aDualfileCantList[] = {
 /*
  *  intf1 option description:
  */
-#define INTF1_DESC      (tcpreplay_edit_opt_strs+3213)
-#define INTF1_NAME      (tcpreplay_edit_opt_strs+3253)
-#define INTF1_name      (tcpreplay_edit_opt_strs+3259)
+#define INTF1_DESC      (tcpreplay_edit_opt_strs+3375)
+#define INTF1_NAME      (tcpreplay_edit_opt_strs+3415)
+#define INTF1_name      (tcpreplay_edit_opt_strs+3421)
 #define INTF1_FLAGS     (OPTST_DISABLED | OPTST_MUST_SET \
         | OPTST_SET_ARGTYPE(OPARG_TYPE_STRING))
 
 /*
  *  intf2 option description:
  */
-#define INTF2_DESC      (tcpreplay_edit_opt_strs+3265)
-#define INTF2_NAME      (tcpreplay_edit_opt_strs+3307)
-#define INTF2_name      (tcpreplay_edit_opt_strs+3313)
+#define INTF2_DESC      (tcpreplay_edit_opt_strs+3427)
+#define INTF2_NAME      (tcpreplay_edit_opt_strs+3469)
+#define INTF2_name      (tcpreplay_edit_opt_strs+3475)
 #define INTF2_FLAGS     (OPTST_DISABLED \
         | OPTST_SET_ARGTYPE(OPARG_TYPE_STRING))
 
@@ -737,9 +785,9 @@ static int const aDualfileCantList[] = {
  *  listnics option description:
  */
 #ifdef ENABLE_PCAP_FINDALLDEVS
-#define LISTNICS_DESC      (tcpreplay_edit_opt_strs+3319)
-#define LISTNICS_NAME      (tcpreplay_edit_opt_strs+3362)
-#define LISTNICS_name      (tcpreplay_edit_opt_strs+3371)
+#define LISTNICS_DESC      (tcpreplay_edit_opt_strs+3481)
+#define LISTNICS_NAME      (tcpreplay_edit_opt_strs+3524)
+#define LISTNICS_name      (tcpreplay_edit_opt_strs+3533)
 #define LISTNICS_FLAGS     (OPTST_DISABLED | OPTST_IMM)
 
 #else   /* disable listnics */
@@ -752,9 +800,9 @@ static int const aDualfileCantList[] = {
 /*
  *  loop option description:
  */
-#define LOOP_DESC      (tcpreplay_edit_opt_strs+3380)
-#define LOOP_NAME      (tcpreplay_edit_opt_strs+3418)
-#define LOOP_name      (tcpreplay_edit_opt_strs+3423)
+#define LOOP_DESC      (tcpreplay_edit_opt_strs+3542)
+#define LOOP_NAME      (tcpreplay_edit_opt_strs+3580)
+#define LOOP_name      (tcpreplay_edit_opt_strs+3585)
 #define LOOP_DFT_ARG   ((char const*)1)
 #define LOOP_FLAGS     (OPTST_DISABLED \
         | OPTST_SET_ARGTYPE(OPARG_TYPE_NUMERIC))
@@ -762,28 +810,42 @@ static int const aDualfileCantList[] = {
 /*
  *  pktlen option description:
  */
-#define PKTLEN_DESC      (tcpreplay_edit_opt_strs+3428)
-#define PKTLEN_NAME      (tcpreplay_edit_opt_strs+3479)
-#define PKTLEN_name      (tcpreplay_edit_opt_strs+3486)
+#define PKTLEN_DESC      (tcpreplay_edit_opt_strs+3590)
+#define PKTLEN_NAME      (tcpreplay_edit_opt_strs+3641)
+#define PKTLEN_name      (tcpreplay_edit_opt_strs+3648)
 #define PKTLEN_FLAGS     (OPTST_DISABLED)
 
 /*
  *  limit option description:
  */
-#define LIMIT_DESC      (tcpreplay_edit_opt_strs+3493)
-#define LIMIT_NAME      (tcpreplay_edit_opt_strs+3529)
-#define LIMIT_name      (tcpreplay_edit_opt_strs+3535)
+#define LIMIT_DESC      (tcpreplay_edit_opt_strs+3655)
+#define LIMIT_NAME      (tcpreplay_edit_opt_strs+3691)
+#define LIMIT_name      (tcpreplay_edit_opt_strs+3697)
 #define LIMIT_DFT_ARG   ((char const*)-1)
 #define LIMIT_FLAGS     (OPTST_DISABLED \
         | OPTST_SET_ARGTYPE(OPARG_TYPE_NUMERIC))
 
+/*
+ *  start-packet option description with
+ *  "Must also have options" and "Incompatible options":
+ */
+#define START_PACKET_DESC      (tcpreplay_edit_opt_strs+3703)
+#define START_PACKET_NAME      (tcpreplay_edit_opt_strs+3749)
+#define START_PACKET_name      (tcpreplay_edit_opt_strs+3762)
+static int const aStart_PacketCantList[] = {
+    INDEX_OPT_ENABLE_FILE_CACHE,
+    INDEX_OPT_PRELOAD_PCAP,
+    INDEX_OPT_DUALFILE, NO_EQUIVALENT };
+#define START_PACKET_FLAGS     (OPTST_DISABLED \
+        | OPTST_SET_ARGTYPE(OPARG_TYPE_NUMERIC))
+
 /*
  *  multiplier option description with
  *  "Must also have options" and "Incompatible options":
  */
-#define MULTIPLIER_DESC      (tcpreplay_edit_opt_strs+3541)
-#define MULTIPLIER_NAME      (tcpreplay_edit_opt_strs+3581)
-#define MULTIPLIER_name      (tcpreplay_edit_opt_strs+3592)
+#define MULTIPLIER_DESC      (tcpreplay_edit_opt_strs+3775)
+#define MULTIPLIER_NAME      (tcpreplay_edit_opt_strs+3815)
+#define MULTIPLIER_name      (tcpreplay_edit_opt_strs+3826)
 static int const aMultiplierCantList[] = {
     INDEX_OPT_PPS,
     INDEX_OPT_MBPS,
@@ -796,9 +858,9 @@ static int const aMultiplierCantList[] = {
  *  pps option description with
  *  "Must also have options" and "Incompatible options":
  */
-#define PPS_DESC      (tcpreplay_edit_opt_strs+3603)
-#define PPS_NAME      (tcpreplay_edit_opt_strs+3641)
-#define PPS_name      (tcpreplay_edit_opt_strs+3645)
+#define PPS_DESC      (tcpreplay_edit_opt_strs+3837)
+#define PPS_NAME      (tcpreplay_edit_opt_strs+3875)
+#define PPS_name      (tcpreplay_edit_opt_strs+3879)
 static int const aPpsCantList[] = {
     INDEX_OPT_MULTIPLIER,
     INDEX_OPT_MBPS,
@@ -811,9 +873,9 @@ static int const aPpsCantList[] = {
  *  mbps option description with
  *  "Must also have options" and "Incompatible options":
  */
-#define MBPS_DESC      (tcpreplay_edit_opt_strs+3649)
-#define MBPS_NAME      (tcpreplay_edit_opt_strs+3680)
-#define MBPS_name      (tcpreplay_edit_opt_strs+3685)
+#define MBPS_DESC      (tcpreplay_edit_opt_strs+3883)
+#define MBPS_NAME      (tcpreplay_edit_opt_strs+3914)
+#define MBPS_name      (tcpreplay_edit_opt_strs+3919)
 static int const aMbpsCantList[] = {
     INDEX_OPT_MULTIPLIER,
     INDEX_OPT_PPS,
@@ -826,9 +888,9 @@ static int const aMbpsCantList[] = {
  *  topspeed option description with
  *  "Must also have options" and "Incompatible options":
  */
-#define TOPSPEED_DESC      (tcpreplay_edit_opt_strs+3690)
-#define TOPSPEED_NAME      (tcpreplay_edit_opt_strs+3725)
-#define TOPSPEED_name      (tcpreplay_edit_opt_strs+3734)
+#define TOPSPEED_DESC      (tcpreplay_edit_opt_strs+3924)
+#define TOPSPEED_NAME      (tcpreplay_edit_opt_strs+3959)
+#define TOPSPEED_name      (tcpreplay_edit_opt_strs+3968)
 static int const aTopspeedCantList[] = {
     INDEX_OPT_MBPS,
     INDEX_OPT_MULTIPLIER,
@@ -840,9 +902,9 @@ static int const aTopspeedCantList[] = {
  *  oneatatime option description with
  *  "Must also have options" and "Incompatible options":
  */
-#define ONEATATIME_DESC      (tcpreplay_edit_opt_strs+3743)
-#define ONEATATIME_NAME      (tcpreplay_edit_opt_strs+3791)
-#define ONEATATIME_name      (tcpreplay_edit_opt_strs+3802)
+#define ONEATATIME_DESC      (tcpreplay_edit_opt_strs+3977)
+#define ONEATATIME_NAME      (tcpreplay_edit_opt_strs+4025)
+#define ONEATATIME_name      (tcpreplay_edit_opt_strs+4036)
 static int const aOneatatimeCantList[] = {
     INDEX_OPT_MBPS,
     INDEX_OPT_PPS,
@@ -854,68 +916,197 @@ static int const aOneatatimeCantList[] = {
  *  pps-multi option description with
  *  "Must also have options" and "Incompatible options":
  */
-#define PPS_MULTI_DESC      (tcpreplay_edit_opt_strs+3813)
-#define PPS_MULTI_NAME      (tcpreplay_edit_opt_strs+3862)
-#define PPS_MULTI_name      (tcpreplay_edit_opt_strs+3872)
+#define PPS_MULTI_DESC      (tcpreplay_edit_opt_strs+4047)
+#define PPS_MULTI_NAME      (tcpreplay_edit_opt_strs+4096)
+#define PPS_MULTI_name      (tcpreplay_edit_opt_strs+4106)
 #define PPS_MULTI_DFT_ARG   ((char const*)1)
 static int const aPps_MultiMustList[] = {
     INDEX_OPT_PPS, NO_EQUIVALENT };
 #define PPS_MULTI_FLAGS     (OPTST_DISABLED \
         | OPTST_SET_ARGTYPE(OPARG_TYPE_NUMERIC))
 
+/*
+ *  burst option description:
+ */
+#define BURST_DESC      (tcpreplay_edit_opt_strs+4116)
+#define BURST_NAME      (tcpreplay_edit_opt_strs+4156)
+#define BURST_name      (tcpreplay_edit_opt_strs+4162)
+#define BURST_DFT_ARG   ((char const*)32)
+#define BURST_FLAGS     (OPTST_DISABLED \
+        | OPTST_SET_ARGTYPE(OPARG_TYPE_NUMERIC))
+
+/*
+ *  pipeline option description with
+ *  "Must also have options" and "Incompatible options":
+ */
+#ifdef HAVE_PTHREAD
+#define PIPELINE_DESC      (tcpreplay_edit_opt_strs+4168)
+#define PIPELINE_NAME      (tcpreplay_edit_opt_strs+4210)
+#define PIPELINE_name      (tcpreplay_edit_opt_strs+4219)
+static int const aPipelineCantList[] = {
+    INDEX_OPT_ONEATATIME, NO_EQUIVALENT };
+#define PIPELINE_FLAGS     (OPTST_DISABLED)
+
+#else   /* disable pipeline */
+#define PIPELINE_FLAGS     (OPTST_OMITTED | OPTST_NO_INIT)
+#define aPipelineCantList   NULL
+#define PIPELINE_NAME      NULL
+#define PIPELINE_DESC      NULL
+#define PIPELINE_name      NULL
+#endif  /* HAVE_PTHREAD */
+
+/*
+ *  pipeline-slots option description with
+ *  "Must also have options" and "Incompatible options":
+ */
+#ifdef HAVE_PTHREAD
+#define PIPELINE_SLOTS_DESC      (tcpreplay_edit_opt_strs+4228)
+#define PIPELINE_SLOTS_NAME      (tcpreplay_edit_opt_strs+4270)
+#define PIPELINE_SLOTS_name      (tcpreplay_edit_opt_strs+4285)
+#define PIPELINE_SLOTS_DFT_ARG   ((char const*)4096)
+static int const aPipeline_SlotsMustList[] = {
+    INDEX_OPT_PIPELINE, NO_EQUIVALENT };
+#define PIPELINE_SLOTS_FLAGS     (OPTST_DISABLED \
+        | OPTST_SET_ARGTYPE(OPARG_TYPE_NUMERIC))
+
+#else   /* disable pipeline-slots */
+#define PIPELINE_SLOTS_FLAGS     (OPTST_OMITTED | OPTST_NO_INIT)
+#define PIPELINE_SLOTS_DFT_ARG   NULL
+#define aPipeline_SlotsMustList   NULL
+#define PIPELINE_SLOTS_NAME      NULL
+#define PIPELINE_SLOTS_DESC      NULL
+#define PIPELINE_SLOTS_name      NULL
+#endif  /* HAVE_PTHREAD */
+
+/*
+ *  pipeline-cpus option description with
+ *  "Must also have options" and "Incompatible options":
+ */
+#ifdef HAVE_PTHREAD
+#define PIPELINE_CPUS_DESC      (tcpreplay_edit_opt_strs+4300)
+#define PIPELINE_CPUS_NAME      (tcpreplay_edit_opt_strs+4349)
+#define PIPELINE_CPUS_name      (tcpreplay_edit_opt_strs+4363)
+static int const aPipeline_CpusMustList[] = {
+    INDEX_OPT_PIPELINE, NO_EQUIVALENT };
+#define PIPELINE_CPUS_FLAGS     (OPTST_DISABLED \
+        | OPTST_SET_ARGTYPE(OPARG_TYPE_STRING))
+
+#else   /* disable pipeline-cpus */
+#define PIPELINE_CPUS_FLAGS     (OPTST_OMITTED | OPTST_NO_INIT)
+#define aPipeline_CpusMustList   NULL
+#define PIPELINE_CPUS_NAME      NULL
+#define PIPELINE_CPUS_DESC      NULL
+#define PIPELINE_CPUS_name      NULL
+#endif  /* HAVE_PTHREAD */
+
+/*
+ *  prefetch option description:
+ */
+#ifdef HAVE_PTHREAD
+#define PREFETCH_DESC      (tcpreplay_edit_opt_strs+4377)
+#define PREFETCH_NAME      (tcpreplay_edit_opt_strs+4434)
+#define PREFETCH_name      (tcpreplay_edit_opt_strs+4443)
+#define PREFETCH_FLAGS     (OPTST_DISABLED \
+        | OPTST_SET_ARGTYPE(OPARG_TYPE_NUMERIC))
+
+#else   /* disable prefetch */
+#define PREFETCH_FLAGS     (OPTST_OMITTED | OPTST_NO_INIT)
+#define PREFETCH_NAME      NULL
+#define PREFETCH_DESC      NULL
+#define PREFETCH_name      NULL
+#endif  /* HAVE_PTHREAD */
+
+/*
+ *  txring-frames option description:
+ */
+#ifdef HAVE_TX_RING
+#define TXRING_FRAMES_DESC      (tcpreplay_edit_opt_strs+4452)
+#define TXRING_FRAMES_NAME      (tcpreplay_edit_opt_strs+4490)
+#define TXRING_FRAMES_name      (tcpreplay_edit_opt_strs+4504)
+#define TXRING_FRAMES_DFT_ARG   ((char const*)2048)
+#define TXRING_FRAMES_FLAGS     (OPTST_DISABLED \
+        | OPTST_SET_ARGTYPE(OPARG_TYPE_NUMERIC))
+
+#else   /* disable txring-frames */
+#define TXRING_FRAMES_FLAGS     (OPTST_OMITTED | OPTST_NO_INIT)
+#define TXRING_FRAMES_DFT_ARG   NULL
+#define TXRING_FRAMES_NAME      NULL
+#define TXRING_FRAMES_DESC      NULL
+#define TXRING_FRAMES_name      NULL
+#endif  /* HAVE_TX_RING */
+
+/*
+ *  txring-batch option description:
+ */
+#ifdef HAVE_TX_RING
+#define TXRING_BATCH_DESC      (tcpreplay_edit_opt_strs+4518)
+#define TXRING_BATCH_NAME      (tcpreplay_edit_opt_strs+4578)
+#define TXRING_BATCH_name      (tcpreplay_edit_opt_strs+4591)
+#define TXRING_BATCH_DFT_ARG   ((char const*)32)
+#define TXRING_BATCH_FLAGS     (OPTST_DISABLED \
+        | OPTST_SET_ARGTYPE(OPARG_TYPE_NUMERIC))
+
+#else   /* disable txring-batch */
+#define TXRING_BATCH_FLAGS     (OPTST_OMITTED | OPTST_NO_INIT)
+#define TXRING_BATCH_DFT_ARG   NULL
+#define TXRING_BATCH_NAME      NULL
+#define TXRING_BATCH_DESC      NULL
+#define TXRING_BATCH_name      NULL
+#endif  /* HAVE_TX_RING */
+
 /*
  *  pid option description:
  */
-#define PID_DESC      (tcpreplay_edit_opt_strs+3882)
-#define PID_NAME      (tcpreplay_edit_opt_strs+3920)
-#define PID_name      (tcpreplay_edit_opt_strs+3924)
+#define PID_DESC      (tcpreplay_edit_opt_strs+4604)
+#define PID_NAME      (tcpreplay_edit_opt_strs+4642)
+#define PID_name      (tcpreplay_edit_opt_strs+4646)
 #define PID_FLAGS     (OPTST_DISABLED)
 
 /*
  *  stats option description:
  */
-#define STATS_DESC      (tcpreplay_edit_opt_strs+3928)
-#define STATS_NAME      (tcpreplay_edit_opt_strs+3961)
-#define STATS_name      (tcpreplay_edit_opt_strs+3967)
+#define STATS_DESC      (tcpreplay_edit_opt_strs+4650)
+#define STATS_NAME      (tcpreplay_edit_opt_strs+4683)
+#define STATS_name      (tcpreplay_edit_opt_strs+4689)
 #define STATS_FLAGS     (OPTST_DISABLED \
         | OPTST_SET_ARGTYPE(OPARG_TYPE_NUMERIC))
 
 /*
  *  version option description:
  */
-#define VERSION_DESC      (tcpreplay_edit_opt_strs+3973)
-#define VERSION_NAME      (tcpreplay_edit_opt_strs+3999)
-#define VERSION_name      (tcpreplay_edit_opt_strs+4007)
+#define VERSION_DESC      (tcpreplay_edit_opt_strs+4695)
+#define VERSION_NAME      (tcpreplay_edit_opt_strs+4721)
+#define VERSION_name      (tcpreplay_edit_opt_strs+4729)
 #define VERSION_FLAGS     (OPTST_DISABLED)
 
 /*
  *  less-help option description:
  */
-#define LESS_HELP_DESC      (tcpreplay_edit_opt_strs+4015)
-#define LESS_HELP_NAME      (tcpreplay_edit_opt_strs+4055)
-#define LESS_HELP_name      (tcpreplay_edit_opt_strs+4065)
+#define LESS_HELP_DESC      (tcpreplay_edit_opt_strs+4737)
+#define LESS_HELP_NAME      (tcpreplay_edit_opt_strs+4777)
+#define LESS_HELP_name      (tcpreplay_edit_opt_strs+4787)
 #define LESS_HELP_FLAGS     (OPTST_DISABLED | OPTST_IMM)
 
 /*
  *  Help/More_Help option descriptions:
  */
-#define HELP_DESC       (tcpreplay_edit_opt_strs+4075)
-#define HELP_name       (tcpreplay_edit_opt_strs+4119)
+#define HELP_DESC       (tcpreplay_edit_opt_strs+4797)
+#define HELP_name       (tcpreplay_edit_opt_strs+4841)
 #ifdef HAVE_WORKING_FORK
-#define MORE_HELP_DESC  (tcpreplay_edit_opt_strs+4124)
-#define MORE_HELP_name  (tcpreplay_edit_opt_strs+4169)
+#define MORE_HELP_DESC  (tcpreplay_edit_opt_strs+4846)
+#define MORE_HELP_name  (tcpreplay_edit_opt_strs+4891)
 #define MORE_HELP_FLAGS (OPTST_IMM | OPTST_NO_INIT)
 #else
 #define MORE_HELP_DESC  NULL
 #define MORE_HELP_name  NULL
 #define MORE_HELP_FLAGS (OPTST_OMITTED | OPTST_NO_INIT)
 #endif
-#define SAVE_OPTS_DESC  (tcpreplay_edit_opt_strs+4179)
-#define SAVE_OPTS_name  (tcpreplay_edit_opt_strs+4218)
-#define LOAD_OPTS_DESC     (tcpreplay_edit_opt_strs+4228)
-#define LOAD_OPTS_NAME     (tcpreplay_edit_opt_strs+4260)
-#define NO_LOAD_OPTS_name  (tcpreplay_edit_opt_strs+4270)
-#define LOAD_OPTS_pfx      (tcpreplay_edit_opt_strs+4283)
+#define SAVE_OPTS_DESC  (tcpreplay_edit_opt_strs+4901)
+#define SAVE_OPTS_name  (tcpreplay_edit_opt_strs+4940)
+#define LOAD_OPTS_DESC     (tcpreplay_edit_opt_strs+4950)
+#define LOAD_OPTS_NAME     (tcpreplay_edit_opt_strs+4982)
+#define NO_LOAD_OPTS_name  (tcpreplay_edit_opt_strs+4992)
+#define LOAD_OPTS_pfx      (tcpreplay_edit_opt_strs+5005)
 #define LOAD_OPTS_name     (NO_LOAD_OPTS_name + 3)
 /*
  *  Declare option callback procedures
@@ -930,17 +1121,38 @@ static int const aPps_MultiMustList[] = {
 #else /* not ENABLE_PCAP_FINDALLDEVS */
 # define doOptListnics NULL
 #endif /* def/not ENABLE_PCAP_FINDALLDEVS */
+#ifdef HAVE_PTHREAD
+  static tOptProc doOptPipeline_Slots;
+#else /* not HAVE_PTHREAD */
+# define doOptPipeline_Slots NULL
+#endif /* def/not HAVE_PTHREAD */
+#ifdef HAVE_PTHREAD
+  static tOptProc doOptPrefetch;
+#else /* not HAVE_PTHREAD */
+# define doOptPrefetch NULL
+#endif /* def/not HAVE_PTHREAD */
+#ifdef HAVE_TX_RING
+  static tOptProc doOptTxring_Frames;
+#else /* not HAVE_TX_RING */
+# define doOptTxring_Frames NULL
+#endif /* def/not HAVE_TX_RING */
+#ifdef HAVE_TX_RING
+  static tOptProc doOptTxring_Batch;
+#else /* not HAVE_TX_RING */
+# define doOptTxring_Batch NULL
+#endif /* def/not HAVE_TX_RING */
 extern tOptProc
     optionBooleanVal,   optionNestedVal,    optionNumericVal,
     optionPagedUsage,   optionPrintVersion, optionResetOpt,
     optionStackArg,     optionTimeDate,     optionTimeVal,
     optionUnstackArg,   optionVendorOption;
 static tOptProc
-    doOptEnet_Vlan_Cfi, doOptEnet_Vlan_Pri, doOptEnet_Vlan_Tag,
-    doOptFlowlabel,     doOptLess_Help,     doOptLimit,
-    doOptLoop,          doOptMtu,           doOptPid,
-    doOptPps_Multi,     doOptStats,         doOptTclass,
-    doOptTos,           doOptVersion,       doUsageOpt;
+    doOptBurst,          doOptEnet_Vlan_Cfi,  doOptEnet_Vlan_Pri,
+    doOptEnet_Vlan_Tag,  doOptFlowlabel,      doOptLess_Help,
+    doOptLimit,          doOptLoop,           doOptMtu,
+    doOptPid,            doOptPps_Multi,      doOptSpin_Threshold,
+    doOptStart_Packet,   doOptStats,          doOptTclass,
+    doOptTos,            doOptVersion,        doUsageOpt;
 
 /* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
 /**
@@ -1333,8 +1545,20 @@ static tOptDesc optDesc[OPTION_CT] = {
      /* desc, NAME, name */ TIMER_DESC, TIMER_NAME, TIMER_name,
      /* disablement strs */ NULL, NULL },
 
-  {  /* entry idx, value */ 32, VALUE_OPT_SLEEP_ACCEL,
-     /* equiv idx, value */ 32, VALUE_OPT_SLEEP_ACCEL,
+  {  /* entry idx, value */ 32, VALUE_OPT_SPIN_THRESHOLD,
+     /* equiv idx, value */ 32, VALUE_OPT_SPIN_THRESHOLD,
+     /* equivalenced to  */ NO_EQUIVALENT,
+     /* min, max, act ct */ 0, 1, 0,
+     /* opt state flags  */ SPIN_THRESHOLD_FLAGS, 0,
+     /* last opt argumnt */ { SPIN_THRESHOLD_DFT_ARG },
+     /* arg list/cookie  */ NULL,
+     /* must/cannot opts */ NULL, NULL,
+     /* option proc      */ doOptSpin_Threshold,
+     /* desc, NAME, name */ SPIN_THRESHOLD_DESC, SPIN_THRESHOLD_NAME, SPIN_THRESHOLD_name,
+     /* disablement strs */ NULL, NULL },
+
+  {  /* entry idx, value */ 33, VALUE_OPT_SLEEP_ACCEL,
+     /* equiv idx, value */ 33, VALUE_OPT_SLEEP_ACCEL,
      /* equivalenced to  */ NO_EQUIVALENT,
      /* min, max, act ct */ 0, 1, 0,
      /* opt state flags  */ SLEEP_ACCEL_FLAGS, 0,
@@ -1345,8 +1569,8 @@ static tOptDesc optDesc[OPTION_CT] = {
      /* desc, NAME, name */ SLEEP_ACCEL_DESC, SLEEP_ACCEL_NAME, SLEEP_ACCEL_name,
      /* disablement strs */ NULL, NULL },
 
-  {  /* entry idx, value */ 33, VALUE_OPT_RDTSC_CLICKS,
-     /* equiv idx, value */ 33, VALUE_OPT_RDTSC_CLICKS,
+  {  /* entry idx, value */ 34, VALUE_OPT_RDTSC_CLICKS,
+     /* equiv idx, value */ 34, VALUE_OPT_RDTSC_CLICKS,
      /* equivalenced to  */ NO_EQUIVALENT,
      /* min, max, act ct */ 0, 1, 0,
      /* opt state flags  */ RDTSC_CLICKS_FLAGS, 0,
@@ -1357,8 +1581,8 @@ static tOptDesc optDesc[OPTION_CT] = {
      /* desc, NAME, name */ RDTSC_CLICKS_DESC, RDTSC_CLICKS_NAME, RDTSC_CLICKS_name,
      /* disablement strs */ NULL, NULL },
 
-  {  /* entry idx, value */ 34, VALUE_OPT_VERBOSE,
-     /* equiv idx, value */ 34, VALUE_OPT_VERBOSE,
+  {  /* entry idx, value */ 35, VALUE_OPT_VERBOSE,
+     /* equiv idx, value */ 35, VALUE_OPT_VERBOSE,
      /* equivalenced to  */ NO_EQUIVALENT,
      /* min, max, act ct */ 0, 1, 0,
      /* opt state flags  */ VERBOSE_FLAGS, 0,
@@ -1369,8 +1593,8 @@ static tOptDesc optDesc[OPTION_CT] = {
      /* desc, NAME, name */ VERBOSE_DESC, VERBOSE_NAME, VERBOSE_name,
      /* disablement strs */ NULL, NULL },
 
-  {  /* entry idx, value */ 35, VALUE_OPT_DECODE,
-     /* equiv idx, value */ 35, VALUE_OPT_DECODE,
+  {  /* entry idx, value */ 36, VALUE_OPT_DECODE,
+     /* equiv idx, value */ 36, VALUE_OPT_DECODE,
      /* equivalenced to  */ NO_EQUIVALENT,
      /* min, max, act ct */ 0, 1, 0,
      /* opt state flags  */ DECODE_FLAGS, 0,
@@ -1381,8 +1605,8 @@ static tOptDesc optDesc[OPTION_CT] = {
      /* desc, NAME, name */ DECODE_DESC, DECODE_NAME, DECODE_name,
      /* disablement strs */ NULL, NULL },
 
-  {  /* entry idx, value */ 36, VALUE_OPT_ENABLE_FILE_CACHE,
-     /* equiv idx, value */ 36, VALUE_OPT_ENABLE_FILE_CACHE,
+  {  /* entry idx, value */ 37, VALUE_OPT_ENABLE_FILE_CACHE,
+     /* equiv idx, value */ 37, VALUE_OPT_ENABLE_FILE_CACHE,
      /* equivalenced to  */ NO_EQUIVALENT,
      /* min, max, act ct */ 0, 1, 0,
      /* opt state flags  */ ENABLE_FILE_CACHE_FLAGS, 0,
@@ -1393,8 +1617,8 @@ static tOptDesc optDesc[OPTION_CT] = {
      /* desc, NAME, name */ ENABLE_FILE_CACHE_DESC, ENABLE_FILE_CACHE_NAME, ENABLE_FILE_CACHE_name,
      /* disablement strs */ NULL, NULL },
 
-  {  /* entry idx, value */ 37, VALUE_OPT_PRELOAD_PCAP,
-     /* equiv idx, value */ 37, VALUE_OPT_PRELOAD_PCAP,
+  {  /* entry idx, value */ 38, VALUE_OPT_PRELOAD_PCAP,
+     /* equiv idx, value */ 38, VALUE_OPT_PRELOAD_PCAP,
      /* equivalenced to  */ NO_EQUIVALENT,
      /* min, max, act ct */ 0, 1, 0,
      /* opt state flags  */ PRELOAD_PCAP_FLAGS, 0,
@@ -1405,8 +1629,20 @@ static tOptDesc optDesc[OPTION_CT] = {
      /* desc, NAME, name */ PRELOAD_PCAP_DESC, PRELOAD_PCAP_NAME, PRELOAD_PCAP_name,
      /* disablement strs */ NULL, NULL },
 
-  {  /* entry idx, value */ 38, VALUE_OPT_CACHEFILE,
-     /* equiv idx, value */ 38, VALUE_OPT_CACHEFILE,
+  {  /* entry idx, value */ 39, VALUE_OPT_CACHE_HUGEPAGES,
+     /* equiv idx, value */ 39, VALUE_OPT_CACHE_HUGEPAGES,
+     /* equivalenced to  */ NO_EQUIVALENT,
+     /* min, max, act ct */ 0, 1, 0,
+     /* opt state flags  */ CACHE_HUGEPAGES_FLAGS, 0,
+     /* last opt argumnt */ { NULL }, /* --cache_hugepages */
+     /* arg list/cookie  */ NULL,
+     /* must/cannot opts */ NULL, NULL,
+     /* option proc      */ NULL,
+     /* desc, NAME, name */ CACHE_HUGEPAGES_DESC, CACHE_HUGEPAGES_NAME, CACHE_HUGEPAGES_name,
+     /* disablement strs */ NULL, NULL },
+
+  {  /* entry idx, value */ 40, VALUE_OPT_CACHEFILE,
+     /* equiv idx, value */ 40, VALUE_OPT_CACHEFILE,
      /* equivalenced to  */ NO_EQUIVALENT,
      /* min, max, act ct */ 0, 1, 0,
      /* opt state flags  */ CACHEFILE_FLAGS, 0,
@@ -1417,8 +1653,8 @@ static tOptDesc optDesc[OPTION_CT] = {
      /* desc, NAME, name */ CACHEFILE_DESC, CACHEFILE_NAME, CACHEFILE_name,
      /* disablement strs */ NULL, NULL },
 
-  {  /* entry idx, value */ 39, VALUE_OPT_DUALFILE,
-     /* equiv idx, value */ 39, VALUE_OPT_DUALFILE,
+  {  /* entry idx, value */ 41, VALUE_OPT_DUALFILE,
+     /* equiv idx, value */ 41, VALUE_OPT_DUALFILE,
      /* equivalenced to  */ NO_EQUIVALENT,
      /* min, max, act ct */ 0, 1, 0,
      /* opt state flags  */ DUALFILE_FLAGS, 0,
@@ -1429,8 +1665,8 @@ static tOptDesc optDesc[OPTION_CT] = {
      /* desc, NAME, name */ DUALFILE_DESC, DUALFILE_NAME, DUALFILE_name,
      /* disablement strs */ NULL, NULL },
 
-  {  /* entry idx, value */ 40, VALUE_OPT_INTF1,
-     /* equiv idx, value */ 40, VALUE_OPT_INTF1,
+  {  /* entry idx, value */ 42, VALUE_OPT_INTF1,
+     /* equiv idx, value */ 42, VALUE_OPT_INTF1,
      /* equivalenced to  */ NO_EQUIVALENT,
      /* min, max, act ct */ 1, 1, 0,
      /* opt state flags  */ INTF1_FLAGS, 0,
@@ -1441,8 +1677,8 @@ static tOptDesc optDesc[OPTION_CT] = {
      /* desc, NAME, name */ INTF1_DESC, INTF1_NAME, INTF1_name,
      /* disablement strs */ NULL, NULL },
 
-  {  /* entry idx, value */ 41, VALUE_OPT_INTF2,
-     /* equiv idx, value */ 41, VALUE_OPT_INTF2,
+  {  /* entry idx, value */ 43, VALUE_OPT_INTF2,
+     /* equiv idx, value */ 43, VALUE_OPT_INTF2,
      /* equivalenced to  */ NO_EQUIVALENT,
      /* min, max, act ct */ 0, 1, 0,
      /* opt state flags  */ INTF2_FLAGS, 0,
@@ -1453,8 +1689,8 @@ static tOptDesc optDesc[OPTION_CT] = {
      /* desc, NAME, name */ INTF2_DESC, INTF2_NAME, INTF2_name,
      /* disablement strs */ NULL, NULL },
 
-  {  /* entry idx, value */ 42, VALUE_OPT_LISTNICS,
-     /* equiv idx, value */ 42, VALUE_OPT_LISTNICS,
+  {  /* entry idx, value */ 44, VALUE_OPT_LISTNICS,
+     /* equiv idx, value */ 44, VALUE_OPT_LISTNICS,
      /* equivalenced to  */ NO_EQUIVALENT,
      /* min, max, act ct */ 0, 1, 0,
      /* opt state flags  */ LISTNICS_FLAGS, 0,
@@ -1465,8 +1701,8 @@ static tOptDesc optDesc[OPTION_CT] = {
      /* desc, NAME, name */ LISTNICS_DESC, LISTNICS_NAME, LISTNICS_name,
      /* disablement strs */ NULL, NULL },
 
-  {  /* entry idx, value */ 43, VALUE_OPT_LOOP,
-     /* equiv idx, value */ 43, VALUE_OPT_LOOP,
+  {  /* entry idx, value */ 45, VALUE_OPT_LOOP,
+     /* equiv idx, value */ 45, VALUE_OPT_LOOP,
      /* equivalenced to  */ NO_EQUIVALENT,
      /* min, max, act ct */ 0, 1, 0,
      /* opt state flags  */ LOOP_FLAGS, 0,
@@ -1477,8 +1713,8 @@ static tOptDesc optDesc[OPTION_CT] = {
      /* desc, NAME, name */ LOOP_DESC, LOOP_NAME, LOOP_name,
      /* disablement strs */ NULL, NULL },
 
-  {  /* entry idx, value */ 44, VALUE_OPT_PKTLEN,
-     /* equiv idx, value */ 44, VALUE_OPT_PKTLEN,
+  {  /* entry idx, value */ 46, VALUE_OPT_PKTLEN,
+     /* equiv idx, value */ 46, VALUE_OPT_PKTLEN,
      /* equivalenced to  */ NO_EQUIVALENT,
      /* min, max, act ct */ 0, 1, 0,
      /* opt state flags  */ PKTLEN_FLAGS, 0,
@@ -1489,8 +1725,8 @@ static tOptDesc optDesc[OPTION_CT] = {
      /* desc, NAME, name */ PKTLEN_DESC, PKTLEN_NAME, PKTLEN_name,
      /* disablement strs */ NULL, NULL },
 
-  {  /* entry idx, value */ 45, VALUE_OPT_LIMIT,
-     /* equiv idx, value */ 45, VALUE_OPT_LIMIT,
+  {  /* entry idx, value */ 47, VALUE_OPT_LIMIT,
+     /* equiv idx, value */ 47, VALUE_OPT_LIMIT,
      /* equivalenced to  */ NO_EQUIVALENT,
      /* min, max, act ct */ 0, 1, 0,
      /* opt state flags  */ LIMIT_FLAGS, 0,
@@ -1501,8 +1737,20 @@ static tOptDesc optDesc[OPTION_CT] = {
      /* desc, NAME, name */ LIMIT_DESC, LIMIT_NAME, LIMIT_name,
      /* disablement strs */ NULL, NULL },
 
-  {  /* entry idx, value */ 46, VALUE_OPT_MULTIPLIER,
-     /* equiv idx, value */ 46, VALUE_OPT_MULTIPLIER,
+  {  /* entry idx, value */ 48, VALUE_OPT_START_PACKET,
+     /* equiv idx, value */ 48, VALUE_OPT_START_PACKET,
+     /* equivalenced to  */ NO_EQUIVALENT,
+     /* min, max, act ct */ 0, 1, 0,
+     /* opt state flags  */ START_PACKET_FLAGS, 0,
+     /* last opt argumnt */ { NULL }, /* --start-packet */
+     /* arg list/cookie  */ NULL,
+     /* must/cannot opts */ NULL, aStart_PacketCantList,
+     /* option proc      */ doOptStart_Packet,
+     /* desc, NAME, name */ START_PACKET_DESC, START_PACKET_NAME, START_PACKET_name,
+     /* disablement strs */ NULL, NULL },
+
+  {  /* entry idx, value */ 49, VALUE_OPT_MULTIPLIER,
+     /* equiv idx, value */ 49, VALUE_OPT_MULTIPLIER,
      /* equivalenced to  */ NO_EQUIVALENT,
      /* min, max, act ct */ 0, 1, 0,
      /* opt state flags  */ MULTIPLIER_FLAGS, 0,
@@ -1513,8 +1761,8 @@ static tOptDesc optDesc[OPTION_CT] = {
      /* desc, NAME, name */ MULTIPLIER_DESC, MULTIPLIER_NAME, MULTIPLIER_name,
      /* disablement strs */ NULL, NULL },
 
-  {  /* entry idx, value */ 47, VALUE_OPT_PPS,
-     /* equiv idx, value */ 47, VALUE_OPT_PPS,
+  {  /* entry idx, value */ 50, VALUE_OPT_PPS,
+     /* equiv idx, value */ 50, VALUE_OPT_PPS,
      /* equivalenced to  */ NO_EQUIVALENT,
      /* min, max, act ct */ 0, 1, 0,
      /* opt state flags  */ PPS_FLAGS, 0,
@@ -1525,8 +1773,8 @@ static tOptDesc optDesc[OPTION_CT] = {
      /* desc, NAME, name */ PPS_DESC, PPS_NAME, PPS_name,
      /* disablement strs */ NULL, NULL },
 
-  {  /* entry idx, value */ 48, VALUE_OPT_MBPS,
-     /* equiv idx, value */ 48, VALUE_OPT_MBPS,
+  {  /* entry idx, value */ 51, VALUE_OPT_MBPS,
+     /* equiv idx, value */ 51, VALUE_OPT_MBPS,
      /* equivalenced to  */ NO_EQUIVALENT,
      /* min, max, act ct */ 0, 1, 0,
      /* opt state flags  */ MBPS_FLAGS, 0,
@@ -1537,8 +1785,8 @@ static tOptDesc optDesc[OPTION_CT] = {
      /* desc, NAME, name */ MBPS_DESC, MBPS_NAME, MBPS_name,
      /* disablement strs */ NULL, NULL },
 
-  {  /* entry idx, value */ 49, VALUE_OPT_TOPSPEED,
-     /* equiv idx, value */ 49, VALUE_OPT_TOPSPEED,
+  {  /* entry idx, value */ 52, VALUE_OPT_TOPSPEED,
+     /* equiv idx, value */ 52, VALUE_OPT_TOPSPEED,
      /* equivalenced to  */ NO_EQUIVALENT,
      /* min, max, act ct */ 0, 1, 0,
      /* opt state flags  */ TOPSPEED_FLAGS, 0,
@@ -1549,8 +1797,8 @@ static tOptDesc optDesc[OPTION_CT] = {
      /* desc, NAME, name */ TOPSPEED_DESC, TOPSPEED_NAME, TOPSPEED_name,
      /* disablement strs */ NULL, NULL },
 
-  {  /* entry idx, value */ 50, VALUE_OPT_ONEATATIME,
-     /* equiv idx, value */ 50, VALUE_OPT_ONEATATIME,
+  {  /* entry idx, value */ 53, VALUE_OPT_ONEATATIME,
+     /* equiv idx, value */ 53, VALUE_OPT_ONEATATIME,
      /* equivalenced to  */ NO_EQUIVALENT,
      /* min, max, act ct */ 0, 1, 0,
      /* opt state flags  */ ONEATATIME_FLAGS, 0,
@@ -1561,8 +1809,8 @@ static tOptDesc optDesc[OPTION_CT] = {
      /* desc, NAME, name */ ONEATATIME_DESC, ONEATATIME_NAME, ONEATATIME_name,
      /* disablement strs */ NULL, NULL },
 
-  {  /* entry idx, value */ 51, VALUE_OPT_PPS_MULTI,
-     /* equiv idx, value */ 51, VALUE_OPT_PPS_MULTI,
+  {  /* entry idx, value */ 54, VALUE_OPT_PPS_MULTI,
+     /* equiv idx, value */ 54, VALUE_OPT_PPS_MULTI,
      /* equivalenced to  */ NO_EQUIVALENT,
      /* min, max, act ct */ 0, 1, 0,
      /* opt state flags  */ PPS_MULTI_FLAGS, 0,
@@ -1573,8 +1821,92 @@ static tOptDesc optDesc[OPTION_CT] = {
      /* desc, NAME, name */ PPS_MULTI_DESC, PPS_MULTI_NAME, PPS_MULTI_name,
      /* disablement strs */ NULL, NULL },
 
-  {  /* entry idx, value */ 52, VALUE_OPT_PID,
-     /* equiv idx, value */ 52, VALUE_OPT_PID,
+  {  /* entry idx, value */ 55, VALUE_OPT_BURST,
+     /* equiv idx, value */ 55, VALUE_OPT_BURST,
+     /* equivalenced to  */ NO_EQUIVALENT,
+     /* min, max, act ct */ 0, 1, 0,
+     /* opt state flags  */ BURST_FLAGS, 0,
+     /* last opt argumnt */ { BURST_DFT_ARG },
+     /* arg list/cookie  */ NULL,
+     /* must/cannot opts */ NULL, NULL,
+     /* option proc      */ doOptBurst,
+     /* desc, NAME, name */ BURST_DESC, BURST_NAME, BURST_name,
+     /* disablement strs */ NULL, NULL },
+
+  {  /* entry idx, value */ 56, VALUE_OPT_PIPELINE,
+     /* equiv idx, value */ 56, VALUE_OPT_PIPELINE,
+     /* equivalenced to  */ NO_EQUIVALENT,
+     /* min, max, act ct */ 0, 1, 0,
+     /* opt state flags  */ PIPELINE_FLAGS, 0,
+     /* last opt argumnt */ { NULL }, /* --pipeline */
+     /* arg list/cookie  */ NULL,
+     /* must/cannot opts */ NULL, aPipelineCantList,
+     /* option proc      */ NULL,
+     /* desc, NAME, name */ PIPELINE_DESC, PIPELINE_NAME, PIPELINE_name,
+     /* disablement strs */ NULL, NULL },
+
+  {  /* entry idx, value */ 57, VALUE_OPT_PIPELINE_SLOTS,
+     /* equiv idx, value */ 57, VALUE_OPT_PIPELINE_SLOTS,
+     /* equivalenced to  */ NO_EQUIVALENT,
+     /* min, max, act ct */ 0, 1, 0,
+     /* opt state flags  */ PIPELINE_SLOTS_FLAGS, 0,
+     /* last opt argumnt */ { PIPELINE_SLOTS_DFT_ARG },
+     /* arg list/cookie  */ NULL,
+     /* must/cannot opts */ aPipeline_SlotsMustList, NULL,
+     /* option proc      */ doOptPipeline_Slots,
+     /* desc, NAME, name */ PIPELINE_SLOTS_DESC, PIPELINE_SLOTS_NAME, PIPELINE_SLOTS_name,
+     /* disablement strs */ NULL, NULL },
+
+  {  /* entry idx, value */ 58, VALUE_OPT_PIPELINE_CPUS,
+     /* equiv idx, value */ 58, VALUE_OPT_PIPELINE_CPUS,
+     /* equivalenced to  */ NO_EQUIVALENT,
+     /* min, max, act ct */ 0, 1, 0,
+     /* opt state flags  */ PIPELINE_CPUS_FLAGS, 0,
+     /* last opt argumnt */ { NULL }, /* --pipeline-cpus */
+     /* arg list/cookie  */ NULL,
+     /* must/cannot opts */ aPipeline_CpusMustList, NULL,
+     /* option proc      */ NULL,
+     /* desc, NAME, name */ PIPELINE_CPUS_DESC, PIPELINE_CPUS_NAME, PIPELINE_CPUS_name,
+     /* disablement strs */ NULL, NULL },
+
+  {  /* entry idx, value */ 59, VALUE_OPT_PREFETCH,
+     /* equiv idx, value */ 59, VALUE_OPT_PREFETCH,
+     /* equivalenced to  */ NO_EQUIVALENT,
+     /* min, max, act ct */ 0, 1, 0,
+     /* opt state flags  */ PREFETCH_FLAGS, 0,
+     /* last opt argumnt */ { NULL }, /* --prefetch */
+     /* arg list/cookie  */ NULL,
+     /* must/cannot opts */ NULL, NULL,
+     /* option proc      */ doOptPrefetch,
+     /* desc, NAME, name */ PREFETCH_DESC, PREFETCH_NAME, PREFETCH_name,
+     /* disablement strs */ NULL, NULL },
+
+  {  /* entry idx, value */ 60, VALUE_OPT_TXRING_FRAMES,
+     /* equiv idx, value */ 60, VALUE_OPT_TXRING_FRAMES,
+     /* equivalenced to  */ NO_EQUIVALENT,
+     /* min, max, act ct */ 0, 1, 0,
+     /* opt state flags  */ TXRING_FRAMES_FLAGS, 0,
+     /* last opt argumnt */ { TXRING_FRAMES_DFT_ARG },
+     /* arg list/cookie  */ NULL,
+     /* must/cannot opts */ NULL, NULL,
+     /* option proc      */ doOptTxring_Frames,
+     /* desc, NAME, name */ TXRING_FRAMES_DESC, TXRING_FRAMES_NAME, TXRING_FRAMES_name,
+     /* disablement strs */ NULL, NULL },
+
+  {  /* entry idx, value */ 61, VALUE_OPT_TXRING_BATCH,
+     /* equiv idx, value */ 61, VALUE_OPT_TXRING_BATCH,
+     /* equivalenced to  */ NO_EQUIVALENT,
+     /* min, max, act ct */ 0, 1, 0,
+     /* opt state flags  */ TXRING_BATCH_FLAGS, 0,
+     /* last opt argumnt */ { TXRING_BATCH_DFT_ARG },
+     /* arg list/cookie  */ NULL,
+     /* must/cannot opts */ NULL, NULL,
+     /* option proc      */ doOptTxring_Batch,
+     /* desc, NAME, name */ TXRING_BATCH_DESC, TXRING_BATCH_NAME, TXRING_BATCH_name,
+     /* disablement strs */ NULL, NULL },
+
+  {  /* entry idx, value */ 62, VALUE_OPT_PID,
+     /* equiv idx, value */ 62, VALUE_OPT_PID,
      /* equivalenced to  */ NO_EQUIVALENT,
      /* min, max, act ct */ 0, 1, 0,
      /* opt state flags  */ PID_FLAGS, 0,
@@ -1585,8 +1917,8 @@ static tOptDesc optDesc[OPTION_CT] = {
      /* desc, NAME, name */ PID_DESC, PID_NAME, PID_name,
      /* disablement strs */ NULL, NULL },
 
-  {  /* entry idx, value */ 53, VALUE_OPT_STATS,
-     /* equiv idx, value */ 53, VALUE_OPT_STATS,
+  {  /* entry idx, value */ 63, VALUE_OPT_STATS,
+     /* equiv idx, value */ 63, VALUE_OPT_STATS,
      /* equivalenced to  */ NO_EQUIVALENT,
      /* min, max, act ct */ 0, 1, 0,
      /* opt state flags  */ STATS_FLAGS, 0,
@@ -1597,8 +1929,8 @@ static tOptDesc optDesc[OPTION_CT] = {
      /* desc, NAME, name */ STATS_DESC, STATS_NAME, STATS_name,
      /* disablement strs */ NULL, NULL },
 
-  {  /* entry idx, value */ 54, VALUE_OPT_VERSION,
-     /* equiv idx, value */ 54, VALUE_OPT_VERSION,
+  {  /* entry idx, value */ 64, VALUE_OPT_VERSION,
+     /* equiv idx, value */ 64, VALUE_OPT_VERSION,
      /* equivalenced to  */ NO_EQUIVALENT,
      /* min, max, act ct */ 0, 1, 0,
      /* opt state flags  */ VERSION_FLAGS, 0,
@@ -1609,8 +1941,8 @@ static tOptDesc optDesc[OPTION_CT] = {
      /* desc, NAME, name */ VERSION_DESC, VERSION_NAME, VERSION_name,
      /* disablement strs */ NULL, NULL },
 
-  {  /* entry idx, value */ 55, VALUE_OPT_LESS_HELP,
-     /* equiv idx, value */ 55, VALUE_OPT_LESS_HELP,
+  {  /* entry idx, value */ 65, VALUE_OPT_LESS_HELP,
+     /* equiv idx, value */ 65, VALUE_OPT_LESS_HELP,
      /* equivalenced to  */ NO_EQUIVALENT,
      /* min, max, act ct */ 0, 1, 0,
      /* opt state flags  */ LESS_HELP_FLAGS, 0,
@@ -1678,15 +2010,15 @@ tOptDesc * const tcpedit_tcpedit_optDesc_p = optDesc + 0;
  *
  *  Define the tcpreplay-edit Option Environment
  */
-#define zPROGNAME       (tcpreplay_edit_opt_strs+4286)
-#define zUsageTitle     (tcpreplay_edit_opt_strs+4301)
-#define zRcName         (tcpreplay_edit_opt_strs+4455)
+#define zPROGNAME       (tcpreplay_edit_opt_strs+5008)
+#define zUsageTitle     (tcpreplay_edit_opt_strs+5023)
+#define zRcName         (tcpreplay_edit_opt_strs+5177)
 static char const * const apzHomeList[2] = {
-    tcpreplay_edit_opt_strs+4451,
+    tcpreplay_edit_opt_strs+5173,
     NULL };
-#define zBugsAddr       (tcpreplay_edit_opt_strs+4473)
-#define zExplain        (tcpreplay_edit_opt_strs+4511)
-#define zDetail         (tcpreplay_edit_opt_strs+4635)
+#define zBugsAddr       (tcpreplay_edit_opt_strs+5195)
+#define zExplain        (tcpreplay_edit_opt_strs+5233)
+#define zDetail         (tcpreplay_edit_opt_strs+5357)
 #define zFullVersion    (NULL)
 /* extracted from optcode.tlib near line 350 */
 
@@ -2006,6 +2338,41 @@ emit_ranges:
 }
 #endif /* defined DEBUG */
 
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+/**
+ * Code to handle the spin-threshold option.
+ *
+ * @param pOptions the tcpreplay_edit options data structure
+ * @param pOptDesc the option descriptor for this option.
+ */
+static void
+doOptSpin_Threshold(tOptions* pOptions, tOptDesc* pOptDesc)
+{
+    static struct {long rmin, rmax;} const rng[1] = {
+        { 0, 1000000 } };
+    int  ix;
+
+    if (pOptions <= OPTPROC_EMIT_LIMIT)
+        goto emit_ranges;
+    optionNumericVal(pOptions, pOptDesc);
+
+    for (ix = 0; ix < 1; ix++) {
+        if (pOptDesc->optArg.argInt < rng[ix].rmin)
+            continue;  /* ranges need not be ordered. */
+        if (pOptDesc->optArg.argInt == rng[ix].rmin)
+            return;
+        if (rng[ix].rmax == LONG_MIN)
+            continue;
+        if (pOptDesc->optArg.argInt <= rng[ix].rmax)
+            return;
+    }
+
+    option_usage_fp = stderr;
+
+emit_ranges:
+    optionShowRange(pOptions, pOptDesc, (void *)rng, 1);
+}
+
 /* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
 /**
  * Code to handle the listnics option, when ENABLE_PCAP_FINDALLDEVS is #define-d.
@@ -2017,7 +2384,7 @@ emit_ranges:
 static void
 doOptListnics(tOptions* pOptions, tOptDesc* pOptDesc)
 {
-    /* extracted from tcpreplay_opts.def, line 312 */
+    /* extracted from tcpreplay_opts.def, line 345 */
 
     interface_list_t *list = get_interface_list();
     list_interfaces(list);
@@ -2099,6 +2466,41 @@ emit_ranges:
     optionShowRange(pOptions, pOptDesc, (void *)rng, 1);
 }
 
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+/**
+ * Code to handle the start-packet option.
+ *
+ * @param pOptions the tcpreplay_edit options data structure
+ * @param pOptDesc the option descriptor for this option.
+ */
+static void
+doOptStart_Packet(tOptions* pOptions, tOptDesc* pOptDesc)
+{
+    static struct {long rmin, rmax;} const rng[1] = {
+        { 1, LONG_MAX } };
+    int  ix;
+
+    if (pOptions <= OPTPROC_EMIT_LIMIT)
+        goto emit_ranges;
+    optionNumericVal(pOptions, pOptDesc);
+
+    for (ix = 0; ix < 1; ix++) {
+        if (pOptDesc->optArg.argInt < rng[ix].rmin)
+            continue;  /* ranges need not be ordered. */
+        if (pOptDesc->optArg.argInt == rng[ix].rmin)
+            return;
+        if (rng[ix].rmax == LONG_MIN)
+            continue;
+        if (pOptDesc->optArg.argInt <= rng[ix].rmax)
+            return;
+    }
+
+    option_usage_fp = stderr;
+
+emit_ranges:
+    optionShowRange(pOptions, pOptDesc, (void *)rng, 1);
+}
+
 /* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
 /**
  * Code to handle the pps-multi option.
@@ -2134,6 +2536,189 @@ emit_ranges:
     optionShowRange(pOptions, pOptDesc, (void *)rng, 1);
 }
 
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+/**
+ * Code to handle the burst option.
+ *
+ * @param pOptions the tcpreplay_edit options data structure
+ * @param pOptDesc the option descriptor for this option.
+ */
+static void
+doOptBurst(tOptions* pOptions, tOptDesc* pOptDesc)
+{
+    static struct {long rmin, rmax;} const rng[1] = {
+        { 1, 64 } };
+    int  ix;
+
+    if (pOptions <= OPTPROC_EMIT_LIMIT)
+        goto emit_ranges;
+    optionNumericVal(pOptions, pOptDesc);
+
+    for (ix = 0; ix < 1; ix++) {
+        if (pOptDesc->optArg.argInt < rng[ix].rmin)
+            continue;  /* ranges need not be ordered. */
+        if (pOptDesc->optArg.argInt == rng[ix].rmin)
+            return;
+        if (rng[ix].rmax == LONG_MIN)
+            continue;
+        if (pOptDesc->optArg.argInt <= rng[ix].rmax)
+            return;
+    }
+
+    option_usage_fp = stderr;
+
+emit_ranges:
+    optionShowRange(pOptions, pOptDesc, (void *)rng, 1);
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+/**
+ * Code to handle the pipeline-slots option, when HAVE_PTHREAD is #define-d.
+ *
+ * @param pOptions the tcpreplay_edit options data structure
+ * @param pOptDesc the option descriptor for this option.
+ */
+#ifdef HAVE_PTHREAD
+static void
+doOptPipeline_Slots(tOptions* pOptions, tOptDesc* pOptDesc)
+{
+    static struct {long rmin, rmax;} const rng[1] = {
+        { 64, 1048576 } };
+    int  ix;
+
+    if (pOptions <= OPTPROC_EMIT_LIMIT)
+        goto emit_ranges;
+    optionNumericVal(pOptions, pOptDesc);
+
+    for (ix = 0; ix < 1; ix++) {
+        if (pOptDesc->optArg.argInt < rng[ix].rmin)
+            continue;  /* ranges need not be ordered. */
+        if (pOptDesc->optArg.argInt == rng[ix].rmin)
+            return;
+        if (rng[ix].rmax == LONG_MIN)
+            continue;
+        if (pOptDesc->optArg.argInt <= rng[ix].rmax)
+            return;
+    }
+
+    option_usage_fp = stderr;
+
+emit_ranges:
+    optionShowRange(pOptions, pOptDesc, (void *)rng, 1);
+}
+#endif /* defined HAVE_PTHREAD */
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+/**
+ * Code to handle the prefetch option, when HAVE_PTHREAD is #define-d.
+ *
+ * @param pOptions the tcpreplay_edit options data structure
+ * @param pOptDesc the option descriptor for this option.
+ */
+#ifdef HAVE_PTHREAD
+static void
+doOptPrefetch(tOptions* pOptions, tOptDesc* pOptDesc)
+{
+    static struct {long rmin, rmax;} const rng[1] = {
+        { 1, 65536 } };
+    int  ix;
+
+    if (pOptions <= OPTPROC_EMIT_LIMIT)
+        goto emit_ranges;
+    optionNumericVal(pOptions, pOptDesc);
+
+    for (ix = 0; ix < 1; ix++) {
+        if (pOptDesc->optArg.argInt < rng[ix].rmin)
+            continue;  /* ranges need not be ordered. */
+        if (pOptDesc->optArg.argInt == rng[ix].rmin)
+            return;
+        if (rng[ix].rmax == LONG_MIN)
+            continue;
+        if (pOptDesc->optArg.argInt <= rng[ix].rmax)
+            return;
+    }
+
+    option_usage_fp = stderr;
+
+emit_ranges:
+    optionShowRange(pOptions, pOptDesc, (void *)rng, 1);
+}
+#endif /* defined HAVE_PTHREAD */
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+/**
+ * Code to handle the txring-frames option, when HAVE_TX_RING is #define-d.
+ *
+ * @param pOptions the tcpreplay_edit options data structure
+ * @param pOptDesc the option descriptor for this option.
+ */
+#ifdef HAVE_TX_RING
+static void
+doOptTxring_Frames(tOptions* pOptions, tOptDesc* pOptDesc)
+{
+    static struct {long rmin, rmax;} const rng[1] = {
+        { 64, 1048576 } };
+    int  ix;
+
+    if (pOptions <= OPTPROC_EMIT_LIMIT)
+        goto emit_ranges;
+    optionNumericVal(pOptions, pOptDesc);
+
+    for (ix = 0; ix < 1; ix++) {
+        if (pOptDesc->optArg.argInt < rng[ix].rmin)
+            continue;  /* ranges need not be ordered. */
+        if (pOptDesc->optArg.argInt == rng[ix].rmin)
+            return;
+        if (rng[ix].rmax == LONG_MIN)
+            continue;
+        if (pOptDesc->optArg.argInt <= rng[ix].rmax)
+            return;
+    }
+
+    option_usage_fp = stderr;
+
+emit_ranges:
+    optionShowRange(pOptions, pOptDesc, (void *)rng, 1);
+}
+#endif /* defined HAVE_TX_RING */
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+/**
+ * Code to handle the txring-batch option, when HAVE_TX_RING is #define-d.
+ *
+ * @param pOptions the tcpreplay_edit options data structure
+ * @param pOptDesc the option descriptor for this option.
+ */
+#ifdef HAVE_TX_RING
+static void
+doOptTxring_Batch(tOptions* pOptions, tOptDesc* pOptDesc)
+{
+    static struct {long rmin, rmax;} const rng[1] = {
+        { 1, 4096 } };
+    int  ix;
+
+    if (pOptions <= OPTPROC_EMIT_LIMIT)
+        goto emit_ranges;
+    optionNumericVal(pOptions, pOptDesc);
+
+    for (ix = 0; ix < 1; ix++) {
+        if (pOptDesc->optArg.argInt < rng[ix].rmin)
+            continue;  /* ranges need not be ordered. */
+        if (pOptDesc->optArg.argInt == rng[ix].rmin)
+            return;
+        if (rng[ix].rmax == LONG_MIN)
+            continue;
+        if (pOptDesc->optArg.argInt <= rng[ix].rmax)
+            return;
+    }
+
+    option_usage_fp = stderr;
+
+emit_ranges:
+    optionShowRange(pOptions, pOptDesc, (void *)rng, 1);
+}
+#endif /* defined HAVE_TX_RING */
+
 /* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
 /**
  * Code to handle the pid option.
@@ -2144,7 +2729,7 @@ emit_ranges:
 static void
 doOptPid(tOptions* pOptions, tOptDesc* pOptDesc)
 {
-    /* extracted from tcpreplay_opts.def, line 462 */
+    /* extracted from tcpreplay_opts.def, line 655 */
 
     fprintf(stderr, "PID: %d\n", getpid());
 
@@ -2197,7 +2782,7 @@ emit_ranges:
 static void
 doOptVersion(tOptions* pOptions, tOptDesc* pOptDesc)
 {
-    /* extracted from tcpreplay_opts.def, line 485 */
+    /* extracted from tcpreplay_opts.def, line 678 */
 
     fprintf(stderr, "tcpreplay version: %s (build %s)", VERSION, git_version());
 #ifdef DEBUG
@@ -2254,7 +2839,7 @@ doOptVersion(tOptions* pOptions, tOptDesc* pOptDesc)
 static void
 doOptLess_Help(tOptions* pOptions, tOptDesc* pOptDesc)
 {
-    /* extracted from tcpreplay_opts.def, line 537 */
+    /* extracted from tcpreplay_opts.def, line 730 */
 
     USAGE(EXIT_FAILURE);
 
@@ -2323,7 +2908,7 @@ tOptions tcpreplay_editOptions = {
       NO_EQUIVALENT, /* '-#' option index */
       9 /* index of default opt */
     },
-    60 /* full option count */, 56 /* user option count */,
+    70 /* full option count */, 66 /* user option count */,
     tcpreplay_edit_full_usage, tcpreplay_edit_short_usage,
     NULL, NULL,
     PKGDATADIR, tcpreplay_edit_packager_info
@@ -98,37 +98,47 @@ typedef enum {
     INDEX_OPT_DBUG               = 29,
     INDEX_OPT_QUIET              = 30,
     INDEX_OPT_TIMER              = 31,
-    INDEX_OPT_SLEEP_ACCEL        = 32,
-    INDEX_OPT_RDTSC_CLICKS       = 33,
-    INDEX_OPT_VERBOSE            = 34,
-    INDEX_OPT_DECODE             = 35,
-    INDEX_OPT_ENABLE_FILE_CACHE  = 36,
-    INDEX_OPT_PRELOAD_PCAP       = 37,
-    INDEX_OPT_CACHEFILE          = 38,
-    INDEX_OPT_DUALFILE           = 39,
-    INDEX_OPT_INTF1              = 40,
-    INDEX_OPT_INTF2              = 41,
-    INDEX_OPT_LISTNICS           = 42,
-    INDEX_OPT_LOOP               = 43,
-    INDEX_OPT_PKTLEN             = 44,
-    INDEX_OPT_LIMIT              = 45,
-    INDEX_OPT_MULTIPLIER         = 46,
-    INDEX_OPT_PPS                = 47,
-    INDEX_OPT_MBPS               = 48,
-    INDEX_OPT_TOPSPEED           = 49,
-    INDEX_OPT_ONEATATIME         = 50,
-    INDEX_OPT_PPS_MULTI          = 51,
-    INDEX_OPT_PID                = 52,
-    INDEX_OPT_STATS              = 53,
-    INDEX_OPT_VERSION            = 54,
-    INDEX_OPT_LESS_HELP          = 55,
-    INDEX_OPT_HELP               = 56,
-    INDEX_OPT_MORE_HELP          = 57,
-    INDEX_OPT_SAVE_OPTS          = 58,
-    INDEX_OPT_LOAD_OPTS          = 59
+    INDEX_OPT_SPIN_THRESHOLD     = 32,
+    INDEX_OPT_SLEEP_ACCEL        = 33,
+    INDEX_OPT_RDTSC_CLICKS       = 34,
+    INDEX_OPT_VERBOSE            = 35,
+    INDEX_OPT_DECODE             = 36,
+    INDEX_OPT_ENABLE_FILE_CACHE  = 37,
+    INDEX_OPT_PRELOAD_PCAP       = 38,
+    INDEX_OPT_CACHE_HUGEPAGES    = 39,
+    INDEX_OPT_CACHEFILE          = 40,
+    INDEX_OPT_DUALFILE           = 41,
+    INDEX_OPT_INTF1              = 42,
+    INDEX_OPT_INTF2              = 43,
+    INDEX_OPT_LISTNICS           = 44,
+    INDEX_OPT_LOOP               = 45,
+    INDEX_OPT_PKTLEN             = 46,
+    INDEX_OPT_LIMIT              = 47,
+    INDEX_OPT_START_PACKET       = 48,
+    INDEX_OPT_MULTIPLIER         = 49,
+    INDEX_OPT_PPS                = 50,
+    INDEX_OPT_MBPS               = 51,
+    INDEX_OPT_TOPSPEED           = 52,
+    INDEX_OPT_ONEATATIME         = 53,
+    INDEX_OPT_PPS_MULTI          = 54,
+    INDEX_OPT_BURST              = 55,
+    INDEX_OPT_PIPELINE           = 56,
+    INDEX_OPT_PIPELINE_SLOTS     = 57,
+    INDEX_OPT_PIPELINE_CPUS      = 58,
+    INDEX_OPT_PREFETCH           = 59,
+    INDEX_OPT_TXRING_FRAMES      = 60,
+    INDEX_OPT_TXRING_BATCH       = 61,
+    INDEX_OPT_PID                = 62,
+    INDEX_OPT_STATS              = 63,
+    INDEX_OPT_VERSION            = 64,
+    INDEX_OPT_LESS_HELP          = 65,
+    INDEX_OPT_HELP               = 66,
+    INDEX_OPT_MORE_HELP          = 67,
+    INDEX_OPT_SAVE_OPTS          = 68,
+    INDEX_OPT_LOAD_OPTS          = 69
 } teOptIndex;
 
-#define OPTION_CT    60
+#define OPTION_CT    70
 
 /*
  *  Interface defines for all options.  Replace "n" with the UPPER_CASED
@@ -221,35 +231,42 @@ typedef enum {
 #endif /* DEBUG */
 #define VALUE_OPT_QUIET          'q'
 #define VALUE_OPT_TIMER          'T'
-#define VALUE_OPT_SLEEP_ACCEL    32
+#define VALUE_OPT_SPIN_THRESHOLD 32
+
+#define OPT_VALUE_SPIN_THRESHOLD (DESC(SPIN_THRESHOLD).optArg.argInt)
+#define VALUE_OPT_SLEEP_ACCEL    129
 
 #define OPT_VALUE_SLEEP_ACCEL    (DESC(SLEEP_ACCEL).optArg.argInt)
-#define VALUE_OPT_RDTSC_CLICKS   129
+#define VALUE_OPT_RDTSC_CLICKS   130
 
 #define OPT_VALUE_RDTSC_CLICKS   (DESC(RDTSC_CLICKS).optArg.argInt)
 #define VALUE_OPT_VERBOSE        'v'
 #ifdef ENABLE_VERBOSE
 #define SET_OPT_VERBOSE   STMTS( \
-        DESC(VERBOSE).optActualIndex = 34; \
+        DESC(VERBOSE).optActualIndex = 35; \
         DESC(VERBOSE).optActualValue = VALUE_OPT_VERBOSE; \
         DESC(VERBOSE).fOptState &= OPTST_PERSISTENT_MASK; \
         DESC(VERBOSE).fOptState |= OPTST_SET )
 #endif /* ENABLE_VERBOSE */
 #define VALUE_OPT_DECODE         'A'
 #define VALUE_OPT_ENABLE_FILE_CACHE 'K'
-#define VALUE_OPT_PRELOAD_PCAP   133
+#define VALUE_OPT_PRELOAD_PCAP   134
+#define VALUE_OPT_CACHE_HUGEPAGES 135
 #define VALUE_OPT_CACHEFILE      'c'
 #define VALUE_OPT_DUALFILE       '2'
 #define VALUE_OPT_INTF1          'i'
 #define VALUE_OPT_INTF2          'I'
-#define VALUE_OPT_LISTNICS       138
+#define VALUE_OPT_LISTNICS       140
 #define VALUE_OPT_LOOP           'l'
 
 #define OPT_VALUE_LOOP           (DESC(LOOP).optArg.argInt)
-#define VALUE_OPT_PKTLEN         140
+#define VALUE_OPT_PKTLEN         142
 #define VALUE_OPT_LIMIT          'L'
 
 #define OPT_VALUE_LIMIT          (DESC(LIMIT).optArg.argInt)
+#define VALUE_OPT_START_PACKET   144
+
+#define OPT_VALUE_START_PACKET   (DESC(START_PACKET).optArg.argInt)
 #define VALUE_OPT_MULTIPLIER     'x'
 #define VALUE_OPT_PPS            'p'
 
@@ -257,11 +274,32 @@ typedef enum {
 #define VALUE_OPT_MBPS           'M'
 #define VALUE_OPT_TOPSPEED       't'
 #define VALUE_OPT_ONEATATIME     'o'
-#define VALUE_OPT_PPS_MULTI      147
+#define VALUE_OPT_PPS_MULTI      150
 
 #define OPT_VALUE_PPS_MULTI      (DESC(PPS_MULTI).optArg.argInt)
+#define VALUE_OPT_BURST          151
+
+#define OPT_VALUE_BURST          (DESC(BURST).optArg.argInt)
+#define VALUE_OPT_PIPELINE       152
+#define VALUE_OPT_PIPELINE_SLOTS 153
+#ifdef HAVE_PTHREAD
+#define OPT_VALUE_PIPELINE_SLOTS (DESC(PIPELINE_SLOTS).optArg.argInt)
+#endif /* HAVE_PTHREAD */
+#define VALUE_OPT_PIPELINE_CPUS  154
+#define VALUE_OPT_PREFETCH       155
+#ifdef HAVE_PTHREAD
+#define OPT_VALUE_PREFETCH       (DESC(PREFETCH).optArg.argInt)
+#endif /* HAVE_PTHREAD */
+#define VALUE_OPT_TXRING_FRAMES  156
+#ifdef HAVE_TX_RING
+#define OPT_VALUE_TXRING_FRAMES  (DESC(TXRING_FRAMES).optArg.argInt)
+#endif /* HAVE_TX_RING */
+#define VALUE_OPT_TXRING_BATCH   157
+#ifdef HAVE_TX_RING
+#define OPT_VALUE_TXRING_BATCH   (DESC(TXRING_BATCH).optArg.argInt)
+#endif /* HAVE_TX_RING */
 #define VALUE_OPT_PID            'P'
-#define VALUE_OPT_STATS          149
+#define VALUE_OPT_STATS          159
 
 #define OPT_VALUE_STATS          (DESC(STATS).optArg.argInt)
 #define VALUE_OPT_VERSION        'V'
@@ -78,7 +78,7 @@ extern FILE * option_usage_fp;
 /*
  *  tcpreplay option static const strings
  */
-static char const tcpreplay_opt_strs[3414] =
+static char const tcpreplay_opt_strs[4191] =
 /*     0 */ "tcpreplay (tcpreplay)\n"
             "Copyright (C) 2000-2010 Aaron Turner, all rights reserved.\n"
             "This is free software. It is licensed for use, modification and\n"
@@ -101,102 +101,135 @@ static char const tcpreplay_opt_strs[3414] =
 /*   911 */ "Quiet mode\0"
 /*   922 */ "QUIET\0"
 /*   928 */ "quiet\0"
-/*   934 */ "Select packet timing mode: select, ioport, rdtsc, gtod, nano, abstime\0"
-/*  1004 */ "TIMER\0"
-/*  1010 */ "timer\0"
-/*  1016 */ "gtod\0"
-/*  1021 */ "Reduce the amount of time to sleep by specified usec\0"
-/*  1074 */ "SLEEP_ACCEL\0"
-/*  1086 */ "sleep-accel\0"
-/*  1098 */ "Specify the RDTSC clicks/usec\0"
-/*  1128 */ "RDTSC_CLICKS\0"
-/*  1141 */ "rdtsc-clicks\0"
-/*  1154 */ "Print decoded packets via tcpdump to STDOUT\0"
-/*  1198 */ "VERBOSE\0"
-/*  1206 */ "verbose\0"
-/*  1214 */ "Arguments passed to tcpdump decoder\0"
-/*  1250 */ "DECODE\0"
-/*  1257 */ "decode\0"
-/*  1264 */ "Enable caching of packets to internal memory\0"
-/*  1309 */ "ENABLE_FILE_CACHE\0"
-/*  1327 */ "enable-file-cache\0"
-/*  1345 */ "Preloads packets into RAM before sending\0"
-/*  1386 */ "PRELOAD_PCAP\0"
-/*  1399 */ "preload-pcap\0"
-/*  1412 */ "Split traffic via a tcpprep cache file\0"
-/*  1451 */ "CACHEFILE\0"
-/*  1461 */ "cachefile\0"
-/*  1471 */ "Replay two files at a time from a network tap\0"
-/*  1517 */ "DUALFILE\0"
-/*  1526 */ "dualfile\0"
-/*  1535 */ "Server/primary traffic output interface\0"
-/*  1575 */ "INTF1\0"
-/*  1581 */ "intf1\0"
-/*  1587 */ "Client/secondary traffic output interface\0"
-/*  1629 */ "INTF2\0"
-/*  1635 */ "intf2\0"
-/*  1641 */ "List available network interfaces and exit\0"
-/*  1684 */ "LISTNICS\0"
-/*  1693 */ "listnics\0"
-/*  1702 */ "Loop through the capture file X times\0"
-/*  1740 */ "LOOP\0"
-/*  1745 */ "loop\0"
-/*  1750 */ "Override the snaplen and use the actual packet len\0"
-/*  1801 */ "PKTLEN\0"
-/*  1808 */ "pktlen\0"
-/*  1815 */ "Limit the number of packets to send\0"
-/*  1851 */ "LIMIT\0"
-/*  1857 */ "limit\0"
-/*  1863 */ "Modify replay speed to a given multiple\0"
-/*  1903 */ "MULTIPLIER\0"
-/*  1914 */ "multiplier\0"
-/*  1925 */ "Replay packets at a given packets/sec\0"
-/*  1963 */ "PPS\0"
-/*  1967 */ "pps\0"
-/*  1971 */ "Replay packets at a given Mbps\0"
-/*  2002 */ "MBPS\0"
-/*  2007 */ "mbps\0"
-/*  2012 */ "Replay packets as fast as possible\0"
-/*  2047 */ "TOPSPEED\0"
-/*  2056 */ "topspeed\0"
-/*  2065 */ "Replay one packet at a time for each user input\0"
-/*  2113 */ "ONEATATIME\0"
-/*  2124 */ "oneatatime\0"
-/*  2135 */ "Number of packets to send for each time interval\0"
-/*  2184 */ "PPS_MULTI\0"
-/*  2194 */ "pps-multi\0"
-/*  2204 */ "Print the PID of tcpreplay at startup\0"
-/*  2242 */ "PID\0"
-/*  2246 */ "pid\0"
-/*  2250 */ "Print statistics every X seconds\0"
-/*  2283 */ "STATS\0"
-/*  2289 */ "stats\0"
-/*  2295 */ "Print version information\0"
-/*  2321 */ "VERSION\0"
-/*  2329 */ "version\0"
-/*  2337 */ "Display less usage information and exit\0"
-/*  2377 */ "LESS_HELP\0"
-/*  2387 */ "less-help\0"
-/*  2397 */ "Display extended usage information and exit\0"
-/*  2441 */ "help\0"
-/*  2446 */ "Extended usage information passed thru pager\0"
-/*  2491 */ "more-help\0"
-/*  2501 */ "Save the option state to a config file\0"
-/*  2540 */ "save-opts\0"
-/*  2550 */ "Load options from a config file\0"
-/*  2582 */ "LOAD_OPTS\0"
-/*  2592 */ "no-load-opts\0"
-/*  2605 */ "no\0"
-/*  2608 */ "TCPREPLAY\0"
-/*  2618 */ "tcpreplay (tcpreplay) - Replay network traffic stored in pcap files\n"
+/*   934 */ "Select packet timing mode: select, ioport, rdtsc, gtod, nano, abstime, deadline\0"
+/*  1014 */ "TIMER\0"
+/*  1020 */ "timer\0"
+/*  1026 */ "gtod\0"
+/*  1031 */ "usec to spin before each packet with --timer=deadline\0"
+/*  1085 */ "SPIN_THRESHOLD\0"
+/*  1100 */ "spin-threshold\0"
+/*  1115 */ "Reduce the amount of time to sleep by specified usec\0"
+/*  1168 */ "SLEEP_ACCEL\0"
+/*  1180 */ "sleep-accel\0"
+/*  1192 */ "Specify the RDTSC clicks/usec\0"
+/*  1222 */ "RDTSC_CLICKS\0"
+/*  1235 */ "rdtsc-clicks\0"
+/*  1248 */ "Print decoded packets via tcpdump to STDOUT\0"
+/*  1292 */ "VERBOSE\0"
+/*  1300 */ "verbose\0"
+/*  1308 */ "Arguments passed to tcpdump decoder\0"
+/*  1344 */ "DECODE\0"
+/*  1351 */ "decode\0"
+/*  1358 */ "Enable caching of packets to internal memory\0"
+/*  1403 */ "ENABLE_FILE_CACHE\0"
+/*  1421 */ "enable-file-cache\0"
+/*  1439 */ "Preloads packets into RAM before sending\0"
+/*  1480 */ "PRELOAD_PCAP\0"
+/*  1493 */ "preload-pcap\0"
+/*  1506 */ "Back the file cache with huge pages\0"
+/*  1542 */ "CACHE_HUGEPAGES\0"
+/*  1558 */ "cache-hugepages\0"
+/*  1574 */ "Split traffic via a tcpprep cache file\0"
+/*  1613 */ "CACHEFILE\0"
+/*  1623 */ "cachefile\0"
+/*  1633 */ "Replay two files at a time from a network tap\0"
+/*  1679 */ "DUALFILE\0"
+/*  1688 */ "dualfile\0"
+/*  1697 */ "Server/primary traffic output interface\0"
+/*  1737 */ "INTF1\0"
+/*  1743 */ "intf1\0"
+/*  1749 */ "Client/secondary traffic output interface\0"
+/*  1791 */ "INTF2\0"
+/*  1797 */ "intf2\0"
+/*  1803 */ "List available network interfaces and exit\0"
+/*  1846 */ "LISTNICS\0"
+/*  1855 */ "listnics\0"
+/*  1864 */ "Loop through the capture file X times\0"
+/*  1902 */ "LOOP\0"
+/*  1907 */ "loop\0"
+/*  1912 */ "Override the snaplen and use the actual packet len\0"
+/*  1963 */ "PKTLEN\0"
+/*  1970 */ "pktlen\0"
+/*  1977 */ "Limit the number of packets to send\0"
+/*  2013 */ "LIMIT\0"
+/*  2019 */ "limit\0"
+/*  2025 */ "Start sending at the given packet of the pcap\0"
+/*  2071 */ "START_PACKET\0"
+/*  2084 */ "start-packet\0"
+/*  2097 */ "Modify replay speed to a given multiple\0"
+/*  2137 */ "MULTIPLIER\0"
+/*  2148 */ "multiplier\0"
+/*  2159 */ "Replay packets at a given packets/sec\0"
+/*  2197 */ "PPS\0"
+/*  2201 */ "pps\0"
+/*  2205 */ "Replay packets at a given Mbps\0"
+/*  2236 */ "MBPS\0"
+/*  2241 */ "mbps\0"
+/*  2246 */ "Replay packets as fast as possible\0"
+/*  2281 */ "TOPSPEED\0"
+/*  2290 */ "topspeed\0"
+/*  2299 */ "Replay one packet at a time for each user input\0"
+/*  2347 */ "ONEATATIME\0"
+/*  2358 */ "oneatatime\0"
+/*  2369 */ "Number of packets to send for each time interval\0"
+/*  2418 */ "PPS_MULTI\0"
+/*  2428 */ "pps-multi\0"
+/*  2438 */ "Max number of packets to send per burst\0"
+/*  2478 */ "BURST\0"
+/*  2484 */ "burst\0"
+/*  2490 */ "Number of threads to send packets with\0"
+/*  2529 */ "THREADS\0"
+/*  2537 */ "threads\0"
+/*  2545 */ "Read and send packets on separate threads\0"
+/*  2587 */ "PIPELINE\0"
+/*  2596 */ "pipeline\0"
+/*  2605 */ "Number of packets the pipeline ring holds\0"
+/*  2647 */ "PIPELINE_SLOTS\0"
+/*  2662 */ "pipeline-slots\0"
+/*  2677 */ "Pin the pipeline reader & sender threads to CPUs\0"
+/*  2726 */ "PIPELINE_CPUS\0"
+/*  2740 */ "pipeline-cpus\0"
+/*  2754 */ "Read ahead this many MB of the pcap on a separate thread\0"
+/*  2811 */ "PREFETCH\0"
+/*  2820 */ "prefetch\0"
+/*  2829 */ "Number of frames in the Linux TX_RING\0"
+/*  2867 */ "TXRING_FRAMES\0"
+/*  2881 */ "txring-frames\0"
+/*  2895 */ "Number of TX_RING frames to queue before kicking the kernel\0"
+/*  2955 */ "TXRING_BATCH\0"
+/*  2968 */ "txring-batch\0"
+/*  2981 */ "Print the PID of tcpreplay at startup\0"
+/*  3019 */ "PID\0"
+/*  3023 */ "pid\0"
+/*  3027 */ "Print statistics every X seconds\0"
+/*  3060 */ "STATS\0"
+/*  3066 */ "stats\0"
+/*  3072 */ "Print version information\0"
+/*  3098 */ "VERSION\0"
+/*  3106 */ "version\0"
+/*  3114 */ "Display less usage information and exit\0"
+/*  3154 */ "LESS_HELP\0"
+/*  3164 */ "less-help\0"
+/*  3174 */ "Display extended usage information and exit\0"
+/*  3218 */ "help\0"
+/*  3223 */ "Extended usage information passed thru pager\0"
+/*  3268 */ "more-help\0"
+/*  3278 */ "Save the option state to a config file\0"
+/*  3317 */ "save-opts\0"
+/*  3327 */ "Load options from a config file\0"
+/*  3359 */ "LOAD_OPTS\0"
+/*  3369 */ "no-load-opts\0"
+/*  3382 */ "no\0"
+/*  3385 */ "TCPREPLAY\0"
+/*  3395 */ "tcpreplay (tcpreplay) - Replay network traffic stored in pcap files\n"
             "USAGE:  %s [ -<flag> [<val>] | --<name>[{=| }<val>] ]... <pcap_file(s)>\n\0"
-/*  2759 */ "$$/\0"
-/*  2763 */ ".tcpreplayrc\0"
-/*  2776 */ "tcpreplay-users@lists.sourceforge.net\0"
-/*  2814 */ "\n"
+/*  3536 */ "$$/\0"
+/*  3540 */ ".tcpreplayrc\0"
+/*  3553 */ "tcpreplay-users@lists.sourceforge.net\0"
+/*  3591 */ "\n"
             "tcpreplay is a tool for replaying network traffic from files saved with\n"
             "tcpdump or other tools which write pcap(3) files.\n\0"
-/*  2938 */ "\n"
+/*  3715 */ "\n"
             "The basic operation of tcpreplay is to resend all packets from the input\n"
             "file(s) at the speed at which they were recorded, or a specified data rate,\n"
             "up to as fast as the hardware is capable.\n\n"
@@ -237,18 +270,28 @@ static char const tcpreplay_opt_strs[3414] =
  *  timer option description:
  */
 #define TIMER_DESC      (tcpreplay_opt_strs+934)
-#define TIMER_NAME      (tcpreplay_opt_strs+1004)
-#define TIMER_name      (tcpreplay_opt_strs+1010)
-#define TIMER_DFT_ARG   (tcpreplay_opt_strs+1016)
+#define TIMER_NAME      (tcpreplay_opt_strs+1014)
+#define TIMER_name      (tcpreplay_opt_strs+1020)
+#define TIMER_DFT_ARG   (tcpreplay_opt_strs+1026)
 #define TIMER_FLAGS     (OPTST_DISABLED \
         | OPTST_SET_ARGTYPE(OPARG_TYPE_STRING))
 
+/*
+ *  spin-threshold option description:
+ */
+#define SPIN_THRESHOLD_DESC      (tcpreplay_opt_strs+1031)
+#define SPIN_THRESHOLD_NAME      (tcpreplay_opt_strs+1085)
+#define SPIN_THRESHOLD_name      (tcpreplay_opt_strs+1100)
+#define SPIN_THRESHOLD_DFT_ARG   ((char const*)50)
+#define SPIN_THRESHOLD_FLAGS     (OPTST_DISABLED \
+        | OPTST_SET_ARGTYPE(OPARG_TYPE_NUMERIC))
+
 /*
  *  sleep-accel option description:
  */
-#define SLEEP_ACCEL_DESC      (tcpreplay_opt_strs+1021)
-#define SLEEP_ACCEL_NAME      (tcpreplay_opt_strs+1074)
-#define SLEEP_ACCEL_name      (tcpreplay_opt_strs+1086)
+#define SLEEP_ACCEL_DESC      (tcpreplay_opt_strs+1115)
+#define SLEEP_ACCEL_NAME      (tcpreplay_opt_strs+1168)
+#define SLEEP_ACCEL_name      (tcpreplay_opt_strs+1180)
 #define SLEEP_ACCEL_DFT_ARG   ((char const*)0)
 #define SLEEP_ACCEL_FLAGS     (OPTST_DISABLED \
         | OPTST_SET_ARGTYPE(OPARG_TYPE_NUMERIC))
@@ -256,9 +299,9 @@ static char const tcpreplay_opt_strs[3414] =
 /*
  *  rdtsc-clicks option description:
  */
-#define RDTSC_CLICKS_DESC      (tcpreplay_opt_strs+1098)
-#define RDTSC_CLICKS_NAME      (tcpreplay_opt_strs+1128)
-#define RDTSC_CLICKS_name      (tcpreplay_opt_strs+1141)
+#define RDTSC_CLICKS_DESC      (tcpreplay_opt_strs+1192)
+#define RDTSC_CLICKS_NAME      (tcpreplay_opt_strs+1222)
+#define RDTSC_CLICKS_name      (tcpreplay_opt_strs+1235)
 #define RDTSC_CLICKS_DFT_ARG   ((char const*)0)
 #define RDTSC_CLICKS_FLAGS     (OPTST_DISABLED \
         | OPTST_SET_ARGTYPE(OPARG_TYPE_NUMERIC))
@@ -267,9 +310,9 @@ static char const tcpreplay_opt_strs[3414] =
  *  verbose option description:
  */
 #ifdef ENABLE_VERBOSE
-#define VERBOSE_DESC      (tcpreplay_opt_strs+1154)
-#define VERBOSE_NAME      (tcpreplay_opt_strs+1198)
-#define VERBOSE_name      (tcpreplay_opt_strs+1206)
+#define VERBOSE_DESC      (tcpreplay_opt_strs+1248)
+#define VERBOSE_NAME      (tcpreplay_opt_strs+1292)
+#define VERBOSE_name      (tcpreplay_opt_strs+1300)
 #define VERBOSE_FLAGS     (OPTST_DISABLED | OPTST_IMM)
 
 #else   /* disable verbose */
@@ -284,9 +327,9 @@ static char const tcpreplay_opt_strs[3414] =
  *  "Must also have options" and "Incompatible options":
  */
 #ifdef ENABLE_VERBOSE
-#define DECODE_DESC      (tcpreplay_opt_strs+1214)
-#define DECODE_NAME      (tcpreplay_opt_strs+1250)
-#define DECODE_name      (tcpreplay_opt_strs+1257)
+#define DECODE_DESC      (tcpreplay_opt_strs+1308)
+#define DECODE_NAME      (tcpreplay_opt_strs+1344)
+#define DECODE_name      (tcpreplay_opt_strs+1351)
 static int const aDecodeMustList[] = {
     INDEX_OPT_VERBOSE, NO_EQUIVALENT };
 #define DECODE_FLAGS     (OPTST_DISABLED \
@@ -304,9 +347,9 @@ static int const aDecodeMustList[] = {
  *  enable_file_cache option description with
  *  "Must also have options" and "Incompatible options":
  */
-#define ENABLE_FILE_CACHE_DESC      (tcpreplay_opt_strs+1264)
-#define ENABLE_FILE_CACHE_NAME      (tcpreplay_opt_strs+1309)
-#define ENABLE_FILE_CACHE_name      (tcpreplay_opt_strs+1327)
+#define ENABLE_FILE_CACHE_DESC      (tcpreplay_opt_strs+1358)
+#define ENABLE_FILE_CACHE_NAME      (tcpreplay_opt_strs+1403)
+#define ENABLE_FILE_CACHE_name      (tcpreplay_opt_strs+1421)
 static int const aEnable_File_CacheMustList[] = {
     INDEX_OPT_LOOP, NO_EQUIVALENT };
 #define ENABLE_FILE_CACHE_FLAGS     (OPTST_DISABLED)
@@ -314,18 +357,26 @@ static int const aEnable_File_CacheMustList[] = {
 /*
  *  preload_pcap option description:
  */
-#define PRELOAD_PCAP_DESC      (tcpreplay_opt_strs+1345)
-#define PRELOAD_PCAP_NAME      (tcpreplay_opt_strs+1386)
-#define PRELOAD_PCAP_name      (tcpreplay_opt_strs+1399)
+#define PRELOAD_PCAP_DESC      (tcpreplay_opt_strs+1439)
+#define PRELOAD_PCAP_NAME      (tcpreplay_opt_strs+1480)
+#define PRELOAD_PCAP_name      (tcpreplay_opt_strs+1493)
 #define PRELOAD_PCAP_FLAGS     (OPTST_DISABLED)
 
+/*
+ *  cache_hugepages option description:
+ */
+#define CACHE_HUGEPAGES_DESC      (tcpreplay_opt_strs+1506)
+#define CACHE_HUGEPAGES_NAME      (tcpreplay_opt_strs+1542)
+#define CACHE_HUGEPAGES_name      (tcpreplay_opt_strs+1558)
+#define CACHE_HUGEPAGES_FLAGS     (OPTST_DISABLED)
+
 /*
  *  cachefile option description with
  *  "Must also have options" and "Incompatible options":
  */
-#define CACHEFILE_DESC      (tcpreplay_opt_strs+1412)
-#define CACHEFILE_NAME      (tcpreplay_opt_strs+1451)
-#define CACHEFILE_name      (tcpreplay_opt_strs+1461)
+#define CACHEFILE_DESC      (tcpreplay_opt_strs+1574)
+#define CACHEFILE_NAME      (tcpreplay_opt_strs+1613)
+#define CACHEFILE_name      (tcpreplay_opt_strs+1623)
 static int const aCachefileMustList[] = {
     INDEX_OPT_INTF2, NO_EQUIVALENT };
 static int const aCachefileCantList[] = {
@@ -337,9 +388,9 @@ static int const aCachefileCantList[] = {
  *  dualfile option description with
  *  "Must also have options" and "Incompatible options":
  */
-#define DUALFILE_DESC      (tcpreplay_opt_strs+1471)
-#define DUALFILE_NAME      (tcpreplay_opt_strs+1517)
-#define DUALFILE_name      (tcpreplay_opt_strs+1526)
+#define DUALFILE_DESC      (tcpreplay_opt_strs+1633)
+#define DUALFILE_NAME      (tcpreplay_opt_strs+1679)
+#define DUALFILE_name      (tcpreplay_opt_strs+1688)
 static int const aDualfileMustList[] = {
     INDEX_OPT_INTF2, NO_EQUIVALENT };
 static int const aDualfileCantList[] = {
@@ -349,18 +400,18 @@ static int const aDualfileCantList[] = {
 /*
  *  intf1 option description:
  */
-#define INTF1_DESC      (tcpreplay_opt_strs+1535)
-#define INTF1_NAME      (tcpreplay_opt_strs+1575)
-#define INTF1_name      (tcpreplay_opt_strs+1581)
+#define INTF1_DESC      (tcpreplay_opt_strs+1697)
+#define INTF1_NAME      (tcpreplay_opt_strs+1737)
+#define INTF1_name      (tcpreplay_opt_strs+1743)
 #define INTF1_FLAGS     (OPTST_DISABLED | OPTST_MUST_SET \
         | OPTST_SET_ARGTYPE(OPARG_TYPE_STRING))
 
 /*
  *  intf2 option description:
  */
-#define INTF2_DESC      (tcpreplay_opt_strs+1587)
-#define INTF2_NAME      (tcpreplay_opt_strs+1629)
-#define INTF2_name      (tcpreplay_opt_strs+1635)
+#define INTF2_DESC      (tcpreplay_opt_strs+1749)
+#define INTF2_NAME      (tcpreplay_opt_strs+1791)
+#define INTF2_name      (tcpreplay_opt_strs+1797)
 #define INTF2_FLAGS     (OPTST_DISABLED \
         | OPTST_SET_ARGTYPE(OPARG_TYPE_STRING))
 
@@ -368,9 +419,9 @@ static int const aDualfileCantList[] = {
  *  listnics option description:
  */
 #ifdef ENABLE_PCAP_FINDALLDEVS
-#define LISTNICS_DESC      (tcpreplay_opt_strs+1641)
-#define LISTNICS_NAME      (tcpreplay_opt_strs+1684)
-#define LISTNICS_name      (tcpreplay_opt_strs+1693)
+#define LISTNICS_DESC      (tcpreplay_opt_strs+1803)
+#define LISTNICS_NAME      (tcpreplay_opt_strs+1846)
+#define LISTNICS_name      (tcpreplay_opt_strs+1855)
 #define LISTNICS_FLAGS     (OPTST_DISABLED | OPTST_IMM)
 
 #else   /* disable listnics */
@@ -383,9 +434,9 @@ static int const aDualfileCantList[] = {
 /*
  *  loop option description:
  */
-#define LOOP_DESC      (tcpreplay_opt_strs+1702)
-#define LOOP_NAME      (tcpreplay_opt_strs+1740)
-#define LOOP_name      (tcpreplay_opt_strs+1745)
+#define LOOP_DESC      (tcpreplay_opt_strs+1864)
+#define LOOP_NAME      (tcpreplay_opt_strs+1902)
+#define LOOP_name      (tcpreplay_opt_strs+1907)
 #define LOOP_DFT_ARG   ((char const*)1)
 #define LOOP_FLAGS     (OPTST_DISABLED \
         | OPTST_SET_ARGTYPE(OPARG_TYPE_NUMERIC))
@@ -393,28 +444,42 @@ static int const aDualfileCantList[] = {
 /*
  *  pktlen option description:
  */
-#define PKTLEN_DESC      (tcpreplay_opt_strs+1750)
-#define PKTLEN_NAME      (tcpreplay_opt_strs+1801)
-#define PKTLEN_name      (tcpreplay_opt_strs+1808)
+#define PKTLEN_DESC      (tcpreplay_opt_strs+1912)
+#define PKTLEN_NAME      (tcpreplay_opt_strs+1963)
+#define PKTLEN_name      (tcpreplay_opt_strs+1970)
 #define PKTLEN_FLAGS     (OPTST_DISABLED)
 
 /*
  *  limit option description:
  */
-#define LIMIT_DESC      (tcpreplay_opt_strs+1815)
-#define LIMIT_NAME      (tcpreplay_opt_strs+1851)
-#define LIMIT_name      (tcpreplay_opt_strs+1857)
+#define LIMIT_DESC      (tcpreplay_opt_strs+1977)
+#define LIMIT_NAME      (tcpreplay_opt_strs+2013)
+#define LIMIT_name      (tcpreplay_opt_strs+2019)
 #define LIMIT_DFT_ARG   ((char const*)-1)
 #define LIMIT_FLAGS     (OPTST_DISABLED \
         | OPTST_SET_ARGTYPE(OPARG_TYPE_NUMERIC))
 
+/*
+ *  start-packet option description with
+ *  "Must also have options" and "Incompatible options":
+ */
+#define START_PACKET_DESC      (tcpreplay_opt_strs+2025)
+#define START_PACKET_NAME      (tcpreplay_opt_strs+2071)
+#define START_PACKET_name      (tcpreplay_opt_strs+2084)
+static int const aStart_PacketCantList[] = {
+    INDEX_OPT_ENABLE_FILE_CACHE,
+    INDEX_OPT_PRELOAD_PCAP,
+    INDEX_OPT_DUALFILE, NO_EQUIVALENT };
+#define START_PACKET_FLAGS     (OPTST_DISABLED \
+        | OPTST_SET_ARGTYPE(OPARG_TYPE_NUMERIC))
+
 /*
  *  multiplier option description with
  *  "Must also have options" and "Incompatible options":
  */
-#define MULTIPLIER_DESC      (tcpreplay_opt_strs+1863)
-#define MULTIPLIER_NAME      (tcpreplay_opt_strs+1903)
-#define MULTIPLIER_name      (tcpreplay_opt_strs+1914)
+#define MULTIPLIER_DESC      (tcpreplay_opt_strs+2097)
+#define MULTIPLIER_NAME      (tcpreplay_opt_strs+2137)
+#define MULTIPLIER_name      (tcpreplay_opt_strs+2148)
 static int const aMultiplierCantList[] = {
     INDEX_OPT_PPS,
     INDEX_OPT_MBPS,
@@ -427,9 +492,9 @@ static int const aMultiplierCantList[] = {
  *  pps option description with
  *  "Must also have options" and "Incompatible options":
  */
-#define PPS_DESC      (tcpreplay_opt_strs+1925)
-#define PPS_NAME      (tcpreplay_opt_strs+1963)
-#define PPS_name      (tcpreplay_opt_strs+1967)
+#define PPS_DESC      (tcpreplay_opt_strs+2159)
+#define PPS_NAME      (tcpreplay_opt_strs+2197)
+#define PPS_name      (tcpreplay_opt_strs+2201)
 static int const aPpsCantList[] = {
     INDEX_OPT_MULTIPLIER,
     INDEX_OPT_MBPS,
@@ -442,9 +507,9 @@ static int const aPpsCantList[] = {
  *  mbps option description with
  *  "Must also have options" and "Incompatible options":
  */
-#define MBPS_DESC      (tcpreplay_opt_strs+1971)
-#define MBPS_NAME      (tcpreplay_opt_strs+2002)
-#define MBPS_name      (tcpreplay_opt_strs+2007)
+#define MBPS_DESC      (tcpreplay_opt_strs+2205)
+#define MBPS_NAME      (tcpreplay_opt_strs+2236)
+#define MBPS_name      (tcpreplay_opt_strs+2241)
 static int const aMbpsCantList[] = {
     INDEX_OPT_MULTIPLIER,
     INDEX_OPT_PPS,
@@ -457,9 +522,9 @@ static int const aMbpsCantList[] = {
  *  topspeed option description with
  *  "Must also have options" and "Incompatible options":
  */
-#define TOPSPEED_DESC      (tcpreplay_opt_strs+2012)
-#define TOPSPEED_NAME      (tcpreplay_opt_strs+2047)
-#define TOPSPEED_name      (tcpreplay_opt_strs+2056)
+#define TOPSPEED_DESC      (tcpreplay_opt_strs+2246)
+#define TOPSPEED_NAME      (tcpreplay_opt_strs+2281)
+#define TOPSPEED_name      (tcpreplay_opt_strs+2290)
 static int const aTopspeedCantList[] = {
     INDEX_OPT_MBPS,
     INDEX_OPT_MULTIPLIER,
@@ -471,9 +536,9 @@ static int const aTopspeedCantList[] = {
  *  oneatatime option description with
  *  "Must also have options" and "Incompatible options":
  */
-#define ONEATATIME_DESC      (tcpreplay_opt_strs+2065)
-#define ONEATATIME_NAME      (tcpreplay_opt_strs+2113)
-#define ONEATATIME_name      (tcpreplay_opt_strs+2124)
+#define ONEATATIME_DESC      (tcpreplay_opt_strs+2299)
+#define ONEATATIME_NAME      (tcpreplay_opt_strs+2347)
+#define ONEATATIME_name      (tcpreplay_opt_strs+2358)
 static int const aOneatatimeCantList[] = {
     INDEX_OPT_MBPS,
     INDEX_OPT_PPS,
@@ -485,68 +550,222 @@ static int const aOneatatimeCantList[] = {
  *  pps-multi option description with
  *  "Must also have options" and "Incompatible options":
  */
-#define PPS_MULTI_DESC      (tcpreplay_opt_strs+2135)
-#define PPS_MULTI_NAME      (tcpreplay_opt_strs+2184)
-#define PPS_MULTI_name      (tcpreplay_opt_strs+2194)
+#define PPS_MULTI_DESC      (tcpreplay_opt_strs+2369)
+#define PPS_MULTI_NAME      (tcpreplay_opt_strs+2418)
+#define PPS_MULTI_name      (tcpreplay_opt_strs+2428)
 #define PPS_MULTI_DFT_ARG   ((char const*)1)
 static int const aPps_MultiMustList[] = {
     INDEX_OPT_PPS, NO_EQUIVALENT };
 #define PPS_MULTI_FLAGS     (OPTST_DISABLED \
         | OPTST_SET_ARGTYPE(OPARG_TYPE_NUMERIC))
 
+/*
+ *  burst option description:
+ */
+#define BURST_DESC      (tcpreplay_opt_strs+2438)
+#define BURST_NAME      (tcpreplay_opt_strs+2478)
+#define BURST_name      (tcpreplay_opt_strs+2484)
+#define BURST_DFT_ARG   ((char const*)32)
+#define BURST_FLAGS     (OPTST_DISABLED \
+        | OPTST_SET_ARGTYPE(OPARG_TYPE_NUMERIC))
+
+/*
+ *  threads option description with
+ *  "Must also have options" and "Incompatible options":
+ */
+#ifdef HAVE_PTHREAD
+#define THREADS_DESC      (tcpreplay_opt_strs+2490)
+#define THREADS_NAME      (tcpreplay_opt_strs+2529)
+#define THREADS_name      (tcpreplay_opt_strs+2537)
+#define THREADS_DFT_ARG   ((char const*)1)
+static int const aThreadsCantList[] = {
+    INDEX_OPT_ONEATATIME,
+    INDEX_OPT_DUALFILE,
+    INDEX_OPT_CACHEFILE, NO_EQUIVALENT };
+#define THREADS_FLAGS     (OPTST_DISABLED \
+        | OPTST_SET_ARGTYPE(OPARG_TYPE_NUMERIC))
+
+#else   /* disable threads */
+#define THREADS_FLAGS     (OPTST_OMITTED | OPTST_NO_INIT)
+#define THREADS_DFT_ARG   NULL
+#define aThreadsCantList   NULL
+#define THREADS_NAME      NULL
+#define THREADS_DESC      NULL
+#define THREADS_name      NULL
+#endif  /* HAVE_PTHREAD */
+
+/*
+ *  pipeline option description with
+ *  "Must also have options" and "Incompatible options":
+ */
+#ifdef HAVE_PTHREAD
+#define PIPELINE_DESC      (tcpreplay_opt_strs+2545)
+#define PIPELINE_NAME      (tcpreplay_opt_strs+2587)
+#define PIPELINE_name      (tcpreplay_opt_strs+2596)
+static int const aPipelineCantList[] = {
+    INDEX_OPT_ONEATATIME, NO_EQUIVALENT };
+#define PIPELINE_FLAGS     (OPTST_DISABLED)
+
+#else   /* disable pipeline */
+#define PIPELINE_FLAGS     (OPTST_OMITTED | OPTST_NO_INIT)
+#define aPipelineCantList   NULL
+#define PIPELINE_NAME      NULL
+#define PIPELINE_DESC      NULL
+#define PIPELINE_name      NULL
+#endif  /* HAVE_PTHREAD */
+
+/*
+ *  pipeline-slots option description with
+ *  "Must also have options" and "Incompatible options":
+ */
+#ifdef HAVE_PTHREAD
+#define PIPELINE_SLOTS_DESC      (tcpreplay_opt_strs+2605)
+#define PIPELINE_SLOTS_NAME      (tcpreplay_opt_strs+2647)
+#define PIPELINE_SLOTS_name      (tcpreplay_opt_strs+2662)
+#define PIPELINE_SLOTS_DFT_ARG   ((char const*)4096)
+static int const aPipeline_SlotsMustList[] = {
+    INDEX_OPT_PIPELINE, NO_EQUIVALENT };
+#define PIPELINE_SLOTS_FLAGS     (OPTST_DISABLED \
+        | OPTST_SET_ARGTYPE(OPARG_TYPE_NUMERIC))
+
+#else   /* disable pipeline-slots */
+#define PIPELINE_SLOTS_FLAGS     (OPTST_OMITTED | OPTST_NO_INIT)
+#define PIPELINE_SLOTS_DFT_ARG   NULL
+#define aPipeline_SlotsMustList   NULL
+#define PIPELINE_SLOTS_NAME      NULL
+#define PIPELINE_SLOTS_DESC      NULL
+#define PIPELINE_SLOTS_name      NULL
+#endif  /* HAVE_PTHREAD */
+
+/*
+ *  pipeline-cpus option description with
+ *  "Must also have options" and "Incompatible options":
+ */
+#ifdef HAVE_PTHREAD
+#define PIPELINE_CPUS_DESC      (tcpreplay_opt_strs+2677)
+#define PIPELINE_CPUS_NAME      (tcpreplay_opt_strs+2726)
+#define PIPELINE_CPUS_name      (tcpreplay_opt_strs+2740)
+static int const aPipeline_CpusMustList[] = {
+    INDEX_OPT_PIPELINE, NO_EQUIVALENT };
+#define PIPELINE_CPUS_FLAGS     (OPTST_DISABLED \
+        | OPTST_SET_ARGTYPE(OPARG_TYPE_STRING))
+
+#else   /* disable pipeline-cpus */
+#define PIPELINE_CPUS_FLAGS     (OPTST_OMITTED | OPTST_NO_INIT)
+#define aPipeline_CpusMustList   NULL
+#define PIPELINE_CPUS_NAME      NULL
+#define PIPELINE_CPUS_DESC      NULL
+#define PIPELINE_CPUS_name      NULL
+#endif  /* HAVE_PTHREAD */
+
+/*
+ *  prefetch option description:
+ */
+#ifdef HAVE_PTHREAD
+#define PREFETCH_DESC      (tcpreplay_opt_strs+2754)
+#define PREFETCH_NAME      (tcpreplay_opt_strs+2811)
+#define PREFETCH_name      (tcpreplay_opt_strs+2820)
+#define PREFETCH_FLAGS     (OPTST_DISABLED \
+        | OPTST_SET_ARGTYPE(OPARG_TYPE_NUMERIC))
+
+#else   /* disable prefetch */
+#define PREFETCH_FLAGS     (OPTST_OMITTED | OPTST_NO_INIT)
+#define PREFETCH_NAME      NULL
+#define PREFETCH_DESC      NULL
+#define PREFETCH_name      NULL
+#endif  /* HAVE_PTHREAD */
+
+/*
+ *  txring-frames option description:
+ */
+#ifdef HAVE_TX_RING
+#define TXRING_FRAMES_DESC      (tcpreplay_opt_strs+2829)
+#define TXRING_FRAMES_NAME      (tcpreplay_opt_strs+2867)
+#define TXRING_FRAMES_name      (tcpreplay_opt_strs+2881)
+#define TXRING_FRAMES_DFT_ARG   ((char const*)2048)
+#define TXRING_FRAMES_FLAGS     (OPTST_DISABLED \
+        | OPTST_SET_ARGTYPE(OPARG_TYPE_NUMERIC))
+
+#else   /* disable txring-frames */
+#define TXRING_FRAMES_FLAGS     (OPTST_OMITTED | OPTST_NO_INIT)
+#define TXRING_FRAMES_DFT_ARG   NULL
+#define TXRING_FRAMES_NAME      NULL
+#define TXRING_FRAMES_DESC      NULL
+#define TXRING_FRAMES_name      NULL
+#endif  /* HAVE_TX_RING */
+
+/*
+ *  txring-batch option description:
+ */
+#ifdef HAVE_TX_RING
+#define TXRING_BATCH_DESC      (tcpreplay_opt_strs+2895)
+#define TXRING_BATCH_NAME      (tcpreplay_opt_strs+2955)
+#define TXRING_BATCH_name      (tcpreplay_opt_strs+2968)
+#define TXRING_BATCH_DFT_ARG   ((char const*)32)
+#define TXRING_BATCH_FLAGS     (OPTST_DISABLED \
+        | OPTST_SET_ARGTYPE(OPARG_TYPE_NUMERIC))
+
+#else   /* disable txring-batch */
+#define TXRING_BATCH_FLAGS     (OPTST_OMITTED | OPTST_NO_INIT)
+#define TXRING_BATCH_DFT_ARG   NULL
+#define TXRING_BATCH_NAME      NULL
+#define TXRING_BATCH_DESC      NULL
+#define TXRING_BATCH_name      NULL
+#endif  /* HAVE_TX_RING */
+
 /*
  *  pid option description:
  */
-#define PID_DESC      (tcpreplay_opt_strs+2204)
-#define PID_NAME      (tcpreplay_opt_strs+2242)
-#define PID_name      (tcpreplay_opt_strs+2246)
+#define PID_DESC      (tcpreplay_opt_strs+2981)
+#define PID_NAME      (tcpreplay_opt_strs+3019)
+#define PID_name      (tcpreplay_opt_strs+3023)
 #define PID_FLAGS     (OPTST_DISABLED)
 
 /*
  *  stats option description:
  */
-#define STATS_DESC      (tcpreplay_opt_strs+2250)
-#define STATS_NAME      (tcpreplay_opt_strs+2283)
-#define STATS_name      (tcpreplay_opt_strs+2289)
+#define STATS_DESC      (tcpreplay_opt_strs+3027)
+#define STATS_NAME      (tcpreplay_opt_strs+3060)
+#define STATS_name      (tcpreplay_opt_strs+3066)
 #define STATS_FLAGS     (OPTST_DISABLED \
         | OPTST_SET_ARGTYPE(OPARG_TYPE_NUMERIC))
 
 /*
  *  version option description:
  */
-#define VERSION_DESC      (tcpreplay_opt_strs+2295)
-#define VERSION_NAME      (tcpreplay_opt_strs+2321)
-#define VERSION_name      (tcpreplay_opt_strs+2329)
+#define VERSION_DESC      (tcpreplay_opt_strs+3072)
+#define VERSION_NAME      (tcpreplay_opt_strs+3098)
+#define VERSION_name      (tcpreplay_opt_strs+3106)
 #define VERSION_FLAGS     (OPTST_DISABLED)
 
 /*
  *  less-help option description:
  */
-#define LESS_HELP_DESC      (tcpreplay_opt_strs+2337)
-#define LESS_HELP_NAME      (tcpreplay_opt_strs+2377)
-#define LESS_HELP_name      (tcpreplay_opt_strs+2387)
+#define LESS_HELP_DESC      (tcpreplay_opt_strs+3114)
+#define LESS_HELP_NAME      (tcpreplay_opt_strs+3154)
+#define LESS_HELP_name      (tcpreplay_opt_strs+3164)
 #define LESS_HELP_FLAGS     (OPTST_DISABLED | OPTST_IMM)
 
 /*
  *  Help/More_Help option descriptions:
  */
-#define HELP_DESC       (tcpreplay_opt_strs+2397)
-#define HELP_name       (tcpreplay_opt_strs+2441)
+#define HELP_DESC       (tcpreplay_opt_strs+3174)
+#define HELP_name       (tcpreplay_opt_strs+3218)
 #ifdef HAVE_WORKING_FORK
-#define MORE_HELP_DESC  (tcpreplay_opt_strs+2446)
-#define MORE_HELP_name  (tcpreplay_opt_strs+2491)
+#define MORE_HELP_DESC  (tcpreplay_opt_strs+3223)
+#define MORE_HELP_name  (tcpreplay_opt_strs+3268)
 #define MORE_HELP_FLAGS (OPTST_IMM | OPTST_NO_INIT)
 #else
 #define MORE_HELP_DESC  NULL
 #define MORE_HELP_name  NULL
 #define MORE_HELP_FLAGS (OPTST_OMITTED | OPTST_NO_INIT)
 #endif
-#define SAVE_OPTS_DESC  (tcpreplay_opt_strs+2501)
-#define SAVE_OPTS_name  (tcpreplay_opt_strs+2540)
-#define LOAD_OPTS_DESC     (tcpreplay_opt_strs+2550)
-#define LOAD_OPTS_NAME     (tcpreplay_opt_strs+2582)
-#define NO_LOAD_OPTS_name  (tcpreplay_opt_strs+2592)
-#define LOAD_OPTS_pfx      (tcpreplay_opt_strs+2605)
+#define SAVE_OPTS_DESC  (tcpreplay_opt_strs+3278)
+#define SAVE_OPTS_name  (tcpreplay_opt_strs+3317)
+#define LOAD_OPTS_DESC     (tcpreplay_opt_strs+3327)
+#define LOAD_OPTS_NAME     (tcpreplay_opt_strs+3359)
+#define NO_LOAD_OPTS_name  (tcpreplay_opt_strs+3369)
+#define LOAD_OPTS_pfx      (tcpreplay_opt_strs+3382)
 #define LOAD_OPTS_name     (NO_LOAD_OPTS_name + 3)
 /*
  *  Declare option callback procedures
@@ -561,14 +780,41 @@ static int const aPps_MultiMustList[] = {
 #else /* not ENABLE_PCAP_FINDALLDEVS */
 # define doOptListnics NULL
 #endif /* def/not ENABLE_PCAP_FINDALLDEVS */
+#ifdef HAVE_PTHREAD
+  static tOptProc doOptThreads;
+#else /* not HAVE_PTHREAD */
+# define doOptThreads NULL
+#endif /* def/not HAVE_PTHREAD */
+#ifdef HAVE_PTHREAD
+  static tOptProc doOptPipeline_Slots;
+#else /* not HAVE_PTHREAD */
+# define doOptPipeline_Slots NULL
+#endif /* def/not HAVE_PTHREAD */
+#ifdef HAVE_PTHREAD
+  static tOptProc doOptPrefetch;
+#else /* not HAVE_PTHREAD */
+# define doOptPrefetch NULL
+#endif /* def/not HAVE_PTHREAD */
+#ifdef HAVE_TX_RING
+  static tOptProc doOptTxring_Frames;
+#else /* not HAVE_TX_RING */
+# define doOptTxring_Frames NULL
+#endif /* def/not HAVE_TX_RING */
+#ifdef HAVE_TX_RING
+  static tOptProc doOptTxring_Batch;
+#else /* not HAVE_TX_RING */
+# define doOptTxring_Batch NULL
+#endif /* def/not HAVE_TX_RING */
 extern tOptProc
     optionBooleanVal,   optionNestedVal,    optionNumericVal,
     optionPagedUsage,   optionPrintVersion, optionResetOpt,
     optionStackArg,     optionTimeDate,     optionTimeVal,
     optionUnstackArg,   optionVendorOption;
 static tOptProc
-    doOptLess_Help, doOptLimit,     doOptLoop,      doOptPid,
-    doOptPps_Multi, doOptStats,     doOptVersion,   doUsageOpt;
+    doOptBurst,          doOptLess_Help,      doOptLimit,
+    doOptLoop,           doOptPid,            doOptPps_Multi,
+    doOptSpin_Threshold, doOptStart_Packet,   doOptStats,
+    doOptVersion,        doUsageOpt;
 
 /* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
 /**
@@ -613,8 +859,20 @@ static tOptDesc optDesc[OPTION_CT] = {
      /* desc, NAME, name */ TIMER_DESC, TIMER_NAME, TIMER_name,
      /* disablement strs */ NULL, NULL },
 
-  {  /* entry idx, value */ 3, VALUE_OPT_SLEEP_ACCEL,
-     /* equiv idx, value */ 3, VALUE_OPT_SLEEP_ACCEL,
+  {  /* entry idx, value */ 3, VALUE_OPT_SPIN_THRESHOLD,
+     /* equiv idx, value */ 3, VALUE_OPT_SPIN_THRESHOLD,
+     /* equivalenced to  */ NO_EQUIVALENT,
+     /* min, max, act ct */ 0, 1, 0,
+     /* opt state flags  */ SPIN_THRESHOLD_FLAGS, 0,
+     /* last opt argumnt */ { SPIN_THRESHOLD_DFT_ARG },
+     /* arg list/cookie  */ NULL,
+     /* must/cannot opts */ NULL, NULL,
+     /* option proc      */ doOptSpin_Threshold,
+     /* desc, NAME, name */ SPIN_THRESHOLD_DESC, SPIN_THRESHOLD_NAME, SPIN_THRESHOLD_name,
+     /* disablement strs */ NULL, NULL },
+
+  {  /* entry idx, value */ 4, VALUE_OPT_SLEEP_ACCEL,
+     /* equiv idx, value */ 4, VALUE_OPT_SLEEP_ACCEL,
      /* equivalenced to  */ NO_EQUIVALENT,
      /* min, max, act ct */ 0, 1, 0,
      /* opt state flags  */ SLEEP_ACCEL_FLAGS, 0,
@@ -625,8 +883,8 @@ static tOptDesc optDesc[OPTION_CT] = {
      /* desc, NAME, name */ SLEEP_ACCEL_DESC, SLEEP_ACCEL_NAME, SLEEP_ACCEL_name,
      /* disablement strs */ NULL, NULL },
 
-  {  /* entry idx, value */ 4, VALUE_OPT_RDTSC_CLICKS,
-     /* equiv idx, value */ 4, VALUE_OPT_RDTSC_CLICKS,
+  {  /* entry idx, value */ 5, VALUE_OPT_RDTSC_CLICKS,
+     /* equiv idx, value */ 5, VALUE_OPT_RDTSC_CLICKS,
      /* equivalenced to  */ NO_EQUIVALENT,
      /* min, max, act ct */ 0, 1, 0,
      /* opt state flags  */ RDTSC_CLICKS_FLAGS, 0,
@@ -637,8 +895,8 @@ static tOptDesc optDesc[OPTION_CT] = {
      /* desc, NAME, name */ RDTSC_CLICKS_DESC, RDTSC_CLICKS_NAME, RDTSC_CLICKS_name,
      /* disablement strs */ NULL, NULL },
 
-  {  /* entry idx, value */ 5, VALUE_OPT_VERBOSE,
-     /* equiv idx, value */ 5, VALUE_OPT_VERBOSE,
+  {  /* entry idx, value */ 6, VALUE_OPT_VERBOSE,
+     /* equiv idx, value */ 6, VALUE_OPT_VERBOSE,
      /* equivalenced to  */ NO_EQUIVALENT,
      /* min, max, act ct */ 0, 1, 0,
      /* opt state flags  */ VERBOSE_FLAGS, 0,
@@ -649,8 +907,8 @@ static tOptDesc optDesc[OPTION_CT] = {
      /* desc, NAME, name */ VERBOSE_DESC, VERBOSE_NAME, VERBOSE_name,
      /* disablement strs */ NULL, NULL },
 
-  {  /* entry idx, value */ 6, VALUE_OPT_DECODE,
-     /* equiv idx, value */ 6, VALUE_OPT_DECODE,
+  {  /* entry idx, value */ 7, VALUE_OPT_DECODE,
+     /* equiv idx, value */ 7, VALUE_OPT_DECODE,
      /* equivalenced to  */ NO_EQUIVALENT,
      /* min, max, act ct */ 0, 1, 0,
      /* opt state flags  */ DECODE_FLAGS, 0,
@@ -661,8 +919,8 @@ static tOptDesc optDesc[OPTION_CT] = {
      /* desc, NAME, name */ DECODE_DESC, DECODE_NAME, DECODE_name,
      /* disablement strs */ NULL, NULL },
 
-  {  /* entry idx, value */ 7, VALUE_OPT_ENABLE_FILE_CACHE,
-     /* equiv idx, value */ 7, VALUE_OPT_ENABLE_FILE_CACHE,
+  {  /* entry idx, value */ 8, VALUE_OPT_ENABLE_FILE_CACHE,
+     /* equiv idx, value */ 8, VALUE_OPT_ENABLE_FILE_CACHE,
      /* equivalenced to  */ NO_EQUIVALENT,
      /* min, max, act ct */ 0, 1, 0,
      /* opt state flags  */ ENABLE_FILE_CACHE_FLAGS, 0,
@@ -673,8 +931,8 @@ static tOptDesc optDesc[OPTION_CT] = {
      /* desc, NAME, name */ ENABLE_FILE_CACHE_DESC, ENABLE_FILE_CACHE_NAME, ENABLE_FILE_CACHE_name,
      /* disablement strs */ NULL, NULL },
 
-  {  /* entry idx, value */ 8, VALUE_OPT_PRELOAD_PCAP,
-     /* equiv idx, value */ 8, VALUE_OPT_PRELOAD_PCAP,
+  {  /* entry idx, value */ 9, VALUE_OPT_PRELOAD_PCAP,
+     /* equiv idx, value */ 9, VALUE_OPT_PRELOAD_PCAP,
      /* equivalenced to  */ NO_EQUIVALENT,
      /* min, max, act ct */ 0, 1, 0,
      /* opt state flags  */ PRELOAD_PCAP_FLAGS, 0,
@@ -685,8 +943,20 @@ static tOptDesc optDesc[OPTION_CT] = {
      /* desc, NAME, name */ PRELOAD_PCAP_DESC, PRELOAD_PCAP_NAME, PRELOAD_PCAP_name,
      /* disablement strs */ NULL, NULL },
 
-  {  /* entry idx, value */ 9, VALUE_OPT_CACHEFILE,
-     /* equiv idx, value */ 9, VALUE_OPT_CACHEFILE,
+  {  /* entry idx, value */ 10, VALUE_OPT_CACHE_HUGEPAGES,
+     /* equiv idx, value */ 10, VALUE_OPT_CACHE_HUGEPAGES,
+     /* equivalenced to  */ NO_EQUIVALENT,
+     /* min, max, act ct */ 0, 1, 0,
+     /* opt state flags  */ CACHE_HUGEPAGES_FLAGS, 0,
+     /* last opt argumnt */ { NULL }, /* --cache_hugepages */
+     /* arg list/cookie  */ NULL,
+     /* must/cannot opts */ NULL, NULL,
+     /* option proc      */ NULL,
+     /* desc, NAME, name */ CACHE_HUGEPAGES_DESC, CACHE_HUGEPAGES_NAME, CACHE_HUGEPAGES_name,
+     /* disablement strs */ NULL, NULL },
+
+  {  /* entry idx, value */ 11, VALUE_OPT_CACHEFILE,
+     /* equiv idx, value */ 11, VALUE_OPT_CACHEFILE,
      /* equivalenced to  */ NO_EQUIVALENT,
      /* min, max, act ct */ 0, 1, 0,
      /* opt state flags  */ CACHEFILE_FLAGS, 0,
@@ -697,8 +967,8 @@ static tOptDesc optDesc[OPTION_CT] = {
      /* desc, NAME, name */ CACHEFILE_DESC, CACHEFILE_NAME, CACHEFILE_name,
      /* disablement strs */ NULL, NULL },
 
-  {  /* entry idx, value */ 10, VALUE_OPT_DUALFILE,
-     /* equiv idx, value */ 10, VALUE_OPT_DUALFILE,
+  {  /* entry idx, value */ 12, VALUE_OPT_DUALFILE,
+     /* equiv idx, value */ 12, VALUE_OPT_DUALFILE,
      /* equivalenced to  */ NO_EQUIVALENT,
      /* min, max, act ct */ 0, 1, 0,
      /* opt state flags  */ DUALFILE_FLAGS, 0,
@@ -709,8 +979,8 @@ static tOptDesc optDesc[OPTION_CT] = {
      /* desc, NAME, name */ DUALFILE_DESC, DUALFILE_NAME, DUALFILE_name,
      /* disablement strs */ NULL, NULL },
 
-  {  /* entry idx, value */ 11, VALUE_OPT_INTF1,
-     /* equiv idx, value */ 11, VALUE_OPT_INTF1,
+  {  /* entry idx, value */ 13, VALUE_OPT_INTF1,
+     /* equiv idx, value */ 13, VALUE_OPT_INTF1,
      /* equivalenced to  */ NO_EQUIVALENT,
      /* min, max, act ct */ 1, 1, 0,
      /* opt state flags  */ INTF1_FLAGS, 0,
@@ -721,8 +991,8 @@ static tOptDesc optDesc[OPTION_CT] = {
      /* desc, NAME, name */ INTF1_DESC, INTF1_NAME, INTF1_name,
      /* disablement strs */ NULL, NULL },
 
-  {  /* entry idx, value */ 12, VALUE_OPT_INTF2,
-     /* equiv idx, value */ 12, VALUE_OPT_INTF2,
+  {  /* entry idx, value */ 14, VALUE_OPT_INTF2,
+     /* equiv idx, value */ 14, VALUE_OPT_INTF2,
      /* equivalenced to  */ NO_EQUIVALENT,
      /* min, max, act ct */ 0, 1, 0,
      /* opt state flags  */ INTF2_FLAGS, 0,
@@ -733,8 +1003,8 @@ static tOptDesc optDesc[OPTION_CT] = {
      /* desc, NAME, name */ INTF2_DESC, INTF2_NAME, INTF2_name,
      /* disablement strs */ NULL, NULL },
 
-  {  /* entry idx, value */ 13, VALUE_OPT_LISTNICS,
-     /* equiv idx, value */ 13, VALUE_OPT_LISTNICS,
+  {  /* entry idx, value */ 15, VALUE_OPT_LISTNICS,
+     /* equiv idx, value */ 15, VALUE_OPT_LISTNICS,
      /* equivalenced to  */ NO_EQUIVALENT,
      /* min, max, act ct */ 0, 1, 0,
      /* opt state flags  */ LISTNICS_FLAGS, 0,
@@ -745,8 +1015,8 @@ static tOptDesc optDesc[OPTION_CT] = {
      /* desc, NAME, name */ LISTNICS_DESC, LISTNICS_NAME, LISTNICS_name,
      /* disablement strs */ NULL, NULL },
 
-  {  /* entry idx, value */ 14, VALUE_OPT_LOOP,
-     /* equiv idx, value */ 14, VALUE_OPT_LOOP,
+  {  /* entry idx, value */ 16, VALUE_OPT_LOOP,
+     /* equiv idx, value */ 16, VALUE_OPT_LOOP,
      /* equivalenced to  */ NO_EQUIVALENT,
      /* min, max, act ct */ 0, 1, 0,
      /* opt state flags  */ LOOP_FLAGS, 0,
@@ -757,8 +1027,8 @@ static tOptDesc optDesc[OPTION_CT] = {
      /* desc, NAME, name */ LOOP_DESC, LOOP_NAME, LOOP_name,
      /* disablement strs */ NULL, NULL },
 
-  {  /* entry idx, value */ 15, VALUE_OPT_PKTLEN,
-     /* equiv idx, value */ 15, VALUE_OPT_PKTLEN,
+  {  /* entry idx, value */ 17, VALUE_OPT_PKTLEN,
+     /* equiv idx, value */ 17, VALUE_OPT_PKTLEN,
      /* equivalenced to  */ NO_EQUIVALENT,
      /* min, max, act ct */ 0, 1, 0,
      /* opt state flags  */ PKTLEN_FLAGS, 0,
@@ -769,8 +1039,8 @@ static tOptDesc optDesc[OPTION_CT] = {
      /* desc, NAME, name */ PKTLEN_DESC, PKTLEN_NAME, PKTLEN_name,
      /* disablement strs */ NULL, NULL },
 
-  {  /* entry idx, value */ 16, VALUE_OPT_LIMIT,
-     /* equiv idx, value */ 16, VALUE_OPT_LIMIT,
+  {  /* entry idx, value */ 18, VALUE_OPT_LIMIT,
+     /* equiv idx, value */ 18, VALUE_OPT_LIMIT,
      /* equivalenced to  */ NO_EQUIVALENT,
      /* min, max, act ct */ 0, 1, 0,
      /* opt state flags  */ LIMIT_FLAGS, 0,
@@ -781,8 +1051,20 @@ static tOptDesc optDesc[OPTION_CT] = {
      /* desc, NAME, name */ LIMIT_DESC, LIMIT_NAME, LIMIT_name,
      /* disablement strs */ NULL, NULL },
 
-  {  /* entry idx, value */ 17, VALUE_OPT_MULTIPLIER,
-     /* equiv idx, value */ 17, VALUE_OPT_MULTIPLIER,
+  {  /* entry idx, value */ 19, VALUE_OPT_START_PACKET,
+     /* equiv idx, value */ 19, VALUE_OPT_START_PACKET,
+     /* equivalenced to  */ NO_EQUIVALENT,
+     /* min, max, act ct */ 0, 1, 0,
+     /* opt state flags  */ START_PACKET_FLAGS, 0,
+     /* last opt argumnt */ { NULL }, /* --start-packet */
+     /* arg list/cookie  */ NULL,
+     /* must/cannot opts */ NULL, aStart_PacketCantList,
+     /* option proc      */ doOptStart_Packet,
+     /* desc, NAME, name */ START_PACKET_DESC, START_PACKET_NAME, START_PACKET_name,
+     /* disablement strs */ NULL, NULL },
+
+  {  /* entry idx, value */ 20, VALUE_OPT_MULTIPLIER,
+     /* equiv idx, value */ 20, VALUE_OPT_MULTIPLIER,
      /* equivalenced to  */ NO_EQUIVALENT,
      /* min, max, act ct */ 0, 1, 0,
      /* opt state flags  */ MULTIPLIER_FLAGS, 0,
@@ -793,8 +1075,8 @@ static tOptDesc optDesc[OPTION_CT] = {
      /* desc, NAME, name */ MULTIPLIER_DESC, MULTIPLIER_NAME, MULTIPLIER_name,
      /* disablement strs */ NULL, NULL },
 
-  {  /* entry idx, value */ 18, VALUE_OPT_PPS,
-     /* equiv idx, value */ 18, VALUE_OPT_PPS,
+  {  /* entry idx, value */ 21, VALUE_OPT_PPS,
+     /* equiv idx, value */ 21, VALUE_OPT_PPS,
      /* equivalenced to  */ NO_EQUIVALENT,
      /* min, max, act ct */ 0, 1, 0,
      /* opt state flags  */ PPS_FLAGS, 0,
@@ -805,8 +1087,8 @@ static tOptDesc optDesc[OPTION_CT] = {
      /* desc, NAME, name */ PPS_DESC, PPS_NAME, PPS_name,
      /* disablement strs */ NULL, NULL },
 
-  {  /* entry idx, value */ 19, VALUE_OPT_MBPS,
-     /* equiv idx, value */ 19, VALUE_OPT_MBPS,
+  {  /* entry idx, value */ 22, VALUE_OPT_MBPS,
+     /* equiv idx, value */ 22, VALUE_OPT_MBPS,
      /* equivalenced to  */ NO_EQUIVALENT,
      /* min, max, act ct */ 0, 1, 0,
      /* opt state flags  */ MBPS_FLAGS, 0,
@@ -817,8 +1099,8 @@ static tOptDesc optDesc[OPTION_CT] = {
      /* desc, NAME, name */ MBPS_DESC, MBPS_NAME, MBPS_name,
      /* disablement strs */ NULL, NULL },
 
-  {  /* entry idx, value */ 20, VALUE_OPT_TOPSPEED,
-     /* equiv idx, value */ 20, VALUE_OPT_TOPSPEED,
+  {  /* entry idx, value */ 23, VALUE_OPT_TOPSPEED,
+     /* equiv idx, value */ 23, VALUE_OPT_TOPSPEED,
      /* equivalenced to  */ NO_EQUIVALENT,
      /* min, max, act ct */ 0, 1, 0,
      /* opt state flags  */ TOPSPEED_FLAGS, 0,
@@ -829,8 +1111,8 @@ static tOptDesc optDesc[OPTION_CT] = {
      /* desc, NAME, name */ TOPSPEED_DESC, TOPSPEED_NAME, TOPSPEED_name,
      /* disablement strs */ NULL, NULL },
 
-  {  /* entry idx, value */ 21, VALUE_OPT_ONEATATIME,
-     /* equiv idx, value */ 21, VALUE_OPT_ONEATATIME,
+  {  /* entry idx, value */ 24, VALUE_OPT_ONEATATIME,
+     /* equiv idx, value */ 24, VALUE_OPT_ONEATATIME,
      /* equivalenced to  */ NO_EQUIVALENT,
      /* min, max, act ct */ 0, 1, 0,
      /* opt state flags  */ ONEATATIME_FLAGS, 0,
@@ -841,8 +1123,8 @@ static tOptDesc optDesc[OPTION_CT] = {
      /* desc, NAME, name */ ONEATATIME_DESC, ONEATATIME_NAME, ONEATATIME_name,
      /* disablement strs */ NULL, NULL },
 
-  {  /* entry idx, value */ 22, VALUE_OPT_PPS_MULTI,
-     /* equiv idx, value */ 22, VALUE_OPT_PPS_MULTI,
+  {  /* entry idx, value */ 25, VALUE_OPT_PPS_MULTI,
+     /* equiv idx, value */ 25, VALUE_OPT_PPS_MULTI,
      /* equivalenced to  */ NO_EQUIVALENT,
      /* min, max, act ct */ 0, 1, 0,
      /* opt state flags  */ PPS_MULTI_FLAGS, 0,
@@ -853,8 +1135,104 @@ static tOptDesc optDesc[OPTION_CT] = {
      /* desc, NAME, name */ PPS_MULTI_DESC, PPS_MULTI_NAME, PPS_MULTI_name,
      /* disablement strs */ NULL, NULL },
 
-  {  /* entry idx, value */ 23, VALUE_OPT_PID,
-     /* equiv idx, value */ 23, VALUE_OPT_PID,
+  {  /* entry idx, value */ 26, VALUE_OPT_BURST,
+     /* equiv idx, value */ 26, VALUE_OPT_BURST,
+     /* equivalenced to  */ NO_EQUIVALENT,
+     /* min, max, act ct */ 0, 1, 0,
+     /* opt state flags  */ BURST_FLAGS, 0,
+     /* last opt argumnt */ { BURST_DFT_ARG },
+     /* arg list/cookie  */ NULL,
+     /* must/cannot opts */ NULL, NULL,
+     /* option proc      */ doOptBurst,
+     /* desc, NAME, name */ BURST_DESC, BURST_NAME, BURST_name,
+     /* disablement strs */ NULL, NULL },
+
+  {  /* entry idx, value */ 27, VALUE_OPT_THREADS,
+     /* equiv idx, value */ 27, VALUE_OPT_THREADS,
+     /* equivalenced to  */ NO_EQUIVALENT,
+     /* min, max, act ct */ 0, 1, 0,
+     /* opt state flags  */ THREADS_FLAGS, 0,
+     /* last opt argumnt */ { THREADS_DFT_ARG },
+     /* arg list/cookie  */ NULL,
+     /* must/cannot opts */ NULL, aThreadsCantList,
+     /* option proc      */ doOptThreads,
+     /* desc, NAME, name */ THREADS_DESC, THREADS_NAME, THREADS_name,
+     /* disablement strs */ NULL, NULL },
+
+  {  /* entry idx, value */ 28, VALUE_OPT_PIPELINE,
+     /* equiv idx, value */ 28, VALUE_OPT_PIPELINE,
+     /* equivalenced to  */ NO_EQUIVALENT,
+     /* min, max, act ct */ 0, 1, 0,
+     /* opt state flags  */ PIPELINE_FLAGS, 0,
+     /* last opt argumnt */ { NULL }, /* --pipeline */
+     /* arg list/cookie  */ NULL,
+     /* must/cannot opts */ NULL, aPipelineCantList,
+     /* option proc      */ NULL,
+     /* desc, NAME, name */ PIPELINE_DESC, PIPELINE_NAME, PIPELINE_name,
+     /* disablement strs */ NULL, NULL },
+
+  {  /* entry idx, value */ 29, VALUE_OPT_PIPELINE_SLOTS,
+     /* equiv idx, value */ 29, VALUE_OPT_PIPELINE_SLOTS,
+     /* equivalenced to  */ NO_EQUIVALENT,
+     /* min, max, act ct */ 0, 1, 0,
+     /* opt state flags  */ PIPELINE_SLOTS_FLAGS, 0,
+     /* last opt argumnt */ { PIPELINE_SLOTS_DFT_ARG },
+     /* arg list/cookie  */ NULL,
+     /* must/cannot opts */ aPipeline_SlotsMustList, NULL,
+     /* option proc      */ doOptPipeline_Slots,
+     /* desc, NAME, name */ PIPELINE_SLOTS_DESC, PIPELINE_SLOTS_NAME, PIPELINE_SLOTS_name,
+     /* disablement strs */ NULL, NULL },
+
+  {  /* entry idx, value */ 30, VALUE_OPT_PIPELINE_CPUS,
+     /* equiv idx, value */ 30, VALUE_OPT_PIPELINE_CPUS,
+     /* equivalenced to  */ NO_EQUIVALENT,
+     /* min, max, act ct */ 0, 1, 0,
+     /* opt state flags  */ PIPELINE_CPUS_FLAGS, 0,
+     /* last opt argumnt */ { NULL }, /* --pipeline-cpus */
+     /* arg list/cookie  */ NULL,
+     /* must/cannot opts */ aPipeline_CpusMustList, NULL,
+     /* option proc      */ NULL,
+     /* desc, NAME, name */ PIPELINE_CPUS_DESC, PIPELINE_CPUS_NAME, PIPELINE_CPUS_name,
+     /* disablement strs */ NULL, NULL },
+
+  {  /* entry idx, value */ 31, VALUE_OPT_PREFETCH,
+     /* equiv idx, value */ 31, VALUE_OPT_PREFETCH,
+     /* equivalenced to  */ NO_EQUIVALENT,
+     /* min, max, act ct */ 0, 1, 0,
+     /* opt state flags  */ PREFETCH_FLAGS, 0,
+     /* last opt argumnt */ { NULL }, /* --prefetch */
+     /* arg list/cookie  */ NULL,
+     /* must/cannot opts */ NULL, NULL,
+     /* option proc      */ doOptPrefetch,
+     /* desc, NAME, name */ PREFETCH_DESC, PREFETCH_NAME, PREFETCH_name,
+     /* disablement strs */ NULL, NULL },
+
+  {  /* entry idx, value */ 32, VALUE_OPT_TXRING_FRAMES,
+     /* equiv idx, value */ 32, VALUE_OPT_TXRING_FRAMES,
+     /* equivalenced to  */ NO_EQUIVALENT,
+     /* min, max, act ct */ 0, 1, 0,
+     /* opt state flags  */ TXRING_FRAMES_FLAGS, 0,
+     /* last opt argumnt */ { TXRING_FRAMES_DFT_ARG },
+     /* arg list/cookie  */ NULL,
+     /* must/cannot opts */ NULL, NULL,
+     /* option proc      */ doOptTxring_Frames,
+     /* desc, NAME, name */ TXRING_FRAMES_DESC, TXRING_FRAMES_NAME, TXRING_FRAMES_name,
+     /* disablement strs */ NULL, NULL },
+
+  {  /* entry idx, value */ 33, VALUE_OPT_TXRING_BATCH,
+     /* equiv idx, value */ 33, VALUE_OPT_TXRING_BATCH,
+     /* equivalenced to  */ NO_EQUIVALENT,
+     /* min, max, act ct */ 0, 1, 0,
+     /* opt state flags  */ TXRING_BATCH_FLAGS, 0,
+     /* last opt argumnt */ { TXRING_BATCH_DFT_ARG },
+     /* arg list/cookie  */ NULL,
+     /* must/cannot opts */ NULL, NULL,
+     /* option proc      */ doOptTxring_Batch,
+     /* desc, NAME, name */ TXRING_BATCH_DESC, TXRING_BATCH_NAME, TXRING_BATCH_name,
+     /* disablement strs */ NULL, NULL },
+
+  {  /* entry idx, value */ 34, VALUE_OPT_PID,
+     /* equiv idx, value */ 34, VALUE_OPT_PID,
      /* equivalenced to  */ NO_EQUIVALENT,
      /* min, max, act ct */ 0, 1, 0,
      /* opt state flags  */ PID_FLAGS, 0,
@@ -865,8 +1243,8 @@ static tOptDesc optDesc[OPTION_CT] = {
      /* desc, NAME, name */ PID_DESC, PID_NAME, PID_name,
      /* disablement strs */ NULL, NULL },
 
-  {  /* entry idx, value */ 24, VALUE_OPT_STATS,
-     /* equiv idx, value */ 24, VALUE_OPT_STATS,
+  {  /* entry idx, value */ 35, VALUE_OPT_STATS,
+     /* equiv idx, value */ 35, VALUE_OPT_STATS,
      /* equivalenced to  */ NO_EQUIVALENT,
      /* min, max, act ct */ 0, 1, 0,
      /* opt state flags  */ STATS_FLAGS, 0,
@@ -877,8 +1255,8 @@ static tOptDesc optDesc[OPTION_CT] = {
      /* desc, NAME, name */ STATS_DESC, STATS_NAME, STATS_name,
      /* disablement strs */ NULL, NULL },
 
-  {  /* entry idx, value */ 25, VALUE_OPT_VERSION,
-     /* equiv idx, value */ 25, VALUE_OPT_VERSION,
+  {  /* entry idx, value */ 36, VALUE_OPT_VERSION,
+     /* equiv idx, value */ 36, VALUE_OPT_VERSION,
      /* equivalenced to  */ NO_EQUIVALENT,
      /* min, max, act ct */ 0, 1, 0,
      /* opt state flags  */ VERSION_FLAGS, 0,
@@ -889,8 +1267,8 @@ static tOptDesc optDesc[OPTION_CT] = {
      /* desc, NAME, name */ VERSION_DESC, VERSION_NAME, VERSION_name,
      /* disablement strs */ NULL, NULL },
 
-  {  /* entry idx, value */ 26, VALUE_OPT_LESS_HELP,
-     /* equiv idx, value */ 26, VALUE_OPT_LESS_HELP,
+  {  /* entry idx, value */ 37, VALUE_OPT_LESS_HELP,
+     /* equiv idx, value */ 37, VALUE_OPT_LESS_HELP,
      /* equivalenced to  */ NO_EQUIVALENT,
      /* min, max, act ct */ 0, 1, 0,
      /* opt state flags  */ LESS_HELP_FLAGS, 0,
@@ -957,15 +1335,15 @@ static tOptDesc optDesc[OPTION_CT] = {
  *
  *  Define the tcpreplay Option Environment
  */
-#define zPROGNAME       (tcpreplay_opt_strs+2608)
-#define zUsageTitle     (tcpreplay_opt_strs+2618)
-#define zRcName         (tcpreplay_opt_strs+2763)
+#define zPROGNAME       (tcpreplay_opt_strs+3385)
+#define zUsageTitle     (tcpreplay_opt_strs+3395)
+#define zRcName         (tcpreplay_opt_strs+3540)
 static char const * const apzHomeList[2] = {
-    tcpreplay_opt_strs+2759,
+    tcpreplay_opt_strs+3536,
     NULL };
-#define zBugsAddr       (tcpreplay_opt_strs+2776)
-#define zExplain        (tcpreplay_opt_strs+2814)
-#define zDetail         (tcpreplay_opt_strs+2938)
+#define zBugsAddr       (tcpreplay_opt_strs+3553)
+#define zExplain        (tcpreplay_opt_strs+3591)
+#define zDetail         (tcpreplay_opt_strs+3715)
 #define zFullVersion    (NULL)
 /* extracted from optcode.tlib near line 350 */
 
@@ -1040,6 +1418,41 @@ emit_ranges:
 }
 #endif /* defined DEBUG */
 
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+/**
+ * Code to handle the spin-threshold option.
+ *
+ * @param pOptions the tcpreplay options data structure
+ * @param pOptDesc the option descriptor for this option.
+ */
+static void
+doOptSpin_Threshold(tOptions* pOptions, tOptDesc* pOptDesc)
+{
+    static struct {long rmin, rmax;} const rng[1] = {
+        { 0, 1000000 } };
+    int  ix;
+
+    if (pOptions <= OPTPROC_EMIT_LIMIT)
+        goto emit_ranges;
+    optionNumericVal(pOptions, pOptDesc);
+
+    for (ix = 0; ix < 1; ix++) {
+        if (pOptDesc->optArg.argInt < rng[ix].rmin)
+            continue;  /* ranges need not be ordered. */
+        if (pOptDesc->optArg.argInt == rng[ix].rmin)
+            return;
+        if (rng[ix].rmax == LONG_MIN)
+            continue;
+        if (pOptDesc->optArg.argInt <= rng[ix].rmax)
+            return;
+    }
+
+    option_usage_fp = stderr;
+
+emit_ranges:
+    optionShowRange(pOptions, pOptDesc, (void *)rng, 1);
+}
+
 /* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
 /**
  * Code to handle the listnics option, when ENABLE_PCAP_FINDALLDEVS is #define-d.
@@ -1051,7 +1464,7 @@ emit_ranges:
 static void
 doOptListnics(tOptions* pOptions, tOptDesc* pOptDesc)
 {
-    /* extracted from tcpreplay_opts.def, line 312 */
+    /* extracted from tcpreplay_opts.def, line 345 */
 
     interface_list_t *list = get_interface_list();
     list_interfaces(list);
@@ -1133,6 +1546,41 @@ emit_ranges:
     optionShowRange(pOptions, pOptDesc, (void *)rng, 1);
 }
 
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+/**
+ * Code to handle the start-packet option.
+ *
+ * @param pOptions the tcpreplay options data structure
+ * @param pOptDesc the option descriptor for this option.
+ */
+static void
+doOptStart_Packet(tOptions* pOptions, tOptDesc* pOptDesc)
+{
+    static struct {long rmin, rmax;} const rng[1] = {
+        { 1, LONG_MAX } };
+    int  ix;
+
+    if (pOptions <= OPTPROC_EMIT_LIMIT)
+        goto emit_ranges;
+    optionNumericVal(pOptions, pOptDesc);
+
+    for (ix = 0; ix < 1; ix++) {
+        if (pOptDesc->optArg.argInt < rng[ix].rmin)
+            continue;  /* ranges need not be ordered. */
+        if (pOptDesc->optArg.argInt == rng[ix].rmin)
+            return;
+        if (rng[ix].rmax == LONG_MIN)
+            continue;
+        if (pOptDesc->optArg.argInt <= rng[ix].rmax)
+            return;
+    }
+
+    option_usage_fp = stderr;
+
+emit_ranges:
+    optionShowRange(pOptions, pOptDesc, (void *)rng, 1);
+}
+
 /* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
 /**
  * Code to handle the pps-multi option.
@@ -1168,6 +1616,226 @@ emit_ranges:
     optionShowRange(pOptions, pOptDesc, (void *)rng, 1);
 }
 
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+/**
+ * Code to handle the burst option.
+ *
+ * @param pOptions the tcpreplay options data structure
+ * @param pOptDesc the option descriptor for this option.
+ */
+static void
+doOptBurst(tOptions* pOptions, tOptDesc* pOptDesc)
+{
+    static struct {long rmin, rmax;} const rng[1] = {
+        { 1, 64 } };
+    int  ix;
+
+    if (pOptions <= OPTPROC_EMIT_LIMIT)
+        goto emit_ranges;
+    optionNumericVal(pOptions, pOptDesc);
+
+    for (ix = 0; ix < 1; ix++) {
+        if (pOptDesc->optArg.argInt < rng[ix].rmin)
+            continue;  /* ranges need not be ordered. */
+        if (pOptDesc->optArg.argInt == rng[ix].rmin)
+            return;
+        if (rng[ix].rmax == LONG_MIN)
+            continue;
+        if (pOptDesc->optArg.argInt <= rng[ix].rmax)
+            return;
+    }
+
+    option_usage_fp = stderr;
+
+emit_ranges:
+    optionShowRange(pOptions, pOptDesc, (void *)rng, 1);
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+/**
+ * Code to handle the threads option, when HAVE_PTHREAD is #define-d.
+ *
+ * @param pOptions the tcpreplay options data structure
+ * @param pOptDesc the option descriptor for this option.
+ */
+#ifdef HAVE_PTHREAD
+static void
+doOptThreads(tOptions* pOptions, tOptDesc* pOptDesc)
+{
+    static struct {long rmin, rmax;} const rng[1] = {
+        { 1, 64 } };
+    int  ix;
+
+    if (pOptions <= OPTPROC_EMIT_LIMIT)
+        goto emit_ranges;
+    optionNumericVal(pOptions, pOptDesc);
+
+    for (ix = 0; ix < 1; ix++) {
+        if (pOptDesc->optArg.argInt < rng[ix].rmin)
+            continue;  /* ranges need not be ordered. */
+        if (pOptDesc->optArg.argInt == rng[ix].rmin)
+            return;
+        if (rng[ix].rmax == LONG_MIN)
+            continue;
+        if (pOptDesc->optArg.argInt <= rng[ix].rmax)
+            return;
+    }
+
+    option_usage_fp = stderr;
+
+emit_ranges:
+    optionShowRange(pOptions, pOptDesc, (void *)rng, 1);
+}
+#endif /* defined HAVE_PTHREAD */
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+/**
+ * Code to handle the pipeline-slots option, when HAVE_PTHREAD is #define-d.
+ *
+ * @param pOptions the tcpreplay options data structure
+ * @param pOptDesc the option descriptor for this option.
+ */
+#ifdef HAVE_PTHREAD
+static void
+doOptPipeline_Slots(tOptions* pOptions, tOptDesc* pOptDesc)
+{
+    static struct {long rmin, rmax;} const rng[1] = {
+        { 64, 1048576 } };
+    int  ix;
+
+    if (pOptions <= OPTPROC_EMIT_LIMIT)
+        goto emit_ranges;
+    optionNumericVal(pOptions, pOptDesc);
+
+    for (ix = 0; ix < 1; ix++) {
+        if (pOptDesc->optArg.argInt < rng[ix].rmin)
+            continue;  /* ranges need not be ordered. */
+        if (pOptDesc->optArg.argInt == rng[ix].rmin)
+            return;
+        if (rng[ix].rmax == LONG_MIN)
+            continue;
+        if (pOptDesc->optArg.argInt <= rng[ix].rmax)
+            return;
+    }
+
+    option_usage_fp = stderr;
+
+emit_ranges:
+    optionShowRange(pOptions, pOptDesc, (void *)rng, 1);
+}
+#endif /* defined HAVE_PTHREAD */
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+/**
+ * Code to handle the prefetch option, when HAVE_PTHREAD is #define-d.
+ *
+ * @param pOptions the tcpreplay options data structure
+ * @param pOptDesc the option descriptor for this option.
+ */
+#ifdef HAVE_PTHREAD
+static void
+doOptPrefetch(tOptions* pOptions, tOptDesc* pOptDesc)
+{
+    static struct {long rmin, rmax;} const rng[1] = {
+        { 1, 65536 } };
+    int  ix;
+
+    if (pOptions <= OPTPROC_EMIT_LIMIT)
+        goto emit_ranges;
+    optionNumericVal(pOptions, pOptDesc);
+
+    for (ix = 0; ix < 1; ix++) {
+        if (pOptDesc->optArg.argInt < rng[ix].rmin)
+            continue;  /* ranges need not be ordered. */
+        if (pOptDesc->optArg.argInt == rng[ix].rmin)
+            return;
+        if (rng[ix].rmax == LONG_MIN)
+            continue;
+        if (pOptDesc->optArg.argInt <= rng[ix].rmax)
+            return;
+    }
+
+    option_usage_fp = stderr;
+
+emit_ranges:
+    optionShowRange(pOptions, pOptDesc, (void *)rng, 1);
+}
+#endif /* defined HAVE_PTHREAD */
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+/**
+ * Code to handle the txring-frames option, when HAVE_TX_RING is #define-d.
+ *
+ * @param pOptions the tcpreplay options data structure
+ * @param pOptDesc the option descriptor for this option.
+ */
+#ifdef HAVE_TX_RING
+static void
+doOptTxring_Frames(tOptions* pOptions, tOptDesc* pOptDesc)
+{
+    static struct {long rmin, rmax;} const rng[1] = {
+        { 64, 1048576 } };
+    int  ix;
+
+    if (pOptions <= OPTPROC_EMIT_LIMIT)
+        goto emit_ranges;
+    optionNumericVal(pOptions, pOptDesc);
+
+    for (ix = 0; ix < 1; ix++) {
+        if (pOptDesc->optArg.argInt < rng[ix].rmin)
+            continue;  /* ranges need not be ordered. */
+        if (pOptDesc->optArg.argInt == rng[ix].rmin)
+            return;
+        if (rng[ix].rmax == LONG_MIN)
+            continue;
+        if (pOptDesc->optArg.argInt <= rng[ix].rmax)
+            return;
+    }
+
+    option_usage_fp = stderr;
+
+emit_ranges:
+    optionShowRange(pOptions, pOptDesc, (void *)rng, 1);
+}
+#endif /* defined HAVE_TX_RING */
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+/**
+ * Code to handle the txring-batch option, when HAVE_TX_RING is #define-d.
+ *
+ * @param pOptions the tcpreplay options data structure
+ * @param pOptDesc the option descriptor for this option.
+ */
+#ifdef HAVE_TX_RING
+static void
+doOptTxring_Batch(tOptions* pOptions, tOptDesc* pOptDesc)
+{
+    static struct {long rmin, rmax;} const rng[1] = {
+        { 1, 4096 } };
+    int  ix;
+
+    if (pOptions <= OPTPROC_EMIT_LIMIT)
+        goto emit_ranges;
+    optionNumericVal(pOptions, pOptDesc);
+
+    for (ix = 0; ix < 1; ix++) {
+        if (pOptDesc->optArg.argInt < rng[ix].rmin)
+            continue;  /* ranges need not be ordered. */
+        if (pOptDesc->optArg.argInt == rng[ix].rmin)
+            return;
+        if (rng[ix].rmax == LONG_MIN)
+            continue;
+        if (pOptDesc->optArg.argInt <= rng[ix].rmax)
+            return;
+    }
+
+    option_usage_fp = stderr;
+
+emit_ranges:
+    optionShowRange(pOptions, pOptDesc, (void *)rng, 1);
+}
+#endif /* defined HAVE_TX_RING */
+
 /* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
 /**
  * Code to handle the pid option.
@@ -1178,7 +1846,7 @@ emit_ranges:
 static void
 doOptPid(tOptions* pOptions, tOptDesc* pOptDesc)
 {
-    /* extracted from tcpreplay_opts.def, line 462 */
+    /* extracted from tcpreplay_opts.def, line 655 */
 
     fprintf(stderr, "PID: %d\n", getpid());
 
@@ -1231,7 +1899,7 @@ emit_ranges:
 static void
 doOptVersion(tOptions* pOptions, tOptDesc* pOptDesc)
 {
-    /* extracted from tcpreplay_opts.def, line 485 */
+    /* extracted from tcpreplay_opts.def, line 678 */
 
     fprintf(stderr, "tcpreplay version: %s (build %s)", VERSION, git_version());
 #ifdef DEBUG
@@ -1288,7 +1956,7 @@ doOptVersion(tOptions* pOptions, tOptDesc* pOptDesc)
 static void
 doOptLess_Help(tOptions* pOptions, tOptDesc* pOptDesc)
 {
-    /* extracted from tcpreplay_opts.def, line 537 */
+    /* extracted from tcpreplay_opts.def, line 730 */
 
     USAGE(EXIT_FAILURE);
 
@@ -1357,7 +2025,7 @@ tOptions tcpreplayOptions = {
       NO_EQUIVALENT, /* '-#' option index */
       NO_EQUIVALENT /* index of default opt */
     },
-    31 /* full option count */, 27 /* user option count */,
+    42 /* full option count */, 38 /* user option count */,
     tcpreplay_full_usage, tcpreplay_short_usage,
     NULL, NULL,
     PKGDATADIR, tcpreplay_packager_info
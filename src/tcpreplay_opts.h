@@ -70,37 +70,48 @@ typedef enum {
     INDEX_OPT_DBUG               =  0,
     INDEX_OPT_QUIET              =  1,
     INDEX_OPT_TIMER              =  2,
-    INDEX_OPT_SLEEP_ACCEL        =  3,
-    INDEX_OPT_RDTSC_CLICKS       =  4,
-    INDEX_OPT_VERBOSE            =  5,
-    INDEX_OPT_DECODE             =  6,
-    INDEX_OPT_ENABLE_FILE_CACHE  =  7,
-    INDEX_OPT_PRELOAD_PCAP       =  8,
-    INDEX_OPT_CACHEFILE          =  9,
-    INDEX_OPT_DUALFILE           = 10,
-    INDEX_OPT_INTF1              = 11,
-    INDEX_OPT_INTF2              = 12,
-    INDEX_OPT_LISTNICS           = 13,
-    INDEX_OPT_LOOP               = 14,
-    INDEX_OPT_PKTLEN             = 15,
-    INDEX_OPT_LIMIT              = 16,
-    INDEX_OPT_MULTIPLIER         = 17,
-    INDEX_OPT_PPS                = 18,
-    INDEX_OPT_MBPS               = 19,
-    INDEX_OPT_TOPSPEED           = 20,
-    INDEX_OPT_ONEATATIME         = 21,
-    INDEX_OPT_PPS_MULTI          = 22,
-    INDEX_OPT_PID                = 23,
-    INDEX_OPT_STATS              = 24,
-    INDEX_OPT_VERSION            = 25,
-    INDEX_OPT_LESS_HELP          = 26,
-    INDEX_OPT_HELP               = 27,
-    INDEX_OPT_MORE_HELP          = 28,
-    INDEX_OPT_SAVE_OPTS          = 29,
-    INDEX_OPT_LOAD_OPTS          = 30
+    INDEX_OPT_SPIN_THRESHOLD     =  3,
+    INDEX_OPT_SLEEP_ACCEL        =  4,
+    INDEX_OPT_RDTSC_CLICKS       =  5,
+    INDEX_OPT_VERBOSE            =  6,
+    INDEX_OPT_DECODE             =  7,
+    INDEX_OPT_ENABLE_FILE_CACHE  =  8,
+    INDEX_OPT_PRELOAD_PCAP       =  9,
+    INDEX_OPT_CACHE_HUGEPAGES    = 10,
+    INDEX_OPT_CACHEFILE          = 11,
+    INDEX_OPT_DUALFILE           = 12,
+    INDEX_OPT_INTF1              = 13,
+    INDEX_OPT_INTF2              = 14,
+    INDEX_OPT_LISTNICS           = 15,
+    INDEX_OPT_LOOP               = 16,
+    INDEX_OPT_PKTLEN             = 17,
+    INDEX_OPT_LIMIT              = 18,
+    INDEX_OPT_START_PACKET       = 19,
+    INDEX_OPT_MULTIPLIER         = 20,
+    INDEX_OPT_PPS                = 21,
+    INDEX_OPT_MBPS               = 22,
+    INDEX_OPT_TOPSPEED           = 23,
+    INDEX_OPT_ONEATATIME         = 24,
+    INDEX_OPT_PPS_MULTI          = 25,
+    INDEX_OPT_BURST              = 26,
+    INDEX_OPT_THREADS            = 27,
+    INDEX_OPT_PIPELINE           = 28,
+    INDEX_OPT_PIPELINE_SLOTS     = 29,
+    INDEX_OPT_PIPELINE_CPUS      = 30,
+    INDEX_OPT_PREFETCH           = 31,
+    INDEX_OPT_TXRING_FRAMES      = 32,
+    INDEX_OPT_TXRING_BATCH       = 33,
+    INDEX_OPT_PID                = 34,
+    INDEX_OPT_STATS              = 35,
+    INDEX_OPT_VERSION            = 36,
+    INDEX_OPT_LESS_HELP          = 37,
+    INDEX_OPT_HELP               = 38,
+    INDEX_OPT_MORE_HELP          = 39,
+    INDEX_OPT_SAVE_OPTS          = 40,
+    INDEX_OPT_LOAD_OPTS          = 41
 } teOptIndex;
 
-#define OPTION_CT    31
+#define OPTION_CT    42
 
 /*
  *  Interface defines for all options.  Replace "n" with the UPPER_CASED
@@ -143,35 +154,42 @@ typedef enum {
 #endif /* DEBUG */
 #define VALUE_OPT_QUIET          'q'
 #define VALUE_OPT_TIMER          'T'
-#define VALUE_OPT_SLEEP_ACCEL    3
+#define VALUE_OPT_SPIN_THRESHOLD 3
+
+#define OPT_VALUE_SPIN_THRESHOLD (DESC(SPIN_THRESHOLD).optArg.argInt)
+#define VALUE_OPT_SLEEP_ACCEL    4
 
 #define OPT_VALUE_SLEEP_ACCEL    (DESC(SLEEP_ACCEL).optArg.argInt)
-#define VALUE_OPT_RDTSC_CLICKS   4
+#define VALUE_OPT_RDTSC_CLICKS   5
 
 #define OPT_VALUE_RDTSC_CLICKS   (DESC(RDTSC_CLICKS).optArg.argInt)
 #define VALUE_OPT_VERBOSE        'v'
 #ifdef ENABLE_VERBOSE
 #define SET_OPT_VERBOSE   STMTS( \
-        DESC(VERBOSE).optActualIndex = 5; \
+        DESC(VERBOSE).optActualIndex = 6; \
         DESC(VERBOSE).optActualValue = VALUE_OPT_VERBOSE; \
         DESC(VERBOSE).fOptState &= OPTST_PERSISTENT_MASK; \
         DESC(VERBOSE).fOptState |= OPTST_SET )
 #endif /* ENABLE_VERBOSE */
 #define VALUE_OPT_DECODE         'A'
 #define VALUE_OPT_ENABLE_FILE_CACHE 'K'
-#define VALUE_OPT_PRELOAD_PCAP   8
+#define VALUE_OPT_PRELOAD_PCAP   9
+#define VALUE_OPT_CACHE_HUGEPAGES 10
 #define VALUE_OPT_CACHEFILE      'c'
 #define VALUE_OPT_DUALFILE       '2'
 #define VALUE_OPT_INTF1          'i'
 #define VALUE_OPT_INTF2          'I'
-#define VALUE_OPT_LISTNICS       13
+#define VALUE_OPT_LISTNICS       15
 #define VALUE_OPT_LOOP           'l'
 
 #define OPT_VALUE_LOOP           (DESC(LOOP).optArg.argInt)
-#define VALUE_OPT_PKTLEN         15
+#define VALUE_OPT_PKTLEN         17
 #define VALUE_OPT_LIMIT          'L'
 
 #define OPT_VALUE_LIMIT          (DESC(LIMIT).optArg.argInt)
+#define VALUE_OPT_START_PACKET   19
+
+#define OPT_VALUE_START_PACKET   (DESC(START_PACKET).optArg.argInt)
 #define VALUE_OPT_MULTIPLIER     'x'
 #define VALUE_OPT_PPS            'p'
 
@@ -179,11 +197,36 @@ typedef enum {
 #define VALUE_OPT_MBPS           'M'
 #define VALUE_OPT_TOPSPEED       't'
 #define VALUE_OPT_ONEATATIME     'o'
-#define VALUE_OPT_PPS_MULTI      22
+#define VALUE_OPT_PPS_MULTI      25
 
 #define OPT_VALUE_PPS_MULTI      (DESC(PPS_MULTI).optArg.argInt)
+#define VALUE_OPT_BURST          26
+
+#define OPT_VALUE_BURST          (DESC(BURST).optArg.argInt)
+#define VALUE_OPT_THREADS        27
+#ifdef HAVE_PTHREAD
+#define OPT_VALUE_THREADS        (DESC(THREADS).optArg.argInt)
+#endif /* HAVE_PTHREAD */
+#define VALUE_OPT_PIPELINE       28
+#define VALUE_OPT_PIPELINE_SLOTS 29
+#ifdef HAVE_PTHREAD
+#define OPT_VALUE_PIPELINE_SLOTS (DESC(PIPELINE_SLOTS).optArg.argInt)
+#endif /* HAVE_PTHREAD */
+#define VALUE_OPT_PIPELINE_CPUS  30
+#define VALUE_OPT_PREFETCH       31
+#ifdef HAVE_PTHREAD
+#define OPT_VALUE_PREFETCH       (DESC(PREFETCH).optArg.argInt)
+#endif /* HAVE_PTHREAD */
+#define VALUE_OPT_TXRING_FRAMES  32
+#ifdef HAVE_TX_RING
+#define OPT_VALUE_TXRING_FRAMES  (DESC(TXRING_FRAMES).optArg.argInt)
+#endif /* HAVE_TX_RING */
+#define VALUE_OPT_TXRING_BATCH   129
+#ifdef HAVE_TX_RING
+#define OPT_VALUE_TXRING_BATCH   (DESC(TXRING_BATCH).optArg.argInt)
+#endif /* HAVE_TX_RING */
 #define VALUE_OPT_PID            'P'
-#define VALUE_OPT_STATS          24
+#define VALUE_OPT_STATS          131
 
 #define OPT_VALUE_STATS          (DESC(STATS).optArg.argInt)
 #define VALUE_OPT_VERSION        'V'
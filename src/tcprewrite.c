@@ -36,6 +36,9 @@
 #include <sys/types.h>
 #include <unistd.h>
 #include <errno.h>
+#ifdef HAVE_PTHREAD
+#include <pthread.h>
+#endif
 
 #include "tcprewrite.h"
 #include "tcprewrite_opts.h"
@@ -57,13 +60,18 @@ tcpedit_t *tcpedit;
 void tcprewrite_init(void);
 void post_args(int argc, char *argv[]);
 void verify_input_pcap(pcap_t *pcap);
-int rewrite_packets(tcpedit_t *tcpedit, pcap_t *pin, pcap_dumper_t *pout);
+tcpedit_t *open_tcpedit(bool warn);
+int rewrite_packets(tcpedit_t *tcpedit, mmpcap_t *mm, pcapwrite_t *pout);
+#ifdef HAVE_PTHREAD
+int rewrite_packets_threaded(tcpedit_t *tcpedit, mmpcap_t *mm, pcapwrite_t *pout);
+#endif
 
 int 
 main(int argc, char *argv[])
 {
-    int optct, rcode;
+    int optct;
     pcap_t *dlt_pcap;
+    mmpcap_t *mm;
 #ifdef ENABLE_FRAGROUTE
     char ebuf[FRAGROUTE_ERRBUF_LEN];
 #endif
@@ -77,29 +85,25 @@ main(int argc, char *argv[])
     /* parse the tcprewrite args */
     post_args(argc, argv);
 
+    /* pick the checksum kernel before any worker threads start */
+    csum_init();
+
     /* init tcpedit context */
-    if (tcpedit_init(&tcpedit, pcap_datalink(options.pin)) < 0) {
-        errx(-1, "Error initializing tcpedit: %s", tcpedit_geterr(tcpedit));
-    }
+    tcpedit = open_tcpedit(true);
 
-    /* parse the tcpedit args */
-    rcode = tcpedit_post_args(tcpedit);
-    if (rcode < 0) {
-        errx(-1, "Unable to parse args: %s", tcpedit_geterr(tcpedit));
-    } else if (rcode == 1) {
-        warnx("%s", tcpedit_geterr(tcpedit));
-    }
+    /* read packets straight out of a mapping of the file when we can */
+    mm = mmpcap_open(options.infile, options.pin);
 
-    if (tcpedit_validate(tcpedit) < 0) {
-        errx(-1, "Unable to edit packets given options:\n%s",
-                tcpedit_geterr(tcpedit));
-    }
+    /* keep the timestamp precision of the input file */
+#ifdef HAVE_PCAP_OPEN_DEAD_WITH_TSTAMP_PRECISION
+    options.nsec = mmpcap_nsec(mm);
+#endif
 
    /* open up the output file */
     options.outfile = safe_strdup(OPT_ARG(OUTFILE));
     dbgx(1, "Rewriting DLT to %s",
             pcap_datalink_val_to_name(tcpedit_get_output_dlt(tcpedit)));
-    if ((dlt_pcap = pcap_open_dead(tcpedit_get_output_dlt(tcpedit), 65535)) == NULL)
+    if ((dlt_pcap = tcpr_pcap_open_dead(tcpedit_get_output_dlt(tcpedit), 65535, options.nsec)) == NULL)
         err(-1, "Unable to open dead pcap handle.");
 
     dbgx(1, "DLT of dlt_pcap is %s",
@@ -118,17 +122,26 @@ main(int argc, char *argv[])
     }
 #endif
 
-    if ((options.pout = pcap_dump_open(dlt_pcap, options.outfile)) == NULL)
+    if ((options.pout = pcapwrite_open(dlt_pcap, options.outfile, options.write_buffer,
+                    options.write_flags, options.fsync)) == NULL)
         errx(-1, "Unable to open output pcap file: %s", pcap_geterr(dlt_pcap));
     pcap_close(dlt_pcap);
 
     /* rewrite packets */
-    if (rewrite_packets(tcpedit, options.pin, options.pout) != 0)
+#ifdef HAVE_PTHREAD
+    if (options.threads > 1) {
+        if (rewrite_packets_threaded(tcpedit, mm, options.pout) != 0)
+            errx(-1, "%s", "Error rewriting packets");
+    } else
+#endif
+    if (rewrite_packets(tcpedit, mm, options.pout) != 0)
         errx(-1, "Error rewriting packets: %s", tcpedit_geterr(tcpedit));
 
+    mmpcap_close(mm);
+
 
     /* clean up after ourselves */
-    pcap_dump_close(options.pout);
+    pcapwrite_close(options.pout);
     pcap_close(options.pin);
 
 #ifdef ENABLE_VERBOSE
@@ -200,9 +213,36 @@ post_args(_U_ int argc, _U_ char *argv[])
     }
 #endif
 
+    /* output buffering */
+    options.write_buffer = PCAPWRITE_DEFAULT_BUFSIZE;
+    if (HAVE_OPT(WRITE_BUFFER))
+        options.write_buffer = (size_t)OPT_VALUE_WRITE_BUFFER * 1024 * 1024;
+
+    if (HAVE_OPT(DIRECT_IO))
+        options.write_flags |= PCAPWRITE_DIRECT;
+
+    options.fsync = PCAPWRITE_FSYNC_NONE;
+    if (HAVE_OPT(FSYNC)) {
+        if (strcmp(OPT_ARG(FSYNC), "none") == 0) {
+            options.fsync = PCAPWRITE_FSYNC_NONE;
+        } else if (strcmp(OPT_ARG(FSYNC), "close") == 0) {
+            options.fsync = PCAPWRITE_FSYNC_CLOSE;
+        } else if (strcmp(OPT_ARG(FSYNC), "buffer") == 0) {
+            options.fsync = PCAPWRITE_FSYNC_BUFFER;
+        } else {
+            errx(-1, "Unknown --fsync value: %s", OPT_ARG(FSYNC));
+        }
+    }
+
+#ifdef HAVE_PTHREAD
+    options.threads = 1;
+    if (HAVE_OPT(THREADS))
+        options.threads = OPT_VALUE_THREADS;
+#endif
+
     /* open up the input file */
     options.infile = safe_strdup(OPT_ARG(INFILE));
-    if ((options.pin = pcap_open_offline(options.infile, ebuf)) == NULL)
+    if ((options.pin = tcpr_pcap_open_offline(options.infile, ebuf)) == NULL)
         errx(-1, "Unable to open input pcap file: %s", ebuf);
 
 #ifdef HAVE_PCAP_SNAPSHOT
@@ -213,108 +253,455 @@ post_args(_U_ int argc, _U_ char *argv[])
 
 }
 
-/** 
- * Main loop to rewrite packets
+/**
+ * init a tcpedit context from the command line args
  */
-int
-rewrite_packets(tcpedit_t *tcpedit, pcap_t *pin, pcap_dumper_t *pout)
+tcpedit_t *
+open_tcpedit(bool warn)
 {
-    tcpr_dir_t cache_result = TCPR_DIR_C2S;     /* default to primary */
-    struct pcap_pkthdr pkthdr, *pkthdr_ptr;     /* packet header */
-    const u_char *pktconst = NULL;              /* packet from libpcap */
-    u_char **pktdata = NULL;
-    static u_char *pktdata_buff;
-    static char *frag = NULL;
-    COUNTER packetnum = 0;
-    int rcode, frag_len, i;
-    
-    pkthdr_ptr = &pkthdr;
+    tcpedit_t *ctx;
+    int rcode;
 
-    if (pktdata_buff == NULL)
-        pktdata_buff = (u_char *)safe_malloc(MAXPACKET);
-        
-    pktdata = &pktdata_buff;
-    
-    if (frag == NULL)
-        frag = (char *)safe_malloc(MAXPACKET);
+    if (tcpedit_init(&ctx, pcap_datalink(options.pin)) < 0) {
+        errx(-1, "Error initializing tcpedit: %s", tcpedit_geterr(ctx));
+    }
+
+    /* parse the tcpedit args */
+    rcode = tcpedit_post_args(ctx);
+    if (rcode < 0) {
+        errx(-1, "Unable to parse args: %s", tcpedit_geterr(ctx));
+    } else if (rcode == 1 && warn) {
+        warnx("%s", tcpedit_geterr(ctx));
+    }
+
+    if (tcpedit_validate(ctx) < 0) {
+        errx(-1, "Unable to edit packets given options:\n%s",
+                tcpedit_geterr(ctx));
+    }
+
+    return ctx;
+}
+
+/**
+ * gets the next packet from the input file and figures out which
+ * direction it goes.  The packet still has to be copied out.
+ * Returns NULL at EOF
+ */
+static const u_char *
+read_packet(mmpcap_t *mm, struct pcap_pkthdr *pkthdr, COUNTER packetnum, 
+        tcpr_dir_t *cache_result)
+{
+    const u_char *pktconst;
+
+    if ((pktconst = mmpcap_next(mm, pkthdr)) == NULL)
+        return NULL;
+
+    dbgx(2, "packet " COUNTER_SPEC " caplen %d", packetnum, pkthdr->caplen);
+
+#ifdef PKTHDR_TS_NSEC
+    /* pcap_dump() writes the ts as is, so match the output file */
+    if (!options.nsec)
+        pkthdr->ts.tv_usec /= 1000;
+#endif
 
-    /* MAIN LOOP 
-     * Keep sending while we have packets or until
-     * we've sent enough packets
-     */
-    while ((pktconst = pcap_next(pin, pkthdr_ptr)) != NULL) {
-        packetnum++;
-        dbgx(2, "packet " COUNTER_SPEC " caplen %d", packetnum, pkthdr.caplen);
-
-        /* 
-         * copy over the packet so we can pad it out if necessary and
-         * because pcap_next() returns a const ptr
-         */
-        memcpy(*pktdata, pktconst, pkthdr.caplen);
-        
 #ifdef ENABLE_VERBOSE
-        if (options.verbose)
-            tcpdump_print(&tcpdump, pkthdr_ptr, *pktdata);
+    if (options.verbose)
+        tcpdump_print(&tcpdump, pkthdr, pktconst);
 #endif
 
-        /* Dual nic processing? */
-        if (options.cachedata != NULL) {
-            cache_result = check_cache(options.cachedata, packetnum);
-        }
+    /* Dual nic processing? */
+    *cache_result = TCPR_DIR_C2S;     /* default to primary */
+    if (options.cachedata != NULL) {
+        *cache_result = check_cache(options.cachedata, packetnum);
+    }
 
-        /* sometimes we should not send the packet, in such cases
-         * no point in editing this packet at all, just write it to the
-         * output file (note, we can't just remove it, or the tcpprep cache
-         * file will loose it's indexing
-         */
+    return pktconst;
+}
 
-        if (cache_result == TCPR_DIR_NOSEND)
-            goto WRITE_PACKET; /* still need to write it so cache stays in sync */
+/**
+ * edits count packets via tcpedit_packet_batch(), skipping the ones we're
+ * not going to send.  Stores the result of each in rcode.
+ * Returns -1 on error
+ */
+static int
+edit_packets(tcpedit_t *tcpedit, struct pcap_pkthdr *pkthdr, u_char **pktdata,
+        const tcpr_dir_t *cache_result, int *rcode, int count)
+{
+    struct pcap_pkthdr *edit_hdr[TCPEDIT_BATCH_MAX];
+    u_char *edit_data[TCPEDIT_BATCH_MAX];
+    tcpr_dir_t edit_dir[TCPEDIT_BATCH_MAX];
+    int edit_idx[TCPEDIT_BATCH_MAX], edit_rcode[TCPEDIT_BATCH_MAX];
+    int i = 0, j, edits;
+
+    while (i < count) {
+        for (edits = 0; i < count && edits < TCPEDIT_BATCH_MAX; i++) {
+            rcode[i] = TCPEDIT_OK;
+
+            /* sometimes we should not send the packet, in such cases
+             * no point in editing this packet at all, just write it to the
+             * output file (note, we can't just remove it, or the tcpprep cache
+             * file will loose it's indexing
+             */
+            if (cache_result[i] == TCPR_DIR_NOSEND)
+                continue;
+
+            edit_hdr[edits] = &pkthdr[i];
+            edit_data[edits] = pktdata[i];
+            edit_dir[edits] = cache_result[i];
+            edit_idx[edits] = i;
+            edits++;
+        }
 
-        if ((rcode = tcpedit_packet(tcpedit, &pkthdr_ptr, pktdata, cache_result)) == TCPEDIT_ERROR) {
+        if (tcpedit_packet_batch(tcpedit, edit_hdr, edit_data, edit_dir, edit_rcode, edits) == TCPEDIT_ERROR)
             return -1;
-        } else if ((rcode == TCPEDIT_SOFT_ERROR) && HAVE_OPT(SKIP_SOFT_ERRORS)) {
-            /* don't write packet */
-            dbgx(1, "Packet " COUNTER_SPEC " is suppressed from being written due to soft errors", packetnum);
-            continue;
+
+        for (j = 0; j < edits; j++) {
+            pktdata[edit_idx[j]] = edit_data[j];
+            rcode[edit_idx[j]] = edit_rcode[j];
         }
+    }
 
+    return 0;
+}
 
-WRITE_PACKET:
+/**
+ * writes an edited packet to the output file, via fragroute if need be
+ */
+static void
+write_packet(pcapwrite_t *pout, struct pcap_pkthdr *pkthdr, u_char *pktdata,
+        tcpr_dir_t cache_result, int rcode, COUNTER packetnum)
+{
 #ifdef ENABLE_FRAGROUTE
-        if (options.frag_ctx == NULL) {
-            /* write the packet when there's no fragrouting to be done */
-            pcap_dump((u_char *)pout, pkthdr_ptr, *pktdata);
-        } else {
-            /* packet needs to be fragmented */
-            if ((options.fragroute_dir == FRAGROUTE_DIR_BOTH) ||
-                    (cache_result == TCPR_DIR_C2S && options.fragroute_dir == FRAGROUTE_DIR_C2S) ||
-                    (cache_result == TCPR_DIR_S2C && options.fragroute_dir == FRAGROUTE_DIR_S2C)) {
-
-                if (fragroute_process(options.frag_ctx, *pktdata, pkthdr_ptr->caplen) < 0)
-                    errx(-1, "Error processing packet via fragroute: %s", options.frag_ctx->errbuf);
-
-                i = 0;
-                while ((frag_len = fragroute_getfragment(options.frag_ctx, &frag)) > 0) {
-                    /* frags get the same timestamp as the original packet */
-                    dbgx(1, "processing packet " COUNTER_SPEC " frag: %u (%d)", packetnum, i++, frag_len);
-                    pkthdr_ptr->caplen = frag_len;
-                    pkthdr_ptr->len = frag_len;
-                    pcap_dump((u_char *)pout, pkthdr_ptr, (u_char *)frag);
-                }
-            } else {
-                /* write the packet without fragroute */
-                pcap_dump((u_char *)pout, pkthdr_ptr, *pktdata);
+    static char *frag = NULL;
+    int frag_len, i;
+
+    if (frag == NULL)
+        frag = (char *)safe_malloc(MAXPACKET);
+#endif
+
+    if ((rcode == TCPEDIT_SOFT_ERROR) && HAVE_OPT(SKIP_SOFT_ERRORS)) {
+        /* don't write packet */
+        dbgx(1, "Packet " COUNTER_SPEC " is suppressed from being written due to soft errors", 
+                packetnum);
+        return;
+    }
+
+#ifdef ENABLE_FRAGROUTE
+    if (options.frag_ctx == NULL) {
+        /* write the packet when there's no fragrouting to be done */
+        pcapwrite_dump(pout, pkthdr, pktdata);
+    } else {
+        /* packet needs to be fragmented */
+        if ((options.fragroute_dir == FRAGROUTE_DIR_BOTH) ||
+                (cache_result == TCPR_DIR_C2S && options.fragroute_dir == FRAGROUTE_DIR_C2S) ||
+                (cache_result == TCPR_DIR_S2C && options.fragroute_dir == FRAGROUTE_DIR_S2C)) {
+
+            if (fragroute_process(options.frag_ctx, pktdata, pkthdr->caplen) < 0)
+                errx(-1, "Error processing packet via fragroute: %s", options.frag_ctx->errbuf);
+
+            i = 0;
+            while ((frag_len = fragroute_getfragment(options.frag_ctx, &frag)) > 0) {
+                /* frags get the same timestamp as the original packet */
+                dbgx(1, "processing packet " COUNTER_SPEC " frag: %u (%d)", packetnum, i++, frag_len);
+                pkthdr->caplen = frag_len;
+                pkthdr->len = frag_len;
+                pcapwrite_dump(pout, pkthdr, (u_char *)frag);
             }
+        } else {
+            /* write the packet without fragroute */
+            pcapwrite_dump(pout, pkthdr, pktdata);
         }
+    }
 #else
     /* write the packet when there's no fragrouting to be done */
-    pcap_dump((u_char *)pout, pkthdr_ptr, *pktdata);
-
+    pcapwrite_dump(pout, pkthdr, pktdata);
 #endif
+}
+
+/**
+ * Main loop to rewrite the pcap file.  Packets are read & edited in
+ * batches of TCPEDIT_BATCH_MAX via tcpedit_packet_batch()
+ */
+int
+rewrite_packets(tcpedit_t *tcpedit, mmpcap_t *mm, pcapwrite_t *pout)
+{
+    tcpr_dir_t cache_result[TCPEDIT_BATCH_MAX];
+    struct pcap_pkthdr pkthdr[TCPEDIT_BATCH_MAX];  /* packet header */
+    const u_char *pktconst = NULL;                  /* packet from libpcap */
+    u_char *pktdata[TCPEDIT_BATCH_MAX];
+    int rcode[TCPEDIT_BATCH_MAX];
+    static u_char *pktdata_buff;
+    COUNTER packetnum = 0, firstnum;
+    int i, n, done = 0;
+    
+    if (pktdata_buff == NULL)
+        pktdata_buff = (u_char *)safe_malloc(MAXPACKET * TCPEDIT_BATCH_MAX);
+
+    /* MAIN LOOP 
+     * Keep sending while we have packets or until
+     * we've sent enough packets
+     */
+    while (! done) {
+        firstnum = packetnum + 1;
+
+        for (n = 0; n < TCPEDIT_BATCH_MAX; n++) {
+            if ((pktconst = read_packet(mm, &pkthdr[n], packetnum + 1, &cache_result[n])) == NULL) {
+                done = 1;
+                break;
+            }
+            packetnum++;
+
+            /* 
+             * copy over the packet so we can pad it out if necessary and
+             * because mmpcap_next() returns a const ptr
+             */
+            pktdata[n] = &pktdata_buff[n * MAXPACKET];
+            memcpy(pktdata[n], pktconst, pkthdr[n].caplen);
+        }
+
+        if (edit_packets(tcpedit, pkthdr, pktdata, cache_result, rcode, n) < 0)
+            return -1;
+
+        for (i = 0; i < n; i++)
+            write_packet(pout, &pkthdr[i], pktdata[i], cache_result[i], rcode[i], firstnum + i);
     } /* while() */
     return 0;
-}   
+}
+
+#ifdef HAVE_PTHREAD
+/*
+ * --threads: the main thread reads the input into chunks of packets, the
+ * edit threads each edit a chunk at a time with their own tcpedit_t and
+ * the writer thread writes the chunks out in the order they were read.
+ */
+
+/* # of packets in a chunk */
+#define CHUNK_PKTS 1024
+
+/* room after each packet for tcpedit to grow the L2 header (USER_L2MAXLEN) */
+#define CHUNK_L2_SLACK 256
+
+#define CHUNK_FREE    0
+#define CHUNK_READY   1     /* read, waiting to be edited */
+#define CHUNK_EDITING 2
+#define CHUNK_DONE    3     /* edited, waiting to be written */
+
+typedef struct {
+    int state;
+    COUNTER firstnum;       /* packet # of the first packet */
+    int count;
+    struct pcap_pkthdr pkthdr[CHUNK_PKTS];
+    u_char *pktdata[CHUNK_PKTS];
+    size_t offset[CHUNK_PKTS];
+    tcpr_dir_t cache_result[CHUNK_PKTS];
+    int rcode[CHUNK_PKTS];
+    u_char *data;
+    size_t data_size;
+} rewrite_chunk_t;
+
+typedef struct {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    rewrite_chunk_t *chunks;
+    int nchunks;
+    COUNTER read;           /* # of chunks read */
+    COUNTER edited;         /* # of chunks handed to an edit thread */
+    COUNTER written;        /* # of chunks written */
+    bool eof;
+    tcpedit_t *failed;      /* tcpedit_t of the first edit thread to fail */
+    pcapwrite_t *pout;
+} rewrite_pool_t;
+
+typedef struct {
+    rewrite_pool_t *pool;
+    tcpedit_t *tcpedit;
+    pthread_t thread;
+} rewrite_worker_t;
+
+/**
+ * edit thread: edits chunks in whatever order they come
+ */
+static void *
+rewrite_worker(void *arg)
+{
+    rewrite_worker_t *worker = (rewrite_worker_t *)arg;
+    rewrite_pool_t *pool = worker->pool;
+    rewrite_chunk_t *chunk;
+    int ret;
+
+    pthread_mutex_lock(&pool->lock);
+    while (1) {
+        while (pool->edited == pool->read && !pool->eof && pool->failed == NULL)
+            pthread_cond_wait(&pool->cond, &pool->lock);
+
+        if (pool->failed != NULL || pool->edited == pool->read)
+            break;
+
+        chunk = &pool->chunks[pool->edited++ % pool->nchunks];
+        chunk->state = CHUNK_EDITING;
+        pthread_mutex_unlock(&pool->lock);
+
+        ret = edit_packets(worker->tcpedit, chunk->pkthdr, chunk->pktdata,
+                chunk->cache_result, chunk->rcode, chunk->count);
+
+        pthread_mutex_lock(&pool->lock);
+        if (ret < 0 && pool->failed == NULL)
+            pool->failed = worker->tcpedit;
+        chunk->state = CHUNK_DONE;
+        pthread_cond_broadcast(&pool->cond);
+    }
+    pthread_mutex_unlock(&pool->lock);
+
+    return NULL;
+}
+
+/**
+ * writer thread: writes the edited chunks in input order
+ */
+static void *
+rewrite_writer(void *arg)
+{
+    rewrite_pool_t *pool = (rewrite_pool_t *)arg;
+    rewrite_chunk_t *chunk;
+    int i;
+
+    pthread_mutex_lock(&pool->lock);
+    while (1) {
+        chunk = &pool->chunks[pool->written % pool->nchunks];
+        while (chunk->state != CHUNK_DONE && pool->failed == NULL &&
+                !(pool->eof && pool->written == pool->read))
+            pthread_cond_wait(&pool->cond, &pool->lock);
+
+        if (pool->failed != NULL || chunk->state != CHUNK_DONE)
+            break;
+        pthread_mutex_unlock(&pool->lock);
+
+        for (i = 0; i < chunk->count; i++)
+            write_packet(pool->pout, &chunk->pkthdr[i], chunk->pktdata[i],
+                    chunk->cache_result[i], chunk->rcode[i], chunk->firstnum + i);
+
+        pthread_mutex_lock(&pool->lock);
+        chunk->state = CHUNK_FREE;
+        pool->written++;
+        pthread_cond_broadcast(&pool->cond);
+    }
+    pthread_mutex_unlock(&pool->lock);
+
+    return NULL;
+}
+
+/**
+ * --threads version of rewrite_packets().  tcpedit is used by the first
+ * edit thread, the others get their own copy built from the same args
+ */
+int
+rewrite_packets_threaded(tcpedit_t *tcpedit, mmpcap_t *mm, pcapwrite_t *pout)
+{
+    rewrite_pool_t pool;
+    rewrite_worker_t *workers;
+    rewrite_chunk_t *chunk;
+    pthread_t writer;
+    const u_char *pktconst;
+    COUNTER packetnum = 0;
+    size_t offset, need;
+    bool eof = false;
+    int i;
+
+    memset(&pool, 0, sizeof(pool));
+    pthread_mutex_init(&pool.lock, NULL);
+    pthread_cond_init(&pool.cond, NULL);
+    pool.pout = pout;
+    pool.nchunks = options.threads * 2 + 2;
+    pool.chunks = (rewrite_chunk_t *)safe_malloc(sizeof(rewrite_chunk_t) * pool.nchunks);
+
+    workers = (rewrite_worker_t *)safe_malloc(sizeof(rewrite_worker_t) * options.threads);
+    for (i = 0; i < options.threads; i++) {
+        workers[i].pool = &pool;
+        workers[i].tcpedit = i == 0 ? tcpedit : open_tcpedit(false);
+        if ((errno = pthread_create(&workers[i].thread, NULL, rewrite_worker, &workers[i])) != 0)
+            errx(-1, "Unable to start edit thread: %s", strerror(errno));
+    }
+
+    if ((errno = pthread_create(&writer, NULL, rewrite_writer, &pool)) != 0)
+        errx(-1, "Unable to start writer thread: %s", strerror(errno));
+
+    while (! eof) {
+        chunk = &pool.chunks[pool.read % pool.nchunks];
+
+        pthread_mutex_lock(&pool.lock);
+        while (chunk->state != CHUNK_FREE && pool.failed == NULL)
+            pthread_cond_wait(&pool.cond, &pool.lock);
+        pthread_mutex_unlock(&pool.lock);
+
+        if (pool.failed != NULL)
+            break;
+
+        /* the chunk is ours until we mark it ready */
+        chunk->firstnum = packetnum + 1;
+        offset = 0;
+        for (chunk->count = 0; chunk->count < CHUNK_PKTS; chunk->count++) {
+            i = chunk->count;
+            if ((pktconst = read_packet(mm, &chunk->pkthdr[i], packetnum + 1, &chunk->cache_result[i])) == NULL) {
+                eof = true;
+                break;
+            }
+            packetnum++;
+
+            /* leave room to pad the packet out and grow the L2 header */
+            need = chunk->pkthdr[i].len > chunk->pkthdr[i].caplen ? 
+                chunk->pkthdr[i].len : chunk->pkthdr[i].caplen;
+            if (need > MAXPACKET)
+                need = MAXPACKET;
+            need = (need + CHUNK_L2_SLACK + 7) & ~(size_t)7;
+
+            if (offset + need > chunk->data_size) {
+                chunk->data_size = (offset + need) * 2;
+                chunk->data = (u_char *)safe_realloc(chunk->data, chunk->data_size);
+            }
+
+            memcpy(&chunk->data[offset], pktconst, chunk->pkthdr[i].caplen);
+            chunk->offset[i] = offset;
+            offset += need;
+        }
+
+        /* data may have moved while growing it */
+        for (i = 0; i < chunk->count; i++)
+            chunk->pktdata[i] = &chunk->data[chunk->offset[i]];
+
+        pthread_mutex_lock(&pool.lock);
+        if (chunk->count > 0) {
+            chunk->state = CHUNK_READY;
+            pool.read++;
+        }
+        pool.eof = eof;
+        pthread_cond_broadcast(&pool.cond);
+        pthread_mutex_unlock(&pool.lock);
+    }
+
+    for (i = 0; i < options.threads; i++)
+        pthread_join(workers[i].thread, NULL);
+    pthread_join(writer, NULL);
+
+    if (pool.failed != NULL)
+        errx(-1, "Error rewriting packets: %s", tcpedit_geterr(pool.failed));
+
+    dbgx(1, "Rewrote " COUNTER_SPEC " packets in " COUNTER_SPEC " chunks with %d threads",
+            packetnum, pool.written, options.threads);
+
+    for (i = 1; i < options.threads; i++)
+        tcpedit_close(workers[i].tcpedit);
+    safe_free(workers);
+
+    for (i = 0; i < pool.nchunks; i++)
+        safe_free(pool.chunks[i].data);
+    safe_free(pool.chunks);
+
+    pthread_cond_destroy(&pool.cond);
+    pthread_mutex_destroy(&pool.lock);
+
+    return 0;
+}
+#endif
 
 
 /*
@@ -38,7 +38,13 @@ struct tcprewrite_opt_s {
     char *infile;
     char *outfile;
     pcap_t *pin;
-    pcap_dumper_t *pout;
+    pcapwrite_t *pout;
+    bool nsec;              /* write nanosecond timestamps */
+
+    /* output buffering */
+    size_t write_buffer;    /* bytes per output buffer */
+    int write_flags;        /* PCAPWRITE_* */
+    pcapwrite_fsync_t fsync;
 
     /* tcpprep cache data */
     COUNTER cache_packets;
@@ -62,6 +68,8 @@ struct tcprewrite_opt_s {
     int fragroute_dir;
 #endif
     tcpedit_t *tcpedit;
+
+    int threads;            /* # of threads to edit packets with */
 };
 
 typedef struct tcprewrite_opt_s tcprewrite_opt_t;
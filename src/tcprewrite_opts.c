@@ -78,7 +78,7 @@ extern tcprewrite_opt_t options;
 /*
  *  tcprewrite option static const strings
  */
-static char const tcprewrite_opt_strs[4563] =
+static char const tcprewrite_opt_strs[4793] =
 /*     0 */ "tcprewrite (tcprewrite)\n"
             "Copyright (C) 2000-2010 Aaron Turner, all rights reserved.\n"
             "This is free software. It is licensed for use, modification and\n"
@@ -207,29 +207,41 @@ static char const tcprewrite_opt_strs[4563] =
 /*  2945 */ "Skip writing packets with soft errors\0"
 /*  2983 */ "SKIP_SOFT_ERRORS\0"
 /*  3000 */ "skip-soft-errors\0"
-/*  3017 */ "Print version information\0"
-/*  3043 */ "VERSION\0"
-/*  3051 */ "version\0"
-/*  3059 */ "Display less usage information and exit\0"
-/*  3099 */ "LESS_HELP\0"
-/*  3109 */ "less-help\0"
-/*  3119 */ "Display extended usage information and exit\0"
-/*  3163 */ "help\0"
-/*  3168 */ "Extended usage information passed thru pager\0"
-/*  3213 */ "more-help\0"
-/*  3223 */ "Save the option state to a config file\0"
-/*  3262 */ "save-opts\0"
-/*  3272 */ "Load options from a config file\0"
-/*  3304 */ "LOAD_OPTS\0"
-/*  3314 */ "no-load-opts\0"
-/*  3327 */ "no\0"
-/*  3330 */ "TCPREWRITE\0"
-/*  3341 */ "tcprewrite (tcprewrite) - Rewrite the packets in a pcap file.\n"
+/*  3017 */ "Size of the output buffers in MB\0"
+/*  3050 */ "WRITE_BUFFER\0"
+/*  3063 */ "write-buffer\0"
+/*  3076 */ "Write the output file with O_DIRECT\0"
+/*  3112 */ "DIRECT_IO\0"
+/*  3122 */ "direct-io\0"
+/*  3132 */ "When to fsync() the output: none, close, buffer\0"
+/*  3180 */ "FSYNC\0"
+/*  3186 */ "fsync\0"
+/*  3192 */ "Number of threads to edit packets with\0"
+/*  3231 */ "THREADS\0"
+/*  3239 */ "threads\0"
+/*  3247 */ "Print version information\0"
+/*  3273 */ "VERSION\0"
+/*  3281 */ "version\0"
+/*  3289 */ "Display less usage information and exit\0"
+/*  3329 */ "LESS_HELP\0"
+/*  3339 */ "less-help\0"
+/*  3349 */ "Display extended usage information and exit\0"
+/*  3393 */ "help\0"
+/*  3398 */ "Extended usage information passed thru pager\0"
+/*  3443 */ "more-help\0"
+/*  3453 */ "Save the option state to a config file\0"
+/*  3492 */ "save-opts\0"
+/*  3502 */ "Load options from a config file\0"
+/*  3534 */ "LOAD_OPTS\0"
+/*  3544 */ "no-load-opts\0"
+/*  3557 */ "no\0"
+/*  3560 */ "TCPREWRITE\0"
+/*  3571 */ "tcprewrite (tcprewrite) - Rewrite the packets in a pcap file.\n"
             "USAGE:  %s [ -<flag> [<val>] | --<name>[{=| }<val>] ]...\n\0"
-/*  3461 */ "$$/\0"
-/*  3465 */ ".tcprewriterc\0"
-/*  3479 */ "tcpreplay-users@lists.sourceforge.net\0"
-/*  3517 */ "\n"
+/*  3691 */ "$$/\0"
+/*  3695 */ ".tcprewriterc\0"
+/*  3709 */ "tcpreplay-users@lists.sourceforge.net\0"
+/*  3747 */ "\n"
             "Tcprewrite is a tool to rewrite packets stored in ``pcap(3)'' file format,\n"
             "such as crated by tools such as ``tcpdump(1)'' and ``ethereal(1)''.  Once a\n"
             "pcap file has had it's packets rewritten, they can be replayed back out on\n"
@@ -663,42 +675,88 @@ static int const aFragdirMustList[] = {
 #define SKIP_SOFT_ERRORS_name      (tcprewrite_opt_strs+3000)
 #define SKIP_SOFT_ERRORS_FLAGS     (OPTST_DISABLED)
 
+/*
+ *  write-buffer option description:
+ */
+#define WRITE_BUFFER_DESC      (tcprewrite_opt_strs+3017)
+#define WRITE_BUFFER_NAME      (tcprewrite_opt_strs+3050)
+#define WRITE_BUFFER_name      (tcprewrite_opt_strs+3063)
+#define WRITE_BUFFER_DFT_ARG   ((char const*)4)
+#define WRITE_BUFFER_FLAGS     (OPTST_DISABLED \
+        | OPTST_SET_ARGTYPE(OPARG_TYPE_NUMERIC))
+
+/*
+ *  direct-io option description:
+ */
+#define DIRECT_IO_DESC      (tcprewrite_opt_strs+3076)
+#define DIRECT_IO_NAME      (tcprewrite_opt_strs+3112)
+#define DIRECT_IO_name      (tcprewrite_opt_strs+3122)
+#define DIRECT_IO_FLAGS     (OPTST_DISABLED)
+
+/*
+ *  fsync option description:
+ */
+#define FSYNC_DESC      (tcprewrite_opt_strs+3132)
+#define FSYNC_NAME      (tcprewrite_opt_strs+3180)
+#define FSYNC_name      (tcprewrite_opt_strs+3186)
+#define FSYNC_FLAGS     (OPTST_DISABLED \
+        | OPTST_SET_ARGTYPE(OPARG_TYPE_STRING))
+
+/*
+ *  threads option description:
+ */
+#ifdef HAVE_PTHREAD
+#define THREADS_DESC      (tcprewrite_opt_strs+3192)
+#define THREADS_NAME      (tcprewrite_opt_strs+3231)
+#define THREADS_name      (tcprewrite_opt_strs+3239)
+#define THREADS_DFT_ARG   ((char const*)1)
+#define THREADS_FLAGS     (OPTST_DISABLED \
+        | OPTST_SET_ARGTYPE(OPARG_TYPE_NUMERIC))
+
+#else   /* disable threads */
+#define THREADS_FLAGS     (OPTST_OMITTED | OPTST_NO_INIT)
+#define THREADS_DFT_ARG   NULL
+#define THREADS_NAME      NULL
+#define THREADS_DESC      NULL
+#define THREADS_name      NULL
+#endif  /* HAVE_PTHREAD */
+
 /*
  *  version option description:
  */
-#define VERSION_DESC      (tcprewrite_opt_strs+3017)
-#define VERSION_NAME      (tcprewrite_opt_strs+3043)
-#define VERSION_name      (tcprewrite_opt_strs+3051)
+#define VERSION_DESC      (tcprewrite_opt_strs+3247)
+#define VERSION_NAME      (tcprewrite_opt_strs+3273)
+#define VERSION_name      (tcprewrite_opt_strs+3281)
 #define VERSION_FLAGS     (OPTST_DISABLED)
 
 /*
  *  less-help option description:
  */
-#define LESS_HELP_DESC      (tcprewrite_opt_strs+3059)
-#define LESS_HELP_NAME      (tcprewrite_opt_strs+3099)
-#define LESS_HELP_name      (tcprewrite_opt_strs+3109)
+#define LESS_HELP_DESC      (tcprewrite_opt_strs+3289)
+#define LESS_HELP_NAME      (tcprewrite_opt_strs+3329)
+#define LESS_HELP_name      (tcprewrite_opt_strs+3339)
 #define LESS_HELP_FLAGS     (OPTST_DISABLED | OPTST_IMM)
 
 /*
  *  Help/More_Help option descriptions:
  */
-#define HELP_DESC       (tcprewrite_opt_strs+3119)
-#define HELP_name       (tcprewrite_opt_strs+3163)
+#define HELP_DESC       (tcprewrite_opt_strs+3349)
+#define HELP_name       (tcprewrite_opt_strs+3393)
 #ifdef HAVE_WORKING_FORK
-#define MORE_HELP_DESC  (tcprewrite_opt_strs+3168)
-#define MORE_HELP_name  (tcprewrite_opt_strs+3213)
+#define MORE_HELP_DESC  (tcprewrite_opt_strs+3398)
+#define MORE_HELP_name  (tcprewrite_opt_strs+3443)
 #define MORE_HELP_FLAGS (OPTST_IMM | OPTST_NO_INIT)
 #else
 #define MORE_HELP_DESC  NULL
 #define MORE_HELP_name  NULL
 #define MORE_HELP_FLAGS (OPTST_OMITTED | OPTST_NO_INIT)
 #endif
-#define SAVE_OPTS_DESC  (tcprewrite_opt_strs+3223)
-#define SAVE_OPTS_name  (tcprewrite_opt_strs+3262)
-#define LOAD_OPTS_DESC     (tcprewrite_opt_strs+3272)
-#define LOAD_OPTS_NAME     (tcprewrite_opt_strs+3304)
-#define NO_LOAD_OPTS_name  (tcprewrite_opt_strs+3314)
-#define LOAD_OPTS_pfx      (tcprewrite_opt_strs+3327)
+#define SAVE_OPTS_DESC  (tcprewrite_opt_strs+3453)
+#define SAVE_OPTS_name  (tcprewrite_opt_strs+3492)
+#define LOAD_OPTS_DESC     (tcprewrite_opt_strs+3502)
+#define LOAD_OPTS_NAME     (tcprewrite_opt_strs+3534)
+#define NO_LOAD_OPTS_name  (tcprewrite_opt_strs+3544)
+#define LOAD_OPTS_pfx      (tcprewrite_opt_strs+3557)
 #define LOAD_OPTS_name     (NO_LOAD_OPTS_name + 3)
 /*
  *  Declare option callback procedures
@@ -708,6 +766,11 @@ static int const aFragdirMustList[] = {
 #else /* not DEBUG */
 # define doOptDbug NULL
 #endif /* def/not DEBUG */
+#ifdef HAVE_PTHREAD
+  static tOptProc doOptThreads;
+#else /* not HAVE_PTHREAD */
+# define doOptThreads NULL
+#endif /* def/not HAVE_PTHREAD */
 extern tOptProc
     optionBooleanVal,   optionNestedVal,    optionNumericVal,
     optionPagedUsage,   optionPrintVersion, optionResetOpt,
@@ -717,7 +780,7 @@ static tOptProc
     doOptCachefile,     doOptEnet_Vlan_Cfi, doOptEnet_Vlan_Pri,
     doOptEnet_Vlan_Tag, doOptFlowlabel,     doOptLess_Help,
     doOptMtu,           doOptTclass,        doOptTos,
-    doOptVersion,       doUsageOpt;
+    doOptVersion,       doOptWrite_Buffer,  doUsageOpt;
 
 /* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
 /**
@@ -1182,8 +1245,56 @@ static tOptDesc optDesc[OPTION_CT] = {
      /* desc, NAME, name */ SKIP_SOFT_ERRORS_DESC, SKIP_SOFT_ERRORS_NAME, SKIP_SOFT_ERRORS_name,
      /* disablement strs */ NULL, NULL },
 
-  {  /* entry idx, value */ 38, VALUE_OPT_VERSION,
-     /* equiv idx, value */ 38, VALUE_OPT_VERSION,
+  {  /* entry idx, value */ 38, VALUE_OPT_WRITE_BUFFER,
+     /* equiv idx, value */ 38, VALUE_OPT_WRITE_BUFFER,
+     /* equivalenced to  */ NO_EQUIVALENT,
+     /* min, max, act ct */ 0, 1, 0,
+     /* opt state flags  */ WRITE_BUFFER_FLAGS, 0,
+     /* last opt argumnt */ { WRITE_BUFFER_DFT_ARG },
+     /* arg list/cookie  */ NULL,
+     /* must/cannot opts */ NULL, NULL,
+     /* option proc      */ doOptWrite_Buffer,
+     /* desc, NAME, name */ WRITE_BUFFER_DESC, WRITE_BUFFER_NAME, WRITE_BUFFER_name,
+     /* disablement strs */ NULL, NULL },
+
+  {  /* entry idx, value */ 39, VALUE_OPT_DIRECT_IO,
+     /* equiv idx, value */ 39, VALUE_OPT_DIRECT_IO,
+     /* equivalenced to  */ NO_EQUIVALENT,
+     /* min, max, act ct */ 0, 1, 0,
+     /* opt state flags  */ DIRECT_IO_FLAGS, 0,
+     /* last opt argumnt */ { NULL }, /* --direct-io */
+     /* arg list/cookie  */ NULL,
+     /* must/cannot opts */ NULL, NULL,
+     /* option proc      */ NULL,
+     /* desc, NAME, name */ DIRECT_IO_DESC, DIRECT_IO_NAME, DIRECT_IO_name,
+     /* disablement strs */ NULL, NULL },
+
+  {  /* entry idx, value */ 40, VALUE_OPT_FSYNC,
+     /* equiv idx, value */ 40, VALUE_OPT_FSYNC,
+     /* equivalenced to  */ NO_EQUIVALENT,
+     /* min, max, act ct */ 0, 1, 0,
+     /* opt state flags  */ FSYNC_FLAGS, 0,
+     /* last opt argumnt */ { NULL }, /* --fsync */
+     /* arg list/cookie  */ NULL,
+     /* must/cannot opts */ NULL, NULL,
+     /* option proc      */ NULL,
+     /* desc, NAME, name */ FSYNC_DESC, FSYNC_NAME, FSYNC_name,
+     /* disablement strs */ NULL, NULL },
+
+  {  /* entry idx, value */ 41, VALUE_OPT_THREADS,
+     /* equiv idx, value */ 41, VALUE_OPT_THREADS,
+     /* equivalenced to  */ NO_EQUIVALENT,
+     /* min, max, act ct */ 0, 1, 0,
+     /* opt state flags  */ THREADS_FLAGS, 0,
+     /* last opt argumnt */ { THREADS_DFT_ARG },
+     /* arg list/cookie  */ NULL,
+     /* must/cannot opts */ NULL, NULL,
+     /* option proc      */ doOptThreads,
+     /* desc, NAME, name */ THREADS_DESC, THREADS_NAME, THREADS_name,
+     /* disablement strs */ NULL, NULL },
+
+  {  /* entry idx, value */ 42, VALUE_OPT_VERSION,
+     /* equiv idx, value */ 42, VALUE_OPT_VERSION,
      /* equivalenced to  */ NO_EQUIVALENT,
      /* min, max, act ct */ 0, 1, 0,
      /* opt state flags  */ VERSION_FLAGS, 0,
@@ -1194,8 +1305,8 @@ static tOptDesc optDesc[OPTION_CT] = {
      /* desc, NAME, name */ VERSION_DESC, VERSION_NAME, VERSION_name,
      /* disablement strs */ NULL, NULL },
 
-  {  /* entry idx, value */ 39, VALUE_OPT_LESS_HELP,
-     /* equiv idx, value */ 39, VALUE_OPT_LESS_HELP,
+  {  /* entry idx, value */ 43, VALUE_OPT_LESS_HELP,
+     /* equiv idx, value */ 43, VALUE_OPT_LESS_HELP,
      /* equivalenced to  */ NO_EQUIVALENT,
      /* min, max, act ct */ 0, 1, 0,
      /* opt state flags  */ LESS_HELP_FLAGS, 0,
@@ -1263,15 +1374,15 @@ tOptDesc * const tcpedit_tcpedit_optDesc_p = optDesc + 0;
  *
  *  Define the tcprewrite Option Environment
  */
-#define zPROGNAME       (tcprewrite_opt_strs+3330)
-#define zUsageTitle     (tcprewrite_opt_strs+3341)
-#define zRcName         (tcprewrite_opt_strs+3465)
+#define zPROGNAME       (tcprewrite_opt_strs+3560)
+#define zUsageTitle     (tcprewrite_opt_strs+3571)
+#define zRcName         (tcprewrite_opt_strs+3695)
 static char const * const apzHomeList[2] = {
-    tcprewrite_opt_strs+3461,
+    tcprewrite_opt_strs+3691,
     NULL };
-#define zBugsAddr       (tcprewrite_opt_strs+3479)
+#define zBugsAddr       (tcprewrite_opt_strs+3709)
 #define zExplain        (NULL)
-#define zDetail         (tcprewrite_opt_strs+3517)
+#define zDetail         (tcprewrite_opt_strs+3747)
 #define zFullVersion    (NULL)
 /* extracted from optcode.tlib near line 350 */
 
@@ -1610,6 +1721,78 @@ doOptCachefile(tOptions* pOptions, tOptDesc* pOptDesc)
     (void)pOptions;
 }
 
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+/**
+ * Code to handle the write-buffer option.
+ *
+ * @param pOptions the tcprewrite options data structure
+ * @param pOptDesc the option descriptor for this option.
+ */
+static void
+doOptWrite_Buffer(tOptions* pOptions, tOptDesc* pOptDesc)
+{
+    static struct {long rmin, rmax;} const rng[1] = {
+        { 1, 1024 } };
+    int  ix;
+
+    if (pOptions <= OPTPROC_EMIT_LIMIT)
+        goto emit_ranges;
+    optionNumericVal(pOptions, pOptDesc);
+
+    for (ix = 0; ix < 1; ix++) {
+        if (pOptDesc->optArg.argInt < rng[ix].rmin)
+            continue;  /* ranges need not be ordered. */
+        if (pOptDesc->optArg.argInt == rng[ix].rmin)
+            return;
+        if (rng[ix].rmax == LONG_MIN)
+            continue;
+        if (pOptDesc->optArg.argInt <= rng[ix].rmax)
+            return;
+    }
+
+    option_usage_fp = stderr;
+
+emit_ranges:
+    optionShowRange(pOptions, pOptDesc, (void *)rng, 1);
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+/**
+ * Code to handle the threads option, when HAVE_PTHREAD is #define-d.
+ *
+ * @param pOptions the tcprewrite options data structure
+ * @param pOptDesc the option descriptor for this option.
+ */
+#ifdef HAVE_PTHREAD
+static void
+doOptThreads(tOptions* pOptions, tOptDesc* pOptDesc)
+{
+    static struct {long rmin, rmax;} const rng[1] = {
+        { 1, 64 } };
+    int  ix;
+
+    if (pOptions <= OPTPROC_EMIT_LIMIT)
+        goto emit_ranges;
+    optionNumericVal(pOptions, pOptDesc);
+
+    for (ix = 0; ix < 1; ix++) {
+        if (pOptDesc->optArg.argInt < rng[ix].rmin)
+            continue;  /* ranges need not be ordered. */
+        if (pOptDesc->optArg.argInt == rng[ix].rmin)
+            return;
+        if (rng[ix].rmax == LONG_MIN)
+            continue;
+        if (pOptDesc->optArg.argInt <= rng[ix].rmax)
+            return;
+    }
+
+    option_usage_fp = stderr;
+
+emit_ranges:
+    optionShowRange(pOptions, pOptDesc, (void *)rng, 1);
+}
+#endif /* defined HAVE_PTHREAD */
+
 /* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
 /**
  * Code to handle the version option.
@@ -1620,7 +1803,7 @@ doOptCachefile(tOptions* pOptions, tOptDesc* pOptDesc)
 static void
 doOptVersion(tOptions* pOptions, tOptDesc* pOptDesc)
 {
-    /* extracted from tcprewrite_opts.def, line 243 */
+    /* extracted from tcprewrite_opts.def, line 296 */
 
     fprintf(stderr, "tcprewrite version: %s (build %s)", VERSION, git_version());
 #ifdef DEBUG
@@ -1671,7 +1854,7 @@ doOptVersion(tOptions* pOptions, tOptDesc* pOptDesc)
 static void
 doOptLess_Help(tOptions* pOptions, tOptDesc* pOptDesc)
 {
-    /* extracted from tcprewrite_opts.def, line 289 */
+    /* extracted from tcprewrite_opts.def, line 342 */
 
     USAGE(EXIT_FAILURE);
 
@@ -1740,7 +1923,7 @@ tOptions tcprewriteOptions = {
       NO_EQUIVALENT, /* '-#' option index */
       9 /* index of default opt */
     },
-    44 /* full option count */, 40 /* user option count */,
+    48 /* full option count */, 44 /* user option count */,
     tcprewrite_full_usage, tcprewrite_short_usage,
     NULL, NULL,
     PKGDATADIR, tcprewrite_packager_info
@@ -104,15 +104,19 @@ typedef enum {
     INDEX_OPT_FRAGROUTE         = 35,
     INDEX_OPT_FRAGDIR           = 36,
     INDEX_OPT_SKIP_SOFT_ERRORS  = 37,
-    INDEX_OPT_VERSION           = 38,
-    INDEX_OPT_LESS_HELP         = 39,
-    INDEX_OPT_HELP              = 40,
-    INDEX_OPT_MORE_HELP         = 41,
-    INDEX_OPT_SAVE_OPTS         = 42,
-    INDEX_OPT_LOAD_OPTS         = 43
+    INDEX_OPT_WRITE_BUFFER      = 38,
+    INDEX_OPT_DIRECT_IO         = 39,
+    INDEX_OPT_FSYNC             = 40,
+    INDEX_OPT_THREADS           = 41,
+    INDEX_OPT_VERSION           = 42,
+    INDEX_OPT_LESS_HELP         = 43,
+    INDEX_OPT_HELP              = 44,
+    INDEX_OPT_MORE_HELP         = 45,
+    INDEX_OPT_SAVE_OPTS         = 46,
+    INDEX_OPT_LOAD_OPTS         = 47
 } teOptIndex;
 
-#define OPTION_CT    44
+#define OPTION_CT    48
 
 /*
  *  Interface defines for all options.  Replace "n" with the UPPER_CASED
@@ -227,6 +231,15 @@ typedef enum {
 #define VALUE_OPT_FRAGROUTE      131
 #define VALUE_OPT_FRAGDIR        132
 #define VALUE_OPT_SKIP_SOFT_ERRORS 133
+#define VALUE_OPT_WRITE_BUFFER   134
+
+#define OPT_VALUE_WRITE_BUFFER   (DESC(WRITE_BUFFER).optArg.argInt)
+#define VALUE_OPT_DIRECT_IO      135
+#define VALUE_OPT_FSYNC          136
+#define VALUE_OPT_THREADS        137
+#ifdef HAVE_PTHREAD
+#define OPT_VALUE_THREADS        (DESC(THREADS).optArg.argInt)
+#endif /* HAVE_PTHREAD */
 #define VALUE_OPT_VERSION        'V'
 #define VALUE_OPT_LESS_HELP      'h'
 #define VALUE_OPT_HELP          'H'
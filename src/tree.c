@@ -36,39 +36,173 @@ extern tcpprep_t *tcpprep;
 extern int debug;
 #endif
 
-/* static buffer used by tree_print*() functions */
-char tree_print_buff[TREEPRINTBUFFLEN]; 
-
-static tcpr_tree_t *new_tree();
-static tcpr_tree_t *packet2tree(const u_char *);
-static char *tree_print(tcpr_data_tree_t *);
-static char *tree_printnode(const char *, const tcpr_tree_t *);
+static void new_tree(tcpr_tree_t *);
+static void packet2tree(const u_char *, tcpr_tree_t *);
+static char *tree_printnode(const char *, const tcpr_tree_t *, char *);
 static void tree_buildcidr(tcpr_data_tree_t *, tcpr_buildcidr_t *);
 static int tree_checkincidr(tcpr_data_tree_t *, tcpr_buildcidr_t *);
 
 static int ipv6_cmp(const struct tcpr_in6_addr *a, const struct tcpr_in6_addr *b);
 
-RB_PROTOTYPE(tcpr_data_tree_s, tcpr_tree_s, node, tree_comp)
-RB_GENERATE(tcpr_data_tree_s, tcpr_tree_s, node, tree_comp)
+/**
+ * hashes the family & address of a host
+ */
+static u_int32_t
+tree_hash(const tcpr_tree_t *node)
+{
+    u_int32_t hash = node->family;
+    int i;
+
+    if (node->family == AF_INET) {
+        hash = (hash ^ (u_int32_t)node->u.ip) * 0x9e3779b1;
+    } else {
+        for (i = 0; i < 4; i++)
+            hash = (hash ^ node->u.ip6.tcpr_s6_addr32[i]) * 0x9e3779b1;
+    }
+
+    return hash ^ (hash >> 16);
+}
+
+/**
+ * returns the slot holding the host with the same address as finder, or
+ * the empty slot where it would go
+ */
+static u_int32_t
+tree_slot(const tcpr_data_tree_t *root, const tcpr_tree_t *finder)
+{
+    u_int32_t slot;
+    const tcpr_tree_t *node;
+
+    slot = tree_hash(finder) & (root->size - 1);
+    while ((node = root->slots[slot]) != NULL) {
+        if (node->family == finder->family &&
+                (node->family == AF_INET ? node->u.ip == finder->u.ip :
+                 ipv6_cmp(&node->u.ip6, &finder->u.ip6) == 0))
+            break;
+
+        slot = (slot + 1) & (root->size - 1);
+    }
+
+    return slot;
+}
+
+/**
+ * returns the host with the same address as finder or NULL
+ */
+static tcpr_tree_t *
+tree_find(const tcpr_data_tree_t *root, const tcpr_tree_t *finder)
+{
+    if (root->count == 0)
+        return NULL;
+
+    return root->slots[tree_slot(root, finder)];
+}
+
+/**
+ * doubles the size of the hash table
+ */
+static void
+tree_grow(tcpr_data_tree_t *root)
+{
+    tcpr_tree_t **old = root->slots;
+    u_int32_t oldsize = root->size, i;
+
+    root->size = oldsize ? oldsize * 2 : TREE_MIN_SLOTS;
+    root->slots = (tcpr_tree_t **)safe_malloc(root->size * sizeof(tcpr_tree_t *));
+
+    for (i = 0; i < oldsize; i++) {
+        if (old[i] != NULL)
+            root->slots[tree_slot(root, old[i])] = old[i];
+    }
+
+    if (old != NULL)
+        safe_free(old);
+}
+
+/**
+ * adds a copy of newnode to the tree (which must not already have the
+ * host) and returns it
+ */
+static tcpr_tree_t *
+tree_insert(tcpr_data_tree_t *root, const tcpr_tree_t *newnode)
+{
+    tcpr_tree_t *node;
+
+    /* keep the table at most half full */
+    if ((root->count + 1) * 2 > root->size)
+        tree_grow(root);
+
+    if (root->block == NULL || root->block_used == TREE_BLOCK) {
+        root->block = (tcpr_tree_t *)safe_malloc(TREE_BLOCK * sizeof(tcpr_tree_t));
+        root->block_used = 0;
+        root->blocks = (tcpr_tree_t **)safe_realloc(root->blocks,
+                (root->nblocks + 1) * sizeof(tcpr_tree_t *));
+        root->blocks[root->nblocks++] = root->block;
+    }
+
+    node = &root->block[root->block_used++];
+    memcpy(node, newnode, sizeof(tcpr_tree_t));
+
+    root->slots[tree_slot(root, node)] = node;
+    root->count++;
+
+    return node;
+}
+
+static int
+tree_sort_comp(const void *a, const void *b)
+{
+    return tree_comp(*(tcpr_tree_t * const *)a, *(tcpr_tree_t * const *)b);
+}
+
+/**
+ * returns all the hosts in the tree sorted by tree_comp().  The list is
+ * kept until a host is added.
+ */
+static tcpr_tree_t **
+tree_sorted(tcpr_data_tree_t *root)
+{
+    u_int32_t i, j;
+
+    if (root->sorted != NULL && root->sorted_count == root->count)
+        return root->sorted;
+
+    if (root->sorted != NULL)
+        safe_free(root->sorted);
+
+    root->sorted = (tcpr_tree_t **)safe_malloc((root->count + 1) * sizeof(tcpr_tree_t *));
+    for (i = 0, j = 0; i < root->size; i++) {
+        if (root->slots[i] != NULL)
+            root->sorted[j++] = root->slots[i];
+    }
+
+    qsort(root->sorted, root->count, sizeof(tcpr_tree_t *), tree_sort_comp);
+    root->sorted_count = root->count;
+
+    return root->sorted;
+}
 
 /**
- * used with rbwalk to walk a tree and generate cidr_t * cidrdata.
- * is smart enough to prevent dupes.  void * arg is cast to bulidcidr_t
+ * walks the tree in order and generates cidr_t * cidrdata.
+ * is smart enough to prevent dupes.
  */
 void
 tree_buildcidr(tcpr_data_tree_t *treeroot, tcpr_buildcidr_t * bcdata)
 {
-    tcpr_tree_t *node = NULL;
+    tcpr_tree_t *node = NULL, **nodes;
     tcpr_cidr_t *newcidr = NULL;
     unsigned long network = 0;
     struct tcpr_in6_addr network6;
     unsigned long mask = ~0;    /* turn on all bits */
     tcpprep_opt_t *options = tcpprep->options;
+    u_int32_t n;
     int i, j, k;
 
     dbg(1, "Running: tree_buildcidr()");
 
-    RB_FOREACH(node, tcpr_data_tree_s, treeroot) {
+    nodes = tree_sorted(treeroot);
+    for (n = 0; n < treeroot->count; n++) {
+        node = nodes[n];
 
         /* we only check types that are vaild */
         if (bcdata->type != DIR_ANY)    /* don't check if we're adding ANY */
@@ -125,17 +259,19 @@ tree_buildcidr(tcpr_data_tree_t *treeroot, tcpr_buildcidr_t * bcdata)
 
 
 /**
- * uses rbwalk to check to see if a given ip address of a given type in the
- * tree is inside any of the cidrdata
+ * walks the tree in order to check to see if a given ip address of a given
+ * type in the tree is inside any of the cidrdata
  */
 static int
 tree_checkincidr(tcpr_data_tree_t *treeroot, tcpr_buildcidr_t * bcdata)
 {
-    tcpr_tree_t *node = NULL;
+    tcpr_tree_t *node = NULL, **nodes;
     tcpprep_opt_t *options = tcpprep->options;
+    u_int32_t n;
 
-
-    RB_FOREACH(node, tcpr_data_tree_s, treeroot) {
+    nodes = tree_sorted(treeroot);
+    for (n = 0; n < treeroot->count; n++) {
+        node = nodes[n];
 
         /* we only check types that are vaild */
         if (bcdata->type != DIR_ANY)    /* don't check if we're adding ANY */
@@ -156,7 +292,7 @@ tree_checkincidr(tcpr_data_tree_t *treeroot, tcpr_buildcidr_t * bcdata)
 }
 
 /**
- * processes the tree using rbwalk / tree2cidr to generate a CIDR
+ * processes the tree using tree_buildcidr() to generate a CIDR
  * used for 2nd pass, router mode
  *
  * returns > 0 for success (the mask len), 0 for fail
@@ -229,13 +365,13 @@ tcpr_tree_to_cidr(const int masklen, const int type)
 tcpr_dir_t
 check_ip_tree(const int mode, const unsigned long ip)
 {
-    tcpr_tree_t *node = NULL, *finder = NULL;
+    tcpr_tree_t *node = NULL, finder;
 
-    finder = new_tree();
-    finder->family = AF_INET;
-    finder->u.ip = ip;
+    new_tree(&finder);
+    finder.family = AF_INET;
+    finder.u.ip = ip;
 
-    node = RB_FIND(tcpr_data_tree_s, &treeroot, finder);
+    node = tree_find(&treeroot, &finder);
 
     if (node == NULL && mode == DIR_UNKNOWN)
         errx(-1, "%s (%lu) is an unknown system... aborting.!\n"
@@ -297,13 +433,13 @@ check_ip_tree(const int mode, const unsigned long ip)
 tcpr_dir_t
 check_ip6_tree(const int mode, const struct tcpr_in6_addr *addr)
 {
-    tcpr_tree_t *node = NULL, *finder = NULL;
+    tcpr_tree_t *node = NULL, finder;
 
-    finder = new_tree();
-    finder->family = AF_INET6;
-    finder->u.ip6 = *addr;
+    new_tree(&finder);
+    finder.family = AF_INET6;
+    finder.u.ip6 = *addr;
 
-    node = RB_FIND(tcpr_data_tree_s, &treeroot, finder);
+    node = tree_find(&treeroot, &finder);
 
     if (node == NULL && mode == DIR_UNKNOWN)
         errx(-1, "%s is an unknown system... aborting.!\n"
@@ -365,12 +501,13 @@ check_ip6_tree(const int mode, const struct tcpr_in6_addr *addr)
 /**
  * Parses the IP header of the given packet (data) to get the SRC/DST IP 
  * addresses.  If the SRC IP doesn't exist in the TREE, we add it as a
- * client, if the DST IP doesn't exist in the TREE, we add it as a server
+ * client, if the DST IP doesn't exist in the TREE, we add it as a server.
+ * Returns the tree node of the SRC IP.
  */
-void
-add_tree_first_ipv4(const u_char *data)
+tcpr_tree_t *
+add_tree_first_ipv4(tcpr_data_tree_t *root, const u_char *data)
 {
-    tcpr_tree_t *newnode = NULL, *findnode;
+    tcpr_tree_t newnode, *findnode, *srcnode;
     eth_hdr_t *eth_hdr = NULL;
     ipv4_hdr_t ip_hdr;
     
@@ -378,50 +515,45 @@ add_tree_first_ipv4(const u_char *data)
     /* 
      * first add/find the source IP/client 
      */
-    newnode = new_tree();
+    new_tree(&newnode);
 
     eth_hdr = (eth_hdr_t *) (data);
     /* prevent issues with byte alignment, must memcpy */
     memcpy(&ip_hdr, (data + TCPR_ETH_H), TCPR_IPV4_H);
 
     /* copy over the source ip, and values to gurantee this a client */
-    newnode->family = AF_INET;
-    newnode->u.ip = ip_hdr.ip_src.s_addr;
-    newnode->type = DIR_CLIENT;
-    newnode->client_cnt = 1000;
-    findnode = RB_FIND(tcpr_data_tree_s, &treeroot, newnode);
+    newnode.family = AF_INET;
+    newnode.u.ip = ip_hdr.ip_src.s_addr;
+    newnode.type = DIR_CLIENT;
+    newnode.client_cnt = 1000;
+    findnode = tree_find(root, &newnode);
     
-    /* if we didn't find it, add it to the tree, else free it */
-    if (findnode == NULL) {
-        RB_INSERT(tcpr_data_tree_s, &treeroot, newnode);
-    } else {
-        safe_free(newnode);
-    }
+    /* if we didn't find it, add it to the tree */
+    srcnode = findnode != NULL ? findnode : tree_insert(root, &newnode);
     
     /*
      * now add/find the destination IP/server
      */
-    newnode = new_tree();
+    new_tree(&newnode);
     eth_hdr = (eth_hdr_t *) (data);
     memcpy(&ip_hdr, (data + TCPR_ETH_H), TCPR_IPV4_H);
 
-    newnode->family = AF_INET;
-    newnode->u.ip = ip_hdr.ip_dst.s_addr;
-    newnode->type = DIR_SERVER;
-    newnode->server_cnt = 1000;
-    findnode = RB_FIND(tcpr_data_tree_s, &treeroot, newnode);
+    newnode.family = AF_INET;
+    newnode.u.ip = ip_hdr.ip_dst.s_addr;
+    newnode.type = DIR_SERVER;
+    newnode.server_cnt = 1000;
+    findnode = tree_find(root, &newnode);
 
-    if (findnode == NULL) {
-        RB_INSERT(tcpr_data_tree_s, &treeroot, newnode);
-    } else {
-        safe_free(newnode);
-    }
+    if (findnode == NULL)
+        tree_insert(root, &newnode);
+
+    return srcnode;
 }
 
-void
-add_tree_first_ipv6(const u_char *data)
+tcpr_tree_t *
+add_tree_first_ipv6(tcpr_data_tree_t *root, const u_char *data)
 {
-    tcpr_tree_t *newnode = NULL, *findnode;
+    tcpr_tree_t newnode, *findnode, *srcnode;
     eth_hdr_t *eth_hdr = NULL;
     ipv6_hdr_t ip6_hdr;
 
@@ -429,55 +561,58 @@ add_tree_first_ipv6(const u_char *data)
     /*
      * first add/find the source IP/client
      */
-    newnode = new_tree();
+    new_tree(&newnode);
     
     eth_hdr = (eth_hdr_t *) (data);
     /* prevent issues with byte alignment, must memcpy */
     memcpy(&ip6_hdr, (data + TCPR_ETH_H), TCPR_IPV6_H);
 
     /* copy over the source ip, and values to gurantee this a client */
-    newnode->family = AF_INET6;
-    newnode->u.ip6 = ip6_hdr.ip_src;
-    newnode->type = DIR_CLIENT;
-    newnode->client_cnt = 1000;
-    findnode = RB_FIND(tcpr_data_tree_s, &treeroot, newnode);
-
-    /* if we didn't find it, add it to the tree, else free it */
-    if (findnode == NULL) {
-        RB_INSERT(tcpr_data_tree_s, &treeroot, newnode);
-    } else {
-        safe_free(newnode);
-    }
+    newnode.family = AF_INET6;
+    newnode.u.ip6 = ip6_hdr.ip_src;
+    newnode.type = DIR_CLIENT;
+    newnode.client_cnt = 1000;
+    findnode = tree_find(root, &newnode);
+
+    /* if we didn't find it, add it to the tree */
+    srcnode = findnode != NULL ? findnode : tree_insert(root, &newnode);
 
     /*
      * now add/find the destination IP/server
      */
-    newnode = new_tree();
+    new_tree(&newnode);
     eth_hdr = (eth_hdr_t *) (data);
     memcpy(&ip6_hdr, (data + TCPR_ETH_H), TCPR_IPV6_H);
 
-    newnode->family = AF_INET6;
-    newnode->u.ip6 = ip6_hdr.ip_dst;
-    newnode->type = DIR_SERVER;
-    newnode->server_cnt = 1000;
-    findnode = RB_FIND(tcpr_data_tree_s, &treeroot, newnode);
+    newnode.family = AF_INET6;
+    newnode.u.ip6 = ip6_hdr.ip_dst;
+    newnode.type = DIR_SERVER;
+    newnode.server_cnt = 1000;
+    findnode = tree_find(root, &newnode);
 
-    if (findnode == NULL) {
-        RB_INSERT(tcpr_data_tree_s, &treeroot, newnode);
-    } else {
-        safe_free(newnode);
-    }
+    if (findnode == NULL)
+        tree_insert(root, &newnode);
+
+    return srcnode;
 }
 
-static void
-add_tree_node(tcpr_tree_t *newnode)
+/**
+ * adds newnode to the tree or updates the existing entry for the host,
+ * returning the node which is in the tree
+ */
+static tcpr_tree_t *
+add_tree_node(tcpr_data_tree_t *root, tcpr_tree_t *newnode)
 {
     tcpr_tree_t *node;
+#ifdef DEBUG
+    /* per call, since the tcpprep worker threads all add hosts */
+    char buf[TREEPRINTBUFFLEN];
+#endif
 
     /* try to find a simular entry in the tree */
-    node = RB_FIND(tcpr_data_tree_s, &treeroot, newnode);
+    node = tree_find(root, newnode);
 
-    dbgx(3, "%s", tree_printnode("add_tree", node));
+    dbgx(3, "%s", tree_printnode("add_tree", node, buf));
 
     /* new entry required */
     if (node == NULL) {
@@ -489,13 +624,12 @@ add_tree_node(tcpr_tree_t *newnode)
             newnode->client_cnt++;
         }
         /* insert it in */
-        RB_INSERT(tcpr_data_tree_s, &treeroot, newnode);
-
+        node = tree_insert(root, newnode);
     }
     else {
         /* we found something, so update it */
         dbgx(2, "   node: %p\nnewnode: %p", node, newnode);
-        dbgx(3, "%s", tree_printnode("update node", node));
+        dbgx(3, "%s", tree_printnode("update node", node, buf));
         /* increment counter */
         if (newnode->type == DIR_SERVER) {
             node->server_cnt++;
@@ -504,13 +638,11 @@ add_tree_node(tcpr_tree_t *newnode)
             /* temp debug code */
             node->client_cnt++;
         }
-                    
-        /* didn't insert it, so free it */
-        safe_free(newnode);
     }
 
     dbg(2, "------- START NEXT -------");
-    dbgx(3, "%s", tree_print(&treeroot));
+
+    return node;
 }
 
 /**
@@ -518,45 +650,95 @@ add_tree_node(tcpr_tree_t *newnode)
  * to the tree if it doesn't yet exist.  We go through and track:
  * - number of times each host acts as a client or server
  * - the way the host acted the first time we saw it (client or server)
+ * Returns the tree node of the host.
  */
-void
-add_tree_ipv4(const unsigned long ip, const u_char * data)
+tcpr_tree_t *
+add_tree_ipv4(tcpr_data_tree_t *root, const unsigned long ip, const u_char * data)
 {
-    tcpr_tree_t *newnode = NULL;
+    tcpr_tree_t newnode;
     assert(data);
 
-    newnode = packet2tree(data);
+    packet2tree(data, &newnode);
 
-    assert(ip == newnode->u.ip);
+    assert(ip == newnode.u.ip);
 
-    if (newnode->type == DIR_UNKNOWN) {
+    if (newnode.type == DIR_UNKNOWN) {
         /* couldn't figure out if packet was client or server */
 
         dbgx(2, "%s (%lu) unknown client/server",
-            get_addr2name4(newnode->u.ip, RESOLVE), newnode->u.ip);
+            get_addr2name4(newnode.u.ip, RESOLVE), newnode.u.ip);
 
     }
-    add_tree_node(newnode);
+    return add_tree_node(root, &newnode);
 }
 
-void
-add_tree_ipv6(const struct tcpr_in6_addr * addr, const u_char * data)
+tcpr_tree_t *
+add_tree_ipv6(tcpr_data_tree_t *root, const struct tcpr_in6_addr * addr, const u_char * data)
 {
-    tcpr_tree_t *newnode = NULL;
+    tcpr_tree_t newnode;
     assert(data);
 
-    newnode = packet2tree(data);
+    packet2tree(data, &newnode);
 
-    assert(ipv6_cmp(addr, &newnode->u.ip6) == 0);
+    assert(ipv6_cmp(addr, &newnode.u.ip6) == 0);
 
-    if (newnode->type == DIR_UNKNOWN) {
+    if (newnode.type == DIR_UNKNOWN) {
         /* couldn't figure out if packet was client or server */
 
         dbgx(2, "%s unknown client/server",
-            get_addr2name6(&newnode->u.ip6, RESOLVE));
+            get_addr2name6(&newnode.u.ip6, RESOLVE));
     }
 
-    add_tree_node(newnode);
+    return add_tree_node(root, &newnode);
+}
+
+/**
+ * merges the hosts another thread found in a later part of the pcap into
+ * root.  Hosts new to root are added as src first saw them, otherwise the
+ * client/server counts are added up, except in first packet mode where
+ * only the first time we saw the host counts.
+ */
+void
+tree_merge(tcpr_data_tree_t *root, const tcpr_data_tree_t *src)
+{
+    tcpr_tree_t *node, *found;
+    tcpprep_opt_t *options = tcpprep->options;
+    u_int32_t i;
+
+    for (i = 0; i < src->size; i++) {
+        if ((node = src->slots[i]) == NULL)
+            continue;
+
+        if ((found = tree_find(root, node)) == NULL) {
+            found = tree_insert(root, node);
+            found->key = 0;
+        } else if (options->automode != FIRST_MODE) {
+            found->server_cnt += node->server_cnt;
+            found->client_cnt += node->client_cnt;
+        }
+    }
+}
+
+/**
+ * frees all the hosts in the tree & empties it.  Any pointers to its
+ * hosts (like an auto mode key log's) are no longer valid.
+ */
+void
+tree_free(tcpr_data_tree_t *root)
+{
+    u_int32_t i;
+
+    for (i = 0; i < root->nblocks; i++)
+        safe_free(root->blocks[i]);
+
+    if (root->blocks != NULL)
+        safe_free(root->blocks);
+    if (root->slots != NULL)
+        safe_free(root->slots);
+    if (root->sorted != NULL)
+        safe_free(root->sorted);
+
+    memset(root, 0, sizeof(tcpr_data_tree_t));
 }
 
 /**
@@ -567,10 +749,14 @@ tree_calculate(tcpr_data_tree_t *treeroot)
 {
     tcpr_tree_t *node;
     tcpprep_opt_t *options = tcpprep->options;
+    u_int32_t i;
 
     dbg(1, "Running tree_calculate()");
 
-    RB_FOREACH(node, tcpr_data_tree_s, treeroot) {
+    for (i = 0; i < treeroot->size; i++) {
+        if ((node = treeroot->slots[i]) == NULL)
+            continue;
+
         dbgx(4, "Processing %s", get_addr2name4(node->u.ip, RESOLVE));
         if ((node->server_cnt > 0) || (node->client_cnt > 0)) {
             /* type based on: server >= (client*ratio) */
@@ -596,18 +782,17 @@ tree_calculate(tcpr_data_tree_t *treeroot)
 static int
 ipv6_cmp(const struct tcpr_in6_addr *a, const struct tcpr_in6_addr *b)
 {
-    int i, k;
+    int i;
 
     for (i = 0; i < 4; i++) {
-       if ((k = (a->tcpr_s6_addr32[i] - b->tcpr_s6_addr32[i]))) {
-           return (k > 0) ? 1 : -1;
-        }
+        if (a->tcpr_s6_addr32[i] != b->tcpr_s6_addr32[i])
+            return (a->tcpr_s6_addr32[i] > b->tcpr_s6_addr32[i]) ? 1 : -1;
     }
     return 0;
 }
 
 /**
- * tree_comp(), called by rbsearch compares two treees and returns:
+ * tree_comp(), used to sort the tree, compares two treees and returns:
  * 1  = first > second
  * -1 = first < second
  * 0  = first = second
@@ -648,7 +833,7 @@ tree_comp(tcpr_tree_t *t1, tcpr_tree_t *t2)
     }
 
     if (t1->family == AF_INET6) {
-        ret = ipv6_cmp(&t1->u.ip6, &t1->u.ip6);
+        ret = ipv6_cmp(&t1->u.ip6, &t2->u.ip6);
         dbgx(2, "cmp(%s, %s) = %d", get_addr2name6(&t1->u.ip6, RESOLVE),
                 get_addr2name6(&t2->u.ip6, RESOLVE), ret);
         return ret;
@@ -658,35 +843,29 @@ tree_comp(tcpr_tree_t *t1, tcpr_tree_t *t2)
 }
 
 /**
- * creates a new TREE * with reasonable defaults
+ * initializes a TREE with reasonable defaults
  */
-static tcpr_tree_t *
-new_tree()
+static void
+new_tree(tcpr_tree_t *node)
 {
-    tcpr_tree_t *node;
-
-    node = (tcpr_tree_t *)safe_malloc(sizeof(tcpr_tree_t));
-
     memset(node, '\0', sizeof(tcpr_tree_t));
     node->server_cnt = 0;
     node->client_cnt = 0;
     node->type = DIR_UNKNOWN;
     node->masklen = -1;
     node->u.ip = 0;
-    return (node);
 }
 
 
 /**
- * returns a struct of TREE * from a packet header
+ * fills in node from a packet header
  * and sets the type to be SERVER or CLIENT or UNKNOWN
  * if it's an undefined packet, we return -1 for the type
  * the u_char * data should be the data that is passed by pcap_dispatch()
  */
-tcpr_tree_t *
-packet2tree(const u_char * data)
+static void
+packet2tree(const u_char * data, tcpr_tree_t *node)
 {
-    tcpr_tree_t *node = NULL;
     eth_hdr_t *eth_hdr = NULL;
     ipv4_hdr_t ip_hdr;
     ipv6_hdr_t ip6_hdr;
@@ -701,7 +880,7 @@ packet2tree(const u_char * data)
     char srcip[INET6_ADDRSTRLEN];
 #endif
 
-    node = new_tree();
+    new_tree(node);
 
     eth_hdr = (eth_hdr_t *) (data);
 
@@ -760,7 +939,7 @@ packet2tree(const u_char * data)
 
         /* ftp-data is going to skew our results so we ignore it */
         if (tcp_hdr.th_sport == 20)
-            return (node);
+            return;
 
         /* set TREE->type based on TCP flags */
         if (tcp_hdr.th_flags == TH_SYN) {
@@ -803,7 +982,7 @@ packet2tree(const u_char * data)
 
                 dbg(3, "is a dns client");
             }
-            return (node);
+            return;
             break;
         default:
             break;
@@ -826,7 +1005,7 @@ packet2tree(const u_char * data)
                 node->type = DIR_CLIENT;
                 dbg(3, "is a dns client");
             }
-            return (node);
+            return;
             break;
         default:
 
@@ -855,52 +1034,36 @@ packet2tree(const u_char * data)
         }
 
     }
-
-    return (node);
 }
 
 
 /**
- * prints out a node of the tree to stderr
+ * prints out a node of the tree into buf, which must hold
+ * TREEPRINTBUFFLEN bytes
  */
 static char *
-tree_printnode(const char *name, const tcpr_tree_t *node)
+tree_printnode(const char *name, const tcpr_tree_t *node, char *buf)
 {
 
-    memset(&tree_print_buff, '\0', TREEPRINTBUFFLEN);
+    memset(buf, '\0', TREEPRINTBUFFLEN);
     if (node == NULL) {
-        snprintf(tree_print_buff, TREEPRINTBUFFLEN, "%s node is null", name);
+        snprintf(buf, TREEPRINTBUFFLEN, "%s node is null", name);
     }
 
     else {
-        snprintf(tree_print_buff, TREEPRINTBUFFLEN,
+        snprintf(buf, TREEPRINTBUFFLEN,
             "-- %s: %p\nIP: %s\nMask: %d\nSrvr: %d\nClnt: %d\n",
             name, (void *)node, node->family == AF_INET ?
             get_addr2name4(node->u.ip, RESOLVE) :
             get_addr2name6(&node->u.ip6, RESOLVE),
             node->masklen, node->server_cnt, node->client_cnt);
         if (node->type == DIR_SERVER) {
-            strlcat(tree_print_buff, "Type: Server\n--\n", TREEPRINTBUFFLEN);
+            strlcat(buf, "Type: Server\n--\n", TREEPRINTBUFFLEN);
         }
         else {
-            strlcat(tree_print_buff, "Type: Client\n--", TREEPRINTBUFFLEN);
+            strlcat(buf, "Type: Client\n--", TREEPRINTBUFFLEN);
         }
 
     }
-    return (tree_print_buff);
-}
-
-/**
- * prints out the entire tree
- */
-static char *
-tree_print(tcpr_data_tree_t *treeroot)
-{
-    tcpr_tree_t *node = NULL;
-    memset(&tree_print_buff, '\0', TREEPRINTBUFFLEN);
-    RB_FOREACH(node, tcpr_data_tree_s, treeroot) {
-        tree_printnode("my node", node);
-    }
-    return (tree_print_buff);
-
+    return (buf);
 }
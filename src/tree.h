@@ -20,12 +20,15 @@
 #ifndef __TREE_H__
 #define __TREE_H__
 
-#include "lib/tree.h"
-
 #define TREEPRINTBUFFLEN 2048
 
+/* # of hosts we allocate at a time */
+#define TREE_BLOCK 4096
+
+/* initial # of hash table slots, must be a power of 2 */
+#define TREE_MIN_SLOTS 1024
+
 typedef struct tcpr_tree_s {
-    RB_ENTRY(tcpr_tree_s) node;
     int family;
     union {
         unsigned long ip;           /* ip/network address in network byte order */
@@ -36,13 +39,24 @@ typedef struct tcpr_tree_s {
     int server_cnt;             /* count # of times this entry was flagged server */
     int client_cnt;             /* flagged client */
     int type;                   /* 1 = server, 0 = client, -1 = undefined */
+    u_int32_t key;              /* auto mode host table index + 1, 0 = none */
 } tcpr_tree_t;
 
 /*
- * replacement for RB_HEAD() which doesn't actually declare the root
+ * All the hosts we've seen, in an open addressing hash table (linear
+ * probing) keyed on the address.  Hosts are allocated TREE_BLOCK at a
+ * time and never move, so pointers to them stay valid.
  */
 typedef struct tcpr_data_tree_s {
-    tcpr_tree_t *rbh_root;
+    tcpr_tree_t **slots;        /* NULL = empty */
+    u_int32_t size;             /* # of slots */
+    u_int32_t count;            /* # of hosts */
+    tcpr_tree_t *block;         /* hosts are allocated from here */
+    u_int32_t block_used;
+    tcpr_tree_t **blocks;       /* every block, for tree_free() */
+    u_int32_t nblocks;
+    tcpr_tree_t **sorted;       /* hosts in tree_comp() order, see tree_sorted() */
+    u_int32_t sorted_count;
 } tcpr_data_tree_t;
 
 typedef struct tcpr_buildcidr_s {
@@ -52,10 +66,12 @@ typedef struct tcpr_buildcidr_s {
 
 #define DNS_QUERY_FLAG 0x8000
 
-void add_tree_ipv4(const unsigned long, const u_char *);
-void add_tree_ipv6(const struct tcpr_in6_addr *, const u_char *);
-void add_tree_first_ipv4(const u_char *);
-void add_tree_first_ipv6(const u_char *);
+tcpr_tree_t *add_tree_ipv4(tcpr_data_tree_t *, const unsigned long, const u_char *);
+tcpr_tree_t *add_tree_ipv6(tcpr_data_tree_t *, const struct tcpr_in6_addr *, const u_char *);
+tcpr_tree_t *add_tree_first_ipv4(tcpr_data_tree_t *, const u_char *);
+tcpr_tree_t *add_tree_first_ipv6(tcpr_data_tree_t *, const u_char *);
+void tree_merge(tcpr_data_tree_t *, const tcpr_data_tree_t *);
+void tree_free(tcpr_data_tree_t *);
 tcpr_dir_t check_ip_tree(const int, const unsigned long);
 tcpr_dir_t check_ip6_tree(const int, const struct tcpr_in6_addr *);
 int process_tree();
@@ -0,0 +1,29 @@
+# Runs tcpprep on PCAP with ARGS, once with a single thread and once with
+# --threads=4, and fails unless both write the same cache file.  The args
+# aren't stored in the cache (--no-arg-comment) since they differ.
+#
+# cmake -D TCPPREP=<tcpprep> -D PCAP=<pcap> -D TEST=<name> -D ARGS=<args> -P PrepThreads.cmake
+
+separate_arguments(ARGS)
+
+foreach(__threads 1 4)
+    execute_process(COMMAND ${TCPPREP} -i ${PCAP} -o ${TEST}.${__threads} ${ARGS}
+            --threads=${__threads} --no-arg-comment
+        RESULT_VARIABLE rcode
+        ERROR_VARIABLE stderr
+        TIMEOUT 60
+        ERROR_STRIP_TRAILING_WHITESPACE)
+
+    if(NOT rcode EQUAL 0)
+        message(FATAL_ERROR "Running ${TEST} --threads=${__threads}: FAILED!  Error code: ${rcode}\n${stderr}")
+    endif(NOT rcode EQUAL 0)
+endforeach(__threads)
+
+execute_process(COMMAND ${CMAKE_COMMAND} -E compare_files ${TEST}.1 ${TEST}.4
+    RESULT_VARIABLE rcode)
+
+if(NOT rcode EQUAL 0)
+    message(FATAL_ERROR "Running ${TEST}: FAILED!  <--threads=4 cache file differs>")
+endif(NOT rcode EQUAL 0)
+
+message(STATUS "Running ${TEST}: OK!")
@@ -0,0 +1,12 @@
+
+message(STATUS "Cleaning Little-endian tests...")
+foreach(__file auto_bridge;auto_router;auto_client;auto_first;auto_server;cidr;cidr_reverse;comment;mac;mac_reverse;port;prep_config;regex;regex_reverse;auto_router_index rewrite_1ttl;rewrite_2ttl;rewrite_3ttl;rewrite_config;rewrite_dlthdlc;rewrite_dltuser;rewrite_efcs;rewrite_endpoint;rewrite_layer2;rewrite_mac;rewrite_pad;rewrite_pnat;rewrite_portmap;rewrite_seed;rewrite_skip;rewrite_tos;rewrite_trunc;rewrite_vlandel;rewrite_mtutrunc;rewrite_endpoint_v04;rewrite_threads;rewrite_direct_io)
+    FILE(REMOVE test2.${__file})
+endforeach(__file)
+
+INCLUDE(RunUnitTest.cmake)
+
+# Create custom commands for standards
+foreach(__test auto_bridge;auto_router;auto_client;auto_first;auto_server;cidr;cidr_reverse;comment;mac;mac_reverse;port;prep_config;regex;regex_reverse;auto_router_index rewrite_1ttl;rewrite_2ttl;rewrite_3ttl;rewrite_config;rewrite_dlthdlc;rewrite_dltuser;rewrite_efcs;rewrite_endpoint;rewrite_layer2;rewrite_mac;rewrite_pad;rewrite_pnat;rewrite_portmap;rewrite_seed;rewrite_skip;rewrite_tos;rewrite_trunc;rewrite_vlandel;rewrite_mtutrunc;rewrite_endpoint_v04;rewrite_threads;rewrite_direct_io)
+        run_unit_test(${__test} true)
+endforeach(__test)
@@ -0,0 +1,22 @@
+
+message(STATUS "Running Little-endian tests...")
+INCLUDE(RunUnitTest.cmake)
+
+# Create custom commands for standards
+foreach(__test auto_bridge;auto_router;auto_client;auto_first;auto_server;cidr;cidr_reverse;comment;mac;mac_reverse;port;prep_config;regex;regex_reverse;auto_router_index rewrite_1ttl;rewrite_2ttl;rewrite_3ttl;rewrite_config;rewrite_dlthdlc;rewrite_dltuser;rewrite_efcs;rewrite_endpoint;rewrite_layer2;rewrite_mac;rewrite_pad;rewrite_pnat;rewrite_portmap;rewrite_seed;rewrite_skip;rewrite_tos;rewrite_trunc;rewrite_vlandel;rewrite_mtutrunc;rewrite_endpoint_v04;rewrite_threads;rewrite_direct_io replay_basic;replay_cache;replay_pps;replay_rate;replay_top;replay_config;replay_multi;replay_pps_multi;replay_precache;replay_stats;replay_start)
+    run_unit_test(${__test} false)
+endforeach(__test)
+
+# tcpprep has to refuse a cache file whose checksum doesn't match
+message(STATUS "Running prep_badsum")
+execute_process(COMMAND /root/repo/src/tcpprep --print-comment test.badsum
+    WORKING_DIRECTORY /root/repo/test
+    RESULT_VARIABLE rcode
+    OUTPUT_QUIET
+    ERROR_QUIET
+    TIMEOUT 10)
+if(rcode EQUAL 0)
+    message(SEND_ERROR "Running prep_badsum: FAILED!  <checksum missmatch not detected>")
+else(rcode EQUAL 0)
+    message(STATUS "Running prep_badsum: OK!")
+endif(rcode EQUAL 0)
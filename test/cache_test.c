@@ -0,0 +1,144 @@
+/* $Id$ */
+
+/*
+ *   Copyright (c) 2001-2010 Aaron Turner <aturner at synfin dot net>
+ *
+ *   The Tcpreplay Suite of tools is free software: you can redistribute it
+ *   and/or modify it under the terms of the GNU General Public License as
+ *   published by the Free Software Foundation, either version 3 of the
+ *   License, or with the authors permission any later version.
+ *
+ *   The Tcpreplay Suite is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with the Tcpreplay Suite.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/*
+ * Checks decode_cache() against check_cache() on random tcpprep cache data.
+ * The cache holds a number of packets which is neither a multiple of
+ * CACHE_DECODE_BLOCK nor of CACHE_PACKETS_PER_BYTE, so the last block and
+ * the last byte are only partly used.  It is decoded in blocks the way
+ * tcpreplay does and then from random, mostly unaligned, packets on.
+ *
+ * Usage: cache_test [iterations [seed]]
+ */
+
+#include "config.h"
+#include "defines.h"
+#include "common.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "unit_test.h"
+
+/* 10 blocks, 3 packets in the last byte */
+#define TEST_PACKETS (10 * CACHE_DECODE_BLOCK + 4 * 17 + 3)
+#define TEST_BYTES ((TEST_PACKETS + CACHE_PACKETS_PER_BYTE - 1) / CACHE_PACKETS_PER_BYTE)
+#define DEFAULT_SEED 25
+#define GUARD 0xaa
+
+#ifdef DEBUG
+int debug = 0;
+#endif
+
+/**
+ * \brief decodes count packets from first and compares each with check_cache()
+ *
+ * Also makes sure decode_cache() doesn't write past dirs[count - 1].
+ * Returns 1 if anything didn't match, otherwise 0
+ */
+static int
+check_decode(char *cachedata, COUNTER first, COUNTER count, u_char *dirs)
+{
+    COUNTER i;
+    tcpr_dir_t want;
+    int errors = 0;
+
+    memset(dirs, GUARD, CACHE_DECODE_BLOCK + 1);
+    decode_cache(cachedata, first, count, dirs);
+
+    for (i = 0; i < count; i++) {
+        want = check_cache(cachedata, first + i);
+        if (dirs[i] != (u_char)want && errors++ < UNIT_MAX_ERRORS)
+            fprintf(stderr, "packet " COUNTER_SPEC " (first " COUNTER_SPEC ", count " COUNTER_SPEC
+                    "): got %d expected %d\n", first + i, first, count, dirs[i], want);
+    }
+
+    if (dirs[count] != GUARD && errors++ < UNIT_MAX_ERRORS)
+        fprintf(stderr, "first " COUNTER_SPEC ", count " COUNTER_SPEC ": wrote past the end\n",
+                first, count);
+
+    return errors ? 1 : 0;
+}
+
+int
+main(int argc, char *argv[])
+{
+    char *cachedata;
+    u_char dirs[CACHE_DECODE_BLOCK + 1];
+    unsigned int seed = DEFAULT_SEED;
+    int i, iterations = 100000, errors, checks, failed = 0;
+    COUNTER first, count;
+    char info[32];
+
+    if (argc > 1)
+        iterations = atoi(argv[1]);
+    if (argc > 2)
+        seed = (unsigned int)strtoul(argv[2], NULL, 0);
+
+    /* exactly as many bytes as the packets need, so over reads show up */
+    cachedata = (char *)safe_malloc(TEST_BYTES);
+    srandom(seed);
+    for (i = 0; i < TEST_BYTES; i++)
+        cachedata[i] = (char)random();
+
+    snprintf(info, sizeof(info), "seed %u", seed);
+
+    /* the whole cache a block at a time, like tcpreplay's cache_lookup() */
+    errors = checks = 0;
+    for (first = 1; first <= TEST_PACKETS; first += CACHE_DECODE_BLOCK, checks++) {
+        count = TEST_PACKETS - first + 1;
+        if (count > CACHE_DECODE_BLOCK)
+            count = CACHE_DECODE_BLOCK;
+        errors += check_decode(cachedata, first, count, dirs);
+    }
+    failed += unit_report("blocks", errors, checks, info);
+
+    /* random runs, which mostly start and end in the middle of a byte */
+    errors = 0;
+    for (i = 0; i < iterations; i++) {
+        first = 1 + random() % TEST_PACKETS;
+        count = random() % (CACHE_DECODE_BLOCK + 1);
+        if (count > TEST_PACKETS - first + 1)
+            count = TEST_PACKETS - first + 1;
+        errors += check_decode(cachedata, first, count, dirs);
+    }
+    failed += unit_report("random", errors, iterations, info);
+
+    /* every start & length within the last few bytes */
+    errors = checks = 0;
+    for (first = TEST_PACKETS - 3 * CACHE_PACKETS_PER_BYTE; first <= TEST_PACKETS; first++) {
+        for (count = 0; count <= TEST_PACKETS - first + 1; count++, checks++)
+            errors += check_decode(cachedata, first, count, dirs);
+    }
+    failed += unit_report("tail", errors, checks, info);
+
+    safe_free(cachedata);
+
+    return failed ? 1 : 0;
+}
+
+/*
+ Local Variables:
+ mode:c
+ indent-tabs-mode:nil
+ c-basic-offset:4
+ End:
+*/
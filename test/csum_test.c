@@ -0,0 +1,158 @@
+/* $Id$ */
+
+/*
+ *   Copyright (c) 2001-2010 Aaron Turner <aturner at synfin dot net>
+ *
+ *   The Tcpreplay Suite of tools is free software: you can redistribute it 
+ *   and/or modify it under the terms of the GNU General Public License as 
+ *   published by the Free Software Foundation, either version 3 of the 
+ *   License, or with the authors permission any later version.
+ *
+ *   The Tcpreplay Suite is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with the Tcpreplay Suite.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/*
+ * Fuzz test & microbenchmark for the checksum kernels in common/csum.c.
+ * Every kernel this CPU supports is checked against the scalar reference
+ * on the same random buffers of random length and alignment.  The seed is
+ * fixed unless one is given, so a failure can be re-run.  -b also times
+ * each kernel.
+ *
+ * Usage: csum_test [-b] [iterations [seed]]
+ */
+
+#include "config.h"
+#include "defines.h"
+#include "common/csum.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "unit_test.h"
+
+#define FUZZ_MAXLEN 4096
+#define BENCH_LEN 1500
+#define BENCH_BYTES (1ULL << 30)
+#define DEFAULT_SEED 1071
+
+#ifdef DEBUG
+int debug = 0;
+#endif
+
+static const char *kernels[] = { "scalar", "sse2", "avx2", "avx512", NULL };
+
+/**
+ * \brief compare the current kernel with csum_partial_ref()
+ *
+ * Returns the number of mismatches
+ */
+static int
+fuzz(u_char *buf, int iterations)
+{
+    int i, errors = 0;
+    size_t off, len, j;
+    u_int32_t seed, got, want;
+
+    for (i = 0; i < iterations; i++) {
+        off = (size_t)(random() % 64);
+        len = (size_t)(random() % (FUZZ_MAXLEN - 64));
+        seed = (u_int32_t)(random() % 3 == 0 ? random() & 0xffff : 0);
+        for (j = 0; j < len; j++)
+            buf[off + j] = (u_char)random();
+
+        got = csum_partial(buf + off, len, seed);
+        want = csum_partial_ref(buf + off, len, seed);
+        if (got != want) {
+            if (errors++ < UNIT_MAX_ERRORS)
+                fprintf(stderr, "%s: len %zu off %zu seed 0x%04x: got 0x%04x expected 0x%04x\n",
+                        csum_kernel(), len, off, seed, got, want);
+        }
+    }
+
+    return errors;
+}
+
+/**
+ * \brief returns the throughput of the current kernel in MB/sec
+ */
+static double
+bench(const u_char *buf)
+{
+    u_int64_t i, loops = BENCH_BYTES / BENCH_LEN;
+    volatile u_int32_t sum = 0;
+    double start, end;
+
+    start = unit_now();
+    for (i = 0; i < loops; i++)
+        sum += csum_partial(buf, BENCH_LEN, 0);
+    end = unit_now();
+
+    return (double)(loops * BENCH_LEN) / (end - start) / (1024.0 * 1024.0);
+}
+
+int
+main(int argc, char *argv[])
+{
+    u_char *buf;
+    unsigned int seed = DEFAULT_SEED;
+    int ch, k, iterations = 100000, failed = 0, errors, benchmark = 0;
+    char info[48];
+    size_t n;
+
+    while ((ch = getopt(argc, argv, "b")) != -1) {
+        switch (ch) {
+        case 'b':
+            benchmark = 1;
+            break;
+        default:
+            fprintf(stderr, "Usage: csum_test [-b] [iterations [seed]]\n");
+            return 1;
+        }
+    }
+    if (optind < argc)
+        iterations = atoi(argv[optind++]);
+    if (optind < argc)
+        seed = (unsigned int)strtoul(argv[optind++], NULL, 0);
+
+    if ((buf = malloc(FUZZ_MAXLEN)) == NULL) {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+
+    csum_init();
+    printf("default kernel: %s\n", csum_kernel());
+
+    for (k = 0; kernels[k] != NULL; k++) {
+        if (csum_set_kernel(kernels[k]) < 0) {
+            printf("%-8s unsupported\n", kernels[k]);
+            continue;
+        }
+
+        /* every kernel gets the same buffers */
+        srandom(seed);
+        errors = fuzz(buf, iterations);
+        n = snprintf(info, sizeof(info), "seed %u", seed);
+        if (benchmark)
+            snprintf(info + n, sizeof(info) - n, ", %.0f MB/sec", bench(buf));
+        failed += unit_report(kernels[k], errors, iterations, info);
+    }
+
+    free(buf);
+    return failed ? 1 : 0;
+}
+
+/*
+ Local Variables:
+ mode:c
+ indent-tabs-mode:nil
+ c-basic-offset:4
+ End:
+*/
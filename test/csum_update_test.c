@@ -0,0 +1,236 @@
+/* $Id$ */
+
+/*
+ *   Copyright (c) 2001-2010 Aaron Turner <aturner at synfin dot net>
+ *
+ *   The Tcpreplay Suite of tools is free software: you can redistribute it
+ *   and/or modify it under the terms of the GNU General Public License as
+ *   published by the Free Software Foundation, either version 3 of the
+ *   License, or with the authors permission any later version.
+ *
+ *   The Tcpreplay Suite is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with the Tcpreplay Suite.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/*
+ * Checks the RFC 1624 incremental checksum updates tcpedit uses when
+ * --fixcsum isn't given.  Random IPv4/IPv6 TCP/UDP packets get their
+ * addresses, ports, TTL/hop limit and TOS/traffic class rewritten, and the
+ * patched checksums have to match a full recompute.
+ *
+ * Usage: csum_update_test [packets [seed]]
+ */
+
+#include "config.h"
+#include "defines.h"
+#include "common.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "tcpedit/tcpedit.h"
+#include "tcpedit/checksum.h"
+#include "unit_test.h"
+
+#define MAX_PAYLOAD 1460
+#define MAX_PACKET (60 + TCPR_TCP_H + MAX_PAYLOAD)
+#define DEFAULT_SEED 1624
+
+#ifdef DEBUG
+int debug = 0;
+#endif
+
+/**
+ * \brief fills buf with a random packet of the given IP version & protocol
+ *
+ * The checksums are calculated the slow way.  Returns the length of the
+ * packet and points l4 at its TCP/UDP header.
+ */
+static int
+random_packet(tcpedit_t *tcpedit, u_char *buf, bool v6, int proto, u_char **l4)
+{
+    ipv4_hdr_t *ip_hdr = (ipv4_hdr_t *)buf;
+    ipv6_hdr_t *ip6_hdr = (ipv6_hdr_t *)buf;
+    int i, l3len, l4len;
+
+    /* IPv4 headers get 0 - 40 bytes of options */
+    l3len = v6 ? TCPR_IPV6_H : (5 + random() % 11) * 4;
+    l4len = (proto == IPPROTO_TCP ? TCPR_TCP_H : TCPR_UDP_H) + random() % MAX_PAYLOAD;
+    for (i = 0; i < l3len + l4len; i++)
+        buf[i] = (u_char)random();
+
+    if (v6) {
+        ip6_hdr->ip_flags[0] = 0x60 | (ip6_hdr->ip_flags[0] & 0x0f);
+        ip6_hdr->ip_len = htons(l4len);
+        ip6_hdr->ip_nh = proto;
+    } else {
+        ip_hdr->ip_v = 4;
+        ip_hdr->ip_hl = l3len / 4;
+        ip_hdr->ip_len = htons(l3len + l4len);
+        ip_hdr->ip_p = proto;
+    }
+
+    *l4 = buf + l3len;
+    if (proto == IPPROTO_UDP) {
+        ((udp_hdr_t *)*l4)->uh_ulen = htons(l4len);
+        /* some senders don't checksum UDP, which has to stay that way */
+        if (random() % 8 == 0)
+            ((udp_hdr_t *)*l4)->uh_sum = 0;
+    }
+
+    do_checksum(tcpedit, buf, proto, l4len);
+    if (!v6)
+        do_checksum(tcpedit, buf, IPPROTO_IP, l3len);
+
+    return l3len + l4len;
+}
+
+/**
+ * \brief rewrites what tcpedit may rewrite, each field with a 50% chance
+ */
+static void
+edit_packet(u_char *buf, bool v6, u_char *l4, bool ports)
+{
+    int i, first, last;
+
+    if (v6) {
+        /* traffic class & flow label, hop limit, addresses */
+        if (random() % 2)
+            buf[1] = (u_char)random();
+        if (random() % 2)
+            buf[7] = (u_char)random();
+        first = 8;
+        last = 40;
+    } else {
+        /* TOS, TTL, addresses */
+        if (random() % 2)
+            buf[1] = (u_char)random();
+        if (random() % 2)
+            buf[8] = (u_char)random();
+        first = 12;
+        last = 20;
+    }
+
+    for (i = first; i < last; i += 2) {
+        if (random() % 2) {
+            buf[i] = (u_char)random();
+            buf[i + 1] = (u_char)random();
+        }
+    }
+
+    if (ports) {
+        for (i = 0; i < 4; i += 2) {
+            if (random() % 2) {
+                l4[i] = (u_char)random();
+                l4[i + 1] = (u_char)random();
+            }
+        }
+    }
+}
+
+/**
+ * \brief returns the L4 checksum of a packet
+ */
+static u_int16_t
+l4_sum(const u_char *l4, int proto)
+{
+    if (proto == IPPROTO_TCP)
+        return ((const tcp_hdr_t *)l4)->th_sum;
+
+    return ((const udp_hdr_t *)l4)->uh_sum;
+}
+
+int
+main(int argc, char *argv[])
+{
+    tcpedit_t *tcpedit;
+    csum_snapshot_t snap;
+    u_char *buf, *ref, *l4;
+    unsigned int seed = DEFAULT_SEED;
+    int i, k, len, proto, packets = 20000, failed = 0, errors, checks;
+    u_int16_t got, want;
+    bool v6, ports;
+    char name[16], info[32];
+
+    if (argc > 1)
+        packets = atoi(argv[1]);
+    if (argc > 2)
+        seed = (unsigned int)strtoul(argv[2], NULL, 0);
+
+    tcpedit = (tcpedit_t *)safe_malloc(sizeof(tcpedit_t));
+    buf = (u_char *)safe_malloc(MAX_PACKET);
+    ref = (u_char *)safe_malloc(MAX_PACKET);
+    srandom(seed);
+
+    for (k = 0; k < 4; k++) {
+        v6 = k & 1;
+        proto = k & 2 ? IPPROTO_UDP : IPPROTO_TCP;
+        errors = checks = 0;
+
+        for (i = 0; i < packets; i++) {
+            len = random_packet(tcpedit, buf, v6, proto, &l4);
+
+            /* tcpedit only snapshots the ports when there's a --portmap */
+            ports = random() % 2;
+            checksum_snapshot(&snap, buf, ports ? l4 : NULL);
+            edit_packet(buf, v6, l4, ports);
+
+            /* the reference gets the full recompute --fixcsum would do */
+            memcpy(ref, buf, len);
+            do_checksum(tcpedit, ref, proto, len - (int)(l4 - buf));
+            if (!v6)
+                do_checksum(tcpedit, ref, IPPROTO_IP, (int)(l4 - buf));
+
+            do_checksum_update(tcpedit, &snap, buf, l4, proto);
+
+            if (!v6) {
+                checks++;
+                got = ((ipv4_hdr_t *)buf)->ip_sum;
+                want = ((ipv4_hdr_t *)ref)->ip_sum;
+                if (got != want && errors++ < UNIT_MAX_ERRORS)
+                    fprintf(stderr, "packet %d: IP checksum 0x%04x, expected 0x%04x\n",
+                            i, ntohs(got), ntohs(want));
+            }
+
+            /*
+             * a computed UDP checksum of 0 is sent as 0xffff (RFC 768),
+             * which the incremental update does and the full recompute
+             * doesn't.  They're the same one's complement value.
+             */
+            checks++;
+            got = l4_sum(l4, proto);
+            want = l4_sum(ref + (l4 - buf), proto);
+            if (proto == IPPROTO_UDP && got == 0xffff && want == 0)
+                continue;
+            if (got != want && errors++ < UNIT_MAX_ERRORS)
+                fprintf(stderr, "packet %d: %s checksum 0x%04x, expected 0x%04x\n",
+                        i, proto == IPPROTO_TCP ? "TCP" : "UDP", ntohs(got), ntohs(want));
+        }
+
+        snprintf(name, sizeof(name), "%s/%s", v6 ? "ipv6" : "ipv4",
+                proto == IPPROTO_TCP ? "tcp" : "udp");
+        snprintf(info, sizeof(info), "seed %u", seed);
+        failed += unit_report(name, errors, checks, info);
+    }
+
+    safe_free(ref);
+    safe_free(buf);
+    safe_free(tcpedit);
+
+    return failed ? 1 : 0;
+}
+
+/*
+ Local Variables:
+ mode:c
+ indent-tabs-mode:nil
+ c-basic-offset:4
+ End:
+*/
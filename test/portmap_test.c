@@ -0,0 +1,148 @@
+/* $Id$ */
+
+/*
+ *   Copyright (c) 2001-2010 Aaron Turner <aturner at synfin dot net>
+ *
+ *   The Tcpreplay Suite of tools is free software: you can redistribute it 
+ *   and/or modify it under the terms of the GNU General Public License as 
+ *   published by the Free Software Foundation, either version 3 of the 
+ *   License, or with the authors permission any later version.
+ *
+ *   The Tcpreplay Suite is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with the Tcpreplay Suite.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/*
+ * Checks the compiled --portmap lookup table against the map_port() linked
+ * list walk for every port, using a large PNAT style map made of many port
+ * ranges.  -b also times both lookups.
+ *
+ * Usage: portmap_test [-b] [ranges]
+ */
+
+#include "config.h"
+#include "defines.h"
+#include "common.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "tcpedit/tcpedit.h"
+#include "tcpedit/portmap.h"
+#include "unit_test.h"
+
+#define LOOKUPS 1000000
+#define BENCH_SEED 1024
+
+#ifdef DEBUG
+int debug = 0;
+#endif
+
+/**
+ * \brief times map_port() and the table on the same random ports
+ */
+static void
+bench(tcpedit_portmap_t *portmap, const u_int16_t *table, int ranges,
+        char *timing, size_t timing_len)
+{
+    u_int16_t *ports;
+    volatile long sum = 0;
+    double start, list_time, table_time;
+    int i;
+
+    srandom(BENCH_SEED);
+    ports = safe_malloc(sizeof(u_int16_t) * LOOKUPS);
+    for (i = 0; i < LOOKUPS; i++)
+        ports[i] = htons(1024 + random() % (ranges * 20));
+
+    start = unit_now();
+    for (i = 0; i < LOOKUPS; i++)
+        sum += map_port(portmap, ports[i]);
+    list_time = unit_now() - start;
+
+    start = unit_now();
+    for (i = 0; i < LOOKUPS; i++)
+        sum += table[ports[i]];
+    table_time = unit_now() - start;
+
+    snprintf(timing, timing_len, "list %.1f ns/lookup, table %.1f ns/lookup",
+            list_time * 1e9 / LOOKUPS, table_time * 1e9 / LOOKUPS);
+    safe_free(ports);
+}
+
+int
+main(int argc, char *argv[])
+{
+    tcpedit_portmap_t *portmap = NULL;
+    u_int16_t *table;
+    char *mapstr, *p;
+    int ch, i, ranges = 200, errors = 0, benchmark = 0;
+    char name[16], timing[64] = "not timed";
+
+    while ((ch = getopt(argc, argv, "b")) != -1) {
+        switch (ch) {
+        case 'b':
+            benchmark = 1;
+            break;
+        default:
+            fprintf(stderr, "Usage: portmap_test [-b] [ranges]\n");
+            return 1;
+        }
+    }
+    if (optind < argc)
+        ranges = atoi(argv[optind]);
+
+    if (ranges < 1 || ranges > 6000) {
+        fprintf(stderr, "ranges must be between 1 and 6000\n");
+        return 1;
+    }
+
+    /* 10 port wide ranges, each mapped to its own port: "1024-1033:40000,..." */
+    mapstr = safe_malloc(ranges * 24);
+    for (i = 0, p = mapstr; i < ranges; i++)
+        p += sprintf(p, "%s%d-%d:%d", i ? "," : "", 1024 + i * 10,
+                1024 + i * 10 + 9, 1024 + (i * 7919) % 60000);
+
+    if (! parse_portmap(&portmap, mapstr)) {
+        fprintf(stderr, "unable to parse portmap\n");
+        return 1;
+    }
+    table = compile_portmap(portmap);
+
+    /* table must agree with the list for every port */
+    for (i = 0; i < 65536; i++) {
+        if (table[i] != (u_int16_t)map_port(portmap, i)) {
+            if (errors++ < UNIT_MAX_ERRORS)
+                fprintf(stderr, "port %d: table %u, list %ld\n", i, table[i],
+                        map_port(portmap, i));
+        }
+    }
+
+    if (benchmark)
+        bench(portmap, table, ranges, timing, sizeof(timing));
+
+    snprintf(name, sizeof(name), "%d ranges", ranges);
+    unit_report(name, errors, 65536, timing);
+
+    safe_free(table);
+    safe_free(mapstr);
+    free_portmap(portmap);
+
+    return errors ? 1 : 0;
+}
+
+/*
+ Local Variables:
+ mode:c
+ indent-tabs-mode:nil
+ c-basic-offset:4
+ End:
+*/
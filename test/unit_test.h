@@ -0,0 +1,70 @@
+/* $Id$ */
+
+/*
+ *   Copyright (c) 2001-2010 Aaron Turner <aturner at synfin dot net>
+ *
+ *   The Tcpreplay Suite of tools is free software: you can redistribute it
+ *   and/or modify it under the terms of the GNU General Public License as
+ *   published by the Free Software Foundation, either version 3 of the
+ *   License, or with the authors permission any later version.
+ *
+ *   The Tcpreplay Suite is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with the Tcpreplay Suite.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/*
+ * Helpers shared by the standalone test programs run by ctest.  Each one
+ * checks a fast code path against its slow reference implementation, and
+ * times it when asked to with -b.
+ */
+
+#ifndef __UNIT_TEST_H__
+#define __UNIT_TEST_H__
+
+#include <stdio.h>
+#include <sys/time.h>
+
+/* only print the first few mismatches of each check */
+#define UNIT_MAX_ERRORS 10
+
+/**
+ * \brief wall clock time in seconds
+ */
+static inline double
+unit_now(void)
+{
+    struct timeval tv;
+
+    gettimeofday(&tv, NULL);
+    return (double)tv.tv_sec + (double)tv.tv_usec / 1000000.0;
+}
+
+/**
+ * \brief prints the one line summary of a check
+ *
+ * Returns 1 if the check failed, 0 otherwise, so the results can be
+ * added up for the exit code.
+ */
+static inline int
+unit_report(const char *name, int errors, int checks, const char *info)
+{
+    printf("%-8s %s (%d/%d mismatches), %s\n", name,
+            errors ? "FAILED" : "ok", errors, checks, info);
+    return errors ? 1 : 0;
+}
+
+#endif
+
+/*
+ Local Variables:
+ mode:c
+ indent-tabs-mode:nil
+ c-basic-offset:4
+ End:
+*/